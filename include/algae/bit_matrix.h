@@ -0,0 +1,335 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#include <algae/matrix.h>
+#include <algae/semiring.h>
+
+/*
+  matrices of bits, 64 to a word. Each row starts a new word, lowest bit
+  first, and the bits past the width stay zero; that's what the bit
+  kernels take. Products are the method of four russians.
+*/
+
+namespace algae {
+
+namespace impl {
+
+constexpr std::size_t bit_words(std::size_t bits) { return (bits + 63) / 64; }
+
+constexpr std::size_t popcount(std::uint64_t x) {
+#if defined(__GNUC__)
+  return static_cast<std::size_t>(__builtin_popcountll(x));
+#else
+  x = x - ((x >> 1) & 0x5555555555555555ull);
+  x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+  return static_cast<std::size_t>((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// the index of the lowest set bit; x must not be zero
+constexpr std::size_t lowest_bit(std::uint64_t x) {
+  return impl::popcount((x & (~x + 1)) - 1);
+}
+
+// plus, on 64 entries at once
+constexpr std::uint64_t bit_plus(or_and, std::uint64_t a, std::uint64_t b) {
+  return a | b;
+}
+constexpr std::uint64_t bit_plus(xor_and, std::uint64_t a, std::uint64_t b) {
+  return a ^ b;
+}
+
+// transposes a 64 x 64 block of bits in place, by swapping the
+// off-diagonal quarters, then the quarters of each quarter, and so on
+constexpr void transpose_bits(std::uint64_t (&block)[64]) {
+  auto mask = std::uint64_t(0x00000000ffffffff);
+  for (std::size_t j = 32; j != 0; j /= 2, mask ^= mask << j) {
+    for (std::size_t k = 0; k < 64; ++k) {
+      if ((k & j) == 0) {
+        auto const t = ((block[k] >> j) ^ block[k + j]) & mask;
+        block[k] ^= t << j;
+        block[k + j] ^= t;
+      }
+    }
+  }
+}
+
+} // namespace impl
+
+template <std::size_t Height, std::size_t Width>
+class bit_matrix {
+public:
+  // the words in each row
+  static constexpr std::size_t row_words = impl::bit_words(Width);
+
+private:
+  std::uint64_t underlying_[Height * row_words];
+
+public:
+  using value_type = bool;
+
+  constexpr bit_matrix() : underlying_{} {}
+
+  constexpr bit_matrix(std::array<std::array<bool, Width>, Height> const& init)
+      : underlying_{} {
+    for (std::size_t row = 0; row < Height; ++row) {
+      for (std::size_t col = 0; col < Width; ++col) {
+        set(row, col, init[row][col]);
+      }
+    }
+  }
+
+  // packs a matrix of bools; this is a copy, so it has to be asked for
+  template <typename Layout>
+  constexpr explicit bit_matrix(matrix<bool, Height, Width, Layout> const& m)
+      : underlying_{} {
+    for (std::size_t row = 0; row < Height; ++row) {
+      for (std::size_t col = 0; col < Width; ++col) {
+        set(row, col, m(row, col));
+      }
+    }
+  }
+
+  static constexpr std::size_t height() noexcept { return Height; }
+  static constexpr std::size_t width() noexcept { return Width; }
+
+  constexpr bool operator()(std::size_t row, std::size_t col) const {
+    return ((row_data(row)[col / 64] >> (col % 64)) & 1) != 0;
+  }
+  constexpr void set(std::size_t row, std::size_t col, bool value = true) {
+    auto const bit = std::uint64_t(1) << (col % 64);
+    auto& word = row_data(row)[col / 64];
+    word = value ? word | bit : word & ~bit;
+  }
+  constexpr void flip(std::size_t row, std::size_t col) {
+    row_data(row)[col / 64] ^= std::uint64_t(1) << (col % 64);
+  }
+
+  // the row_words words of a row; the bits past width() must stay zero
+  constexpr std::uint64_t* row_data(std::size_t row) noexcept {
+    return underlying_ + row * row_words;
+  }
+  constexpr std::uint64_t const* row_data(std::size_t row) const noexcept {
+    return underlying_ + row * row_words;
+  }
+
+  // every row, one after another
+  constexpr std::uint64_t* data() noexcept { return underlying_; }
+  constexpr std::uint64_t const* data() const noexcept { return underlying_; }
+  static constexpr std::size_t storage_size() noexcept {
+    return Height * row_words;
+  }
+
+  template <typename Layout = row_major>
+  constexpr matrix<bool, Height, Width, Layout> unpack() const {
+    auto ret = matrix<bool, Height, Width, Layout>();
+    for (std::size_t row = 0; row < Height; ++row) {
+      for (std::size_t col = 0; col < Width; ++col) {
+        ret(row, col) = (*this)(row, col);
+      }
+    }
+    return ret;
+  }
+};
+
+template <std::size_t H, std::size_t W>
+constexpr bool
+operator==(bit_matrix<H, W> const& lhs, bit_matrix<H, W> const& rhs) {
+  for (std::size_t idx = 0; idx < lhs.storage_size(); ++idx) {
+    if (lhs.data()[idx] != rhs.data()[idx]) {
+      return false;
+    }
+  }
+  return true;
+}
+template <std::size_t H, std::size_t W>
+constexpr bool
+operator!=(bit_matrix<H, W> const& lhs, bit_matrix<H, W> const& rhs) {
+  return !(lhs == rhs);
+}
+
+// a 64 x 64 block at a time
+template <std::size_t H, std::size_t W>
+constexpr bit_matrix<W, H> transpose(bit_matrix<H, W> const& m) {
+  auto ret = bit_matrix<W, H>();
+  for (std::size_t i0 = 0; i0 < H; i0 += 64) {
+    for (std::size_t j0 = 0; j0 < W; j0 += 64) {
+      std::uint64_t block[64] = {};
+      for (std::size_t i = i0; i < H && i < i0 + 64; ++i) {
+        block[i - i0] = m.row_data(i)[j0 / 64];
+      }
+      impl::transpose_bits(block);
+      for (std::size_t j = j0; j < W && j < j0 + 64; ++j) {
+        ret.row_data(j)[i0 / 64] = block[j - j0];
+      }
+    }
+  }
+  return ret;
+}
+
+// the product over or_and or xor_and
+template <std::size_t M, std::size_t K, std::size_t N, typename Semiring>
+constexpr bit_matrix<M, N> multiply(
+    bit_matrix<M, K> const& lhs, bit_matrix<K, N> const& rhs, Semiring) {
+  static_assert(
+      std::is_same_v<Semiring, or_and> || std::is_same_v<Semiring, xor_and>,
+      "bit matrices multiply over or_and or xor_and");
+  constexpr auto words = bit_matrix<M, N>::row_words;
+  // a panel of columns at a time, so the table is only 16KiB
+  constexpr std::size_t panel = 8;
+
+  auto ret = bit_matrix<M, N>();
+  for (std::size_t j0 = 0; j0 < words; j0 += panel) {
+    auto const nb = j0 + panel < words ? panel : words - j0;
+    for (std::size_t p0 = 0; p0 < K; p0 += 8) {
+      auto const rows = p0 + 8 < K ? std::size_t(8) : K - p0;
+
+      // every entry is the one with its lowest bit cleared, plus a row
+      std::uint64_t table[256][panel] = {};
+      for (std::size_t s = 1; s < (std::size_t(1) << rows); ++s) {
+        auto const low = impl::lowest_bit(s);
+        auto const rhs_row = rhs.row_data(p0 + low) + j0;
+        auto const prev = s & ~(std::size_t(1) << low);
+        for (std::size_t j = 0; j < nb; ++j) {
+          table[s][j] =
+              impl::bit_plus(Semiring(), table[prev][j], rhs_row[j]);
+        }
+      }
+
+      for (std::size_t i = 0; i < M; ++i) {
+        auto const byte = (lhs.row_data(i)[p0 / 64] >> (p0 % 64)) & 0xff;
+        if (byte != 0) {
+          auto const ret_row = ret.row_data(i) + j0;
+          for (std::size_t j = 0; j < nb; ++j) {
+            ret_row[j] =
+                impl::bit_plus(Semiring(), ret_row[j], table[byte][j]);
+          }
+        }
+      }
+    }
+  }
+  return ret;
+}
+
+// ret(i, j) = the number of bits set in both row i of lhs and row j of rhs
+template <std::size_t M, std::size_t N, std::size_t W>
+constexpr matrix<std::size_t, M, N>
+and_popcounts(bit_matrix<M, W> const& lhs, bit_matrix<N, W> const& rhs) {
+  auto ret = matrix<std::size_t, M, N>();
+  for (std::size_t i = 0; i < M; ++i) {
+    for (std::size_t j = 0; j < N; ++j) {
+      for (std::size_t word = 0; word < lhs.row_words; ++word) {
+        ret(i, j) +=
+            impl::popcount(lhs.row_data(i)[word] & rhs.row_data(j)[word]);
+      }
+    }
+  }
+  return ret;
+}
+
+// ret(i, j) = the hamming distance between row i of lhs and row j of rhs
+template <std::size_t M, std::size_t N, std::size_t W>
+constexpr matrix<std::size_t, M, N>
+xor_popcounts(bit_matrix<M, W> const& lhs, bit_matrix<N, W> const& rhs) {
+  auto ret = matrix<std::size_t, M, N>();
+  for (std::size_t i = 0; i < M; ++i) {
+    for (std::size_t j = 0; j < N; ++j) {
+      for (std::size_t word = 0; word < lhs.row_words; ++word) {
+        ret(i, j) +=
+            impl::popcount(lhs.row_data(i)[word] ^ rhs.row_data(j)[word]);
+      }
+    }
+  }
+  return ret;
+}
+
+// puts m in reduced row echelon form, over GF(2), and returns its rank
+template <std::size_t H, std::size_t W>
+constexpr std::size_t row_reduce(bit_matrix<H, W>& m) {
+  constexpr auto words = bit_matrix<H, W>::row_words;
+
+  std::size_t rank = 0;
+  for (std::size_t col = 0; col < W && rank < H; ++col) {
+    auto const word = col / 64;
+    auto const bit = std::uint64_t(1) << (col % 64);
+
+    auto pivot = rank;
+    while (pivot < H && (m.row_data(pivot)[word] & bit) == 0) {
+      ++pivot;
+    }
+    if (pivot == H) {
+      continue;
+    }
+
+    // the rows from `rank` down are zero before `col`, so the row
+    // operations can start at its word
+    auto const pivot_row = m.row_data(rank);
+    if (pivot != rank) {
+      auto const other = m.row_data(pivot);
+      for (auto idx = word; idx < words; ++idx) {
+        auto const tmp = pivot_row[idx];
+        pivot_row[idx] = other[idx];
+        other[idx] = tmp;
+      }
+    }
+    for (std::size_t row = 0; row < H; ++row) {
+      auto const row_bits = m.row_data(row);
+      if (row != rank && (row_bits[word] & bit) != 0) {
+        for (auto idx = word; idx < words; ++idx) {
+          row_bits[idx] ^= pivot_row[idx];
+        }
+      }
+    }
+    ++rank;
+  }
+  return rank;
+}
+
+// the rank over GF(2)
+template <std::size_t H, std::size_t W>
+constexpr std::size_t rank(bit_matrix<H, W> m) {
+  return row_reduce(m);
+}
+
+// an x with a * x = b, over GF(2), or std::nullopt if there isn't one
+// if there are many, the free variables are all zero
+template <std::size_t H, std::size_t W, std::size_t R>
+constexpr std::optional<bit_matrix<W, R>>
+solve(bit_matrix<H, W> const& a, bit_matrix<H, R> const& b) {
+  auto augmented = bit_matrix<H, W + R>();
+  for (std::size_t row = 0; row < H; ++row) {
+    for (std::size_t col = 0; col < W; ++col) {
+      augmented.set(row, col, a(row, col));
+    }
+    for (std::size_t col = 0; col < R; ++col) {
+      augmented.set(row, W + col, b(row, col));
+    }
+  }
+  auto const pivots = row_reduce(augmented);
+
+  auto ret = bit_matrix<W, R>();
+  for (std::size_t row = 0; row < pivots; ++row) {
+    auto const row_bits = augmented.row_data(row);
+    std::size_t word = 0;
+    while (row_bits[word] == 0) {
+      ++word;
+    }
+    auto const pivot = word * 64 + impl::lowest_bit(row_bits[word]);
+    // a pivot in b is a row 0 = 1
+    if (pivot >= W) {
+      return std::nullopt;
+    }
+    for (std::size_t col = 0; col < R; ++col) {
+      ret.set(pivot, col, augmented(row, W + col));
+    }
+  }
+  return ret;
+}
+
+} // namespace algae
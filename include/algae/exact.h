@@ -0,0 +1,511 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+#include <algae/matrix.h>
+#include <algae/modint.h>
+
+/*
+  bareiss' fraction-free elimination over the signed integers. Arithmetic
+  is in T by default, at twice its width with `algae::checked`, or mod
+  many primes with `algae::multimodular`.
+*/
+
+namespace algae {
+
+struct checked_t {};
+constexpr static checked_t checked;
+
+struct multimodular_t {};
+constexpr static multimodular_t multimodular;
+
+// the solution of a * x = b is numerators / denominator, where the
+// denominator is |det(a)|
+template <typename T, std::size_t N, std::size_t R>
+struct exact_solution {
+  matrix<T, N, R> numerators;
+  T denominator;
+};
+
+namespace impl {
+
+template <typename T>
+constexpr bool is_exact_integer = std::is_integral_v<T> && std::is_signed_v<T>;
+
+// twice the width of T; or, where there's no such type, the widest there is
+template <typename T>
+struct wider {
+#if defined(__SIZEOF_INT128__)
+  __extension__ typedef __int128 widest;
+#else
+  using widest = std::intmax_t;
+#endif
+  using type = std::conditional_t<
+      (sizeof(T) < sizeof(std::int64_t)),
+      std::int64_t,
+      widest>;
+  static constexpr bool is_wide = sizeof(type) >= 2 * sizeof(T);
+};
+
+template <typename T>
+constexpr bool checked_multiply(T lhs, T rhs, T& out) {
+  constexpr auto max = std::numeric_limits<T>::max();
+  constexpr auto min = std::numeric_limits<T>::min();
+  if (lhs > 0 ? (rhs > 0 ? lhs > max / rhs : rhs < min / lhs)
+              : (rhs > 0 ? lhs < min / rhs : lhs != 0 && rhs < max / lhs)) {
+    return false;
+  }
+  out = T(lhs * rhs);
+  return true;
+}
+
+// x = (x * pivot - a * b) / previous, which is exact; false if checked, and
+// the result doesn't fit
+template <bool Checked, typename T>
+constexpr bool bareiss_update(T& x, T pivot, T a, T b, T previous) {
+  constexpr auto max = std::numeric_limits<T>::max();
+  constexpr auto min = std::numeric_limits<T>::min();
+  if constexpr (!Checked) {
+    x = T((x * pivot - a * b) / previous);
+  } else if constexpr (wider<T>::is_wide) {
+    using wide = typename wider<T>::type;
+    auto const ret = (wide(x) * pivot - wide(a) * b) / previous;
+    if (ret < min || ret > max) {
+      return false;
+    }
+    x = T(ret);
+  } else {
+    // no wider type, so the products have to fit too
+    auto lhs = T(0);
+    auto rhs = T(0);
+    if (!checked_multiply(x, pivot, lhs) || !checked_multiply(a, b, rhs)) {
+      return false;
+    }
+    if (rhs < 0 ? lhs > max + rhs : lhs < min + rhs) {
+      return false;
+    }
+    // ...and so does the quotient, which doesn't for min / -1
+    auto const difference = T(lhs - rhs);
+    if (difference == min && previous == T(-1)) {
+      return false;
+    }
+    x = T(difference / previous);
+  }
+  return true;
+}
+
+template <typename T>
+struct bareiss_result {
+  std::size_t rank;
+  // the last pivot; if m is square and of full rank, this is its
+  // determinant, up to sign
+  T pivot;
+  // whether there were an odd number of row swaps
+  bool negated;
+};
+
+// puts m in fraction-free row echelon form; std::nullopt if checked, and
+// a minor doesn't fit
+template <
+    bool Checked,
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout>
+constexpr std::optional<bareiss_result<T>>
+bareiss_echelon(matrix<T, H, W, Layout>& m) {
+  auto ret = bareiss_result<T>{0, T(1), false};
+  for (std::size_t col = 0; col < W && ret.rank < H; ++col) {
+    auto pivot = ret.rank;
+    while (pivot < H && m(pivot, col) == T(0)) {
+      ++pivot;
+    }
+    if (pivot == H) {
+      continue;
+    }
+
+    auto const top = ret.rank;
+    // the rows from `top` down are zero before `col`
+    if (pivot != top) {
+      for (auto idx = col; idx < W; ++idx) {
+        auto const tmp = m(pivot, idx);
+        m(pivot, idx) = m(top, idx);
+        m(top, idx) = tmp;
+      }
+      ret.negated = !ret.negated;
+    }
+    for (auto row = top + 1; row < H; ++row) {
+      for (auto idx = col + 1; idx < W; ++idx) {
+        auto const ok = bareiss_update<Checked>(
+            m(row, idx), m(top, col), m(row, col), m(top, idx), ret.pivot);
+        if (!ok) {
+          return std::nullopt;
+        }
+      }
+      m(row, col) = T(0);
+    }
+    ret.pivot = m(top, col);
+    ++ret.rank;
+  }
+  return ret;
+}
+
+template <bool Checked, typename T, std::size_t N, typename Layout>
+constexpr std::optional<T> bareiss_determinant(matrix<T, N, N, Layout> m) {
+  auto const result = bareiss_echelon<Checked>(m);
+  if (!result) {
+    return std::nullopt;
+  }
+  if (result->rank < N) {
+    return T(0);
+  }
+  if (!result->negated) {
+    return result->pivot;
+  }
+  if (Checked && result->pivot == std::numeric_limits<T>::min()) {
+    return std::nullopt;
+  }
+  return T(-result->pivot);
+}
+
+// fraction-free gauss-jordan on [a | b]; at the end, the left side is
+// det(a) times the identity, and the right side is det(a) times x
+template <
+    bool Checked,
+    typename T,
+    std::size_t N,
+    std::size_t R,
+    typename Layout_a,
+    typename Layout_b>
+constexpr std::optional<exact_solution<T, N, R>> bareiss_solve(
+    matrix<T, N, N, Layout_a> const& a, matrix<T, N, R, Layout_b> const& b) {
+  auto augmented = matrix<T, N, N + R>();
+  for (std::size_t row = 0; row < N; ++row) {
+    for (std::size_t col = 0; col < N; ++col) {
+      augmented(row, col) = a(row, col);
+    }
+    for (std::size_t col = 0; col < R; ++col) {
+      augmented(row, N + col) = b(row, col);
+    }
+  }
+
+  auto previous = T(1);
+  for (std::size_t col = 0; col < N; ++col) {
+    auto pivot = col;
+    while (pivot < N && augmented(pivot, col) == T(0)) {
+      ++pivot;
+    }
+    if (pivot == N) {
+      return std::nullopt;
+    }
+    if (pivot != col) {
+      for (auto idx = col; idx < N + R; ++idx) {
+        auto const tmp = augmented(pivot, idx);
+        augmented(pivot, idx) = augmented(col, idx);
+        augmented(col, idx) = tmp;
+      }
+    }
+    // the rows above get the same update; the columns of the earlier
+    // pivots stay zero, and their diagonals aren't needed
+    for (std::size_t row = 0; row < N; ++row) {
+      if (row == col) {
+        continue;
+      }
+      for (auto idx = col + 1; idx < N + R; ++idx) {
+        auto const ok = bareiss_update<Checked>(
+            augmented(row, idx),
+            augmented(col, col),
+            augmented(row, col),
+            augmented(col, idx),
+            previous);
+        if (!ok) {
+          return std::nullopt;
+        }
+      }
+      augmented(row, col) = T(0);
+    }
+    previous = augmented(col, col);
+  }
+
+  auto const negate = previous < 0;
+  if (negate && Checked && previous == std::numeric_limits<T>::min()) {
+    return std::nullopt;
+  }
+  auto ret = exact_solution<T, N, R>{
+      matrix<T, N, R>(), negate ? T(-previous) : previous};
+  for (std::size_t row = 0; row < N; ++row) {
+    for (std::size_t col = 0; col < R; ++col) {
+      auto const x = augmented(row, N + col);
+      if (negate && Checked && x == std::numeric_limits<T>::min()) {
+        return std::nullopt;
+      }
+      ret.numerators(row, col) = negate ? T(-x) : x;
+    }
+  }
+  return ret;
+}
+
+// primes just below 2^62, so that each covers more than 61 bits
+constexpr static std::array<std::uint64_t, 16> crt_primes = {
+    (std::uint64_t(1) << 62) - 57,
+    (std::uint64_t(1) << 62) - 87,
+    (std::uint64_t(1) << 62) - 117,
+    (std::uint64_t(1) << 62) - 143,
+    (std::uint64_t(1) << 62) - 153,
+    (std::uint64_t(1) << 62) - 167,
+    (std::uint64_t(1) << 62) - 171,
+    (std::uint64_t(1) << 62) - 195,
+    (std::uint64_t(1) << 62) - 203,
+    (std::uint64_t(1) << 62) - 273,
+    (std::uint64_t(1) << 62) - 287,
+    (std::uint64_t(1) << 62) - 317,
+    (std::uint64_t(1) << 62) - 443,
+    (std::uint64_t(1) << 62) - 483,
+    (std::uint64_t(1) << 62) - 495,
+    (std::uint64_t(1) << 62) - 575,
+};
+using crt_digits = std::array<std::uint64_t, crt_primes.size()>;
+
+constexpr std::size_t bit_width(std::uint64_t x) {
+  std::size_t ret = 0;
+  for (; x != 0; x >>= 1) {
+    ++ret;
+  }
+  return ret;
+}
+
+// the number of primes it takes to cover hadamard's bound on the minors of
+// m, and a sign; each row is at most sqrt(W) times its largest entry long
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr std::size_t crt_primes_needed(matrix<T, H, W, Layout> const& m) {
+  std::size_t bits = 1;
+  for (std::size_t row = 0; row < H; ++row) {
+    auto largest = std::uint64_t(0);
+    for (std::size_t col = 0; col < W; ++col) {
+      auto const x = m(row, col);
+      auto const magnitude = x < 0 ? std::uint64_t(0) - std::uint64_t(x)
+                                   : std::uint64_t(x);
+      largest = magnitude > largest ? magnitude : largest;
+    }
+    bits += bit_width(largest);
+  }
+  auto const size = H < W ? H : W;
+  bits += size * ((bit_width(size) + 1) / 2);
+  return (bits + 60) / 61;
+}
+
+// the determinants of m, mod each of the first `count` primes
+template <std::size_t I, typename T, std::size_t N, typename Layout>
+constexpr void crt_determinants(
+    matrix<T, N, N, Layout> const& m, std::size_t count, crt_digits& out) {
+  if constexpr (I < crt_primes.size()) {
+    if (I < count) {
+      using mod = modint<crt_primes[I]>;
+      auto reduced = matrix<mod, N, N>();
+      for (std::size_t row = 0; row < N; ++row) {
+        for (std::size_t col = 0; col < N; ++col) {
+          reduced(row, col) = mod(m(row, col));
+        }
+      }
+      out[I] = determinant(reduced).value();
+      crt_determinants<I + 1>(m, count, out);
+    }
+  }
+}
+
+// the largest of the ranks of m, mod each of the first `count` primes
+template <
+    std::size_t I,
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout>
+constexpr std::size_t
+crt_rank(matrix<T, H, W, Layout> const& m, std::size_t count) {
+  if constexpr (I < crt_primes.size()) {
+    if (I < count) {
+      using mod = modint<crt_primes[I]>;
+      auto reduced = matrix<mod, H, W>();
+      for (std::size_t row = 0; row < H; ++row) {
+        for (std::size_t col = 0; col < W; ++col) {
+          reduced(row, col) = mod(m(row, col));
+        }
+      }
+      auto const ret = rank(reduced);
+      if (ret == (H < W ? H : W)) {
+        return ret;
+      }
+      auto const rest = crt_rank<I + 1>(m, count);
+      return rest > ret ? rest : ret;
+    }
+  }
+  return 0;
+}
+
+// turns residues into mixed radix digits, in place, by garner's algorithm:
+// x = digits[0] + digits[1] * p0 + digits[2] * p0 * p1 + ...
+template <std::size_t I>
+constexpr void to_mixed_radix(crt_digits& digits, std::size_t count) {
+  if constexpr (I < crt_primes.size()) {
+    if (I < count) {
+      using mod = modint<crt_primes[I]>;
+      auto x = mod(digits[I]);
+      for (std::size_t idx = 0; idx < I; ++idx) {
+        x = (x - mod(digits[idx])) / mod(crt_primes[idx]);
+      }
+      digits[I] = x.value();
+      to_mixed_radix<I + 1>(digits, count);
+    }
+  }
+}
+
+// x, from the mixed radix digits of x mod M, the product of the first
+// `count` primes, where |x| < M / 2; std::nullopt if it doesn't fit in T
+template <typename T>
+constexpr std::optional<T> from_mixed_radix(
+    crt_digits digits, std::size_t count) {
+  auto const top = count - 1;
+  auto const negative = digits[top] > (crt_primes[top] - 1) / 2;
+  if (negative) {
+    // the digits of M - 1 - x, which is -x - 1
+    for (std::size_t idx = 0; idx < count; ++idx) {
+      digits[idx] = crt_primes[idx] - 1 - digits[idx];
+    }
+  }
+  for (std::size_t idx = 2; idx < count; ++idx) {
+    if (digits[idx] != 0) {
+      return std::nullopt;
+    }
+  }
+  auto const high =
+      impl::multiply_wide(count > 1 ? digits[1] : 0, crt_primes[0]);
+  auto const magnitude = high.low + digits[0];
+  if (high.high != 0 || magnitude < high.low ||
+      magnitude > std::uint64_t(std::numeric_limits<T>::max())) {
+    return std::nullopt;
+  }
+  return negative ? T(-T(magnitude) - 1) : T(magnitude);
+}
+
+} // namespace impl
+
+// the exact determinant; every product of two minors of m must fit in T
+template <
+    typename T,
+    std::size_t N,
+    typename Layout,
+    typename = std::enable_if_t<impl::is_exact_integer<T>>>
+constexpr T determinant(matrix<T, N, N, Layout> const& m) {
+  return *impl::bareiss_determinant<false>(m);
+}
+
+// std::nullopt if a minor of m doesn't fit in T
+template <
+    typename T,
+    std::size_t N,
+    typename Layout,
+    typename = std::enable_if_t<impl::is_exact_integer<T>>>
+constexpr std::optional<T>
+determinant(matrix<T, N, N, Layout> const& m, checked_t) {
+  return impl::bareiss_determinant<true>(m);
+}
+
+// std::nullopt if the determinant doesn't fit in T
+template <
+    typename T,
+    std::size_t N,
+    typename Layout,
+    typename = std::enable_if_t<impl::is_exact_integer<T>>>
+constexpr std::optional<T>
+determinant(matrix<T, N, N, Layout> const& m, multimodular_t) {
+  auto const count = impl::crt_primes_needed(m);
+  if (count > impl::crt_primes.size()) {
+    return impl::bareiss_determinant<true>(m);
+  }
+  auto digits = impl::crt_digits();
+  impl::crt_determinants<0>(m, count, digits);
+  impl::to_mixed_radix<0>(digits, count);
+  return impl::from_mixed_radix<T>(digits, count);
+}
+
+// every product of two minors of m must fit in T
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout,
+    typename = std::enable_if_t<impl::is_exact_integer<T>>>
+constexpr std::size_t rank(matrix<T, H, W, Layout> m) {
+  return impl::bareiss_echelon<false>(m)->rank;
+}
+
+// std::nullopt if a minor of m doesn't fit in T
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout,
+    typename = std::enable_if_t<impl::is_exact_integer<T>>>
+constexpr std::optional<std::size_t>
+rank(matrix<T, H, W, Layout> m, checked_t) {
+  auto const result = impl::bareiss_echelon<true>(m);
+  if (!result) {
+    return std::nullopt;
+  }
+  return result->rank;
+}
+
+// the rank mod a prime is never more than the rank, and it's less only if
+// the prime divides every largest nonzero minor; so if the primes multiply
+// to more than hadamard's bound, the largest of their ranks is the rank.
+// std::nullopt only if there aren't enough primes, and checked fails
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout,
+    typename = std::enable_if_t<impl::is_exact_integer<T>>>
+constexpr std::optional<std::size_t>
+rank(matrix<T, H, W, Layout> const& m, multimodular_t) {
+  auto const count = impl::crt_primes_needed(m);
+  if (count > impl::crt_primes.size()) {
+    return rank(m, checked);
+  }
+  return impl::crt_rank<0>(m, count);
+}
+
+// the exact solution of a * x = b, or std::nullopt if a is singular; every
+// product of two minors of [a | b] must fit in T
+template <
+    typename T,
+    std::size_t N,
+    std::size_t R,
+    typename Layout_a,
+    typename Layout_b,
+    typename = std::enable_if_t<impl::is_exact_integer<T>>>
+constexpr std::optional<exact_solution<T, N, R>> solve(
+    matrix<T, N, N, Layout_a> const& a, matrix<T, N, R, Layout_b> const& b) {
+  return impl::bareiss_solve<false>(a, b);
+}
+
+// std::nullopt if a is singular, or a minor of [a | b] doesn't fit in T
+template <
+    typename T,
+    std::size_t N,
+    std::size_t R,
+    typename Layout_a,
+    typename Layout_b,
+    typename = std::enable_if_t<impl::is_exact_integer<T>>>
+constexpr std::optional<exact_solution<T, N, R>> solve(
+    matrix<T, N, N, Layout_a> const& a,
+    matrix<T, N, R, Layout_b> const& b,
+    checked_t) {
+  return impl::bareiss_solve<true>(a, b);
+}
+
+} // namespace algae
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+/*
+  the portable versions of the algorithms in algae/kernels.h. Not inline,
+  so that `extern template` keeps them out of every translation unit.
+*/
+
+namespace algae::impl {
+
+template <typename T>
+T dot(T const* lhs, T const* rhs, std::size_t n) {
+  auto ret = T(0);
+  for (std::size_t i = 0; i < n; ++i) {
+    ret = ret + lhs[i] * rhs[i];
+  }
+  return ret;
+}
+
+template <typename T>
+void add(T const* lhs, T const* rhs, T* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = lhs[i] + rhs[i];
+  }
+}
+template <typename T>
+void subtract(T const* lhs, T const* rhs, T* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = lhs[i] - rhs[i];
+  }
+}
+template <typename T>
+void hadamard(T const* lhs, T const* rhs, T* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = lhs[i] * rhs[i];
+  }
+}
+
+template <typename T>
+void axpy(T alpha, T const* x, T* y, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    y[i] = y[i] + alpha * x[i];
+  }
+}
+
+template <typename T>
+void gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    T alpha,
+    T const* a,
+    std::size_t lda,
+    T const* b,
+    std::size_t ldb,
+    T beta,
+    T* c,
+    std::size_t ldc) {
+  for (std::size_t i = 0; i < m; ++i) {
+    auto const c_row = c + i * ldc;
+    if (beta == T(0)) {
+      std::fill(c_row, c_row + n, T(0));
+    } else if (!(beta == T(1))) {
+      for (std::size_t j = 0; j < n; ++j) {
+        c_row[j] = c_row[j] * beta;
+      }
+    }
+
+    // i-k-j order, so the inner loop walks rows of both `b` and `c`
+    for (std::size_t p = 0; p < k; ++p) {
+      impl::axpy(alpha * a[i * lda + p], b + p * ldb, c_row, n);
+    }
+  }
+}
+
+// y = alpha * a * x + beta * y
+template <typename T>
+void gemv(
+    std::size_t m,
+    std::size_t n,
+    T alpha,
+    T const* a,
+    std::size_t lda,
+    T const* x,
+    T beta,
+    T* y) {
+  for (std::size_t i = 0; i < m; ++i) {
+    auto const sum = alpha * impl::dot(a + i * lda, x, n);
+    y[i] = beta == T(0) ? sum : sum + beta * y[i];
+  }
+}
+
+// y = alpha * transpose(a) * x + beta * y
+template <typename T>
+void gemv_t(
+    std::size_t m,
+    std::size_t n,
+    T alpha,
+    T const* a,
+    std::size_t lda,
+    T const* x,
+    T beta,
+    T* y) {
+  if (beta == T(0)) {
+    std::fill(y, y + n, T(0));
+  } else if (!(beta == T(1))) {
+    for (std::size_t j = 0; j < n; ++j) {
+      y[j] = y[j] * beta;
+    }
+  }
+  for (std::size_t i = 0; i < m; ++i) {
+    impl::axpy(alpha * x[i], a + i * lda, y, n);
+  }
+}
+
+template <typename T>
+void transpose(
+    std::size_t m,
+    std::size_t n,
+    T const* a,
+    std::size_t lda,
+    T* b,
+    std::size_t ldb) {
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      b[j * ldb + i] = a[i * lda + j];
+    }
+  }
+}
+
+template <typename T>
+void column_sums(
+    std::size_t m, std::size_t n, T const* a, std::size_t lda, T* out) {
+  std::fill(out, out + n, T(0));
+  for (std::size_t i = 0; i < m; ++i) {
+    impl::add(out, a + i * lda, out, n);
+  }
+}
+
+template <typename T>
+void batched_gemm(
+    std::size_t n, std::size_t count, T const* a, T const* b, T* c) {
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    auto const offset = idx * n * n;
+    impl::gemm(
+        n, n, n, T(1), a + offset, n, b + offset, n, T(0), c + offset, n);
+  }
+}
+
+// gauss-jordan elimination with partial pivoting; a is overwritten
+template <typename T>
+void batched_inverse(
+    std::size_t n, std::size_t count, T* a, T* out, bool* singular) {
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    auto const m = a + idx * n * n;
+    auto const inv = out + idx * n * n;
+    std::fill(inv, inv + n * n, T(0));
+    for (std::size_t i = 0; i < n; ++i) {
+      inv[i * n + i] = T(1);
+    }
+    singular[idx] = false;
+
+    for (std::size_t k = 0; k < n; ++k) {
+      auto pivot = k;
+      for (auto row = k + 1; row < n; ++row) {
+        if (std::abs(m[row * n + k]) > std::abs(m[pivot * n + k])) {
+          pivot = row;
+        }
+      }
+      if (m[pivot * n + k] == T(0)) {
+        singular[idx] = true;
+        break;
+      }
+      std::swap_ranges(m + k * n, m + k * n + n, m + pivot * n);
+      std::swap_ranges(inv + k * n, inv + k * n + n, inv + pivot * n);
+
+      auto const scale = T(1) / m[k * n + k];
+      for (std::size_t j = 0; j < n; ++j) {
+        m[k * n + j] = m[k * n + j] * scale;
+        inv[k * n + j] = inv[k * n + j] * scale;
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        if (i != k) {
+          auto const f = -m[i * n + k];
+          impl::axpy(f, m + k * n, m + i * n, n);
+          impl::axpy(f, inv + k * n, inv + i * n, n);
+        }
+      }
+    }
+  }
+}
+
+// gaussian elimination with partial pivoting; x starts out holding b, and
+// a is overwritten
+template <typename T>
+void batched_solve(
+    std::size_t n, std::size_t count, T* a, T* x, bool* singular) {
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    auto const m = a + idx * n * n;
+    auto const v = x + idx * n;
+    singular[idx] = false;
+
+    for (std::size_t k = 0; k < n; ++k) {
+      auto pivot = k;
+      for (auto row = k + 1; row < n; ++row) {
+        if (std::abs(m[row * n + k]) > std::abs(m[pivot * n + k])) {
+          pivot = row;
+        }
+      }
+      if (m[pivot * n + k] == T(0)) {
+        singular[idx] = true;
+        break;
+      }
+      std::swap_ranges(m + k * n + k, m + k * n + n, m + pivot * n + k);
+      std::swap(v[k], v[pivot]);
+
+      for (auto i = k + 1; i < n; ++i) {
+        auto const f = m[i * n + k] / m[k * n + k];
+        impl::axpy(-f, m + k * n + k, m + i * n + k, n - k);
+        v[i] = v[i] - f * v[k];
+      }
+    }
+    if (singular[idx]) {
+      continue;
+    }
+    for (std::size_t k = n; k-- > 0;) {
+      auto sum = v[k];
+      for (auto j = k + 1; j < n; ++j) {
+        sum = sum - m[k * n + j] * v[j];
+      }
+      v[k] = sum / m[k * n + k];
+    }
+  }
+}
+
+// a = L L^T, in place; the upper triangle is zeroed
+template <typename T>
+void batched_cholesky(std::size_t n, std::size_t count, T* a, bool* failed) {
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    auto const m = a + idx * n * n;
+    failed[idx] = false;
+    for (std::size_t j = 0; j < n; ++j) {
+      auto const d = m[j * n + j] - impl::dot(m + j * n, m + j * n, j);
+      if (!(d > T(0))) {
+        failed[idx] = true;
+        break;
+      }
+      m[j * n + j] = std::sqrt(d);
+      for (auto i = j + 1; i < n; ++i) {
+        m[i * n + j] =
+            (m[i * n + j] - impl::dot(m + i * n, m + j * n, j)) / m[j * n + j];
+      }
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      std::fill(m + i * n + i + 1, m + i * n + n, T(0));
+    }
+  }
+}
+
+} // namespace algae::impl
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <complex>
+#include <cstdint>
+
+/*
+  what algae_kernels instantiates; each macro takes `extern template` or
+  `template` to put in front.
+*/
+
+#define ALGAE_FOR_EACH_INSTANTIATED_TYPE(X, prefix)                           \
+  X(prefix, float)                                                             \
+  X(prefix, double)                                                            \
+  X(prefix, std::int32_t)                                                      \
+  X(prefix, std::complex<float>)                                               \
+  X(prefix, std::complex<double>)
+
+#define ALGAE_FOR_EACH_INSTANTIATED_SIZE(X, prefix, T)                        \
+  X(prefix, T, 2)                                                              \
+  X(prefix, T, 3)                                                              \
+  X(prefix, T, 4)                                                              \
+  X(prefix, T, 8)
+
+// the runtime-extent algorithms cover every size, so they only vary by type
+#define ALGAE_INSTANTIATE_ALGORITHMS(prefix, T)                               \
+  prefix T algae::impl::dot<T>(T const*, T const*, std::size_t);               \
+  prefix void algae::impl::add<T>(T const*, T const*, T*, std::size_t);        \
+  prefix void algae::impl::subtract<T>(T const*, T const*, T*, std::size_t);   \
+  prefix void algae::impl::hadamard<T>(T const*, T const*, T*, std::size_t);   \
+  prefix void algae::impl::axpy<T>(T, T const*, T*, std::size_t);              \
+  prefix void algae::impl::gemm<T>(                                            \
+      std::size_t,                                                             \
+      std::size_t,                                                             \
+      std::size_t,                                                             \
+      T,                                                                       \
+      T const*,                                                                \
+      std::size_t,                                                             \
+      T const*,                                                                \
+      std::size_t,                                                             \
+      T,                                                                       \
+      T*,                                                                      \
+      std::size_t);                                                            \
+  prefix void algae::impl::gemv<T>(                                            \
+      std::size_t,                                                             \
+      std::size_t,                                                             \
+      T,                                                                       \
+      T const*,                                                                \
+      std::size_t,                                                             \
+      T const*,                                                                \
+      T,                                                                       \
+      T*);                                                                     \
+  prefix void algae::impl::gemv_t<T>(                                          \
+      std::size_t,                                                             \
+      std::size_t,                                                             \
+      T,                                                                       \
+      T const*,                                                                \
+      std::size_t,                                                             \
+      T const*,                                                                \
+      T,                                                                       \
+      T*);                                                                     \
+  prefix void algae::impl::transpose<T>(                                       \
+      std::size_t, std::size_t, T const*, std::size_t, T*, std::size_t);       \
+  prefix void algae::impl::column_sums<T>(                                     \
+      std::size_t, std::size_t, T const*, std::size_t, T*);                    \
+  ALGAE_FOR_EACH_INSTANTIATED_SIZE(ALGAE_INSTANTIATE_FIXED_SIZE, prefix, T)
+
+#define ALGAE_INSTANTIATE_FIXED_SIZE(prefix, T, N)                            \
+  prefix T algae::kernels::dot<T, N>(                                          \
+      algae::vector<T, N> const&, algae::vector<T, N> const&) noexcept;        \
+  prefix algae::vector<T, N> algae::kernels::add<T, N>(                        \
+      algae::vector<T, N> const&, algae::vector<T, N> const&) noexcept;        \
+  prefix algae::vector<T, N> algae::kernels::subtract<T, N>(                   \
+      algae::vector<T, N> const&, algae::vector<T, N> const&) noexcept;        \
+  prefix algae::vector<T, N> algae::kernels::hadamard<T, N>(                   \
+      algae::vector<T, N> const&, algae::vector<T, N> const&) noexcept;        \
+  prefix void algae::kernels::axpy<T, N>(                                      \
+      T, algae::vector<T, N> const&, algae::vector<T, N>&) noexcept;           \
+  prefix algae::matrix<T, N, N> algae::kernels::add<T, N, N>(                  \
+      algae::matrix<T, N, N> const&, algae::matrix<T, N, N> const&) noexcept;  \
+  prefix algae::matrix<T, N, N> algae::kernels::subtract<T, N, N>(             \
+      algae::matrix<T, N, N> const&, algae::matrix<T, N, N> const&) noexcept;  \
+  prefix algae::matrix<T, N, N> algae::kernels::hadamard<T, N, N>(             \
+      algae::matrix<T, N, N> const&, algae::matrix<T, N, N> const&) noexcept;  \
+  prefix algae::matrix<T, N, N> algae::kernels::multiply<T, N, N, N>(          \
+      algae::matrix<T, N, N> const&, algae::matrix<T, N, N> const&) noexcept;  \
+  prefix algae::vector<T, N> algae::kernels::multiply<T, N, N>(                \
+      algae::matrix<T, N, N> const&, algae::vector<T, N> const&) noexcept;     \
+  prefix algae::vector<T, N> algae::kernels::multiply<T, N, N>(                \
+      algae::vector<T, N> const&, algae::matrix<T, N, N> const&) noexcept;     \
+  prefix algae::matrix<T, N, N> algae::kernels::transpose<T, N, N>(            \
+      algae::matrix<T, N, N> const&) noexcept;                                 \
+  prefix algae::vector<T, N> algae::kernels::column_sums<T, N, N>(             \
+      algae::matrix<T, N, N> const&) noexcept;
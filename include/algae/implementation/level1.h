@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+/*
+  the portable level 1 BLAS, for anything with size() and operator[]. The
+  absolute values are std::abs, the modulus for complex numbers.
+*/
+
+namespace algae::impl {
+
+template <typename T, typename X, typename Y>
+void axpby(T const& alpha, X const& x, T const& beta, Y& y) {
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    y[i] = alpha * x[i] + beta * y[i];
+  }
+}
+
+template <typename T, typename X>
+void scal(T const& alpha, X& x) {
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    x[i] = alpha * x[i];
+  }
+}
+
+template <typename X>
+auto asum(X const& x) {
+  using std::abs;
+  auto ret = decltype(abs(x[0]))(0);
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    ret = ret + abs(x[i]);
+  }
+  return ret;
+}
+
+// the first index of the largest (Is_max) or smallest absolute value
+template <bool Is_max, typename X>
+std::size_t index_abs_extreme(X const& x) {
+  using std::abs;
+  auto ret = std::size_t(0);
+  for (std::size_t i = 1; i < x.size(); ++i) {
+    auto const current = abs(x[i]);
+    auto const best = abs(x[ret]);
+    if (Is_max ? best < current : current < best) {
+      ret = i;
+    }
+  }
+  return ret;
+}
+
+// scales by the largest element as it goes, so nothing overflows
+template <typename X>
+auto nrm2(X const& x) {
+  using std::abs;
+  using std::sqrt;
+  using real = decltype(abs(x[0]));
+
+  auto largest = real(0);
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    auto const current = abs(x[i]);
+    largest = largest < current ? current : largest;
+  }
+  if (!(largest > real(0) && largest <= std::numeric_limits<real>::max())) {
+    return largest;
+  }
+
+  auto sum = real(0);
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    auto const scaled = abs(x[i]) / largest;
+    sum = sum + scaled * scaled;
+  }
+  return largest * sqrt(sum);
+}
+
+template <typename X, typename Y>
+void swap(X& x, Y& y) {
+  using std::swap;
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    swap(x[i], y[i]);
+  }
+}
+
+template <typename X, typename Y>
+void copy(X const& x, Y& y) {
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    y[i] = x[i];
+  }
+}
+
+template <typename X, typename Y, typename T>
+void rot(X& x, Y& y, T const& c, T const& s) {
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    auto const xi = x[i];
+    auto const yi = y[i];
+    x[i] = c * xi + s * yi;
+    y[i] = c * yi - s * xi;
+  }
+}
+
+template <typename T, typename X, typename Y, typename Z>
+T axpy_dot(T const& alpha, X const& x, Y& y, Z const& z) {
+  auto ret = T(0);
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    y[i] = y[i] + alpha * x[i];
+    ret = ret + y[i] * z[i];
+  }
+  return ret;
+}
+
+// the givens rotation that zeroes b; as in the reference BLAS, a becomes
+// r, and b becomes z, from which c and s can be rebuilt
+template <typename T>
+void rotg(T& a, T& b, T& c, T& s) {
+  using std::abs;
+  using std::sqrt;
+
+  auto const roe = abs(a) > abs(b) ? a : b;
+  auto const scale = abs(a) + abs(b);
+  if (scale == T(0)) {
+    c = T(1);
+    s = T(0);
+    a = T(0);
+    b = T(0);
+    return;
+  }
+
+  auto const a_scaled = a / scale;
+  auto const b_scaled = b / scale;
+  auto r = scale * sqrt(a_scaled * a_scaled + b_scaled * b_scaled);
+  if (roe < T(0)) {
+    r = -r;
+  }
+  c = a / r;
+  s = b / r;
+
+  auto z = T(1);
+  if (abs(a) > abs(b)) {
+    z = s;
+  } else if (!(c == T(0))) {
+    z = T(1) / c;
+  }
+  a = r;
+  b = z;
+}
+
+} // namespace algae::impl
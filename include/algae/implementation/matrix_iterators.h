@@ -1,318 +1,257 @@
 #pragma once
 
 #include <cstddef>
+#include <iterator>
+#include <type_traits>
 
 namespace algae {
 
-// matrix_row::iterator
+/*
+  a line is a row (Is_row) or a column of a matrix; both go through
+  matrix::operator(), so they work whatever the layout.
+*/
 
-template <typename T>
-class matrix_row_iterator {
-  T* current_;
-  constexpr matrix_row_iterator(T* ptr) : current_(ptr) {}
+// iterates over the elements of one line
 
-public:
-  template <typename T, std::size_t Width>
-  friend class matrix_row;
+template <typename Matrix, bool Is_row>
+class matrix_line_iterator {
+  Matrix* matrix_;
+  std::size_t line_;
+  std::size_t current_;
 
-  using value_type = T;
-  using reference = T & ;
-  using pointer = T * ;
+public:
+  using value_type = typename std::remove_const_t<Matrix>::value_type;
+  using reference = std::conditional_t<
+      std::is_const_v<Matrix>,
+      value_type const&,
+      value_type&>;
+  using pointer = std::remove_reference_t<reference>*;
   using difference_type = std::ptrdiff_t;
   using iterator_category = std::random_access_iterator_tag;
 
-  constexpr bool operator==(matrix_row_iterator other) {
+  constexpr matrix_line_iterator() : matrix_(nullptr), line_(0), current_(0) {}
+  constexpr matrix_line_iterator(
+      Matrix& matrix, std::size_t line, std::size_t current)
+      : matrix_(&matrix), line_(line), current_(current) {}
+
+  constexpr bool operator==(matrix_line_iterator other) const {
     return current_ == other.current_;
   }
-  constexpr bool operator!=(matrix_row_iterator other) {
+  constexpr bool operator!=(matrix_line_iterator other) const {
     return current_ != other.current_;
   }
-  constexpr bool operator<(matrix_row_iterator other) {
+  constexpr bool operator<(matrix_line_iterator other) const {
     return current_ < other.current_;
   }
-  constexpr bool operator>(matrix_row_iterator other) {
+  constexpr bool operator>(matrix_line_iterator other) const {
     return current_ > other.current_;
   }
-  constexpr bool operator<=(matrix_row_iterator other) {
+  constexpr bool operator<=(matrix_line_iterator other) const {
     return current_ <= other.current_;
   }
-  constexpr bool operator>=(matrix_row_iterator other) {
+  constexpr bool operator>=(matrix_line_iterator other) const {
     return current_ >= other.current_;
   }
 
-  constexpr reference operator*() { return *current_; }
-  constexpr pointer operator->() { return current_; }
+  constexpr reference operator*() const {
+    if constexpr (Is_row) {
+      return (*matrix_)(line_, current_);
+    } else {
+      return (*matrix_)(current_, line_);
+    }
+  }
+  constexpr pointer operator->() const { return &**this; }
 
-  constexpr matrix_row_iterator& operator++() {
+  constexpr matrix_line_iterator& operator++() {
     ++current_;
     return *this;
   }
-  constexpr matrix_row_iterator operator++(int) { return matrix_row_iterator(current_++); }
-  constexpr matrix_row_iterator& operator--() {
+  constexpr matrix_line_iterator operator++(int) {
+    auto ret = *this;
+    ++current_;
+    return ret;
+  }
+  constexpr matrix_line_iterator& operator--() {
     --current_;
     return *this;
   }
-  constexpr matrix_row_iterator operator--(int) { return matrix_row_iterator(current_--); }
+  constexpr matrix_line_iterator operator--(int) {
+    auto ret = *this;
+    --current_;
+    return ret;
+  }
 
-  constexpr matrix_row_iterator& operator+=(difference_type dif) {
+  constexpr matrix_line_iterator& operator+=(difference_type dif) {
     current_ += dif;
     return *this;
   }
-  constexpr matrix_row_iterator operator+(difference_type dif) const {
-    return matrix_row_iterator(current_ + dif);
+  constexpr matrix_line_iterator operator+(difference_type dif) const {
+    return matrix_line_iterator(*matrix_, line_, current_ + dif);
   }
-  constexpr friend matrix_row_iterator operator+(difference_type dif, matrix_row_iterator self) {
-    return matrix_row_iterator(self.current_ + dif);
+  constexpr friend matrix_line_iterator
+  operator+(difference_type dif, matrix_line_iterator self) {
+    return self + dif;
   }
-  constexpr matrix_row_iterator& operator-=(difference_type dif) {
+  constexpr matrix_line_iterator& operator-=(difference_type dif) {
     current_ -= dif;
     return *this;
   }
-  constexpr matrix_row_iterator operator-(difference_type dif) const {
-    return matrix_row_iterator(current_ - dif);
+  constexpr matrix_line_iterator operator-(difference_type dif) const {
+    return matrix_line_iterator(*matrix_, line_, current_ - dif);
   }
-  constexpr difference_type operator-(matrix_row_iterator other) const {
-    return current_ - other.current_;
+  constexpr difference_type operator-(matrix_line_iterator other) const {
+    return difference_type(current_) - difference_type(other.current_);
   }
 
-  constexpr reference operator[](difference_type dif) {
-    return current_[dif];
+  constexpr reference operator[](difference_type dif) const {
+    return *(*this + dif);
   }
 };
 
-template <typename T>
-class matrix_row_const_iterator {
-  T const* current_;
-  constexpr matrix_row_const_iterator(T* ptr) : current_(ptr) {}
+// one row or column; a reference to it, not a copy
+
+template <typename Matrix, bool Is_row>
+class matrix_line {
+  Matrix* matrix_;
+  std::size_t line_;
 
 public:
-  template <typename T, std::size_t Width>
-  friend class matrix_row;
+  using value_type = typename std::remove_const_t<Matrix>::value_type;
+  using iterator = matrix_line_iterator<Matrix, Is_row>;
+  using const_iterator = matrix_line_iterator<Matrix const, Is_row>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-  using value_type = T;
-  using reference = T const&;
-  using pointer = T const*;
-  using difference_type = std::ptrdiff_t;
-  using iterator_category = std::random_access_iterator_tag;
+  constexpr matrix_line(Matrix& matrix, std::size_t line)
+      : matrix_(&matrix), line_(line) {}
 
-  constexpr bool operator==(matrix_row_const_iterator other) {
-    return current_ == other.current_;
+  static constexpr std::size_t size() noexcept {
+    if constexpr (Is_row) {
+      return std::remove_const_t<Matrix>::width();
+    } else {
+      return std::remove_const_t<Matrix>::height();
+    }
   }
-  constexpr bool operator!=(matrix_row_const_iterator other) {
-    return current_ != other.current_;
-  }
-  constexpr bool operator<(matrix_row_const_iterator other) {
-    return current_ < other.current_;
-  }
-  constexpr bool operator>(matrix_row_const_iterator other) {
-    return current_ > other.current_;
-  }
-  constexpr bool operator<=(matrix_row_const_iterator other) {
-    return current_ <= other.current_;
-  }
-  constexpr bool operator>=(matrix_row_const_iterator other) {
-    return current_ >= other.current_;
-  }
-
-  constexpr reference operator*() { return *current_; }
-  constexpr pointer operator->() { return current_; }
 
-  constexpr matrix_row_const_iterator& operator++() {
-    ++current_;
-    return *this;
-  }
-  constexpr matrix_row_const_iterator operator++(int) { return matrix_row_const_iterator(current_++); }
-  constexpr matrix_row_const_iterator& operator--() {
-    --current_;
-    return *this;
+  constexpr decltype(auto) operator[](std::size_t idx) const {
+    return begin()[idx];
   }
-  constexpr matrix_row_const_iterator operator--(int) { return matrix_row_const_iterator(current_--); }
 
-  constexpr matrix_row_const_iterator& operator+=(difference_type dif) {
-    current_ += dif;
-    return *this;
-  }
-  constexpr matrix_row_const_iterator operator+(difference_type dif) const {
-    return matrix_row_const_iterator(current_ + dif);
-  }
-  constexpr friend matrix_row_const_iterator operator+(difference_type dif, matrix_row_const_iterator self) {
-    return matrix_row_const_iterator(self.current_ + dif);
-  }
-  constexpr matrix_row_const_iterator& operator-=(difference_type dif) {
-    current_ -= dif;
-    return *this;
-  }
-  constexpr matrix_row_const_iterator operator-(difference_type dif) const {
-    return matrix_row_const_iterator(current_ - dif);
+  constexpr iterator begin() const { return iterator(*matrix_, line_, 0); }
+  constexpr iterator end() const { return iterator(*matrix_, line_, size()); }
+  constexpr const_iterator cbegin() const {
+    return const_iterator(*matrix_, line_, 0);
   }
-  constexpr difference_type operator-(matrix_row_const_iterator other) const {
-    return current_ - other.current_;
+  constexpr const_iterator cend() const {
+    return const_iterator(*matrix_, line_, size());
   }
 
-  constexpr reference operator[](difference_type dif) {
-    return current_[dif];
+  constexpr reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  constexpr reverse_iterator rend() const { return reverse_iterator(begin()); }
+  constexpr const_reverse_iterator crbegin() const {
+    return const_reverse_iterator(cend());
+  }
+  constexpr const_reverse_iterator crend() const {
+    return const_reverse_iterator(cbegin());
   }
 };
 
-// matrix::row_iterator
-
-template <typename T, std::size_t Width>
-class matrix_iterator_row {
-  matrix_row<T, Width>* current_;
+// iterates over the rows or columns of a matrix
+// since it hands out matrix_lines by value, it's only an input iterator
 
-  constexpr matrix_iterator_row(matrix_row<T, Width>* underlying_)
-    : current_(underlying_) {}
+template <typename Matrix, bool Is_row>
+class matrix_lines_iterator {
+  Matrix* matrix_;
+  std::size_t current_;
 
 public:
-  template <typename T, std::size_t Height, std::size_t Width>
-  friend class matrix;
-
-  using value_type = matrix_row;
-  using reference = matrix_row&;
-  using pointer = matrix_row*;
+  using value_type = matrix_line<Matrix, Is_row>;
+  using reference = value_type;
+  using pointer = void;
   using difference_type = std::ptrdiff_t;
-  using iterator_category = std::random_access_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+
+  constexpr matrix_lines_iterator() : matrix_(nullptr), current_(0) {}
+  constexpr matrix_lines_iterator(Matrix& matrix, std::size_t current)
+      : matrix_(&matrix), current_(current) {}
 
-  constexpr bool operator==(matrix_iterator_row other) {
+  constexpr bool operator==(matrix_lines_iterator other) const {
     return current_ == other.current_;
   }
-  constexpr bool operator!=(matrix_iterator_row other) {
+  constexpr bool operator!=(matrix_lines_iterator other) const {
     return current_ != other.current_;
   }
-  constexpr bool operator<(matrix_iterator_row other) {
-    return current_ < other.current_;
-  }
-  constexpr bool operator>(matrix_iterator_row other) {
-    return current_ > other.current_;
-  }
-  constexpr bool operator<=(matrix_iterator_row other) {
-    return current_ <= other.current_;
-  }
-  constexpr bool operator>=(matrix_iterator_row other) {
-    return current_ >= other.current_;
-  }
 
-  constexpr reference operator*() { return *current_; }
-  constexpr pointer operator->() { return current_; }
+  constexpr reference operator*() const {
+    return value_type(*matrix_, current_);
+  }
 
-  constexpr matrix_iterator_row& operator++() {
+  constexpr matrix_lines_iterator& operator++() {
     ++current_;
     return *this;
   }
-  constexpr matrix_iterator_row operator++(int) {
-    return matrix_iterator_row(current_++);
+  constexpr matrix_lines_iterator operator++(int) {
+    auto ret = *this;
+    ++current_;
+    return ret;
   }
-  constexpr matrix_iterator_row& operator--() {
+  constexpr matrix_lines_iterator& operator--() {
     --current_;
     return *this;
   }
-  constexpr matrix_iterator_row operator--(int) {
-    return matrix_iterator_row(current_--);
+  constexpr matrix_lines_iterator operator--(int) {
+    auto ret = *this;
+    --current_;
+    return ret;
   }
 
-  constexpr matrix_iterator_row& operator+=(difference_type dif) {
-    current_ += dif;
-    return *this;
-  }
-  constexpr matrix_iterator_row operator+(difference_type dif) const {
-    return matrix_iterator_row(current_ + dif);
-  }
-  constexpr friend matrix_iterator_row
-    operator+(difference_type dif, matrix_iterator_row self) {
-    return matrix_iterator_row(self.current_ + dif);
-  }
-  constexpr matrix_iterator_row& operator-=(difference_type dif) {
-    current_ -= dif;
-    return *this;
+  constexpr matrix_lines_iterator operator+(difference_type dif) const {
+    return matrix_lines_iterator(*matrix_, current_ + dif);
   }
-  constexpr matrix_iterator_row operator-(difference_type dif) const {
-    return matrix_iterator_row(current_ - dif);
+  constexpr matrix_lines_iterator operator-(difference_type dif) const {
+    return matrix_lines_iterator(*matrix_, current_ - dif);
   }
-  constexpr difference_type operator-(matrix_iterator_row other) const {
-    return current_ - other.current_;
+  constexpr difference_type operator-(matrix_lines_iterator other) const {
+    return difference_type(current_) - difference_type(other.current_);
   }
 
-  constexpr reference operator[](difference_type dif) { return current_[dif]; }
+  constexpr reference operator[](difference_type dif) const {
+    return *(*this + dif);
+  }
 };
 
-template <typename T, std::size_t Width>
-class matrix_const_iterator_row {
-  matrix_row<T, Width> const* current_;
+template <typename Matrix, bool Is_row>
+class matrix_lines {
+  Matrix* matrix_;
 
-  constexpr matrix_const_iterator_row(matrix_row<T, Width> const* underlying_)
-    : current_(underlying_) {}
+  static constexpr std::size_t count() noexcept {
+    if constexpr (Is_row) {
+      return std::remove_const_t<Matrix>::height();
+    } else {
+      return std::remove_const_t<Matrix>::width();
+    }
+  }
 
 public:
-  template <typename T, std::size_t Height, std::size_t Width>
-  friend class matrix;
-
-  using value_type = matrix_row;
-  using reference = matrix_row const&;
-  using pointer = matrix_row const*;
-  using difference_type = std::ptrdiff_t;
-  using iterator_category = std::random_access_iterator_tag;
+  using iterator = matrix_lines_iterator<Matrix, Is_row>;
+  using const_iterator = matrix_lines_iterator<Matrix const, Is_row>;
 
-  constexpr bool operator==(matrix_const_iterator_row other) {
-    return current_ == other.current_;
-  }
-  constexpr bool operator!=(matrix_const_iterator_row other) {
-    return current_ != other.current_;
-  }
-  constexpr bool operator<(matrix_const_iterator_row other) {
-    return current_ < other.current_;
-  }
-  constexpr bool operator>(matrix_const_iterator_row other) {
-    return current_ > other.current_;
-  }
-  constexpr bool operator<=(matrix_const_iterator_row other) {
-    return current_ <= other.current_;
-  }
-  constexpr bool operator>=(matrix_const_iterator_row other) {
-    return current_ >= other.current_;
-  }
+  constexpr explicit matrix_lines(Matrix& matrix) : matrix_(&matrix) {}
 
-  constexpr reference operator*() { return *current_; }
-  constexpr pointer operator->() { return current_; }
+  static constexpr std::size_t size() noexcept { return count(); }
 
-  constexpr matrix_const_iterator_row& operator++() {
-    ++current_;
-    return *this;
-  }
-  constexpr matrix_const_iterator_row operator++(int) {
-    return matrix_const_iterator_row(current_++);
-  }
-  constexpr matrix_const_iterator_row& operator--() {
-    --current_;
-    return *this;
+  constexpr iterator begin() const { return iterator(*matrix_, 0); }
+  constexpr iterator end() const { return iterator(*matrix_, count()); }
+  constexpr const_iterator cbegin() const {
+    return const_iterator(*matrix_, 0);
   }
-  constexpr matrix_const_iterator_row operator--(int) {
-    return matrix_const_iterator_row(current_--);
+  constexpr const_iterator cend() const {
+    return const_iterator(*matrix_, count());
   }
 
-  constexpr matrix_const_iterator_row& operator+=(difference_type dif) {
-    current_ += dif;
-    return *this;
-  }
-  constexpr matrix_const_iterator_row operator+(difference_type dif) const {
-    return matrix_const_iterator_row(current_ + dif);
+  constexpr matrix_line<Matrix, Is_row> operator[](std::size_t idx) const {
+    return matrix_line<Matrix, Is_row>(*matrix_, idx);
   }
-  constexpr friend matrix_const_iterator_row
-    operator+(difference_type dif, matrix_const_iterator_row self) {
-    return matrix_const_iterator_row(self.current_ + dif);
-  }
-  constexpr matrix_const_iterator_row& operator-=(difference_type dif) {
-    current_ -= dif;
-    return *this;
-  }
-  constexpr matrix_const_iterator_row operator-(difference_type dif) const {
-    return matrix_const_iterator_row(current_ - dif);
-  }
-  constexpr difference_type operator-(matrix_const_iterator_row other) const {
-    return current_ - other.current_;
-  }
-
-  constexpr reference operator[](difference_type dif) { return current_[dif]; }
 };
 
-
-}
\ No newline at end of file
+} // namespace algae
@@ -0,0 +1,399 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/*
+  the pieces of the CSR and BSR products, each doing the rows [begin, end)
+  of c. Sparse * sparse is Gustavson's algorithm, with a dense or hashed
+  accumulator per row.
+*/
+
+namespace algae::impl {
+
+inline constexpr auto spgemm_empty = static_cast<std::size_t>(-1);
+
+// the number of products that go into row i of a * b; an upper bound on
+// the nonzeros in that row
+inline std::size_t spgemm_row_products(
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    std::size_t const* b_offsets,
+    std::size_t row) {
+  auto ret = std::size_t(0);
+  for (auto idx = a_offsets[row]; idx < a_offsets[row + 1]; ++idx) {
+    auto const k = a_columns[idx];
+    ret += b_offsets[k + 1] - b_offsets[k];
+  }
+  return ret;
+}
+
+// a power of two, at least twice `entries`, so probes stay short
+inline std::size_t spgemm_hash_size(std::size_t entries) {
+  auto ret = std::size_t(16);
+  while (ret < 2 * entries) {
+    ret *= 2;
+  }
+  return ret;
+}
+
+// hash rows with their table under an eighth of a dense row
+inline bool spgemm_use_hash(std::size_t entries, std::size_t width) {
+  return spgemm_hash_size(entries) * 8 <= width;
+}
+
+inline std::size_t spgemm_hash(std::size_t col, std::size_t mask) {
+  return (col * 0x9e3779b97f4a7c15ull >> 17) & mask;
+}
+
+// finds the distinct columns of one row at a time
+class spgemm_pattern_accumulator {
+  std::size_t width_;
+  // the (1-based) row that last touched each column; 0 for none
+  std::vector<std::size_t> dense_seen_;
+  std::vector<std::size_t> table_;
+  std::vector<std::size_t> found_;
+
+public:
+  explicit spgemm_pattern_accumulator(std::size_t width) : width_(width) {}
+
+  // the columns of row `row` of a * b, sorted, in found()
+  void run(
+      std::size_t const* a_offsets,
+      std::size_t const* a_columns,
+      std::size_t const* b_offsets,
+      std::size_t const* b_columns,
+      std::size_t row) {
+    found_.clear();
+    auto const products =
+        impl::spgemm_row_products(a_offsets, a_columns, b_offsets, row);
+    auto const begin = a_offsets[row];
+    auto const end = a_offsets[row + 1];
+
+    if (spgemm_use_hash(products, width_)) {
+      table_.assign(spgemm_hash_size(products), spgemm_empty);
+      auto const mask = table_.size() - 1;
+      for (auto idx = begin; idx < end; ++idx) {
+        auto const k = a_columns[idx];
+        for (auto b_idx = b_offsets[k]; b_idx < b_offsets[k + 1]; ++b_idx) {
+          auto const col = b_columns[b_idx];
+          auto slot = spgemm_hash(col, mask);
+          while (table_[slot] != spgemm_empty && table_[slot] != col) {
+            slot = (slot + 1) & mask;
+          }
+          if (table_[slot] == spgemm_empty) {
+            table_[slot] = col;
+            found_.push_back(col);
+          }
+        }
+      }
+    } else {
+      if (dense_seen_.empty()) {
+        dense_seen_.assign(width_, 0);
+      }
+      for (auto idx = begin; idx < end; ++idx) {
+        auto const k = a_columns[idx];
+        for (auto b_idx = b_offsets[k]; b_idx < b_offsets[k + 1]; ++b_idx) {
+          auto const col = b_columns[b_idx];
+          if (dense_seen_[col] != row + 1) {
+            dense_seen_[col] = row + 1;
+            found_.push_back(col);
+          }
+        }
+      }
+    }
+    std::sort(found_.begin(), found_.end());
+  }
+
+  std::vector<std::size_t> const& found() const { return found_; }
+};
+
+// sums up the values of one row at a time, for a row pattern already known
+template <typename T>
+class spgemm_value_accumulator {
+  std::size_t width_;
+  // kept all zeroes between rows
+  std::vector<T> dense_;
+  std::vector<std::size_t> table_keys_;
+  std::vector<T> table_values_;
+
+  std::size_t find(std::size_t col) const {
+    auto const mask = table_keys_.size() - 1;
+    auto slot = spgemm_hash(col, mask);
+    while (table_keys_[slot] != col) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+public:
+  explicit spgemm_value_accumulator(std::size_t width) : width_(width) {}
+
+  // fills in the values of row `row` of c = a * b
+  void run(
+      std::size_t const* a_offsets,
+      std::size_t const* a_columns,
+      T const* a_values,
+      std::size_t const* b_offsets,
+      std::size_t const* b_columns,
+      T const* b_values,
+      std::size_t const* c_offsets,
+      std::size_t const* c_columns,
+      T* c_values,
+      std::size_t row) {
+    auto const begin = a_offsets[row];
+    auto const end = a_offsets[row + 1];
+    auto const c_begin = c_offsets[row];
+    auto const c_end = c_offsets[row + 1];
+
+    if (spgemm_use_hash(c_end - c_begin, width_)) {
+      auto const size = spgemm_hash_size(c_end - c_begin);
+      table_keys_.assign(size, spgemm_empty);
+      table_values_.assign(size, T(0));
+      auto const mask = size - 1;
+      for (auto idx = c_begin; idx < c_end; ++idx) {
+        auto slot = spgemm_hash(c_columns[idx], mask);
+        while (table_keys_[slot] != spgemm_empty) {
+          slot = (slot + 1) & mask;
+        }
+        table_keys_[slot] = c_columns[idx];
+      }
+
+      for (auto idx = begin; idx < end; ++idx) {
+        auto const k = a_columns[idx];
+        auto const a_ik = a_values[idx];
+        for (auto b_idx = b_offsets[k]; b_idx < b_offsets[k + 1]; ++b_idx) {
+          auto& sum = table_values_[find(b_columns[b_idx])];
+          sum = sum + a_ik * b_values[b_idx];
+        }
+      }
+      for (auto idx = c_begin; idx < c_end; ++idx) {
+        c_values[idx] = table_values_[find(c_columns[idx])];
+      }
+    } else {
+      if (dense_.empty()) {
+        dense_.assign(width_, T(0));
+      }
+      for (auto idx = begin; idx < end; ++idx) {
+        auto const k = a_columns[idx];
+        auto const a_ik = a_values[idx];
+        for (auto b_idx = b_offsets[k]; b_idx < b_offsets[k + 1]; ++b_idx) {
+          auto& sum = dense_[b_columns[b_idx]];
+          sum = sum + a_ik * b_values[b_idx];
+        }
+      }
+      for (auto idx = c_begin; idx < c_end; ++idx) {
+        c_values[idx] = dense_[c_columns[idx]];
+        dense_[c_columns[idx]] = T(0);
+      }
+    }
+  }
+};
+
+// c_offsets[row + 1] = the number of nonzeros in each row of a * b; the
+// caller takes the running sum afterwards
+inline void spgemm_count(
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    std::size_t* c_offsets,
+    std::size_t begin,
+    std::size_t end) {
+  auto acc = spgemm_pattern_accumulator(n);
+  for (auto row = begin; row < end; ++row) {
+    acc.run(a_offsets, a_columns, b_offsets, b_columns, row);
+    c_offsets[row + 1] = acc.found().size();
+  }
+}
+
+inline void spgemm_columns(
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    std::size_t const* c_offsets,
+    std::size_t* c_columns,
+    std::size_t begin,
+    std::size_t end) {
+  auto acc = spgemm_pattern_accumulator(n);
+  for (auto row = begin; row < end; ++row) {
+    acc.run(a_offsets, a_columns, b_offsets, b_columns, row);
+    auto const& found = acc.found();
+    std::copy(found.begin(), found.end(), c_columns + c_offsets[row]);
+  }
+}
+
+template <typename T>
+void spgemm_numeric(
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    T const* a_values,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    T const* b_values,
+    std::size_t const* c_offsets,
+    std::size_t const* c_columns,
+    T* c_values,
+    std::size_t begin,
+    std::size_t end) {
+  auto acc = spgemm_value_accumulator<T>(n);
+  for (auto row = begin; row < end; ++row) {
+    acc.run(
+        a_offsets,
+        a_columns,
+        a_values,
+        b_offsets,
+        b_columns,
+        b_values,
+        c_offsets,
+        c_columns,
+        c_values,
+        row);
+  }
+}
+
+// c = a * b, for sparse a and dense b; `b` and `c` are anything with
+// (row, col), like matrix views
+template <typename T, typename B, typename C>
+void spmm(
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    T const* a_values,
+    B const& b,
+    C& c,
+    std::size_t begin,
+    std::size_t end) {
+  for (auto row = begin; row < end; ++row) {
+    for (std::size_t col = 0; col < c.width(); ++col) {
+      c(row, col) = T(0);
+    }
+    for (auto idx = a_offsets[row]; idx < a_offsets[row + 1]; ++idx) {
+      auto const k = a_columns[idx];
+      for (std::size_t col = 0; col < c.width(); ++col) {
+        c(row, col) = c(row, col) + a_values[idx] * b(k, col);
+      }
+    }
+  }
+}
+
+// acc += a * x, for one row-major B x B block
+template <std::size_t B, typename T>
+void bsr_block_multiply_add(T const* a, T const* x, T* acc) {
+  for (std::size_t r = 0; r < B; ++r) {
+    for (std::size_t q = 0; q < B; ++q) {
+      acc[r] += a[r * B + q] * x[q];
+    }
+  }
+}
+
+// c = a * b, a column of b at a time, for block rows [begin, end) of a;
+// the blocks are anything with value_type and a row-major data(), like
+// matrix<T, B, B>, and `b` and `c` anything with (row, col)
+template <std::size_t B, typename Block, typename Bm, typename C>
+void bsr_spmm(
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    Block const* a_blocks,
+    Bm const& b,
+    C& c,
+    std::size_t begin,
+    std::size_t end) {
+  using T = typename Block::value_type;
+  for (auto block_row = begin; block_row < end; ++block_row) {
+    for (std::size_t col = 0; col < c.width(); ++col) {
+      T acc[B] = {};
+      for (auto idx = a_offsets[block_row]; idx < a_offsets[block_row + 1];
+           ++idx) {
+        auto const k = a_columns[idx] * B;
+        T x[B];
+        for (std::size_t q = 0; q < B; ++q) {
+          x[q] = b(k + q, col);
+        }
+        impl::bsr_block_multiply_add<B>(a_blocks[idx].data(), x, acc);
+      }
+      for (std::size_t r = 0; r < B; ++r) {
+        c(block_row * B + r, col) = acc[r];
+      }
+    }
+  }
+}
+
+// y = a * x, for block rows [begin, end); `x` and `y` are anything with
+// operator[], like vector views
+template <std::size_t B, typename Block, typename X, typename Y>
+void bsr_spmv(
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    Block const* a_blocks,
+    X const& x,
+    Y& y,
+    std::size_t begin,
+    std::size_t end) {
+  using T = typename Block::value_type;
+  for (auto block_row = begin; block_row < end; ++block_row) {
+    T acc[B] = {};
+    for (auto idx = a_offsets[block_row]; idx < a_offsets[block_row + 1];
+         ++idx) {
+      auto const k = a_columns[idx] * B;
+      T xs[B];
+      for (std::size_t q = 0; q < B; ++q) {
+        xs[q] = x[k + q];
+      }
+      impl::bsr_block_multiply_add<B>(a_blocks[idx].data(), xs, acc);
+    }
+    for (std::size_t r = 0; r < B; ++r) {
+      y[block_row * B + r] = acc[r];
+    }
+  }
+}
+
+// ret = the inverse of a row-major B x B block, by gauss-jordan
+// elimination with partial pivoting; false if it's singular
+template <std::size_t B, typename T>
+bool invert_block(T const* a, T* ret) {
+  auto m = std::array<T, B * B>();
+  for (std::size_t idx = 0; idx < B * B; ++idx) {
+    m[idx] = a[idx];
+    ret[idx] = idx % (B + 1) == 0 ? T(1) : T(0);
+  }
+  for (std::size_t col = 0; col < B; ++col) {
+    auto pivot = col;
+    for (auto row = col + 1; row < B; ++row) {
+      if (std::abs(m[row * B + col]) > std::abs(m[pivot * B + col])) {
+        pivot = row;
+      }
+    }
+    if (m[pivot * B + col] == T(0)) {
+      return false;
+    }
+    for (std::size_t q = 0; q < B; ++q) {
+      std::swap(m[col * B + q], m[pivot * B + q]);
+      std::swap(ret[col * B + q], ret[pivot * B + q]);
+    }
+    auto const scale = T(1) / m[col * B + col];
+    for (std::size_t q = 0; q < B; ++q) {
+      m[col * B + q] *= scale;
+      ret[col * B + q] *= scale;
+    }
+    for (std::size_t row = 0; row < B; ++row) {
+      auto const factor = m[row * B + col];
+      if (row == col || factor == T(0)) {
+        continue;
+      }
+      for (std::size_t q = 0; q < B; ++q) {
+        m[row * B + q] -= factor * m[col * B + q];
+        ret[row * B + q] -= factor * ret[col * B + q];
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace algae::impl
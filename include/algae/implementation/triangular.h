@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+#include <algae/misc.h>
+
+/*
+  the portable triangular solves, for whatever the kernels in
+  algae/kernels.h can't take.
+*/
+
+namespace algae::impl {
+
+template <typename A, typename X>
+void trsv(triangle tri, diagonal diag, A const& a, X& x) {
+  auto const n = x.size();
+  if (tri == triangle::lower) {
+    for (std::size_t i = 0; i < n; ++i) {
+      auto sum = x[i];
+      for (std::size_t j = 0; j < i; ++j) {
+        sum = sum - a(i, j) * x[j];
+      }
+      x[i] = diag == diagonal::non_unit ? sum / a(i, i) : sum;
+    }
+  } else {
+    for (std::size_t i = n; i-- > 0;) {
+      auto sum = x[i];
+      for (std::size_t j = i + 1; j < n; ++j) {
+        sum = sum - a(i, j) * x[j];
+      }
+      x[i] = diag == diagonal::non_unit ? sum / a(i, i) : sum;
+    }
+  }
+}
+
+template <typename A, typename B>
+void trsm(triangle tri, diagonal diag, A const& a, B& b) {
+  for (std::size_t col = 0; col < b.width(); ++col) {
+    auto column = b.column(col);
+    impl::trsv(tri, diag, a, column);
+  }
+}
+
+} // namespace algae::impl
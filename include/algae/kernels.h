@@ -0,0 +1,2623 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <algae/bit_matrix.h>
+#include <algae/implementation/algorithms.h>
+#include <algae/implementation/instantiations.h>
+#include <algae/implementation/level1.h>
+#include <algae/implementation/triangular.h>
+#include <algae/matrix.h>
+#include <algae/modint.h>
+#include <algae/semiring.h>
+#include <algae/sparse.h>
+#include <algae/structured.h>
+#include <algae/vector.h>
+#include <algae/view.h>
+
+/*
+  implemented in the algae_kernels library; link against it to use this
+  header. Each kernel is built once per instruction set, and the best one
+  the CPU has is picked on first use.
+*/
+
+namespace algae::impl {
+
+template <typename T>
+constexpr bool is_dispatched_v =
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// the element types with min-plus kernels
+template <typename T>
+constexpr bool is_min_plus_dispatched_v =
+    is_dispatched_v<T> || std::is_same_v<T, std::int32_t>;
+
+// the rows of a view of bools, packed 64 to a word, lowest bit first
+template <typename View>
+std::vector<std::uint64_t> pack_bits(View const& m, std::size_t row_words) {
+  auto ret = std::vector<std::uint64_t>(m.height() * row_words, 0);
+  for (std::size_t i = 0; i < m.height(); ++i) {
+    for (std::size_t j = 0; j < m.width(); ++j) {
+      if (m(i, j)) {
+        ret[i * row_words + j / 64] |= std::uint64_t(1) << (j % 64);
+      }
+    }
+  }
+  return ret;
+}
+
+// the montgomery residues of modints, for the modular kernels
+template <std::uint64_t P>
+std::uint32_t const* residues(modint<P> const* ptr) noexcept {
+  static_assert(sizeof(modint<P>) == sizeof(std::uint32_t));
+  return reinterpret_cast<std::uint32_t const*>(ptr);
+}
+template <std::uint64_t P>
+std::uint32_t* residues(modint<P>* ptr) noexcept {
+  static_assert(sizeof(modint<P>) == sizeof(std::uint32_t));
+  return reinterpret_cast<std::uint32_t*>(ptr);
+}
+
+template <typename Op, typename Lhs, typename Rhs, typename Out>
+void strided_elementwise(Op op, Lhs lhs, Rhs rhs, Out out) noexcept {
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    out[i] = op(lhs[i], rhs[i]);
+  }
+}
+
+struct add_op {
+  template <typename T>
+  T operator()(T const& lhs, T const& rhs) const {
+    return lhs + rhs;
+  }
+};
+struct subtract_op {
+  template <typename T>
+  T operator()(T const& lhs, T const& rhs) const {
+    return lhs - rhs;
+  }
+};
+struct hadamard_op {
+  template <typename T>
+  T operator()(T const& lhs, T const& rhs) const {
+    return lhs * rhs;
+  }
+};
+
+// how many groups of problems the batched wrappers interleave at a time;
+// enough to split across threads, few enough to stay in cache
+inline constexpr std::size_t batched_chunk_groups = 64;
+
+// copies `count` matrices into the interleaved layout of the batched
+// kernels, `lanes` to a group; the lanes past the end of the last group
+// get the identity, so they have nothing to trip over
+template <typename T, std::size_t N, typename Layout>
+void interleave(
+    matrix<T, N, N, Layout> const* from,
+    std::size_t count,
+    std::size_t lanes,
+    T* to) noexcept {
+  auto const groups = (count + lanes - 1) / lanes;
+  for (std::size_t idx = 0; idx < groups * lanes; ++idx) {
+    auto const group = to + idx / lanes * N * N * lanes + idx % lanes;
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j < N; ++j) {
+        group[(i * N + j) * lanes] =
+            idx < count ? from[idx](i, j) : i == j ? T(1) : T(0);
+      }
+    }
+  }
+}
+template <typename T, std::size_t N, typename Layout>
+void deinterleave(
+    T const* from,
+    std::size_t count,
+    std::size_t lanes,
+    matrix<T, N, N, Layout>* to) noexcept {
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    auto const group = from + idx / lanes * N * N * lanes + idx % lanes;
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j < N; ++j) {
+        to[idx](i, j) = group[(i * N + j) * lanes];
+      }
+    }
+  }
+}
+// the same, for vectors; the padding is zeroes
+template <typename T, std::size_t N>
+void interleave(
+    vector<T, N> const* from,
+    std::size_t count,
+    std::size_t lanes,
+    T* to) noexcept {
+  auto const groups = (count + lanes - 1) / lanes;
+  for (std::size_t idx = 0; idx < groups * lanes; ++idx) {
+    auto const group = to + idx / lanes * N * lanes + idx % lanes;
+    for (std::size_t i = 0; i < N; ++i) {
+      group[i * lanes] = idx < count ? from[idx][i] : T(0);
+    }
+  }
+}
+template <typename T, std::size_t N>
+void deinterleave(
+    T const* from,
+    std::size_t count,
+    std::size_t lanes,
+    vector<T, N>* to) noexcept {
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    auto const group = from + idx / lanes * N * lanes + idx % lanes;
+    for (std::size_t i = 0; i < N; ++i) {
+      to[idx][i] = group[i * lanes];
+    }
+  }
+}
+
+// copies the flags of `count` problems out, if there's anywhere to put
+// them, and returns how many were set
+inline std::size_t
+report_flags(bool const* flags, std::size_t count, bool* to) noexcept {
+  std::size_t ret = 0;
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    ret += flags[idx];
+    if (to) {
+      to[idx] = flags[idx];
+    }
+  }
+  return ret;
+}
+
+// the vectors, one after another; the rows of a row-major matrix
+template <typename T, std::size_t N>
+std::vector<T> pack_vectors(vector<T, N> const* vs, std::size_t count) {
+  auto ret = std::vector<T>(count * N);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    std::copy(vs[idx].begin(), vs[idx].end(), ret.begin() + idx * N);
+  }
+  return ret;
+}
+
+constexpr bool larger_is_nearer(metric which) noexcept {
+  return which != metric::squared_euclidean;
+}
+
+// a single comparison, directly; for the element types without kernels
+template <typename T, std::size_t N>
+T compare(metric which, vector<T, N> const& a, vector<T, N> const& b) {
+  auto ret = T(0);
+  if (which == metric::squared_euclidean) {
+    for (std::size_t idx = 0; idx < N; ++idx) {
+      auto const diff = a[idx] - b[idx];
+      ret = ret + diff * diff;
+    }
+    return ret;
+  }
+  auto a_squared = T(0);
+  auto b_squared = T(0);
+  for (std::size_t idx = 0; idx < N; ++idx) {
+    ret = ret + a[idx] * b[idx];
+    a_squared = a_squared + a[idx] * a[idx];
+    b_squared = b_squared + b[idx] * b[idx];
+  }
+  if (which == metric::cosine) {
+    auto const norms = std::sqrt(a_squared * b_squared);
+    return norms > T(0) ? ret / norms : T(0);
+  }
+  return ret;
+}
+
+// a score's key for top_k_push, turned around (negated) when larger scores
+// are better; and since it's its own inverse, a key's score. Integers are
+// complemented rather than negated, which keeps the order without
+// overflowing at the lowest value
+template <typename T>
+constexpr T top_k_key(T value, bool negated) noexcept {
+  if (!negated) {
+    return value;
+  }
+  if constexpr (std::is_integral_v<T>) {
+    return T(~value);
+  } else {
+    return -value;
+  }
+}
+
+// the best k (key, index) pairs seen so far, where a smaller key is
+// better, in a heap with the worst of them at the front; ties go to the
+// lower index
+template <typename T>
+void top_k_push(
+    std::pair<T, std::size_t>* heap,
+    std::size_t& size,
+    std::size_t k,
+    T key,
+    std::size_t index) noexcept {
+  auto const entry = std::pair<T, std::size_t>(key, index);
+  if (size < k) {
+    heap[size++] = entry;
+    std::push_heap(heap, heap + size);
+  } else if (k != 0 && entry < heap[0]) {
+    std::pop_heap(heap, heap + k);
+    heap[k - 1] = entry;
+    std::push_heap(heap, heap + k);
+  }
+}
+// sorts the heap, best first, into k indices and values; the keys are
+// top_k_key's, negated when larger values are better. Missing places get index
+// `none`, and the worst possible value: an infinity, or for types without
+// one, the largest or lowest value
+template <typename T>
+void top_k_finish(
+    std::pair<T, std::size_t>* heap,
+    std::size_t size,
+    std::size_t k,
+    bool negated,
+    std::size_t none,
+    std::size_t* indices,
+    T* values) noexcept {
+  std::sort_heap(heap, heap + size);
+  for (std::size_t idx = 0; idx < k; ++idx) {
+    if (idx < size) {
+      indices[idx] = heap[idx].second;
+      values[idx] = top_k_key(heap[idx].first, negated);
+    } else {
+      using limits = std::numeric_limits<T>;
+      indices[idx] = none;
+      if constexpr (limits::has_infinity) {
+        values[idx] = negated ? -limits::infinity() : limits::infinity();
+      } else {
+        values[idx] = negated ? limits::lowest() : limits::max();
+      }
+    }
+  }
+}
+
+} // namespace algae::impl
+
+namespace algae::kernels {
+
+enum class isa {
+  generic,
+  sse4_2,
+  avx2,
+  avx512,
+};
+
+char const* name(isa level) noexcept;
+
+// the best instruction set this CPU (and OS) supports; found with cpuid
+isa detected_isa() noexcept;
+// the instruction set the kernels are currently dispatching to
+isa active_isa() noexcept;
+// switch the kernels over to `level`
+// returns false, and changes nothing, if this CPU doesn't support it
+bool select_isa(isa level) noexcept;
+
+// cache blocking parameters, for a single element type
+struct blocking {
+  // gemm streams each gemm_kc x gemm_nc panel of `b` through all of `a`
+  std::size_t gemm_kc;
+  std::size_t gemm_nc;
+  // transpose moves square tiles of this size
+  std::size_t transpose_tile;
+  // column_sums accumulates this many columns at a time
+  std::size_t reduction_nc;
+};
+
+struct tuning {
+  blocking f32;
+  blocking f64;
+};
+
+/*
+  the blocking; algae_tune measures it and writes a file of lines like
+    float.gemm_kc = 256
+  which is read from default_tuning_path() when there is one.
+*/
+
+tuning default_tuning() noexcept;
+tuning const& current_tuning() noexcept;
+// don't call this while any kernels are running
+void set_tuning(tuning const& new_tuning) noexcept;
+
+// the number of threads the kernels may use, counting the calling thread;
+// by default, std::thread::hardware_concurrency()
+// only big enough problems are split up, so small ones don't pay for it
+std::size_t thread_count() noexcept;
+// 1 keeps everything on the calling thread, 0 goes back to the default
+// don't call this while any kernels are running
+void set_thread_count(std::size_t count) noexcept;
+
+// calls body(ctx, begin, end) on each of `chunks` contiguous pieces of
+// [0, n), on the kernels' threads, and returns once they've all finished.
+// One of these runs on the threads at a time; any other (including one
+// from inside body) runs on its calling thread
+void parallel_for(
+    std::size_t n,
+    std::size_t chunks,
+    void (*body)(void const*, std::size_t, std::size_t),
+    void const* ctx) noexcept;
+// ...with f(begin, end)
+template <typename F>
+void parallel_for(std::size_t n, std::size_t chunks, F const& f) noexcept {
+  if (chunks <= 1) {
+    f(std::size_t(0), n);
+    return;
+  }
+  parallel_for(
+      n,
+      chunks,
+      [](void const* ctx, std::size_t begin, std::size_t end) {
+        (*static_cast<F const*>(ctx))(begin, end);
+      },
+      &f);
+}
+
+// $ALGAE_TUNING_FILE if it's set, otherwise algae/tuning.conf in the user's
+// configuration directory; empty if there's no configuration directory
+// either, and then nothing is read
+std::string default_tuning_path();
+// std::nullopt if the file can't be opened, or has malformed lines
+// any parameters the file doesn't mention are left at their defaults
+std::optional<tuning> read_tuning(std::string const& path);
+bool write_tuning(tuning const& to_write, std::string const& path);
+
+// the number of problems interleaved into a group by the batched kernels;
+// 64 bytes' worth, the widest register, so that every instruction set's
+// registers divide a group evenly
+template <typename T>
+constexpr std::size_t batch_lanes = 64 / sizeof(T);
+
+// raw kernels; all matrices are row-major with a leading dimension
+
+float dot(float const* lhs, float const* rhs, std::size_t n) noexcept;
+double dot(double const* lhs, double const* rhs, std::size_t n) noexcept;
+
+void add(
+    float const* lhs, float const* rhs, float* out, std::size_t n) noexcept;
+void add(
+    double const* lhs, double const* rhs, double* out, std::size_t n) noexcept;
+void subtract(
+    float const* lhs, float const* rhs, float* out, std::size_t n) noexcept;
+void subtract(
+    double const* lhs, double const* rhs, double* out, std::size_t n) noexcept;
+void hadamard(
+    float const* lhs, float const* rhs, float* out, std::size_t n) noexcept;
+void hadamard(
+    double const* lhs, double const* rhs, double* out, std::size_t n) noexcept;
+
+// y = alpha * x + y
+void axpy(float alpha, float const* x, float* y, std::size_t n) noexcept;
+void axpy(double alpha, double const* x, double* y, std::size_t n) noexcept;
+
+// y = alpha * x + beta * y
+void axpby(
+    float alpha, float const* x, float beta, float* y, std::size_t n) noexcept;
+void axpby(
+    double alpha,
+    double const* x,
+    double beta,
+    double* y,
+    std::size_t n) noexcept;
+// x = alpha * x
+void scal(float alpha, float* x, std::size_t n) noexcept;
+void scal(double alpha, double* x, std::size_t n) noexcept;
+
+// the euclidean norm; doesn't overflow or underflow unless the result does
+float nrm2(float const* x, std::size_t n) noexcept;
+double nrm2(double const* x, std::size_t n) noexcept;
+// sum of absolute values
+float asum(float const* x, std::size_t n) noexcept;
+double asum(double const* x, std::size_t n) noexcept;
+// index of the first element with the largest/smallest absolute value
+// 0 if n is 0
+std::size_t iamax(float const* x, std::size_t n) noexcept;
+std::size_t iamax(double const* x, std::size_t n) noexcept;
+std::size_t iamin(float const* x, std::size_t n) noexcept;
+std::size_t iamin(double const* x, std::size_t n) noexcept;
+
+void swap(float* x, float* y, std::size_t n) noexcept;
+void swap(double* x, double* y, std::size_t n) noexcept;
+// y = x
+void copy(float const* x, float* y, std::size_t n) noexcept;
+void copy(double const* x, double* y, std::size_t n) noexcept;
+
+// applies a givens rotation: (x, y) = (c * x + s * y, c * y - s * x)
+void rot(float* x, float* y, std::size_t n, float c, float s) noexcept;
+void rot(double* x, double* y, std::size_t n, double c, double s) noexcept;
+
+// y = alpha * x + y, then returns dot(y, z); in a single pass
+float axpy_dot(
+    float alpha,
+    float const* x,
+    float* y,
+    float const* z,
+    std::size_t n) noexcept;
+double axpy_dot(
+    double alpha,
+    double const* x,
+    double* y,
+    double const* z,
+    std::size_t n) noexcept;
+
+// c = alpha * a * b + beta * c, where a is m x k, b is k x n, c is m x n
+// if beta is zero, c is never read
+void gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    float alpha,
+    float const* a,
+    std::size_t lda,
+    float const* b,
+    std::size_t ldb,
+    float beta,
+    float* c,
+    std::size_t ldc) noexcept;
+void gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    double alpha,
+    double const* a,
+    std::size_t lda,
+    double const* b,
+    std::size_t ldb,
+    double beta,
+    double* c,
+    std::size_t ldc) noexcept;
+
+// products over other semirings (see algae/semiring.h); these add into c
+// rather than overwriting it, so for a plain product c should start out as
+// the semiring's zero()
+
+// c = min(c, a (min-plus) b), or
+//   c[i, j] = min(c[i, j], min over p of a[i, p] + b[p, j])
+// where a is m x k and b is k x n. For integers, the largest value is
+// infinity, and stays that way; finite weights from half of it up can
+// overflow into it, or past it
+void min_plus_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    float const* a,
+    std::size_t lda,
+    float const* b,
+    std::size_t ldb,
+    float* c,
+    std::size_t ldc) noexcept;
+void min_plus_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    double const* a,
+    std::size_t lda,
+    double const* b,
+    std::size_t ldb,
+    double* c,
+    std::size_t ldc) noexcept;
+void min_plus_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    std::int32_t const* a,
+    std::size_t lda,
+    std::int32_t const* b,
+    std::size_t ldb,
+    std::int32_t* c,
+    std::size_t ldc) noexcept;
+
+// c |= a (or-and) b, for bit matrices; each row is packed 64 bits to a
+// word, lowest bit first, and lda, ldb and ldc are in words. a is m x k
+// bits, and b is k x (64 * n_words)
+void or_and_gemm(
+    std::size_t m,
+    std::size_t n_words,
+    std::size_t k,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::uint64_t* c,
+    std::size_t ldc) noexcept;
+// c ^= a (xor-and) b, the product over GF(2); packed in the same way
+void xor_and_gemm(
+    std::size_t m,
+    std::size_t n_words,
+    std::size_t k,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::uint64_t* c,
+    std::size_t ldc) noexcept;
+
+// out[i, j] = the number of bits set in both row i of a and row j of b,
+// where a has m rows and b has n, each `words` words long
+void and_popcounts(
+    std::size_t m,
+    std::size_t n,
+    std::size_t words,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::size_t* out,
+    std::size_t ldo) noexcept;
+// ...and the number that differ between them; the hamming distance
+void xor_popcounts(
+    std::size_t m,
+    std::size_t n,
+    std::size_t words,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::size_t* out,
+    std::size_t ldo) noexcept;
+
+// modular arithmetic, for an odd modulus p < 2^31; residues are in
+// montgomery form, x * 2^32 mod p, as algae::modint keeps them (see
+// algae/modint.h)
+
+// c = a * b mod p, where a is m x k and b is k x n
+void mod_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    std::uint32_t p,
+    std::uint32_t const* a,
+    std::size_t lda,
+    std::uint32_t const* b,
+    std::size_t ldb,
+    std::uint32_t* c,
+    std::size_t ldc) noexcept;
+// y = alpha * x + y mod p
+void mod_axpy(
+    std::uint32_t p,
+    std::uint32_t alpha,
+    std::uint32_t const* x,
+    std::uint32_t* y,
+    std::size_t n) noexcept;
+
+// y = alpha * a * x + beta * y, where a is m x n
+// if beta is zero, y is never read
+void gemv(
+    std::size_t m,
+    std::size_t n,
+    float alpha,
+    float const* a,
+    std::size_t lda,
+    float const* x,
+    float beta,
+    float* y) noexcept;
+void gemv(
+    std::size_t m,
+    std::size_t n,
+    double alpha,
+    double const* a,
+    std::size_t lda,
+    double const* x,
+    double beta,
+    double* y) noexcept;
+
+// y = alpha * transpose(a) * x + beta * y, where a is m x n
+// if beta is zero, y is never read
+void gemv_t(
+    std::size_t m,
+    std::size_t n,
+    float alpha,
+    float const* a,
+    std::size_t lda,
+    float const* x,
+    float beta,
+    float* y) noexcept;
+void gemv_t(
+    std::size_t m,
+    std::size_t n,
+    double alpha,
+    double const* a,
+    std::size_t lda,
+    double const* x,
+    double beta,
+    double* y) noexcept;
+
+// solves a * x = b for x, where a is n x n and triangular; x starts out
+// holding b. Only the `tri` half of a is read, and with diagonal::unit
+// not even its diagonal
+void trsv(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    float const* a,
+    std::size_t lda,
+    float* x) noexcept;
+void trsv(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    double const* a,
+    std::size_t lda,
+    double* x) noexcept;
+
+// the same, for an n x nrhs b; blocked so most of the work is in gemm
+void trsm(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    std::size_t nrhs,
+    float const* a,
+    std::size_t lda,
+    float* b,
+    std::size_t ldb) noexcept;
+void trsm(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    std::size_t nrhs,
+    double const* a,
+    std::size_t lda,
+    double* b,
+    std::size_t ldb) noexcept;
+
+// b = transpose(a), where a is m x n
+void transpose(
+    std::size_t m,
+    std::size_t n,
+    float const* a,
+    std::size_t lda,
+    float* b,
+    std::size_t ldb) noexcept;
+void transpose(
+    std::size_t m,
+    std::size_t n,
+    double const* a,
+    std::size_t lda,
+    double* b,
+    std::size_t ldb) noexcept;
+
+// out[j] = sum of column j of a, where a is m x n
+void column_sums(
+    std::size_t m,
+    std::size_t n,
+    float const* a,
+    std::size_t lda,
+    float* out) noexcept;
+void column_sums(
+    std::size_t m,
+    std::size_t n,
+    double const* a,
+    std::size_t lda,
+    double* out) noexcept;
+
+// batches of small, independent, n x n problems, in an interleaved layout;
+// `batch_lanes<T>` problems make up a group, and element (i, j) of problem
+// l is at [(i * n + j) * batch_lanes<T> + l] of its group. A register then
+// holds the same element of several problems, and each of its lanes works
+// on a different one. Groups are n * n * batch_lanes<T> elements long, and
+// the vectors of batched_solve are n * batch_lanes<T>
+// the flags are batch_lanes<T> to a group, one for each problem
+
+// c = a * b
+void batched_gemm(
+    std::size_t n,
+    std::size_t groups,
+    float const* a,
+    float const* b,
+    float* c) noexcept;
+void batched_gemm(
+    std::size_t n,
+    std::size_t groups,
+    double const* a,
+    double const* b,
+    double* c) noexcept;
+
+// out = a^-1, by gauss-jordan elimination with partial pivoting; a is
+// overwritten. singular is set for the problems with no inverse
+void batched_inverse(
+    std::size_t n,
+    std::size_t groups,
+    float* a,
+    float* out,
+    bool* singular) noexcept;
+void batched_inverse(
+    std::size_t n,
+    std::size_t groups,
+    double* a,
+    double* out,
+    bool* singular) noexcept;
+
+// solves a * x = b for x, by gaussian elimination with partial pivoting;
+// x starts out holding b, and a is overwritten
+void batched_solve(
+    std::size_t n,
+    std::size_t groups,
+    float* a,
+    float* x,
+    bool* singular) noexcept;
+void batched_solve(
+    std::size_t n,
+    std::size_t groups,
+    double* a,
+    double* x,
+    bool* singular) noexcept;
+
+// a = L L^T, in place; only the lower triangle of a is read, and the upper
+// one is zeroed. failed is set for the problems that aren't positive
+// definite
+void batched_cholesky(
+    std::size_t n, std::size_t groups, float* a, bool* failed) noexcept;
+void batched_cholesky(
+    std::size_t n, std::size_t groups, double* a, bool* failed) noexcept;
+
+// out[i, j] compares row i of a with row j of b, where a is m x d and b is
+// n x d. Each of them is a dot product, so the whole thing is a single
+// gemm, a * transpose(b), with the norms of the rows folded in afterwards
+void pairwise(
+    metric which,
+    std::size_t m,
+    std::size_t n,
+    std::size_t d,
+    float const* a,
+    std::size_t lda,
+    float const* b,
+    std::size_t ldb,
+    float* out,
+    std::size_t ldo) noexcept;
+void pairwise(
+    metric which,
+    std::size_t m,
+    std::size_t n,
+    std::size_t d,
+    double const* a,
+    std::size_t lda,
+    double const* b,
+    std::size_t ldb,
+    double* out,
+    std::size_t ldo) noexcept;
+
+// the k rows of b nearest to each row of a, nearest first, as indices into
+// b and what pairwise would have given for them; k to a row of a. Ties go
+// to the lower index. The full m x n result is never built; b is taken a
+// tile at a time, and each tile is folded into the rows' top k while it's
+// still in cache. If k > n, the extra places get index n, and a value
+// further than anything (an infinity)
+void pairwise_top_k(
+    metric which,
+    std::size_t m,
+    std::size_t n,
+    std::size_t d,
+    float const* a,
+    std::size_t lda,
+    float const* b,
+    std::size_t ldb,
+    std::size_t k,
+    std::size_t* indices,
+    float* values) noexcept;
+void pairwise_top_k(
+    metric which,
+    std::size_t m,
+    std::size_t n,
+    std::size_t d,
+    double const* a,
+    std::size_t lda,
+    double const* b,
+    std::size_t ldb,
+    std::size_t k,
+    std::size_t* indices,
+    double* values) noexcept;
+
+// the k rows of `database`, which is n x d, with the largest inner
+// products with each of the q queries, which are q x d; indices and values
+// are q x k, best first, and ties go to the lower index. If scales isn't
+// null, the product with row j is multiplied by scales[j] first; with one
+// over the norm of each row, and normalized queries, that's the cosine.
+// Made for a few queries against many rows: the rows are split across
+// threads, each keeping its own top k, and those are merged at the end.
+// If k > n, the extra places get index n, and minus infinity
+void inner_product_top_k(
+    std::size_t n,
+    std::size_t d,
+    float const* database,
+    std::size_t ldd,
+    float const* scales,
+    std::size_t q,
+    float const* queries,
+    std::size_t ldq,
+    std::size_t k,
+    std::size_t* indices,
+    float* values) noexcept;
+void inner_product_top_k(
+    std::size_t n,
+    std::size_t d,
+    double const* database,
+    std::size_t ldd,
+    double const* scales,
+    std::size_t q,
+    double const* queries,
+    std::size_t ldq,
+    std::size_t k,
+    std::size_t* indices,
+    double* values) noexcept;
+
+// `clusters` centroids for the n rows of points, which is n x d, by
+// Lloyd's k-means: each round assigns every row to its nearest centroid
+// (with pairwise_top_k, so a gemm), then moves each centroid to the mean of
+// its rows, until nothing moves or `iterations` rounds. It starts from
+// rows picked by k-means++ (with seed), and a centroid left with no rows
+// moves to the row furthest from its own. centroids is clusters x d
+void kmeans(
+    std::size_t n,
+    std::size_t d,
+    float const* points,
+    std::size_t ldp,
+    std::size_t clusters,
+    std::size_t iterations,
+    std::uint64_t seed,
+    float* centroids) noexcept;
+void kmeans(
+    std::size_t n,
+    std::size_t d,
+    double const* points,
+    std::size_t ldp,
+    std::size_t clusters,
+    std::size_t iterations,
+    std::uint64_t seed,
+    double* centroids) noexcept;
+
+// asymmetric distances, from product quantization codes: codes is n x m
+// bytes, each one of `centroids` entries in its column's row of table,
+// which is m x centroids. out[i] is the sum over s of
+// table[s, codes[i, s]]
+void adc_scan(
+    std::size_t n,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    float const* table,
+    float* out) noexcept;
+void adc_scan(
+    std::size_t n,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    double const* table,
+    double* out) noexcept;
+
+// the k of the n codes nearest each of q queries, by adc_scan with their
+// tables (q of them, one after another); `which` says whether smaller or
+// larger sums are nearer. Split across threads, and padded, as
+// inner_product_top_k is
+void adc_top_k(
+    metric which,
+    std::size_t n,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    std::size_t q,
+    float const* tables,
+    std::size_t k,
+    std::size_t* indices,
+    float* values) noexcept;
+void adc_top_k(
+    metric which,
+    std::size_t n,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    std::size_t q,
+    double const* tables,
+    std::size_t k,
+    std::size_t* indices,
+    double* values) noexcept;
+
+// sparse matrices, in compressed sparse row form (see algae/sparse.h)
+// the rows of the product are split across threads, by how many products
+// go into each
+
+// the symbolic half of c = a * b, for an m-row a and an n-column b; fills
+// in the m + 1 c_offsets, so that c_offsets[m] is the number of nonzeros
+void spgemm_offsets(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    std::size_t* c_offsets) noexcept;
+// ...and then the (sorted) columns of each row
+void spgemm_columns(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    std::size_t const* c_offsets,
+    std::size_t* c_columns) noexcept;
+
+// the numeric half; fills in c_values, for the pattern found above
+void spgemm_numeric(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    float const* a_values,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    float const* b_values,
+    std::size_t const* c_offsets,
+    std::size_t const* c_columns,
+    float* c_values) noexcept;
+void spgemm_numeric(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    double const* a_values,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    double const* b_values,
+    std::size_t const* c_offsets,
+    std::size_t const* c_columns,
+    double* c_values) noexcept;
+
+// c = a * b, for a sparse, m-row, a, and a dense b with n columns
+void spmm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    float const* a_values,
+    float const* b,
+    std::size_t ldb,
+    float* c,
+    std::size_t ldc) noexcept;
+void spmm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    double const* a_values,
+    double const* b,
+    std::size_t ldb,
+    double* c,
+    std::size_t ldc) noexcept;
+
+// algae types
+
+template <typename T, std::size_t N>
+T dot(vector<T, N> const& lhs, vector<T, N> const& rhs) noexcept {
+  if constexpr (impl::is_dispatched_v<T>) {
+    return kernels::dot(lhs.data(), rhs.data(), N);
+  } else {
+    return impl::dot(lhs.data(), rhs.data(), N);
+  }
+}
+
+template <typename T, std::size_t N>
+vector<T, N> add(vector<T, N> const& lhs, vector<T, N> const& rhs) noexcept {
+  auto ret = vector<T, N>(algae::list_init);
+  if constexpr (impl::is_dispatched_v<T>) {
+    kernels::add(lhs.data(), rhs.data(), ret.data(), N);
+  } else {
+    impl::add(lhs.data(), rhs.data(), ret.data(), N);
+  }
+  return ret;
+}
+template <typename T, std::size_t N>
+vector<T, N>
+subtract(vector<T, N> const& lhs, vector<T, N> const& rhs) noexcept {
+  auto ret = vector<T, N>(algae::list_init);
+  if constexpr (impl::is_dispatched_v<T>) {
+    kernels::subtract(lhs.data(), rhs.data(), ret.data(), N);
+  } else {
+    impl::subtract(lhs.data(), rhs.data(), ret.data(), N);
+  }
+  return ret;
+}
+template <typename T, std::size_t N>
+vector<T, N>
+hadamard(vector<T, N> const& lhs, vector<T, N> const& rhs) noexcept {
+  auto ret = vector<T, N>(algae::list_init);
+  if constexpr (impl::is_dispatched_v<T>) {
+    kernels::hadamard(lhs.data(), rhs.data(), ret.data(), N);
+  } else {
+    impl::hadamard(lhs.data(), rhs.data(), ret.data(), N);
+  }
+  return ret;
+}
+
+template <typename T, std::size_t N>
+void axpy(T alpha, vector<T, N> const& x, vector<T, N>& y) noexcept {
+  if constexpr (impl::is_dispatched_v<T>) {
+    kernels::axpy(alpha, x.data(), y.data(), N);
+  } else {
+    impl::axpy(alpha, x.data(), y.data(), N);
+  }
+}
+
+// elementwise operations don't care about layout, as long as both sides
+// have the same one; tiled padding is all zeroes, and stays that way
+
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+matrix<T, H, W, Layout> add(
+    matrix<T, H, W, Layout> const& lhs,
+    matrix<T, H, W, Layout> const& rhs) noexcept {
+  auto ret = matrix<T, H, W, Layout>();
+  auto const n = ret.storage_size();
+  if constexpr (impl::is_dispatched_v<T>) {
+    kernels::add(lhs.data(), rhs.data(), ret.data(), n);
+  } else {
+    impl::add(lhs.data(), rhs.data(), ret.data(), n);
+  }
+  return ret;
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+matrix<T, H, W, Layout> subtract(
+    matrix<T, H, W, Layout> const& lhs,
+    matrix<T, H, W, Layout> const& rhs) noexcept {
+  auto ret = matrix<T, H, W, Layout>();
+  auto const n = ret.storage_size();
+  if constexpr (impl::is_dispatched_v<T>) {
+    kernels::subtract(lhs.data(), rhs.data(), ret.data(), n);
+  } else {
+    impl::subtract(lhs.data(), rhs.data(), ret.data(), n);
+  }
+  return ret;
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+matrix<T, H, W, Layout> hadamard(
+    matrix<T, H, W, Layout> const& lhs,
+    matrix<T, H, W, Layout> const& rhs) noexcept {
+  auto ret = matrix<T, H, W, Layout>();
+  auto const n = ret.storage_size();
+  if constexpr (impl::is_dispatched_v<T>) {
+    kernels::hadamard(lhs.data(), rhs.data(), ret.data(), n);
+  } else {
+    impl::hadamard(lhs.data(), rhs.data(), ret.data(), n);
+  }
+  return ret;
+}
+
+// row-major products go straight to gemm; column-major ones are row-major
+// products of the transposes, with the operands swapped
+// any other mix of layouts uses algae::multiply
+template <
+    typename T,
+    std::size_t M,
+    std::size_t K,
+    std::size_t N,
+    typename Layout_lhs,
+    typename Layout_rhs>
+matrix<T, M, N, Layout_lhs> multiply(
+    matrix<T, M, K, Layout_lhs> const& lhs,
+    matrix<T, K, N, Layout_rhs> const& rhs) noexcept {
+  constexpr auto row = std::is_same_v<Layout_lhs, row_major> &&
+      std::is_same_v<Layout_rhs, row_major>;
+  constexpr auto column = std::is_same_v<Layout_lhs, column_major> &&
+      std::is_same_v<Layout_rhs, column_major>;
+
+  auto ret = matrix<T, M, N, Layout_lhs>();
+  if constexpr (row) {
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::gemm(
+          M, N, K, T(1), lhs.data(), K, rhs.data(), N, T(0), ret.data(), N);
+    } else {
+      impl::gemm(
+          M, N, K, T(1), lhs.data(), K, rhs.data(), N, T(0), ret.data(), N);
+    }
+  } else if constexpr (column) {
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::gemm(
+          N, M, K, T(1), rhs.data(), K, lhs.data(), M, T(0), ret.data(), M);
+    } else {
+      impl::gemm(
+          N, M, K, T(1), rhs.data(), K, lhs.data(), M, T(0), ret.data(), M);
+    }
+  } else {
+    ret = algae::multiply(lhs, rhs);
+  }
+  return ret;
+}
+
+// matrix * vector; a row-major matrix takes a dot product per row, and a
+// column-major one is a row-major transpose, so it takes the axpy form
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+vector<T, H> multiply(
+    matrix<T, H, W, Layout> const& m, vector<T, W> const& x) noexcept {
+  auto ret = vector<T, H>(algae::list_init);
+  if constexpr (std::is_same_v<Layout, row_major>) {
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::gemv(H, W, T(1), m.data(), W, x.data(), T(0), ret.data());
+    } else {
+      impl::gemv(H, W, T(1), m.data(), W, x.data(), T(0), ret.data());
+    }
+  } else if constexpr (std::is_same_v<Layout, column_major>) {
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::gemv_t(W, H, T(1), m.data(), H, x.data(), T(0), ret.data());
+    } else {
+      impl::gemv_t(W, H, T(1), m.data(), H, x.data(), T(0), ret.data());
+    }
+  } else {
+    ret = algae::multiply(m, x);
+  }
+  return ret;
+}
+
+// vector * matrix, the transposed product; the other way around
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+vector<T, W> multiply(
+    vector<T, H> const& x, matrix<T, H, W, Layout> const& m) noexcept {
+  auto ret = vector<T, W>(algae::list_init);
+  if constexpr (std::is_same_v<Layout, row_major>) {
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::gemv_t(H, W, T(1), m.data(), W, x.data(), T(0), ret.data());
+    } else {
+      impl::gemv_t(H, W, T(1), m.data(), W, x.data(), T(0), ret.data());
+    }
+  } else if constexpr (std::is_same_v<Layout, column_major>) {
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::gemv(W, H, T(1), m.data(), H, x.data(), T(0), ret.data());
+    } else {
+      impl::gemv(W, H, T(1), m.data(), H, x.data(), T(0), ret.data());
+    }
+  } else {
+    ret = algae::multiply(x, m);
+  }
+  return ret;
+}
+
+// the storage of a column-major matrix is a row-major matrix, transposed
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+matrix<T, W, H, Layout> transpose(matrix<T, H, W, Layout> const& m) noexcept {
+  auto ret = matrix<T, W, H, Layout>();
+  if constexpr (
+      std::is_same_v<Layout, row_major> ||
+      std::is_same_v<Layout, column_major>) {
+    constexpr auto rows = std::is_same_v<Layout, row_major> ? H : W;
+    constexpr auto cols = std::is_same_v<Layout, row_major> ? W : H;
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::transpose(rows, cols, m.data(), cols, ret.data(), rows);
+    } else {
+      impl::transpose(rows, cols, m.data(), cols, ret.data(), rows);
+    }
+  } else {
+    ret = algae::transpose(m);
+  }
+  return ret;
+}
+
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+vector<T, W> column_sums(matrix<T, H, W, Layout> const& m) noexcept {
+  auto ret = vector<T, W>(algae::list_init);
+  if constexpr (std::is_same_v<Layout, row_major>) {
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::column_sums(H, W, m.data(), W, ret.data());
+    } else {
+      impl::column_sums(H, W, m.data(), W, ret.data());
+    }
+  } else {
+    for (std::size_t col = 0; col < W; ++col) {
+      for (auto const& x : m.column(col)) {
+        ret[col] = ret[col] + x;
+      }
+    }
+  }
+  return ret;
+}
+
+// views; element types may differ only in const, and sizes have to agree
+// as for the algorithms in view.h
+
+template <typename A, std::size_t N, typename B, std::size_t M>
+std::remove_cv_t<A>
+dot(vector_view<A, N> lhs, vector_view<B, M> rhs) noexcept {
+  if constexpr (impl::is_dispatched_v<std::remove_cv_t<A>>) {
+    if (lhs.is_contiguous() && rhs.is_contiguous()) {
+      return kernels::dot(
+          lhs.data(), rhs.data(), std::min(lhs.size(), rhs.size()));
+    }
+  }
+  return algae::dot(lhs, rhs);
+}
+
+// out = lhs + rhs; out may be the same view as lhs or rhs
+template <
+    typename A,
+    std::size_t N,
+    typename B,
+    std::size_t M,
+    typename C,
+    std::size_t P>
+void add(
+    vector_view<A, N> lhs,
+    vector_view<B, M> rhs,
+    vector_view<C, P> out) noexcept {
+  static_assert(
+      impl::extents_match(N, M, P), "vectors must be the same size");
+  if (lhs.size() != out.size() || rhs.size() != out.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<C>) {
+    if (lhs.is_contiguous() && rhs.is_contiguous() && out.is_contiguous()) {
+      return kernels::add(lhs.data(), rhs.data(), out.data(), out.size());
+    }
+  }
+  impl::strided_elementwise(impl::add_op(), lhs, rhs, out);
+}
+template <
+    typename A,
+    std::size_t N,
+    typename B,
+    std::size_t M,
+    typename C,
+    std::size_t P>
+void subtract(
+    vector_view<A, N> lhs,
+    vector_view<B, M> rhs,
+    vector_view<C, P> out) noexcept {
+  static_assert(
+      impl::extents_match(N, M, P), "vectors must be the same size");
+  if (lhs.size() != out.size() || rhs.size() != out.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<C>) {
+    if (lhs.is_contiguous() && rhs.is_contiguous() && out.is_contiguous()) {
+      return kernels::subtract(lhs.data(), rhs.data(), out.data(), out.size());
+    }
+  }
+  impl::strided_elementwise(impl::subtract_op(), lhs, rhs, out);
+}
+template <
+    typename A,
+    std::size_t N,
+    typename B,
+    std::size_t M,
+    typename C,
+    std::size_t P>
+void hadamard(
+    vector_view<A, N> lhs,
+    vector_view<B, M> rhs,
+    vector_view<C, P> out) noexcept {
+  static_assert(
+      impl::extents_match(N, M, P), "vectors must be the same size");
+  if (lhs.size() != out.size() || rhs.size() != out.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<C>) {
+    if (lhs.is_contiguous() && rhs.is_contiguous() && out.is_contiguous()) {
+      return kernels::hadamard(lhs.data(), rhs.data(), out.data(), out.size());
+    }
+  }
+  impl::strided_elementwise(impl::hadamard_op(), lhs, rhs, out);
+}
+
+template <typename T, typename A, std::size_t N, typename B, std::size_t M>
+void axpy(T alpha, vector_view<A, N> x, vector_view<B, M> y) noexcept {
+  static_assert(impl::extents_match(N, M), "vectors must be the same size");
+  if (x.size() != y.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<B>) {
+    if (x.is_contiguous() && y.is_contiguous()) {
+      return kernels::axpy(B(alpha), x.data(), y.data(), y.size());
+    }
+  }
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    y[i] = y[i] + B(alpha) * x[i];
+  }
+}
+
+// level 1 BLAS; the views take the kernels when they're contiguous, and
+// the vectors always are
+
+template <typename T, typename A, std::size_t N, typename B, std::size_t M>
+void axpby(
+    T alpha, vector_view<A, N> x, T beta, vector_view<B, M> y) noexcept {
+  static_assert(impl::extents_match(N, M), "vectors must be the same size");
+  if (x.size() != y.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<B>) {
+    if (x.is_contiguous() && y.is_contiguous()) {
+      return kernels::axpby(B(alpha), x.data(), B(beta), y.data(), y.size());
+    }
+  }
+  impl::axpby(B(alpha), x, B(beta), y);
+}
+template <typename T, std::size_t N>
+void axpby(
+    T alpha, vector<T, N> const& x, T beta, vector<T, N>& y) noexcept {
+  kernels::axpby(alpha, view(x), beta, view(y));
+}
+
+template <typename T, typename A, std::size_t N>
+void scal(T alpha, vector_view<A, N> x) noexcept {
+  if constexpr (impl::is_dispatched_v<A>) {
+    if (x.is_contiguous()) {
+      return kernels::scal(A(alpha), x.data(), x.size());
+    }
+  }
+  impl::scal(A(alpha), x);
+}
+template <typename T, std::size_t N>
+void scal(T alpha, vector<T, N>& x) noexcept {
+  kernels::scal(alpha, view(x));
+}
+
+template <typename A, std::size_t N>
+auto nrm2(vector_view<A, N> x) noexcept {
+  if constexpr (impl::is_dispatched_v<std::remove_cv_t<A>>) {
+    if (x.is_contiguous()) {
+      return kernels::nrm2(x.data(), x.size());
+    }
+  }
+  return impl::nrm2(x);
+}
+template <typename T, std::size_t N>
+auto nrm2(vector<T, N> const& x) noexcept {
+  return kernels::nrm2(view(x));
+}
+
+template <typename A, std::size_t N>
+auto asum(vector_view<A, N> x) noexcept {
+  if constexpr (impl::is_dispatched_v<std::remove_cv_t<A>>) {
+    if (x.is_contiguous()) {
+      return kernels::asum(x.data(), x.size());
+    }
+  }
+  return impl::asum(x);
+}
+template <typename T, std::size_t N>
+auto asum(vector<T, N> const& x) noexcept {
+  return kernels::asum(view(x));
+}
+
+template <typename A, std::size_t N>
+std::size_t iamax(vector_view<A, N> x) noexcept {
+  if constexpr (impl::is_dispatched_v<std::remove_cv_t<A>>) {
+    if (x.is_contiguous()) {
+      return kernels::iamax(x.data(), x.size());
+    }
+  }
+  return impl::index_abs_extreme<true>(x);
+}
+template <typename T, std::size_t N>
+std::size_t iamax(vector<T, N> const& x) noexcept {
+  return kernels::iamax(view(x));
+}
+template <typename A, std::size_t N>
+std::size_t iamin(vector_view<A, N> x) noexcept {
+  if constexpr (impl::is_dispatched_v<std::remove_cv_t<A>>) {
+    if (x.is_contiguous()) {
+      return kernels::iamin(x.data(), x.size());
+    }
+  }
+  return impl::index_abs_extreme<false>(x);
+}
+template <typename T, std::size_t N>
+std::size_t iamin(vector<T, N> const& x) noexcept {
+  return kernels::iamin(view(x));
+}
+
+template <typename A, std::size_t N, typename B, std::size_t M>
+void swap(vector_view<A, N> x, vector_view<B, M> y) noexcept {
+  static_assert(impl::extents_match(N, M), "vectors must be the same size");
+  if (x.size() != y.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<A>) {
+    if (x.is_contiguous() && y.is_contiguous()) {
+      return kernels::swap(x.data(), y.data(), x.size());
+    }
+  }
+  impl::swap(x, y);
+}
+template <typename T, std::size_t N>
+void swap(vector<T, N>& x, vector<T, N>& y) noexcept {
+  kernels::swap(view(x), view(y));
+}
+
+// y = x
+template <typename A, std::size_t N, typename B, std::size_t M>
+void copy(vector_view<A, N> x, vector_view<B, M> y) noexcept {
+  static_assert(impl::extents_match(N, M), "vectors must be the same size");
+  if (x.size() != y.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<B>) {
+    if (x.is_contiguous() && y.is_contiguous()) {
+      return kernels::copy(x.data(), y.data(), y.size());
+    }
+  }
+  impl::copy(x, y);
+}
+template <typename T, std::size_t N>
+void copy(vector<T, N> const& x, vector<T, N>& y) noexcept {
+  kernels::copy(view(x), view(y));
+}
+
+template <typename T, typename A, std::size_t N, typename B, std::size_t M>
+void rot(vector_view<A, N> x, vector_view<B, M> y, T c, T s) noexcept {
+  static_assert(impl::extents_match(N, M), "vectors must be the same size");
+  if (x.size() != y.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<A>) {
+    if (x.is_contiguous() && y.is_contiguous()) {
+      return kernels::rot(x.data(), y.data(), x.size(), A(c), A(s));
+    }
+  }
+  impl::rot(x, y, A(c), A(s));
+}
+template <typename T, std::size_t N>
+void rot(vector<T, N>& x, vector<T, N>& y, T c, T s) noexcept {
+  kernels::rot(view(x), view(y), c, s);
+}
+
+// the rotation (c, s) that takes (a, b) to (r, 0); afterwards, a is r
+template <typename T>
+void rotg(T& a, T& b, T& c, T& s) noexcept {
+  impl::rotg(a, b, c, s);
+}
+
+// y = alpha * x + y, then returns dot(y, z); in a single pass. Sizes that
+// disagree leave y as it was, and return 0
+template <
+    typename T,
+    typename A,
+    std::size_t N,
+    typename B,
+    std::size_t M,
+    typename C,
+    std::size_t P>
+B axpy_dot(
+    T alpha,
+    vector_view<A, N> x,
+    vector_view<B, M> y,
+    vector_view<C, P> z) noexcept {
+  static_assert(
+      impl::extents_match(N, M, P), "vectors must be the same size");
+  if (x.size() != y.size() || z.size() != y.size()) {
+    return B(0);
+  }
+  if constexpr (impl::is_dispatched_v<B>) {
+    if (x.is_contiguous() && y.is_contiguous() && z.is_contiguous()) {
+      return kernels::axpy_dot(
+          B(alpha), x.data(), y.data(), z.data(), y.size());
+    }
+  }
+  return impl::axpy_dot(B(alpha), x, y, z);
+}
+template <typename T, std::size_t N>
+T axpy_dot(
+    T alpha,
+    vector<T, N> const& x,
+    vector<T, N>& y,
+    vector<T, N> const& z) noexcept {
+  return kernels::axpy_dot(alpha, view(x), view(y), view(z));
+}
+
+// out = lhs * rhs; gemm wants all three with contiguous rows, so an
+// operand with only contiguous columns (like a transpose_view) is packed
+// into a row-major copy first, which is O(size) next to the product's
+// O(m n k). An out with only contiguous columns takes the transposed
+// product, out^T = rhs^T * lhs^T, instead
+template <
+    typename A,
+    std::size_t M,
+    std::size_t K,
+    typename B,
+    std::size_t K2,
+    std::size_t N,
+    typename C,
+    std::size_t M2,
+    std::size_t N2>
+void multiply(
+    matrix_view<A, M, K> lhs,
+    matrix_view<B, K2, N> rhs,
+    matrix_view<C, M2, N2> out) noexcept {
+  static_assert(
+      impl::extents_match(M, M2) && impl::extents_match(K, K2) &&
+          impl::extents_match(N, N2),
+      "the product's shapes must agree");
+  if (lhs.height() != out.height() || lhs.width() != rhs.height() ||
+      rhs.width() != out.width()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<C>) {
+    if (!out.has_contiguous_rows() && out.has_contiguous_columns()) {
+      return kernels::multiply(
+          transpose_view(rhs), transpose_view(lhs), transpose_view(out));
+    }
+    auto const fits = [](auto const& v) {
+      return v.has_contiguous_rows() || v.has_contiguous_columns();
+    };
+    if (out.has_contiguous_rows() && fits(lhs) && fits(rhs)) {
+      // the rows of `v`, and how far apart they are
+      auto const rows = [](auto const& v, std::vector<C>& packed) {
+        using rows_t = std::pair<C const*, std::size_t>;
+        if (v.has_contiguous_rows()) {
+          return rows_t(v.data(), v.row_stride());
+        }
+        packed.resize(v.height() * v.width());
+        kernels::transpose(
+            v.width(),
+            v.height(),
+            v.data(),
+            v.col_stride(),
+            packed.data(),
+            v.width());
+        return rows_t(packed.data(), v.width());
+      };
+      auto packed_lhs = std::vector<C>();
+      auto packed_rhs = std::vector<C>();
+      auto const a = rows(lhs, packed_lhs);
+      auto const b = rows(rhs, packed_rhs);
+      return kernels::gemm(
+          out.height(),
+          out.width(),
+          lhs.width(),
+          C(1),
+          a.first,
+          a.second,
+          b.first,
+          b.second,
+          C(0),
+          out.data(),
+          out.row_stride());
+    }
+  }
+  algae::multiply(lhs, rhs, out);
+}
+
+// out = lhs * rhs over a semiring; min-plus products of float, double and
+// 32-bit integers go to the kernels when all three views have contiguous
+// rows (or all have contiguous columns), and or-and and xor-and products
+// of bools are packed into bits for the kernels
+template <
+    typename A,
+    std::size_t M,
+    std::size_t K,
+    typename B,
+    std::size_t K2,
+    std::size_t N,
+    typename C,
+    std::size_t M2,
+    std::size_t N2,
+    typename Semiring>
+void multiply(
+    matrix_view<A, M, K> lhs,
+    matrix_view<B, K2, N> rhs,
+    matrix_view<C, M2, N2> out,
+    Semiring semiring) noexcept {
+  static_assert(
+      impl::extents_match(M, M2) && impl::extents_match(K, K2) &&
+          impl::extents_match(N, N2),
+      "the product's shapes must agree");
+  if (lhs.height() != out.height() || lhs.width() != rhs.height() ||
+      rhs.width() != out.width()) {
+    return;
+  }
+  auto const m = out.height();
+  auto const n = out.width();
+  auto const k = lhs.width();
+  if constexpr (
+      std::is_same_v<Semiring, min_plus<C>> &&
+      impl::is_min_plus_dispatched_v<C>) {
+    auto const rows = lhs.has_contiguous_rows() &&
+        rhs.has_contiguous_rows() && out.has_contiguous_rows();
+    auto const columns = lhs.has_contiguous_columns() &&
+        rhs.has_contiguous_columns() && out.has_contiguous_columns();
+    if (rows || columns) {
+      for (std::size_t i = 0; i < m; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+          out(i, j) = Semiring::zero();
+        }
+      }
+    }
+    // a + b is b + a, so the transposed product works as well
+    if (rows) {
+      return kernels::min_plus_gemm(
+          m,
+          n,
+          k,
+          lhs.data(),
+          lhs.row_stride(),
+          rhs.data(),
+          rhs.row_stride(),
+          out.data(),
+          out.row_stride());
+    }
+    if (columns) {
+      return kernels::min_plus_gemm(
+          n,
+          m,
+          k,
+          rhs.data(),
+          rhs.col_stride(),
+          lhs.data(),
+          lhs.col_stride(),
+          out.data(),
+          out.col_stride());
+    }
+  } else if constexpr (
+      std::is_same_v<C, bool> &&
+      (std::is_same_v<Semiring, or_and> ||
+       std::is_same_v<Semiring, xor_and>)) {
+    auto const k_words = impl::bit_words(k);
+    auto const n_words = impl::bit_words(n);
+    auto const a = impl::pack_bits(lhs, k_words);
+    auto const b = impl::pack_bits(rhs, n_words);
+    auto c = std::vector<std::uint64_t>(m * n_words, 0);
+    auto const kernel = std::is_same_v<Semiring, or_and>
+        ? &kernels::or_and_gemm
+        : &kernels::xor_and_gemm;
+    kernel(
+        m, n_words, k, a.data(), k_words, b.data(), n_words, c.data(), n_words);
+    for (std::size_t i = 0; i < m; ++i) {
+      for (std::size_t j = 0; j < n; ++j) {
+        out(i, j) = ((c[i * n_words + j / 64] >> (j % 64)) & 1) != 0;
+      }
+    }
+    return;
+  }
+  algae::multiply(lhs, rhs, out, semiring);
+}
+
+// products over other semirings; row- and column-major matrices go
+// through the view overload, which picks the kernel, and anything else
+// uses algae::multiply
+template <
+    typename T,
+    std::size_t M,
+    std::size_t K,
+    std::size_t N,
+    typename Layout_lhs,
+    typename Layout_rhs,
+    typename Semiring>
+matrix<T, M, N, Layout_lhs> multiply(
+    matrix<T, M, K, Layout_lhs> const& lhs,
+    matrix<T, K, N, Layout_rhs> const& rhs,
+    Semiring semiring) noexcept {
+  auto ret = matrix<T, M, N, Layout_lhs>();
+  if constexpr (
+      impl::is_strided_layout_v<Layout_lhs> &&
+      impl::is_strided_layout_v<Layout_rhs>) {
+    kernels::multiply(view(lhs), view(rhs), view(ret), semiring);
+  } else {
+    ret = algae::multiply(lhs, rhs, semiring);
+  }
+  return ret;
+}
+
+// bit matrices, over or_and or xor_and
+template <std::size_t M, std::size_t K, std::size_t N, typename Semiring>
+bit_matrix<M, N> multiply(
+    bit_matrix<M, K> const& lhs,
+    bit_matrix<K, N> const& rhs,
+    Semiring) noexcept {
+  static_assert(
+      std::is_same_v<Semiring, or_and> || std::is_same_v<Semiring, xor_and>,
+      "bit matrices multiply over or_and or xor_and");
+  auto ret = bit_matrix<M, N>();
+  auto const kernel = std::is_same_v<Semiring, or_and>
+      ? &kernels::or_and_gemm
+      : &kernels::xor_and_gemm;
+  kernel(
+      M,
+      ret.row_words,
+      K,
+      lhs.data(),
+      lhs.row_words,
+      rhs.data(),
+      rhs.row_words,
+      ret.data(),
+      ret.row_words);
+  return ret;
+}
+
+// matrices mod P, for P < 2^31, in the same layouts as gemm; anything else
+// uses algae::multiply
+template <
+    std::uint64_t P,
+    std::size_t M,
+    std::size_t K,
+    std::size_t N,
+    typename Layout_lhs,
+    typename Layout_rhs>
+matrix<modint<P>, M, N, Layout_lhs> multiply(
+    matrix<modint<P>, M, K, Layout_lhs> const& lhs,
+    matrix<modint<P>, K, N, Layout_rhs> const& rhs) noexcept {
+  constexpr auto small = impl::montgomery<P>::is_small;
+  constexpr auto rows = std::is_same_v<Layout_lhs, row_major> &&
+      std::is_same_v<Layout_rhs, row_major>;
+  constexpr auto columns = std::is_same_v<Layout_lhs, column_major> &&
+      std::is_same_v<Layout_rhs, column_major>;
+
+  auto ret = matrix<modint<P>, M, N, Layout_lhs>();
+  if constexpr (small && rows) {
+    kernels::mod_gemm(
+        M,
+        N,
+        K,
+        P,
+        impl::residues(lhs.data()),
+        K,
+        impl::residues(rhs.data()),
+        N,
+        impl::residues(ret.data()),
+        N);
+  } else if constexpr (small && columns) {
+    kernels::mod_gemm(
+        N,
+        M,
+        K,
+        P,
+        impl::residues(rhs.data()),
+        K,
+        impl::residues(lhs.data()),
+        M,
+        impl::residues(ret.data()),
+        M);
+  } else {
+    ret = algae::multiply(lhs, rhs);
+  }
+  return ret;
+}
+
+// elimination mod P, with the row operations done by mod_axpy, for
+// row-major matrices and P < 2^31; anything else uses algae::row_reduce
+template <std::uint64_t P, std::size_t H, std::size_t W, typename Layout>
+std::size_t row_reduce(matrix<modint<P>, H, W, Layout>& m) noexcept {
+  if constexpr (
+      impl::montgomery<P>::is_small && std::is_same_v<Layout, row_major>) {
+    return impl::modint_row_reduce(
+        m,
+        [&m](
+            std::size_t row,
+            std::size_t pivot,
+            std::size_t col,
+            modint<P> factor) {
+          kernels::mod_axpy(
+              P,
+              factor.montgomery(),
+              impl::residues(&m(pivot, col)),
+              impl::residues(&m(row, col)),
+              W - col);
+        });
+  } else {
+    return algae::row_reduce(m);
+  }
+}
+
+template <std::size_t M, std::size_t N, std::size_t W>
+matrix<std::size_t, M, N> and_popcounts(
+    bit_matrix<M, W> const& lhs, bit_matrix<N, W> const& rhs) noexcept {
+  auto ret = matrix<std::size_t, M, N>();
+  kernels::and_popcounts(
+      M,
+      N,
+      lhs.row_words,
+      lhs.data(),
+      lhs.row_words,
+      rhs.data(),
+      rhs.row_words,
+      ret.data(),
+      N);
+  return ret;
+}
+
+template <std::size_t M, std::size_t N, std::size_t W>
+matrix<std::size_t, M, N> xor_popcounts(
+    bit_matrix<M, W> const& lhs, bit_matrix<N, W> const& rhs) noexcept {
+  auto ret = matrix<std::size_t, M, N>();
+  kernels::xor_popcounts(
+      M,
+      N,
+      lhs.row_words,
+      lhs.data(),
+      lhs.row_words,
+      rhs.data(),
+      rhs.row_words,
+      ret.data(),
+      N);
+  return ret;
+}
+
+// out = m * x
+template <
+    typename A,
+    std::size_t H,
+    std::size_t W,
+    typename B,
+    std::size_t N,
+    typename C,
+    std::size_t P>
+void multiply(
+    matrix_view<A, H, W> m,
+    vector_view<B, N> x,
+    vector_view<C, P> out) noexcept {
+  static_assert(
+      impl::extents_match(W, N) && impl::extents_match(H, P),
+      "the product's shapes must agree");
+  if (m.width() != x.size() || m.height() != out.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<C>) {
+    if (x.is_contiguous() && out.is_contiguous()) {
+      if (m.has_contiguous_rows()) {
+        return kernels::gemv(
+            m.height(),
+            m.width(),
+            C(1),
+            m.data(),
+            m.row_stride(),
+            x.data(),
+            C(0),
+            out.data());
+      }
+      if (m.has_contiguous_columns()) {
+        return kernels::gemv_t(
+            m.width(),
+            m.height(),
+            C(1),
+            m.data(),
+            m.col_stride(),
+            x.data(),
+            C(0),
+            out.data());
+      }
+    }
+  }
+  algae::multiply(m, x, out);
+}
+
+// triangular solves, in place; a needs contiguous rows, and x or b
+// contiguous elements or rows, to go to the kernels. An a that isn't
+// square, or doesn't fit x or b, leaves them as they were
+template <typename A, std::size_t N, std::size_t M, typename B, std::size_t P>
+void trsv(
+    triangle tri,
+    diagonal diag,
+    matrix_view<A, N, M> a,
+    vector_view<B, P> x) noexcept {
+  static_assert(
+      impl::extents_match(N, M, P), "a must be square, and x its size");
+  if (a.height() != a.width() || a.width() != x.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<B>) {
+    if (a.has_contiguous_rows() && x.is_contiguous()) {
+      return kernels::trsv(
+          tri, diag, x.size(), a.data(), a.row_stride(), x.data());
+    }
+  }
+  impl::trsv(tri, diag, a, x);
+}
+template <
+    typename A,
+    std::size_t N,
+    std::size_t M,
+    typename B,
+    std::size_t P,
+    std::size_t Q>
+void trsm(
+    triangle tri,
+    diagonal diag,
+    matrix_view<A, N, M> a,
+    matrix_view<B, P, Q> b) noexcept {
+  static_assert(
+      impl::extents_match(N, M, P), "a must be square, and b as tall");
+  if (a.height() != a.width() || a.width() != b.height()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<B>) {
+    if (a.has_contiguous_rows() && b.has_contiguous_rows()) {
+      return kernels::trsm(
+          tri,
+          diag,
+          b.height(),
+          b.width(),
+          a.data(),
+          a.row_stride(),
+          b.data(),
+          b.row_stride());
+    }
+  }
+  impl::trsm(tri, diag, a, b);
+}
+
+// solves a * x = b, for triangular a; any layout of `a` other than row-
+// or column-major is copied to row-major first
+template <typename T, std::size_t N, typename Layout>
+vector<T, N> solve_triangular(
+    triangle tri,
+    diagonal diag,
+    matrix<T, N, N, Layout> const& a,
+    vector<T, N> b) noexcept {
+  if constexpr (impl::is_strided_layout_v<Layout>) {
+    kernels::trsv(tri, diag, view(a), view(b));
+  } else {
+    kernels::trsv(tri, diag, view(matrix<T, N, N>(a)), view(b));
+  }
+  return b;
+}
+template <
+    typename T,
+    std::size_t N,
+    std::size_t R,
+    typename Layout,
+    typename Layout_b>
+matrix<T, N, R, Layout_b> solve_triangular(
+    triangle tri,
+    diagonal diag,
+    matrix<T, N, N, Layout> const& a,
+    matrix<T, N, R, Layout_b> b) noexcept {
+  static_assert(
+      impl::is_strided_layout_v<Layout_b>,
+      "the right hand sides must be row- or column-major");
+  if constexpr (impl::is_strided_layout_v<Layout>) {
+    kernels::trsm(tri, diag, view(a), view(b));
+  } else {
+    kernels::trsm(tri, diag, view(matrix<T, N, N>(a)), view(b));
+  }
+  return b;
+}
+
+// out = transpose(in)
+template <
+    typename A,
+    std::size_t H,
+    std::size_t W,
+    typename B,
+    std::size_t W2,
+    std::size_t H2>
+void transpose(matrix_view<A, H, W> in, matrix_view<B, W2, H2> out) noexcept {
+  static_assert(
+      impl::extents_match(H, H2) && impl::extents_match(W, W2),
+      "out must be in's shape, transposed");
+  if (in.height() != out.width() || in.width() != out.height()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<B>) {
+    if (in.has_contiguous_rows() && out.has_contiguous_rows()) {
+      return kernels::transpose(
+          in.height(),
+          in.width(),
+          in.data(),
+          in.row_stride(),
+          out.data(),
+          out.row_stride());
+    }
+    if (in.has_contiguous_columns() && out.has_contiguous_columns()) {
+      return kernels::transpose(
+          in.width(),
+          in.height(),
+          in.data(),
+          in.col_stride(),
+          out.data(),
+          out.col_stride());
+    }
+  }
+  algae::transpose(in, out);
+}
+
+template <typename A, std::size_t H, std::size_t W, typename B, std::size_t N>
+void column_sums(matrix_view<A, H, W> in, vector_view<B, N> out) noexcept {
+  static_assert(impl::extents_match(W, N), "out must be in's width");
+  if (in.width() != out.size()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<B>) {
+    if (in.has_contiguous_rows() && out.is_contiguous()) {
+      return kernels::column_sums(
+          in.height(), in.width(), in.data(), in.row_stride(), out.data());
+    }
+  }
+  for (std::size_t col = 0; col < in.width(); ++col) {
+    auto sum = B(0);
+    for (auto const& x : in.column(col)) {
+      sum = sum + x;
+    }
+    out[col] = sum;
+  }
+}
+
+// sparse products; the symbolic half doesn't care about the element
+// type, so it always runs in parallel
+
+template <typename T>
+csr_matrix<T>
+multiply_symbolic(csr_matrix<T> const& a, csr_matrix<T> const& b) {
+  auto offsets = std::vector<std::size_t>(a.height() + 1);
+  kernels::spgemm_offsets(
+      a.height(),
+      b.width(),
+      a.row_offsets().data(),
+      a.columns().data(),
+      b.row_offsets().data(),
+      b.columns().data(),
+      offsets.data());
+
+  auto columns = std::vector<std::size_t>(offsets.back());
+  kernels::spgemm_columns(
+      a.height(),
+      b.width(),
+      a.row_offsets().data(),
+      a.columns().data(),
+      b.row_offsets().data(),
+      b.columns().data(),
+      offsets.data(),
+      columns.data());
+
+  auto values = std::vector<T>(columns.size(), T(0));
+  return csr_matrix<T>(
+      a.height(),
+      b.width(),
+      std::move(offsets),
+      std::move(columns),
+      std::move(values));
+}
+
+// c must have the pattern that multiply_symbolic(a, b) gave
+template <typename T>
+void multiply_numeric(
+    csr_matrix<T> const& a, csr_matrix<T> const& b, csr_matrix<T>& c) {
+  if constexpr (impl::is_dispatched_v<T>) {
+    kernels::spgemm_numeric(
+        a.height(),
+        b.width(),
+        a.row_offsets().data(),
+        a.columns().data(),
+        a.values().data(),
+        b.row_offsets().data(),
+        b.columns().data(),
+        b.values().data(),
+        c.row_offsets().data(),
+        c.columns().data(),
+        c.values().data());
+  } else {
+    algae::multiply_numeric(a, b, c);
+  }
+}
+
+template <typename T>
+csr_matrix<T> multiply(csr_matrix<T> const& a, csr_matrix<T> const& b) {
+  auto ret = kernels::multiply_symbolic(a, b);
+  kernels::multiply_numeric(a, b, ret);
+  return ret;
+}
+
+// out = a * b, for sparse a and dense b; b and out need contiguous rows to
+// go to the kernel
+template <
+    typename T,
+    typename B,
+    std::size_t K,
+    std::size_t N,
+    typename C,
+    std::size_t M,
+    std::size_t N2>
+void multiply(
+    csr_matrix<T> const& a,
+    matrix_view<B, K, N> b,
+    matrix_view<C, M, N2> out) {
+  static_assert(impl::extents_match(N, N2), "out must be as wide as b");
+  if (a.width() != b.height() || a.height() != out.height() ||
+      b.width() != out.width()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<C> && std::is_same_v<T, C>) {
+    if (b.has_contiguous_rows() && out.has_contiguous_rows()) {
+      return kernels::spmm(
+          a.height(),
+          out.width(),
+          a.row_offsets().data(),
+          a.columns().data(),
+          a.values().data(),
+          b.data(),
+          b.row_stride(),
+          out.data(),
+          out.row_stride());
+    }
+  }
+  algae::multiply(a, b, out);
+}
+
+// algae::multiply_chain, with the products done by kernels::multiply
+template <typename... Matrices>
+auto multiply_chain(Matrices const&... ms) {
+  using order = impl::chain_order_of<Matrices...>;
+  return impl::multiply_subchain<0, sizeof...(Matrices) - 1, order>(
+      std::forward_as_tuple(ms...), [](auto const& lhs, auto const& rhs) {
+        return kernels::multiply(lhs, rhs);
+      });
+}
+
+// algae::pow, with the products done by kernels::multiply
+template <typename T, std::size_t N, typename Layout>
+matrix<T, N, N, Layout>
+pow(matrix<T, N, N, Layout> const& m, std::uint64_t k) {
+  if (k == 0) {
+    return impl::semiring_identity<matrix<T, N, N, Layout>>(plus_times<T>());
+  }
+  return impl::pow_by_squaring(m, k, [](auto const& lhs, auto const& rhs) {
+    return kernels::multiply(lhs, rhs);
+  });
+}
+
+template <std::uint64_t K, typename T, std::size_t N, typename Layout>
+matrix<T, N, N, Layout> pow(matrix<T, N, N, Layout> const& m) {
+  if constexpr (K == 0) {
+    return impl::semiring_identity<matrix<T, N, N, Layout>>(plus_times<T>());
+  } else {
+    return impl::pow_by_chain<K>(m, [](auto const& lhs, auto const& rhs) {
+      return kernels::multiply(lhs, rhs);
+    });
+  }
+}
+
+// structured matrices (see algae/structured.h); as there, shapes that
+// disagree leave out as it was
+// the kernels work a block of rows of `a` at a time; small enough that a
+// block of packed rows stays in cache, big enough that gemm does the work
+inline constexpr std::size_t structured_block_rows = 64;
+
+// out = a * b, for triangular a; in each block of rows, the rectangle left
+// (or right) of the diagonal block goes to gemm, and only the triangle of
+// the diagonal block itself is done a row at a time
+template <
+    typename T,
+    std::size_t N,
+    typename B,
+    std::size_t K,
+    std::size_t R,
+    typename C,
+    std::size_t M,
+    std::size_t P>
+void multiply(
+    triangular_view<T, N> a,
+    matrix_view<B, K, R> b,
+    matrix_view<C, M, P> out) noexcept {
+  static_assert(
+      impl::extents_match(N, K, M) && impl::extents_match(R, P),
+      "the product's shapes must agree");
+  if (b.height() != a.height() || out.height() != a.height() ||
+      out.width() != b.width()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<C> && std::is_same_v<T, C>) {
+    auto const base = a.base();
+    if (base.has_contiguous_rows() && b.has_contiguous_rows() &&
+        out.has_contiguous_rows()) {
+      auto const n = a.height();
+      auto const nrhs = out.width();
+      auto const is_lower = a.tri() == triangle::lower;
+      for (std::size_t i0 = 0; i0 < n; i0 += structured_block_rows) {
+        auto const i1 = std::min(i0 + structured_block_rows, n);
+        auto const p0 = is_lower ? 0 : i1;
+        auto const p1 = is_lower ? i0 : n;
+        kernels::gemm(
+            i1 - i0,
+            nrhs,
+            p1 - p0,
+            C(1),
+            base.data() + i0 * base.row_stride() + p0,
+            base.row_stride(),
+            b.data() + p0 * b.row_stride(),
+            b.row_stride(),
+            C(0),
+            out.data() + i0 * out.row_stride(),
+            out.row_stride());
+        for (std::size_t i = i0; i < i1; ++i) {
+          auto const row = out.data() + i * out.row_stride();
+          auto const q0 = is_lower ? i0 : i + 1;
+          auto const q1 = is_lower ? i : i1;
+          for (std::size_t q = q0; q < q1; ++q) {
+            kernels::axpy(base(i, q), b.data() + q * b.row_stride(), row, nrhs);
+          }
+          auto const scale = a.diag() == diagonal::unit ? C(1) : base(i, i);
+          kernels::axpy(scale, b.data() + i * b.row_stride(), row, nrhs);
+        }
+      }
+      return;
+    }
+  }
+  algae::multiply(a, b, out);
+}
+template <
+    typename T,
+    std::size_t N,
+    typename B,
+    std::size_t K,
+    typename C,
+    std::size_t M>
+void multiply(
+    triangular_view<T, N> a,
+    vector_view<B, K> x,
+    vector_view<C, M> out) noexcept {
+  static_assert(
+      impl::extents_match(N, K, M), "the product's shapes must agree");
+  if (x.size() != a.height() || out.size() != a.height()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<C> && std::is_same_v<T, C>) {
+    auto const base = a.base();
+    if (base.has_contiguous_rows() && x.is_contiguous() &&
+        out.is_contiguous()) {
+      auto const n = a.height();
+      for (std::size_t i = 0; i < n; ++i) {
+        auto const row = base.data() + i * base.row_stride();
+        auto sum = a.tri() == triangle::lower
+            ? kernels::dot(row, x.data(), i)
+            : kernels::dot(row + i + 1, x.data() + i + 1, n - i - 1);
+        sum += a.diag() == diagonal::unit ? x[i] : row[i] * x[i];
+        out[i] = sum;
+      }
+      return;
+    }
+  }
+  algae::multiply(a, x, out);
+}
+
+// out = a * b, for symmetric a; each block of rows of `a` is filled in from
+// the stored half into a row-major panel, and the panel goes to gemm (or
+// gemv), so it doesn't matter how `a` itself is laid out
+template <
+    typename T,
+    std::size_t N,
+    typename B,
+    std::size_t K,
+    std::size_t R,
+    typename C,
+    std::size_t M,
+    std::size_t P>
+void multiply(
+    symmetric_view<T, N> a,
+    matrix_view<B, K, R> b,
+    matrix_view<C, M, P> out) {
+  static_assert(
+      impl::extents_match(N, K, M) && impl::extents_match(R, P),
+      "the product's shapes must agree");
+  if (b.height() != a.height() || out.height() != a.height() ||
+      out.width() != b.width()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<C> && std::is_same_v<T, C>) {
+    if (b.has_contiguous_rows() && out.has_contiguous_rows()) {
+      auto const n = a.height();
+      auto panel = std::vector<C>(std::min(structured_block_rows, n) * n);
+      for (std::size_t i0 = 0; i0 < n; i0 += structured_block_rows) {
+        auto const i1 = std::min(i0 + structured_block_rows, n);
+        for (std::size_t i = i0; i < i1; ++i) {
+          for (std::size_t p = 0; p < n; ++p) {
+            panel[(i - i0) * n + p] = a(i, p);
+          }
+        }
+        kernels::gemm(
+            i1 - i0,
+            out.width(),
+            n,
+            C(1),
+            panel.data(),
+            n,
+            b.data(),
+            b.row_stride(),
+            C(0),
+            out.data() + i0 * out.row_stride(),
+            out.row_stride());
+      }
+      return;
+    }
+  }
+  algae::multiply(a, b, out);
+}
+template <
+    typename T,
+    std::size_t N,
+    typename B,
+    std::size_t K,
+    typename C,
+    std::size_t M>
+void multiply(
+    symmetric_view<T, N> a, vector_view<B, K> x, vector_view<C, M> out) {
+  static_assert(
+      impl::extents_match(N, K, M), "the product's shapes must agree");
+  if (x.size() != a.height() || out.size() != a.height()) {
+    return;
+  }
+  if constexpr (impl::is_dispatched_v<C> && std::is_same_v<T, C>) {
+    if (x.is_contiguous() && out.is_contiguous()) {
+      auto const n = a.height();
+      auto panel = std::vector<C>(std::min(structured_block_rows, n) * n);
+      for (std::size_t i0 = 0; i0 < n; i0 += structured_block_rows) {
+        auto const i1 = std::min(i0 + structured_block_rows, n);
+        for (std::size_t i = i0; i < i1; ++i) {
+          for (std::size_t p = 0; p < n; ++p) {
+            panel[(i - i0) * n + p] = a(i, p);
+          }
+        }
+        kernels::gemv(
+            i1 - i0,
+            n,
+            C(1),
+            panel.data(),
+            n,
+            x.data(),
+            C(0),
+            out.data() + i0);
+      }
+      return;
+    }
+  }
+  algae::multiply(a, x, out);
+}
+
+// there are no kernels for complex elements, so these are always portable
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename B,
+    std::size_t K,
+    std::size_t R,
+    typename C,
+    std::size_t M,
+    std::size_t P>
+void multiply(
+    adjoint_matrix_view<T, H, W> a,
+    matrix_view<B, K, R> b,
+    matrix_view<C, M, P> out) noexcept {
+  algae::multiply(a, b, out);
+}
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename B,
+    std::size_t K,
+    typename C,
+    std::size_t M>
+void multiply(
+    adjoint_matrix_view<T, H, W> a,
+    vector_view<B, K> x,
+    vector_view<C, M> out) noexcept {
+  algae::multiply(a, x, out);
+}
+
+// triangular solves, in place, by way of trsv and trsm
+template <typename T, std::size_t N, typename B, std::size_t M>
+void solve(triangular_view<T, N> a, vector_view<B, M> x) noexcept {
+  kernels::trsv(a.tri(), a.diag(), a.base(), x);
+}
+template <typename T, std::size_t N, typename B, std::size_t M, std::size_t R>
+void solve(triangular_view<T, N> a, matrix_view<B, M, R> b) noexcept {
+  kernels::trsm(a.tri(), a.diag(), a.base(), b);
+}
+template <typename T, std::size_t N, std::size_t M>
+vector<T, M> solve(triangular_view<T, N> a, vector<T, M> b) noexcept {
+  kernels::solve(a, view(b));
+  return b;
+}
+template <
+    typename T,
+    std::size_t N,
+    std::size_t M,
+    std::size_t R,
+    typename Layout>
+matrix<T, M, R, Layout>
+solve(triangular_view<T, N> a, matrix<T, M, R, Layout> b) noexcept {
+  static_assert(
+      impl::is_strided_layout_v<Layout>,
+      "the right hand sides must be row- or column-major");
+  kernels::solve(a, view(b));
+  return b;
+}
+
+/*
+  batches of small matrices, interleaved a chunk at a time so that each
+  lane of a register works on a different one.
+*/
+
+// out[i] = a[i] * b[i]
+template <typename T, std::size_t N, typename Layout>
+void batched_multiply(
+    matrix<T, N, N, Layout> const* a,
+    matrix<T, N, N, Layout> const* b,
+    matrix<T, N, N, Layout>* out,
+    std::size_t count) noexcept {
+  constexpr std::size_t lanes = impl::is_dispatched_v<T> ? batch_lanes<T> : 1;
+  constexpr auto chunk = impl::batched_chunk_groups * lanes;
+  auto buffer = std::vector<T>(3 * chunk * N * N);
+  auto const ga = buffer.data();
+  auto const gb = ga + chunk * N * N;
+  auto const gc = gb + chunk * N * N;
+  for (std::size_t first = 0; first < count; first += chunk) {
+    auto const n = std::min(chunk, count - first);
+    auto const groups = (n + lanes - 1) / lanes;
+    impl::interleave(a + first, n, lanes, ga);
+    impl::interleave(b + first, n, lanes, gb);
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::batched_gemm(N, groups, ga, gb, gc);
+    } else {
+      impl::batched_gemm(N, groups, ga, gb, gc);
+    }
+    impl::deinterleave(gc, n, lanes, out + first);
+  }
+}
+
+// out[i] = a[i]^-1; out[i] is unspecified where a[i] is singular
+template <typename T, std::size_t N, typename Layout>
+std::size_t batched_inverse(
+    matrix<T, N, N, Layout> const* a,
+    matrix<T, N, N, Layout>* out,
+    std::size_t count,
+    bool* singular = nullptr) noexcept {
+  constexpr std::size_t lanes = impl::is_dispatched_v<T> ? batch_lanes<T> : 1;
+  constexpr auto chunk = impl::batched_chunk_groups * lanes;
+  auto buffer = std::vector<T>(2 * chunk * N * N);
+  auto const ga = buffer.data();
+  auto const gout = ga + chunk * N * N;
+  auto const flags = std::make_unique<bool[]>(chunk);
+  std::size_t ret = 0;
+  for (std::size_t first = 0; first < count; first += chunk) {
+    auto const n = std::min(chunk, count - first);
+    auto const groups = (n + lanes - 1) / lanes;
+    impl::interleave(a + first, n, lanes, ga);
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::batched_inverse(N, groups, ga, gout, flags.get());
+    } else {
+      impl::batched_inverse(N, groups, ga, gout, flags.get());
+    }
+    impl::deinterleave(gout, n, lanes, out + first);
+    ret += impl::report_flags(
+        flags.get(), n, singular ? singular + first : nullptr);
+  }
+  return ret;
+}
+
+// solves a[i] * x[i] = b[i]; x[i] starts out holding b[i], and is left
+// unspecified where a[i] is singular
+template <typename T, std::size_t N, typename Layout>
+std::size_t batched_solve(
+    matrix<T, N, N, Layout> const* a,
+    vector<T, N>* x,
+    std::size_t count,
+    bool* singular = nullptr) noexcept {
+  constexpr std::size_t lanes = impl::is_dispatched_v<T> ? batch_lanes<T> : 1;
+  constexpr auto chunk = impl::batched_chunk_groups * lanes;
+  auto buffer = std::vector<T>(chunk * N * N + chunk * N);
+  auto const ga = buffer.data();
+  auto const gx = ga + chunk * N * N;
+  auto const flags = std::make_unique<bool[]>(chunk);
+  std::size_t ret = 0;
+  for (std::size_t first = 0; first < count; first += chunk) {
+    auto const n = std::min(chunk, count - first);
+    auto const groups = (n + lanes - 1) / lanes;
+    impl::interleave(a + first, n, lanes, ga);
+    impl::interleave(x + first, n, lanes, gx);
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::batched_solve(N, groups, ga, gx, flags.get());
+    } else {
+      impl::batched_solve(N, groups, ga, gx, flags.get());
+    }
+    impl::deinterleave(gx, n, lanes, x + first);
+    ret += impl::report_flags(
+        flags.get(), n, singular ? singular + first : nullptr);
+  }
+  return ret;
+}
+
+// out[i] = L, where a[i] = L L^T; only the lower triangle of a[i] is read
+// out[i] is unspecified where a[i] isn't positive definite
+template <typename T, std::size_t N, typename Layout>
+std::size_t batched_cholesky(
+    matrix<T, N, N, Layout> const* a,
+    matrix<T, N, N, Layout>* out,
+    std::size_t count,
+    bool* failed = nullptr) noexcept {
+  constexpr std::size_t lanes = impl::is_dispatched_v<T> ? batch_lanes<T> : 1;
+  constexpr auto chunk = impl::batched_chunk_groups * lanes;
+  auto buffer = std::vector<T>(chunk * N * N);
+  auto const flags = std::make_unique<bool[]>(chunk);
+  std::size_t ret = 0;
+  for (std::size_t first = 0; first < count; first += chunk) {
+    auto const n = std::min(chunk, count - first);
+    auto const groups = (n + lanes - 1) / lanes;
+    impl::interleave(a + first, n, lanes, buffer.data());
+    if constexpr (impl::is_dispatched_v<T>) {
+      kernels::batched_cholesky(N, groups, buffer.data(), flags.get());
+    } else {
+      impl::batched_cholesky(N, groups, buffer.data(), flags.get());
+    }
+    impl::deinterleave(buffer.data(), n, lanes, out + first);
+    ret += impl::report_flags(
+        flags.get(), n, failed ? failed + first : nullptr);
+  }
+  return ret;
+}
+
+// pairwise over sets of vectors; out is m x n, row-major. The vectors are
+// packed into the rows of matrices for the kernels
+template <typename T, std::size_t N>
+void pairwise(
+    metric which,
+    vector<T, N> const* a,
+    std::size_t m,
+    vector<T, N> const* b,
+    std::size_t n,
+    T* out) noexcept {
+  if constexpr (impl::is_dispatched_v<T>) {
+    auto const packed_a = impl::pack_vectors(a, m);
+    auto const packed_b = impl::pack_vectors(b, n);
+    kernels::pairwise(
+        which, m, n, N, packed_a.data(), N, packed_b.data(), N, out, n);
+  } else {
+    for (std::size_t i = 0; i < m; ++i) {
+      for (std::size_t j = 0; j < n; ++j) {
+        out[i * n + j] = impl::compare(which, a[i], b[j]);
+      }
+    }
+  }
+}
+
+// the k vectors of b nearest to each vector of a; indices and values are
+// m x k, row-major, as for the raw pairwise_top_k
+template <typename T, std::size_t N>
+void pairwise_top_k(
+    metric which,
+    vector<T, N> const* a,
+    std::size_t m,
+    vector<T, N> const* b,
+    std::size_t n,
+    std::size_t k,
+    std::size_t* indices,
+    T* values) noexcept {
+  if constexpr (impl::is_dispatched_v<T>) {
+    auto const packed_a = impl::pack_vectors(a, m);
+    auto const packed_b = impl::pack_vectors(b, n);
+    kernels::pairwise_top_k(
+        which,
+        m,
+        n,
+        N,
+        packed_a.data(),
+        N,
+        packed_b.data(),
+        N,
+        k,
+        indices,
+        values);
+  } else {
+    auto const negated = impl::larger_is_nearer(which);
+    auto heap = std::vector<std::pair<T, std::size_t>>(k);
+    for (std::size_t i = 0; i < m; ++i) {
+      std::size_t size = 0;
+      for (std::size_t j = 0; j < n; ++j) {
+        auto const value = impl::compare(which, a[i], b[j]);
+        impl::top_k_push(
+            heap.data(), size, k, impl::top_k_key(value, negated), j);
+      }
+      impl::top_k_finish(
+          heap.data(), size, k, negated, n, indices + i * k, values + i * k);
+    }
+  }
+}
+
+} // namespace algae::kernels
+
+#if defined(ALGAE_KERNELS)
+ALGAE_FOR_EACH_INSTANTIATED_TYPE(ALGAE_INSTANTIATE_ALGORITHMS, extern template)
+#endif
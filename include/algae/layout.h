@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+  where element (row, col) of a Height x Width matrix lives. Every layout
+  has storage_size, index(row, col), tile_height, tile_width and
+  is_column_major; tiled layouts pad their storage with zeroes.
+*/
+
+namespace algae {
+
+struct row_major {
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t storage_size = Height * Width;
+
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t tile_height = Height;
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t tile_width = Width;
+
+  static constexpr bool is_column_major = false;
+
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t index(std::size_t row, std::size_t col) {
+    return row * Width + col;
+  }
+};
+
+// the same storage as Fortran; a column-major Height x Width matrix has
+// the same bytes as its row-major transpose
+struct column_major {
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t storage_size = Height * Width;
+
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t tile_height = Height;
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t tile_width = Width;
+
+  static constexpr bool is_column_major = true;
+
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t index(std::size_t row, std::size_t col) {
+    return col * Height + row;
+  }
+};
+
+enum class tile_order {
+  row_major,
+  // Z-order; tiles that are close in the matrix are close in memory in
+  // both directions, not just along rows
+  morton,
+};
+
+namespace impl {
+
+constexpr std::size_t ceil_div(std::size_t n, std::size_t d) {
+  return (n + d - 1) / d;
+}
+
+constexpr std::size_t ceil_pow2(std::size_t n) {
+  auto ret = std::size_t(1);
+  while (ret < n) {
+    ret *= 2;
+  }
+  return ret;
+}
+
+// morton order needs a square, power of two, grid of tiles
+constexpr std::size_t
+morton_tile_count(std::size_t tile_rows, std::size_t tile_cols) {
+  auto const side = ceil_pow2(tile_rows > tile_cols ? tile_rows : tile_cols);
+  return side * side;
+}
+
+// interleaves the bits of row and col: ...r1 c1 r0 c0
+constexpr std::size_t morton_index(std::size_t row, std::size_t col) {
+  auto ret = std::size_t(0);
+  for (std::size_t bit = 0; (row >> bit) != 0 || (col >> bit) != 0; ++bit) {
+    ret |= ((col >> bit) & 1) << (2 * bit);
+    ret |= ((row >> bit) & 1) << (2 * bit + 1);
+  }
+  return ret;
+}
+
+} // namespace impl
+
+// Tile_height x Tile_width tiles, each stored row-major, with the tiles
+// themselves laid out in `Order`
+template <
+    std::size_t Tile_height,
+    std::size_t Tile_width = Tile_height,
+    tile_order Order = tile_order::row_major>
+struct tiled {
+  static_assert(Tile_height > 0 && Tile_width > 0, "tiles can't be empty");
+
+  template <std::size_t Height>
+  static constexpr std::size_t tile_rows =
+      impl::ceil_div(Height, Tile_height);
+  template <std::size_t Width>
+  static constexpr std::size_t tile_cols = impl::ceil_div(Width, Tile_width);
+
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t tile_count = Order == tile_order::morton
+      ? impl::morton_tile_count(tile_rows<Height>, tile_cols<Width>)
+      : tile_rows<Height> * tile_cols<Width>;
+
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t storage_size =
+      tile_count<Height, Width> * Tile_height * Tile_width;
+
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t tile_height = Tile_height;
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t tile_width = Tile_width;
+
+  static constexpr bool is_column_major = false;
+
+  template <std::size_t Height, std::size_t Width>
+  static constexpr std::size_t index(std::size_t row, std::size_t col) {
+    auto const tile_row = row / Tile_height;
+    auto const tile_col = col / Tile_width;
+    auto const tile = Order == tile_order::morton
+        ? impl::morton_index(tile_row, tile_col)
+        : tile_row * tile_cols<Width> + tile_col;
+
+    auto const inner = (row % Tile_height) * Tile_width + col % Tile_width;
+    return tile * (Tile_height * Tile_width) + inner;
+  }
+};
+
+template <std::size_t Tile_height, std::size_t Tile_width = Tile_height>
+using morton = tiled<Tile_height, Tile_width, tile_order::morton>;
+
+} // namespace algae
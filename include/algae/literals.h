@@ -24,9 +24,9 @@ struct vector_literal_t {
     // this is this way because my current version of MSVC
     // doesn't support constexpr lambdas
     struct make_vector_generic {
-      template <typename... Ts>
-      constexpr auto operator()(Ts&&... ts) {
-        return make_vector(std::forward<Ts>(ts)...);
+      template <typename... Us>
+      constexpr auto operator()(Us&&... us) {
+        return make_vector(std::forward<Us>(us)...);
       }
     };
 
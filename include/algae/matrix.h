@@ -2,93 +2,634 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <tuple>
 
 #include <algae/iterator.h>
+#include <algae/layout.h>
+#include <algae/vector.h>
 
 namespace algae {
 
-/*
-  NOTE(ubsan): technically a ContiguousIterator,
-  but I can't figure out how to write that.
-*/
-
-template <typename T>
-class matrix_row_iterator;
-template <typename T>
-class matrix_row_const_iterator;
+template <typename Matrix, bool Is_row>
+class matrix_line;
+template <typename Matrix, bool Is_row>
+class matrix_lines;
+template <typename Matrix, bool Is_row>
+class matrix_lines_iterator;
 
-template <typename T, std::size_t Width>
-class matrix_row {
-  T underlying_[Width];
+template <
+    typename T,
+    std::size_t Height,
+    std::size_t Width,
+    typename Layout = row_major>
+class matrix {
+  T underlying_[Layout::template storage_size<Height, Width>];
 
 public:
-  template <typename, std::size_t, std::size_t>
-  friend class matrix;
+  using value_type = T;
+  using layout_type = Layout;
+
+  using row_type = matrix_line<matrix, true>;
+  using const_row_type = matrix_line<matrix const, true>;
+  using column_type = matrix_line<matrix, false>;
+  using const_column_type = matrix_line<matrix const, false>;
 
-  using iterator = matrix_row_iterator<T>;
-  using const_iterator = matrix_row_const_iterator<T>;
-  using reverse_iterator = std::reverse_iterator<iterator>;
-  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using row_iterator = matrix_lines_iterator<matrix, true>;
+  using const_row_iterator = matrix_lines_iterator<matrix const, true>;
+  using reverse_row_iterator = std::reverse_iterator<row_iterator>;
+  using const_reverse_row_iterator = std::reverse_iterator<const_row_iterator>;
+
+  using column_iterator = matrix_lines_iterator<matrix, false>;
+  using const_column_iterator = matrix_lines_iterator<matrix const, false>;
 
-  constexpr iterator begin() { return iterator(&underlying_[0]); }
-  constexpr iterator end() { return iterator(&underlying_[Width]); }
-  constexpr const_iterator cbegin() const {
-    return const_iterator(&underlying_[0]);
+  using iterator = row_iterator;
+  using const_iterator = const_row_iterator;
+  using reverse_iterator = reverse_row_iterator;
+  using const_reverse_iterator = const_reverse_row_iterator;
+
+  constexpr matrix() : underlying_{} {}
+
+  constexpr matrix(std::array<std::array<T, Width>, Height> const& init)
+      : underlying_{} {
+    for (std::size_t row = 0; row < Height; ++row) {
+      for (std::size_t col = 0; col < Width; ++col) {
+        (*this)(row, col) = init[row][col];
+      }
+    }
   }
+
+  // relayout a matrix; this is a copy, so it has to be asked for
+  template <typename Other_layout>
+  constexpr explicit matrix(matrix<T, Height, Width, Other_layout> const& other)
+      : underlying_{} {
+    for (std::size_t row = 0; row < Height; ++row) {
+      for (std::size_t col = 0; col < Width; ++col) {
+        (*this)(row, col) = other(row, col);
+      }
+    }
+  }
+
+  static constexpr std::size_t height() noexcept { return Height; }
+  static constexpr std::size_t width() noexcept { return Width; }
+
+  constexpr T& operator()(std::size_t row, std::size_t col) {
+    return underlying_[Layout::template index<Height, Width>(row, col)];
+  }
+  constexpr T const& operator()(std::size_t row, std::size_t col) const {
+    return underlying_[Layout::template index<Height, Width>(row, col)];
+  }
+
+  // the storage, in layout order; storage_size() elements, which for tiled
+  // layouts includes the (zeroed) padding
+  constexpr T* data() noexcept { return underlying_; }
+  constexpr T const* data() const noexcept { return underlying_; }
+  static constexpr std::size_t storage_size() noexcept {
+    return Layout::template storage_size<Height, Width>;
+  }
+
+  constexpr row_type row(std::size_t idx) { return row_type(*this, idx); }
+  constexpr const_row_type row(std::size_t idx) const {
+    return const_row_type(*this, idx);
+  }
+  constexpr column_type column(std::size_t idx) {
+    return column_type(*this, idx);
+  }
+  constexpr const_column_type column(std::size_t idx) const {
+    return const_column_type(*this, idx);
+  }
+
+  constexpr matrix_lines<matrix, true> rows() {
+    return matrix_lines<matrix, true>(*this);
+  }
+  constexpr matrix_lines<matrix const, true> rows() const {
+    return matrix_lines<matrix const, true>(*this);
+  }
+  constexpr matrix_lines<matrix, false> columns() {
+    return matrix_lines<matrix, false>(*this);
+  }
+  constexpr matrix_lines<matrix const, false> columns() const {
+    return matrix_lines<matrix const, false>(*this);
+  }
+
+  // iterating over a matrix goes over its rows
+  constexpr iterator begin() { return iterator(*this, 0); }
+  constexpr iterator end() { return iterator(*this, Height); }
+  constexpr const_iterator cbegin() const { return const_iterator(*this, 0); }
   constexpr const_iterator cend() const {
-    return const_iterator(&underlying_[Width]);
+    return const_iterator(*this, Height);
   }
   constexpr const_iterator begin() const { return cbegin(); }
   constexpr const_iterator end() const { return cend(); }
 
-  constexpr reverse_iterator rbegin() { return std::reverse_iterator(end()); }
-  constexpr reverse_iterator rend() { return std::reverse_iterator(begin()); }
+  constexpr reverse_iterator rbegin() { return reverse_iterator(end()); }
+  constexpr reverse_iterator rend() { return reverse_iterator(begin()); }
   constexpr const_reverse_iterator crbegin() const {
-    return std::reverse_iterator(cend());
+    return const_reverse_iterator(cend());
   }
   constexpr const_reverse_iterator crend() const {
-    return std::reverse_iterator(cbegin());
+    return const_reverse_iterator(cbegin());
   }
   constexpr const_reverse_iterator rbegin() const { return crbegin(); }
   constexpr const_reverse_iterator rend() const { return crend(); }
 };
 
-template <typename T, std::size_t Width>
-class matrix_iterator_row;
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout1,
+    typename Layout2>
+constexpr bool operator==(
+    matrix<T, H, W, Layout1> const& lhs, matrix<T, H, W, Layout2> const& rhs) {
+  for (std::size_t row = 0; row < H; ++row) {
+    for (std::size_t col = 0; col < W; ++col) {
+      if (!(lhs(row, col) == rhs(row, col))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout1,
+    typename Layout2>
+constexpr bool operator!=(
+    matrix<T, H, W, Layout1> const& lhs, matrix<T, H, W, Layout2> const& rhs) {
+  return !(lhs == rhs);
+}
 
-template <typename T, std::size_t Width>
-class matrix_const_iterator_row;
+// both of these walk a tile at a time, in its contiguous direction
 
-template <typename T, std::size_t Height, std::size_t Width>
-class matrix {
-  std::array<matrix_row<T, Width>, Height> underlying_;
+template <
+    typename T,
+    std::size_t M,
+    std::size_t K,
+    std::size_t N,
+    typename Layout_lhs,
+    typename Layout_rhs,
+    typename Semiring = plus_times<T>>
+constexpr auto multiply(
+    matrix<T, M, K, Layout_lhs> const& lhs,
+    matrix<T, K, N, Layout_rhs> const& rhs,
+    Semiring = {}) {
+  auto ret = matrix<T, M, N, Layout_lhs>();
+  for (std::size_t i = 0; i < M; ++i) {
+    for (std::size_t j = 0; j < N; ++j) {
+      ret(i, j) = Semiring::zero();
+    }
+  }
 
-public:
-  using row_iterator = matrix_iterator_row<T, Width>;
-  using const_row_iterator = matrix_const_iterator_row<T, Width>;
-  using reverse_row_iterator = std::reverse_iterator<row_iterator>;
-  using const_reverse_row_iterator = std::reverse_iterator<const_row_iterator>;
+  constexpr auto bm = Layout_lhs::template tile_height<M, N>;
+  constexpr auto bn = Layout_lhs::template tile_width<M, N>;
+  constexpr auto bk = Layout_lhs::template tile_width<M, K>;
 
-  using iterator = row_iterator;
-  using const_iterator = const_row_iterator;
-  using reverse_iterator = reverse_row_iterator;
-  using const_reverse_iterator = const_reverse_row_iterator;
+  for (std::size_t i0 = 0; i0 < M; i0 += bm) {
+    auto const i1 = i0 + bm < M ? i0 + bm : M;
+    for (std::size_t j0 = 0; j0 < N; j0 += bn) {
+      auto const j1 = j0 + bn < N ? j0 + bn : N;
+      for (std::size_t k0 = 0; k0 < K; k0 += bk) {
+        auto const k1 = k0 + bk < K ? k0 + bk : K;
+
+        if constexpr (Layout_lhs::is_column_major) {
+          // j-k-i, so the inner loop walks columns of `lhs` and `ret`
+          for (std::size_t j = j0; j < j1; ++j) {
+            for (std::size_t k = k0; k < k1; ++k) {
+              auto const& scale = rhs(k, j);
+              for (std::size_t i = i0; i < i1; ++i) {
+                auto const product = Semiring::times(lhs(i, k), scale);
+                ret(i, j) = Semiring::plus(ret(i, j), product);
+              }
+            }
+          }
+        } else {
+          // i-k-j, so the inner loop walks rows of `rhs` and `ret`
+          for (std::size_t i = i0; i < i1; ++i) {
+            for (std::size_t k = k0; k < k1; ++k) {
+              auto const& scale = lhs(i, k);
+              for (std::size_t j = j0; j < j1; ++j) {
+                auto const product = Semiring::times(scale, rhs(k, j));
+                ret(i, j) = Semiring::plus(ret(i, j), product);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return ret;
+}
+
+// matrix * vector, one dot product per row
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout,
+    typename Semiring = plus_times<T>>
+constexpr vector<T, H> multiply(
+    matrix<T, H, W, Layout> const& m, vector<T, W> const& x, Semiring = {}) {
+  auto ret = vector<T, H>(algae::list_init);
+  for (auto& x : ret) {
+    x = Semiring::zero();
+  }
+  if constexpr (Layout::is_column_major) {
+    // column by column, so the inner loop walks down `m`
+    for (std::size_t j = 0; j < W; ++j) {
+      for (std::size_t i = 0; i < H; ++i) {
+        ret[i] = Semiring::plus(ret[i], Semiring::times(m(i, j), x[j]));
+      }
+    }
+  } else {
+    for (std::size_t i = 0; i < H; ++i) {
+      for (std::size_t j = 0; j < W; ++j) {
+        ret[i] = Semiring::plus(ret[i], Semiring::times(m(i, j), x[j]));
+      }
+    }
+  }
+  return ret;
+}
+
+// vector * matrix, or transpose(m) * x
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout,
+    typename Semiring = plus_times<T>>
+constexpr vector<T, W> multiply(
+    vector<T, H> const& x, matrix<T, H, W, Layout> const& m, Semiring = {}) {
+  auto ret = vector<T, W>(algae::list_init);
+  for (auto& x : ret) {
+    x = Semiring::zero();
+  }
+  if constexpr (Layout::is_column_major) {
+    for (std::size_t j = 0; j < W; ++j) {
+      for (std::size_t i = 0; i < H; ++i) {
+        ret[j] = Semiring::plus(ret[j], Semiring::times(x[i], m(i, j)));
+      }
+    }
+  } else {
+    // row by row, so the inner loop walks along `m`
+    for (std::size_t i = 0; i < H; ++i) {
+      for (std::size_t j = 0; j < W; ++j) {
+        ret[j] = Semiring::plus(ret[j], Semiring::times(x[i], m(i, j)));
+      }
+    }
+  }
+  return ret;
+}
 
-  // note: this will be done in a better way eventually
-  // too lazy to TMP right now
-  matrix(std::array<std::array<T, Width>, Height> init) {
-    using std::begin;
-    using std::end;
-    for (auto [dst, src] : range::zip(init, underlying_)) {
-      std::move(begin(dst), end(dst), begin(src));
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr auto transpose(matrix<T, H, W, Layout> const& m) {
+  auto ret = matrix<T, W, H, Layout>();
+
+  constexpr auto bh = Layout::template tile_height<H, W>;
+  constexpr auto bw = Layout::template tile_width<H, W>;
+
+  for (std::size_t i0 = 0; i0 < H; i0 += bh) {
+    auto const i1 = i0 + bh < H ? i0 + bh : H;
+    for (std::size_t j0 = 0; j0 < W; j0 += bw) {
+      auto const j1 = j0 + bw < W ? j0 + bw : W;
+      for (std::size_t i = i0; i < i1; ++i) {
+        for (std::size_t j = j0; j < j1; ++j) {
+          ret(j, i) = m(i, j);
+        }
+      }
     }
   }
+  return ret;
+}
 
-  // TODO(ubsan): actually implement *begin/*end
-  // TODO(ubsan): column iterators
+namespace impl {
+
+// the cheapest order for a chain of N products, where matrix i is dims[i]
+// by dims[i + 1]; the usual dynamic program, over every subchain from the
+// shortest up
+template <std::size_t N>
+struct chain_order {
+  // the multiply-adds it takes to multiply out matrices i through j
+  std::array<std::array<std::size_t, N>, N> cost;
+  // the last product of i through j is (i through split) * (split + 1
+  // through j)
+  std::array<std::array<std::size_t, N>, N> split;
 };
 
+template <std::size_t N>
+constexpr chain_order<N>
+order_chain(std::array<std::size_t, N + 1> const& dims) {
+  auto ret = chain_order<N>{};
+  for (std::size_t length = 2; length <= N; ++length) {
+    for (std::size_t i = 0; i + length <= N; ++i) {
+      auto const j = i + length - 1;
+      ret.cost[i][j] = std::size_t(-1);
+      for (auto k = i; k < j; ++k) {
+        auto const cost = ret.cost[i][k] + ret.cost[k + 1][j] +
+            dims[i] * dims[k + 1] * dims[j + 1];
+        if (cost < ret.cost[i][j]) {
+          ret.cost[i][j] = cost;
+          ret.split[i][j] = k;
+        }
+      }
+    }
+  }
+  return ret;
 }
 
-#include <algae/implementation/matrix_iterators.h>
\ No newline at end of file
+template <typename... Matrices>
+constexpr bool chain_fits() {
+  std::size_t const heights[] = {Matrices::height()...};
+  std::size_t const widths[] = {Matrices::width()...};
+  for (std::size_t idx = 1; idx < sizeof...(Matrices); ++idx) {
+    if (widths[idx - 1] != heights[idx]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename First, typename... Rest>
+struct chain_order_of {
+  static_assert(
+      chain_fits<First, Rest...>(),
+      "each matrix must be as tall as the last is wide");
+  static constexpr auto value = order_chain<1 + sizeof...(Rest)>(
+      {First::height(), First::width(), Rest::width()...});
+};
+
+// the leaves are references into `ms`; `multiply` takes care of the rest
+template <
+    std::size_t I,
+    std::size_t J,
+    typename Order,
+    typename Tuple,
+    typename Multiply>
+constexpr decltype(auto)
+multiply_subchain(Tuple const& ms, Multiply const& multiply) {
+  if constexpr (I == J) {
+    return std::get<I>(ms);
+  } else {
+    constexpr auto k = Order::value.split[I][J];
+    return multiply(
+        multiply_subchain<I, k, Order>(ms, multiply),
+        multiply_subchain<k + 1, J, Order>(ms, multiply));
+  }
+}
+
+} // namespace impl
+
+// ms[0] * ms[1] * ..., parenthesized to take the fewest multiply-adds; the
+// dimensions are all in the types, so the order is decided at compile time
+template <typename... Matrices>
+constexpr auto multiply_chain(Matrices const&... ms) {
+  using order = impl::chain_order_of<Matrices...>;
+  return impl::multiply_subchain<0, sizeof...(Matrices) - 1, order>(
+      std::forward_as_tuple(ms...),
+      [](auto const& lhs, auto const& rhs) { return multiply(lhs, rhs); });
+}
+
+namespace impl {
+
+template <typename Matrix, typename Semiring>
+constexpr Matrix semiring_identity(Semiring) {
+  auto ret = Matrix();
+  for (std::size_t i = 0; i < Matrix::height(); ++i) {
+    for (std::size_t j = 0; j < Matrix::width(); ++j) {
+      ret(i, j) = i == j ? Semiring::one() : Semiring::zero();
+    }
+  }
+  return ret;
+}
+
+// m^k, by squaring m for each bit of k, and multiplying in the squares
+// for the bits that are set
+template <typename Matrix, typename Multiply>
+constexpr Matrix
+pow_by_squaring(Matrix m, std::uint64_t k, Multiply const& multiply) {
+  while (k % 2 == 0) {
+    m = multiply(m, m);
+    k /= 2;
+  }
+  auto ret = m;
+  while (k /= 2) {
+    m = multiply(m, m);
+    if (k % 2 == 1) {
+      ret = multiply(ret, m);
+    }
+  }
+  return ret;
+}
+
+/*
+  an addition chain for k: each value is the sum of two before it, so that
+  m^k takes a product per value after the first, which is 1. For k below
+  256, it's as short as can be, from an iterative deepening search of the
+  chains where each value uses the one just before it (which are shortest
+  for far larger k than that); the search gets too slow for a constexpr
+  after that, so above, it's the sliding window method with windows of four
+  bits, which is close.
+*/
+struct addition_chain {
+  static constexpr std::size_t capacity = 128;
+  static constexpr std::size_t no_slot = std::size_t(-1);
+
+  std::size_t length;
+  std::array<std::uint64_t, capacity> values;
+  std::array<std::size_t, capacity> lhs;
+  std::array<std::size_t, capacity> rhs;
+  // the values that are used after the next step need keeping around
+  std::array<std::size_t, capacity> slots;
+  std::size_t slot_count;
+
+  constexpr std::size_t push(std::size_t lhs_idx, std::size_t rhs_idx) {
+    values[length] = values[lhs_idx] + values[rhs_idx];
+    lhs[length] = lhs_idx;
+    rhs[length] = rhs_idx;
+    return length++;
+  }
+};
+
+constexpr bool
+search_chain(addition_chain& chain, std::uint64_t k, std::size_t limit) {
+  auto const last = chain.length - 1;
+  if (chain.values[last] == k) {
+    return true;
+  }
+  // doubling the rest of the way isn't enough
+  if (chain.length == limit ||
+      (chain.values[last] << (limit - chain.length)) < k) {
+    return false;
+  }
+  auto const remaining = limit - chain.length;
+  for (auto idx = chain.length; idx-- > 0;) {
+    auto const next = chain.values[last] + chain.values[idx];
+    if (next > k) {
+      continue;
+    }
+    // and the rest are smaller
+    if ((next << (remaining - 1)) < k) {
+      break;
+    }
+    chain.push(last, idx);
+    if (search_chain(chain, k, limit)) {
+      return true;
+    }
+    --chain.length;
+  }
+  return false;
+}
+
+// the lowest bit of the window that starts at set bit `top` of k; windows
+// end on a set bit too
+constexpr std::size_t window_start(std::uint64_t k, std::size_t top) {
+  constexpr std::size_t window = 4;
+  auto ret = top + 1 >= window ? top + 1 - window : 0;
+  while (((k >> ret) & 1) == 0) {
+    ++ret;
+  }
+  return ret;
+}
+
+constexpr std::uint64_t
+window_value(std::uint64_t k, std::size_t top, std::size_t low) {
+  return (k >> low) & ((std::uint64_t(2) << (top - low)) - 1);
+}
+
+constexpr void window_chain(addition_chain& chain, std::uint64_t k) {
+  auto top = std::size_t(63);
+  while ((k >> top) == 0) {
+    --top;
+  }
+
+  // the odd values up to the largest window; odd[u / 2] is the index of u
+  auto largest = std::uint64_t(1);
+  for (auto idx = top + 1; idx-- > 0;) {
+    if (((k >> idx) & 1) != 0) {
+      auto const low = window_start(k, idx);
+      auto const u = window_value(k, idx, low);
+      largest = u > largest ? u : largest;
+      idx = low;
+    }
+  }
+  std::size_t odd[8] = {};
+  if (largest > 1) {
+    auto const two = chain.push(0, 0);
+    for (auto u = std::uint64_t(3); u <= largest; u += 2) {
+      odd[u / 2] = chain.push(odd[u / 2 - 1], two);
+    }
+  }
+
+  // then from the top bit down, squaring for each bit, and multiplying in
+  // each window
+  auto current = addition_chain::no_slot;
+  for (auto idx = top + 1; idx-- > 0;) {
+    if (((k >> idx) & 1) == 0) {
+      current = chain.push(current, current);
+      continue;
+    }
+    auto const low = window_start(k, idx);
+    auto const u = window_value(k, idx, low);
+    if (current == addition_chain::no_slot) {
+      current = odd[u / 2];
+    } else {
+      for (auto bit = low; bit <= idx; ++bit) {
+        current = chain.push(current, current);
+      }
+      current = chain.push(current, odd[u / 2]);
+    }
+    idx = low;
+  }
+}
+
+// k must be at least 1
+constexpr addition_chain make_addition_chain(std::uint64_t k) {
+  auto ret = addition_chain{};
+  ret.length = 1;
+  ret.values[0] = 1;
+  if (k < 256) {
+    auto limit = std::size_t(1);
+    while (!search_chain(ret, k, limit)) {
+      ++limit;
+    }
+  } else {
+    window_chain(ret, k);
+  }
+
+  for (std::size_t idx = 0; idx < ret.length; ++idx) {
+    ret.slots[idx] = addition_chain::no_slot;
+    for (auto step = idx + 2; step < ret.length; ++step) {
+      if (ret.lhs[step] == idx || ret.rhs[step] == idx) {
+        ret.slots[idx] = ret.slot_count++;
+        break;
+      }
+    }
+  }
+  return ret;
+}
+
+template <std::uint64_t K, typename Matrix, typename Multiply>
+constexpr Matrix pow_by_chain(Matrix const& m, Multiply const& multiply) {
+  constexpr auto chain = make_addition_chain(K);
+  auto kept = std::array<Matrix, chain.slot_count>();
+
+  auto current = m;
+  for (std::size_t step = 0; step < chain.length; ++step) {
+    // the values that aren't kept are only used by the next step
+    if (step != 0) {
+      auto const lhs = chain.lhs[step];
+      auto const rhs = chain.rhs[step];
+      current = multiply(
+          lhs + 1 == step ? current : kept[chain.slots[lhs]],
+          rhs + 1 == step ? current : kept[chain.slots[rhs]]);
+    }
+    if (chain.slots[step] != addition_chain::no_slot) {
+      kept[chain.slots[step]] = current;
+    }
+  }
+  return current;
+}
+
+} // namespace impl
+
+// m^k, by repeated squaring; m^0 is the identity of the semiring
+template <
+    typename T,
+    std::size_t N,
+    typename Layout,
+    typename Semiring = plus_times<T>>
+constexpr matrix<T, N, N, Layout>
+pow(matrix<T, N, N, Layout> const& m, std::uint64_t k, Semiring = {}) {
+  if (k == 0) {
+    return impl::semiring_identity<matrix<T, N, N, Layout>>(Semiring());
+  }
+  return impl::pow_by_squaring(m, k, [](auto const& lhs, auto const& rhs) {
+    return multiply(lhs, rhs, Semiring());
+  });
+}
+
+// m^K, with a chain of products worked out at compile time; shortest, for
+// K below 256
+template <
+    std::uint64_t K,
+    typename T,
+    std::size_t N,
+    typename Layout,
+    typename Semiring = plus_times<T>>
+constexpr matrix<T, N, N, Layout>
+pow(matrix<T, N, N, Layout> const& m, Semiring = {}) {
+  if constexpr (K == 0) {
+    return impl::semiring_identity<matrix<T, N, N, Layout>>(Semiring());
+  } else {
+    return impl::pow_by_chain<K>(m, [](auto const& lhs, auto const& rhs) {
+      return multiply(lhs, rhs, Semiring());
+    });
+  }
+}
+
+} // namespace algae
+
+#include <algae/implementation/matrix_iterators.h>
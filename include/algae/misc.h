@@ -12,6 +12,31 @@ constexpr static list_init_t list_init;
 struct range_init_t {};
 constexpr static range_init_t range_init;
 
+// for triangular matrices; which half of the matrix is used, and whether
+// the diagonal is stored or taken to be all ones
+
+enum class triangle {
+  lower,
+  upper,
+};
+
+enum class diagonal {
+  non_unit,
+  unit,
+};
+
+// for distances; how two vectors are compared
+
+enum class metric {
+  // ||a - b||^2; smaller is nearer
+  squared_euclidean,
+  // a . b; larger is nearer
+  inner_product,
+  // a . b / (||a|| ||b||); larger is nearer, and a zero vector is at zero
+  // from everything
+  cosine,
+};
+
 // for ADL purposes
 template <std::size_t Idx, typename T>
 constexpr decltype(auto) get(T&& t) {
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#include <algae/matrix.h>
+#include <algae/semiring.h>
+#include <algae/vector.h>
+
+/*
+  the integers mod an odd P below 2^62, in montgomery form; 32 bits for
+  moduli below 2^31, 64 otherwise. Sums of products reduce once, at the
+  end, folding the high word whenever it reaches 2^63.
+*/
+
+namespace algae {
+
+namespace impl {
+
+// the full 128 bit product of two 64 bit numbers
+struct wide_product {
+  std::uint64_t high;
+  std::uint64_t low;
+};
+
+constexpr wide_product multiply_wide(std::uint64_t a, std::uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  __extension__ typedef unsigned __int128 uint128;
+  auto const product = uint128(a) * b;
+  return {std::uint64_t(product >> 64), std::uint64_t(product)};
+#else
+  auto const a_low = a & 0xffffffff;
+  auto const a_high = a >> 32;
+  auto const b_low = b & 0xffffffff;
+  auto const b_high = b >> 32;
+  auto const low_low = a_low * b_low;
+  auto const high_low = a_high * b_low;
+  auto const cross =
+      (low_low >> 32) + (high_low & 0xffffffff) + a_low * b_high;
+  return {
+      a_high * b_high + (high_low >> 32) + (cross >> 32),
+      (cross << 32) | (low_low & 0xffffffff)};
+#endif
+}
+
+// the constants for montgomery arithmetic mod P
+template <std::uint64_t P>
+struct montgomery {
+  static_assert(P % 2 == 1 && P > 2, "the modulus must be odd");
+  static_assert(P < (std::uint64_t(1) << 62), "the modulus must be < 2^62");
+
+  static constexpr bool is_small = P < (std::uint64_t(1) << 31);
+  using storage = std::conditional_t<is_small, std::uint32_t, std::uint64_t>;
+
+  // -1 / P mod R; newton's method doubles the correct bits each time, and
+  // P is its own inverse mod 8
+  static constexpr storage negated_inverse() {
+    auto inv = storage(P);
+    for (int i = 0; i < 5; ++i) {
+      inv *= storage(2) - storage(P) * inv;
+    }
+    return storage(0) - inv;
+  }
+
+  // R^2 mod P, to get into montgomery form
+  static constexpr storage r_squared() {
+    // R mod P
+    auto ret = is_small ? (std::uint64_t(1) << 32) % P : (0 - P) % P;
+    for (int i = 0; i < (is_small ? 32 : 64); ++i) {
+      ret = (ret * 2) % P;
+    }
+    return storage(ret);
+  }
+
+  static constexpr storage inv = negated_inverse();
+  static constexpr storage r2 = r_squared();
+
+  // x / R mod P, for x < P * R
+  static constexpr storage reduce(std::uint64_t high, std::uint64_t low) {
+    if constexpr (is_small) {
+      auto const x = (high << 32) | low;
+      auto const m = storage(x) * inv;
+      auto const t = storage((x + std::uint64_t(m) * P) >> 32);
+      return t >= P ? storage(t - P) : t;
+    } else {
+      auto const m = low * inv;
+      auto const mp = impl::multiply_wide(m, P);
+      // the low halves add up to zero mod 2^64, with a carry unless both
+      // are zero
+      auto const t = high + mp.high + (low != 0 ? 1 : 0);
+      return t >= P ? t - P : t;
+    }
+  }
+
+  // a * b / R mod P
+  static constexpr storage multiply(storage a, storage b) {
+    if constexpr (is_small) {
+      auto const x = std::uint64_t(a) * b;
+      return reduce(x >> 32, x & 0xffffffff);
+    } else {
+      auto const x = impl::multiply_wide(a, b);
+      return reduce(x.high, x.low);
+    }
+  }
+};
+
+} // namespace impl
+
+template <std::uint64_t P>
+class modint {
+  using params = impl::montgomery<P>;
+
+public:
+  using storage_type = typename params::storage;
+
+private:
+  storage_type value_;
+
+  struct raw_tag {};
+  constexpr modint(raw_tag, storage_type x) : value_(x) {}
+
+public:
+  constexpr modint() : value_(0) {}
+
+  // any integer, negative ones included
+  template <
+      typename Integer,
+      typename = std::enable_if_t<std::is_integral_v<Integer>>>
+  constexpr modint(Integer x) : value_(0) {
+    auto residue = std::uint64_t(0);
+    if constexpr (std::is_signed_v<Integer>) {
+      auto const r = static_cast<long long>(x) % static_cast<long long>(P);
+      residue = static_cast<std::uint64_t>(
+          r < 0 ? r + static_cast<long long>(P) : r);
+    } else {
+      residue = static_cast<std::uint64_t>(x) % P;
+    }
+    value_ = params::multiply(storage_type(residue), params::r2);
+  }
+
+  static constexpr std::uint64_t modulus() noexcept { return P; }
+
+  // x * R mod P; what the kernels work on
+  static constexpr modint from_montgomery(storage_type x) noexcept {
+    return modint(raw_tag(), x);
+  }
+  constexpr storage_type montgomery() const noexcept { return value_; }
+
+  // the value, in [0, P)
+  constexpr std::uint64_t value() const noexcept {
+    return params::reduce(0, value_);
+  }
+
+  constexpr modint& operator+=(modint other) noexcept {
+    value_ += other.value_;
+    if (value_ >= P) {
+      value_ -= storage_type(P);
+    }
+    return *this;
+  }
+  constexpr modint& operator-=(modint other) noexcept {
+    value_ = value_ >= other.value_ ? value_ - other.value_
+                                    : value_ + storage_type(P) - other.value_;
+    return *this;
+  }
+  constexpr modint& operator*=(modint other) noexcept {
+    value_ = params::multiply(value_, other.value_);
+    return *this;
+  }
+  // other must not be zero, and P must be prime
+  constexpr modint& operator/=(modint other) noexcept {
+    return *this *= other.inverse();
+  }
+
+  constexpr modint operator-() const noexcept { return modint() - *this; }
+
+  constexpr modint pow(std::uint64_t exponent) const noexcept {
+    auto ret = modint(1);
+    auto base = *this;
+    for (; exponent != 0; exponent /= 2) {
+      if (exponent % 2 != 0) {
+        ret *= base;
+      }
+      base *= base;
+    }
+    return ret;
+  }
+  // by fermat's little theorem; *this must not be zero, and P must be prime
+  constexpr modint inverse() const noexcept { return pow(P - 2); }
+
+  friend constexpr modint operator+(modint lhs, modint rhs) noexcept {
+    return lhs += rhs;
+  }
+  friend constexpr modint operator-(modint lhs, modint rhs) noexcept {
+    return lhs -= rhs;
+  }
+  friend constexpr modint operator*(modint lhs, modint rhs) noexcept {
+    return lhs *= rhs;
+  }
+  friend constexpr modint operator/(modint lhs, modint rhs) noexcept {
+    return lhs /= rhs;
+  }
+  friend constexpr bool operator==(modint lhs, modint rhs) noexcept {
+    return lhs.value_ == rhs.value_;
+  }
+  friend constexpr bool operator!=(modint lhs, modint rhs) noexcept {
+    return lhs.value_ != rhs.value_;
+  }
+};
+
+namespace impl {
+
+// a sum of products of montgomery values, unreduced; (high, low) is a 128
+// bit number, which is only reduced when high gets to 2^63
+template <std::uint64_t P>
+class modint_accumulator {
+  using params = montgomery<P>;
+  std::uint64_t high_ = 0;
+  std::uint64_t low_ = 0;
+
+  static constexpr auto top_bit = std::uint64_t(1) << 63;
+
+public:
+  constexpr void add_product(modint<P> a, modint<P> b) {
+    if constexpr (params::is_small) {
+      // everything fits in low_; products are under 2^62
+      low_ += std::uint64_t(a.montgomery()) * b.montgomery();
+      if (low_ >= top_bit) {
+        low_ = ((low_ >> 32) % P << 32) | (low_ & 0xffffffff);
+      }
+    } else {
+      auto const product = impl::multiply_wide(a.montgomery(), b.montgomery());
+      low_ += product.low;
+      high_ += product.high + (low_ < product.low ? 1 : 0);
+      if (high_ >= top_bit) {
+        high_ %= P;
+      }
+    }
+  }
+
+  // the sum; the products are a * b * R^2, so reducing once gives the
+  // montgomery form
+  constexpr modint<P> get() const {
+    if constexpr (params::is_small) {
+      return modint<P>::from_montgomery(
+          params::reduce((low_ >> 32) % P, low_ & 0xffffffff));
+    } else {
+      return modint<P>::from_montgomery(params::reduce(high_ % P, low_));
+    }
+  }
+};
+
+} // namespace impl
+
+// the semiring argument is only there to be more specialized than the
+// generic dot and multiply
+template <std::uint64_t P, std::size_t N>
+constexpr modint<P> dot(
+    vector<modint<P>, N> const& lhs,
+    vector<modint<P>, N> const& rhs,
+    plus_times<modint<P>> = {}) {
+  auto acc = impl::modint_accumulator<P>();
+  for (std::size_t idx = 0; idx < N; ++idx) {
+    acc.add_product(lhs[idx], rhs[idx]);
+  }
+  return acc.get();
+}
+
+template <
+    std::uint64_t P,
+    std::size_t M,
+    std::size_t K,
+    std::size_t N,
+    typename Layout_lhs,
+    typename Layout_rhs>
+constexpr auto multiply(
+    matrix<modint<P>, M, K, Layout_lhs> const& lhs,
+    matrix<modint<P>, K, N, Layout_rhs> const& rhs,
+    plus_times<modint<P>> = {}) {
+  auto ret = matrix<modint<P>, M, N, Layout_lhs>();
+  for (std::size_t i = 0; i < M; ++i) {
+    for (std::size_t j = 0; j < N; ++j) {
+      auto acc = impl::modint_accumulator<P>();
+      for (std::size_t k = 0; k < K; ++k) {
+        acc.add_product(lhs(i, k), rhs(k, j));
+      }
+      ret(i, j) = acc.get();
+    }
+  }
+  return ret;
+}
+
+namespace impl {
+
+// row_reduce, but the row operations are done by `axpy(row, pivot, col,
+// factor)`, which adds factor times row `pivot` to row `row`, from column
+// `col` on; the kernels pass in their own
+template <
+    std::uint64_t P,
+    std::size_t H,
+    std::size_t W,
+    typename Layout,
+    typename Axpy>
+constexpr std::size_t
+modint_row_reduce(matrix<modint<P>, H, W, Layout>& m, Axpy const& axpy) {
+  std::size_t rank = 0;
+  for (std::size_t col = 0; col < W && rank < H; ++col) {
+    auto pivot = rank;
+    while (pivot < H && m(pivot, col) == modint<P>()) {
+      ++pivot;
+    }
+    if (pivot == H) {
+      continue;
+    }
+
+    // the rows from `rank` down are zero before `col`
+    for (auto idx = col; idx < W; ++idx) {
+      auto const tmp = m(pivot, idx);
+      m(pivot, idx) = m(rank, idx);
+      m(rank, idx) = tmp;
+    }
+    auto const scale = m(rank, col).inverse();
+    for (auto idx = col; idx < W; ++idx) {
+      m(rank, idx) *= scale;
+    }
+    for (std::size_t row = 0; row < H; ++row) {
+      if (row != rank && m(row, col) != modint<P>()) {
+        axpy(row, rank, col, -m(row, col));
+      }
+    }
+    ++rank;
+  }
+  return rank;
+}
+
+} // namespace impl
+
+// puts m in reduced row echelon form, and returns its rank; P must be prime
+template <std::uint64_t P, std::size_t H, std::size_t W, typename Layout>
+constexpr std::size_t row_reduce(matrix<modint<P>, H, W, Layout>& m) {
+  return impl::modint_row_reduce(
+      m,
+      [&m](std::size_t row, std::size_t pivot, std::size_t col, modint<P> f) {
+        for (auto idx = col; idx < W; ++idx) {
+          m(row, idx) += f * m(pivot, idx);
+        }
+      });
+}
+
+template <std::uint64_t P, std::size_t H, std::size_t W, typename Layout>
+constexpr std::size_t rank(matrix<modint<P>, H, W, Layout> m) {
+  return row_reduce(m);
+}
+
+// by elimination; P must be prime
+template <std::uint64_t P, std::size_t N, typename Layout>
+constexpr modint<P> determinant(matrix<modint<P>, N, N, Layout> m) {
+  auto ret = modint<P>(1);
+  for (std::size_t col = 0; col < N; ++col) {
+    auto pivot = col;
+    while (pivot < N && m(pivot, col) == modint<P>()) {
+      ++pivot;
+    }
+    if (pivot == N) {
+      return modint<P>();
+    }
+    if (pivot != col) {
+      for (auto idx = col; idx < N; ++idx) {
+        auto const tmp = m(pivot, idx);
+        m(pivot, idx) = m(col, idx);
+        m(col, idx) = tmp;
+      }
+      ret = -ret;
+    }
+    ret *= m(col, col);
+    auto const scale = m(col, col).inverse();
+    for (auto row = col + 1; row < N; ++row) {
+      auto const f = m(row, col) * scale;
+      for (auto idx = col; idx < N; ++idx) {
+        m(row, idx) -= f * m(col, idx);
+      }
+    }
+  }
+  return ret;
+}
+
+// an x with a * x = b, or std::nullopt if there isn't one; if there are
+// many, the free variables are all zero. P must be prime
+template <
+    std::uint64_t P,
+    std::size_t H,
+    std::size_t W,
+    std::size_t R,
+    typename Layout_a,
+    typename Layout_b>
+constexpr std::optional<matrix<modint<P>, W, R>> solve(
+    matrix<modint<P>, H, W, Layout_a> const& a,
+    matrix<modint<P>, H, R, Layout_b> const& b) {
+  auto augmented = matrix<modint<P>, H, W + R>();
+  for (std::size_t row = 0; row < H; ++row) {
+    for (std::size_t col = 0; col < W; ++col) {
+      augmented(row, col) = a(row, col);
+    }
+    for (std::size_t col = 0; col < R; ++col) {
+      augmented(row, W + col) = b(row, col);
+    }
+  }
+  auto const pivots = row_reduce(augmented);
+
+  auto ret = matrix<modint<P>, W, R>();
+  for (std::size_t row = 0; row < pivots; ++row) {
+    std::size_t pivot = 0;
+    while (augmented(row, pivot) == modint<P>()) {
+      ++pivot;
+    }
+    // a pivot in b is a row 0 = 1
+    if (pivot >= W) {
+      return std::nullopt;
+    }
+    for (std::size_t col = 0; col < R; ++col) {
+      ret(pivot, col) = augmented(row, W + col);
+    }
+  }
+  return ret;
+}
+
+} // namespace algae
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <algae/matrix.h>
+#include <algae/view.h>
+
+/*
+  symmetric packed (the lower triangle, row by row) and banded (kl below,
+  ku above) matrices, with run-time shapes. Their factorizations keep the
+  same storage; banded LU grows the upper bandwidth to kl + ku.
+*/
+
+namespace algae {
+
+template <typename T>
+class symmetric_packed_matrix {
+  std::size_t size_;
+  std::vector<T> elements_;
+
+  static std::size_t index(std::size_t row, std::size_t col) noexcept {
+    return row < col ? col * (col + 1) / 2 + row : row * (row + 1) / 2 + col;
+  }
+
+public:
+  using value_type = T;
+
+  symmetric_packed_matrix() : symmetric_packed_matrix(0) {}
+
+  // all zeroes
+  explicit symmetric_packed_matrix(std::size_t n)
+      : size_(n), elements_(n * (n + 1) / 2, T(0)) {}
+
+  // reads the lower triangle of m; the upper one is ignored
+  template <std::size_t N, typename Layout>
+  explicit symmetric_packed_matrix(matrix<T, N, N, Layout> const& m)
+      : symmetric_packed_matrix(N) {
+    for (std::size_t row = 0; row < N; ++row) {
+      for (std::size_t col = 0; col <= row; ++col) {
+        elements_[index(row, col)] = m(row, col);
+      }
+    }
+  }
+
+  std::size_t height() const noexcept { return size_; }
+  std::size_t width() const noexcept { return size_; }
+
+  // the packed lower triangle
+  T* data() noexcept { return elements_.data(); }
+  T const* data() const noexcept { return elements_.data(); }
+  std::size_t storage_size() const noexcept { return elements_.size(); }
+
+  T& operator()(std::size_t row, std::size_t col) {
+    return elements_[index(row, col)];
+  }
+  T const& operator()(std::size_t row, std::size_t col) const {
+    return elements_[index(row, col)];
+  }
+};
+
+template <typename T>
+class banded_matrix {
+  std::size_t size_;
+  std::size_t lower_;
+  std::size_t upper_;
+  std::vector<T> elements_;
+
+public:
+  using value_type = T;
+
+  banded_matrix() : banded_matrix(0, 0, 0) {}
+
+  // all zeroes
+  banded_matrix(std::size_t n, std::size_t kl, std::size_t ku)
+      : size_(n),
+        lower_(kl),
+        upper_(ku),
+        elements_(n * (kl + ku + 1), T(0)) {}
+
+  // keeps the bands of m; anything outside of them is dropped
+  template <std::size_t N, typename Layout>
+  banded_matrix(
+      matrix<T, N, N, Layout> const& m, std::size_t kl, std::size_t ku)
+      : banded_matrix(N, kl, ku) {
+    for (std::size_t row = 0; row < N; ++row) {
+      for (auto col = first_column(row); col < end_column(row); ++col) {
+        (*this)(row, col) = m(row, col);
+      }
+    }
+  }
+
+  std::size_t height() const noexcept { return size_; }
+  std::size_t width() const noexcept { return size_; }
+  std::size_t lower_bandwidth() const noexcept { return lower_; }
+  std::size_t upper_bandwidth() const noexcept { return upper_; }
+  // the distance between rows in data()
+  std::size_t row_stride() const noexcept { return lower_ + upper_ + 1; }
+
+  T* data() noexcept { return elements_.data(); }
+  T const* data() const noexcept { return elements_.data(); }
+  std::size_t storage_size() const noexcept { return elements_.size(); }
+
+  // the columns of row `row` that are in the band, [first, end)
+  std::size_t first_column(std::size_t row) const noexcept {
+    return row > lower_ ? row - lower_ : 0;
+  }
+  std::size_t end_column(std::size_t row) const noexcept {
+    return std::min(row + upper_ + 1, size_);
+  }
+  bool in_band(std::size_t row, std::size_t col) const noexcept {
+    return first_column(row) <= col && col < end_column(row);
+  }
+
+  // (row, col) must be in the band
+  T& operator()(std::size_t row, std::size_t col) {
+    return elements_[row * row_stride() + col + lower_ - row];
+  }
+  // zero outside the band
+  T operator()(std::size_t row, std::size_t col) const {
+    if (!in_band(row, col)) {
+      return T(0);
+    }
+    return elements_[row * row_stride() + col + lower_ - row];
+  }
+};
+
+// factorizations
+
+// a = L L^T, for a positive definite a
+template <typename T>
+class packed_cholesky {
+  symmetric_packed_matrix<T> factor_;
+
+public:
+  explicit packed_cholesky(symmetric_packed_matrix<T> factor)
+      : factor_(std::move(factor)) {}
+
+  std::size_t height() const noexcept { return factor_.height(); }
+  std::size_t width() const noexcept { return factor_.height(); }
+
+  // L, in the lower triangle; its upper triangle is zero, not stored
+  symmetric_packed_matrix<T> const& factor() const noexcept {
+    return factor_;
+  }
+};
+
+// P a = L U, where L has a unit diagonal; row i of a was swapped with
+// row pivots()[i] at step i
+template <typename T>
+class banded_lu {
+  banded_matrix<T> factors_;
+  std::vector<std::size_t> pivots_;
+
+public:
+  // factors must have an upper bandwidth of kl + ku, for the original ku
+  banded_lu(banded_matrix<T> factors, std::vector<std::size_t> pivots)
+      : factors_(std::move(factors)), pivots_(std::move(pivots)) {}
+
+  std::size_t height() const noexcept { return factors_.height(); }
+  std::size_t width() const noexcept { return factors_.height(); }
+
+  // L below the diagonal, and U on and above it
+  banded_matrix<T> const& factors() const noexcept { return factors_; }
+  std::vector<std::size_t> const& pivots() const noexcept { return pivots_; }
+};
+
+// std::nullopt if a isn't positive definite
+template <typename T>
+std::optional<packed_cholesky<T>>
+cholesky(symmetric_packed_matrix<T> const& a) {
+  auto factor = a;
+  auto const l = factor.data();
+  for (std::size_t i = 0; i < a.height(); ++i) {
+    auto const row_i = l + i * (i + 1) / 2;
+    for (std::size_t j = 0; j <= i; ++j) {
+      auto const row_j = l + j * (j + 1) / 2;
+      auto sum = row_i[j];
+      for (std::size_t p = 0; p < j; ++p) {
+        sum -= row_i[p] * row_j[p];
+      }
+      if (j < i) {
+        row_i[j] = sum / row_j[j];
+      } else if (sum > T(0)) {
+        row_i[i] = std::sqrt(sum);
+      } else {
+        return std::nullopt;
+      }
+    }
+  }
+  return packed_cholesky<T>(std::move(factor));
+}
+
+// std::nullopt if a is singular
+template <typename T>
+std::optional<banded_lu<T>> lu(banded_matrix<T> const& a) {
+  auto const n = a.height();
+  auto const kl = a.lower_bandwidth();
+  auto const ku = a.upper_bandwidth();
+  auto factors = banded_matrix<T>(n, kl, kl + ku);
+  for (std::size_t row = 0; row < n; ++row) {
+    for (auto col = a.first_column(row); col < a.end_column(row); ++col) {
+      factors(row, col) = a(row, col);
+    }
+  }
+
+  auto pivots = std::vector<std::size_t>(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    auto const last_row = std::min(i + kl + 1, n);
+    auto const last_col = factors.end_column(i);
+
+    auto pivot = i;
+    for (auto row = i + 1; row < last_row; ++row) {
+      if (std::abs(factors(row, i)) > std::abs(factors(pivot, i))) {
+        pivot = row;
+      }
+    }
+    if (factors(pivot, i) == T(0)) {
+      return std::nullopt;
+    }
+    pivots[i] = pivot;
+    if (pivot != i) {
+      // only from column i on; left of it, both rows hold multipliers of
+      // L, which stay put, as in LAPACK's gbtrf. solve applies the swaps
+      // to the right hand side one step at a time, in the same order
+      for (auto col = i; col < last_col; ++col) {
+        std::swap(factors(i, col), factors(pivot, col));
+      }
+    }
+
+    for (auto row = i + 1; row < last_row; ++row) {
+      auto const scale = factors(row, i) / factors(i, i);
+      factors(row, i) = scale;
+      for (auto col = i + 1; col < last_col; ++col) {
+        factors(row, col) -= scale * factors(i, col);
+      }
+    }
+  }
+  return banded_lu<T>(std::move(factors), std::move(pivots));
+}
+
+// products; out can't overlap x, and is left as it was if either isn't
+// a's size
+
+template <typename T, typename B, std::size_t N, typename C, std::size_t M>
+void multiply(
+    symmetric_packed_matrix<T> const& a,
+    vector_view<B, N> x,
+    vector_view<C, M> out) {
+  if (x.size() != a.width() || out.size() != a.height()) {
+    return;
+  }
+  // each element off the diagonal is used twice; once for its row, and
+  // once for its column
+  for (std::size_t i = 0; i < a.height(); ++i) {
+    auto const row = a.data() + i * (i + 1) / 2;
+    auto sum = row[i] * x[i];
+    for (std::size_t j = 0; j < i; ++j) {
+      sum += row[j] * x[j];
+      out[j] += row[j] * x[i];
+    }
+    out[i] = sum;
+  }
+}
+
+template <typename T, typename B, std::size_t N, typename C, std::size_t M>
+void multiply(
+    banded_matrix<T> const& a, vector_view<B, N> x, vector_view<C, M> out) {
+  if (x.size() != a.width() || out.size() != a.height()) {
+    return;
+  }
+  for (std::size_t i = 0; i < a.height(); ++i) {
+    auto sum = C(0);
+    for (auto j = a.first_column(i); j < a.end_column(i); ++j) {
+      sum += a(i, j) * x[j];
+    }
+    out[i] = sum;
+  }
+}
+
+// solves, in place; x starts out holding b, and is left that way if it
+// isn't the factorization's size
+
+template <typename T, typename B, std::size_t N>
+void solve(packed_cholesky<T> const& c, vector_view<B, N> x) {
+  if (x.size() != c.height()) {
+    return;
+  }
+  auto const l = c.factor().data();
+  auto const n = c.height();
+  // L y = b, a row of L at a time
+  for (std::size_t i = 0; i < n; ++i) {
+    auto const row = l + i * (i + 1) / 2;
+    auto sum = x[i];
+    for (std::size_t j = 0; j < i; ++j) {
+      sum -= row[j] * x[j];
+    }
+    x[i] = sum / row[i];
+  }
+  // then L^T x = y; a row of L is a column of L^T, so each x[i] is
+  // subtracted out of the ones before it as soon as it's known
+  for (std::size_t i = n; i-- > 0;) {
+    auto const row = l + i * (i + 1) / 2;
+    x[i] /= row[i];
+    for (std::size_t j = 0; j < i; ++j) {
+      x[j] -= row[j] * x[i];
+    }
+  }
+}
+
+template <typename T, typename B, std::size_t N>
+void solve(banded_lu<T> const& f, vector_view<B, N> x) {
+  if (x.size() != f.height()) {
+    return;
+  }
+  auto const& lu = f.factors();
+  auto const n = f.height();
+  auto const kl = lu.lower_bandwidth();
+  // L y = P b
+  for (std::size_t i = 0; i < n; ++i) {
+    std::swap(x[i], x[f.pivots()[i]]);
+    for (auto row = i + 1; row < std::min(i + kl + 1, n); ++row) {
+      x[row] -= lu(row, i) * x[i];
+    }
+  }
+  // U x = y
+  for (std::size_t i = n; i-- > 0;) {
+    auto sum = x[i];
+    for (auto col = i + 1; col < lu.end_column(i); ++col) {
+      sum -= lu(i, col) * x[col];
+    }
+    x[i] = sum / lu(i, i);
+  }
+}
+
+// many right hand sides, one column at a time
+template <typename T, typename B, std::size_t N, std::size_t R>
+void solve(packed_cholesky<T> const& c, matrix_view<B, N, R> b) {
+  for (std::size_t col = 0; col < b.width(); ++col) {
+    algae::solve(c, b.column(col));
+  }
+}
+template <typename T, typename B, std::size_t N, std::size_t R>
+void solve(banded_lu<T> const& f, matrix_view<B, N, R> b) {
+  for (std::size_t col = 0; col < b.width(); ++col) {
+    algae::solve(f, b.column(col));
+  }
+}
+
+} // namespace algae
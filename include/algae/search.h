@@ -0,0 +1,1322 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <algae/kernels.h>
+#include <algae/misc.h>
+#include <algae/vector.h>
+
+/*
+  nearest neighbour search; needs algae_kernels. flat_index is exact, by
+  brute force, hnsw_index approximate (Malkov and Yashunin), and pq_index
+  keeps only product quantization codes (Jegou, Douze and Schmid).
+*/
+
+namespace algae {
+
+template <typename T, std::size_t N>
+class flat_index {
+  metric metric_;
+  std::vector<T> rows_;
+  // one over the norm of each row, for cosines; empty otherwise
+  std::vector<T> scales_;
+
+public:
+  using value_type = T;
+  static constexpr std::size_t dimension = N;
+
+  explicit flat_index(metric which = metric::inner_product)
+      : metric_(which) {}
+  flat_index(metric which, vector<T, N> const* vs, std::size_t count)
+      : flat_index(which) {
+    rows_.reserve(count * N);
+    for (std::size_t idx = 0; idx < count; ++idx) {
+      add(vs[idx]);
+    }
+  }
+
+  metric which() const noexcept { return metric_; }
+  std::size_t size() const noexcept { return rows_.size() / N; }
+
+  // the vectors, as the rows of a size() x N matrix
+  T const* data() const noexcept { return rows_.data(); }
+
+  // returns the index of v
+  std::size_t add(vector<T, N> const& v) {
+    auto const ret = size();
+    rows_.insert(rows_.end(), v.begin(), v.end());
+    if (metric_ == metric::cosine) {
+      auto const squared = impl::compare(metric::inner_product, v, v);
+      scales_.push_back(squared > T(0) ? T(1) / std::sqrt(squared) : T(0));
+    }
+    return ret;
+  }
+
+  // the k nearest to query; indices and values each hold k
+  void search(
+      vector<T, N> const& query,
+      std::size_t k,
+      std::size_t* indices,
+      T* values) const noexcept {
+    search(&query, 1, k, indices, values);
+  }
+
+  // ...and to each of `count` queries, k to a query
+  void search(
+      vector<T, N> const* queries,
+      std::size_t count,
+      std::size_t k,
+      std::size_t* indices,
+      T* values) const noexcept {
+    if constexpr (impl::is_dispatched_v<T>) {
+      auto packed = impl::pack_vectors(queries, count);
+      if (metric_ == metric::squared_euclidean) {
+        kernels::pairwise_top_k(
+            metric_,
+            count,
+            size(),
+            N,
+            packed.data(),
+            N,
+            rows_.data(),
+            N,
+            k,
+            indices,
+            values);
+        return;
+      }
+      if (metric_ == metric::cosine) {
+        for (std::size_t query = 0; query < count; ++query) {
+          auto const row = packed.data() + query * N;
+          auto const squared = kernels::dot(row, row, N);
+          if (squared > T(0)) {
+            kernels::scal(T(1) / std::sqrt(squared), row, N);
+          }
+        }
+      }
+      kernels::inner_product_top_k(
+          size(),
+          N,
+          rows_.data(),
+          N,
+          scales_.empty() ? nullptr : scales_.data(),
+          count,
+          packed.data(),
+          N,
+          k,
+          indices,
+          values);
+    } else {
+      auto const negated = impl::larger_is_nearer(metric_);
+      auto heap = std::vector<std::pair<T, std::size_t>>(k);
+      auto row = vector<T, N>(algae::list_init);
+      for (std::size_t query = 0; query < count; ++query) {
+        std::size_t heap_size = 0;
+        for (std::size_t idx = 0; idx < size(); ++idx) {
+          std::copy_n(rows_.data() + idx * N, N, row.begin());
+          auto const score = impl::compare(metric_, queries[query], row);
+          impl::top_k_push(
+              heap.data(),
+              heap_size,
+              k,
+              impl::top_k_key(score, negated),
+              idx);
+        }
+        impl::top_k_finish(
+            heap.data(),
+            heap_size,
+            k,
+            negated,
+            size(),
+            indices + query * k,
+            values + query * k);
+      }
+    }
+  }
+};
+
+struct hnsw_parameters {
+  // the most links a vector keeps on each level above the bottom, and half
+  // the most on the bottom; at least 2
+  std::size_t m = 16;
+  // how many candidates an insertion keeps, looking for its links
+  std::size_t ef_construction = 200;
+  // ...and a search, looking for its results; never fewer than k
+  std::size_t ef_search = 64;
+  // for the levels of the vectors
+  std::uint64_t seed = 0;
+};
+
+} // namespace algae
+
+namespace algae::impl {
+
+constexpr std::uint32_t hnsw_none = ~std::uint32_t(0);
+// no vector is on more levels than this
+constexpr std::uint32_t hnsw_levels = 32;
+
+// splitmix64
+inline std::uint64_t hnsw_mix(std::uint64_t x) noexcept {
+  x += 0x9e3779b97f4a7c15u;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+  return x ^ (x >> 31);
+}
+
+// the top level of the idx'th vector; each level is m times less likely
+// than the one below
+inline std::uint32_t
+hnsw_level(std::uint64_t seed, std::size_t idx, std::size_t m) noexcept {
+  auto const bits = hnsw_mix(seed ^ hnsw_mix(idx));
+  auto const uniform = (double(bits >> 11) + 1.0) * 0x1p-53;
+  auto const level = -std::log(uniform) / std::log(double(m));
+  return std::uint32_t(std::min(level, double(hnsw_levels - 1)));
+}
+
+// a vector's links on a level are a count, then that many indices, in a
+// slot with room for as many as the level allows
+constexpr std::size_t hnsw_slot(std::size_t m, std::size_t level) noexcept {
+  return (level == 0 ? 2 * m : m) + 1;
+}
+
+// the slot of node on level; `offsets` is where each vector's slots for
+// the levels above the bottom start, in `upper`
+template <typename U>
+U* hnsw_links(
+    U* bottom,
+    U* upper,
+    std::uint64_t const* offsets,
+    std::size_t m,
+    std::size_t node,
+    std::size_t level) noexcept {
+  if (level == 0) {
+    return bottom + node * hnsw_slot(m, 0);
+  }
+  return upper + offsets[node] + (level - 1) * hnsw_slot(m, 1);
+}
+
+template <typename T, std::size_t N>
+T hnsw_dot(T const* a, T const* b) noexcept {
+  if constexpr (is_dispatched_v<T>) {
+    return kernels::dot(a, b, N);
+  } else {
+    return impl::dot(a, b, N);
+  }
+}
+
+template <typename T, std::size_t N>
+void hnsw_normalize(T* v) noexcept {
+  auto const squared = hnsw_dot<T, N>(v, v);
+  if (squared > T(0)) {
+    auto const scale = T(1) / std::sqrt(squared);
+    for (std::size_t idx = 0; idx < N; ++idx) {
+      v[idx] = v[idx] * scale;
+    }
+  }
+}
+
+// smaller is nearer: the squared euclidean distance, from the squared
+// norms, or the negated inner product (of normalized vectors, for cosines)
+template <typename T, std::size_t N>
+T hnsw_distance(
+    metric which,
+    T const* a,
+    T a_squared,
+    T const* b,
+    T b_squared) noexcept {
+  auto const product = hnsw_dot<T, N>(a, b);
+  if (which == metric::squared_euclidean) {
+    return std::max(a_squared + b_squared - T(2) * product, T(0));
+  }
+  return top_k_key(product, true);
+}
+
+// the vectors a search has been to; cleared by moving on to the next mark,
+// rather than by writing every one
+class hnsw_visited {
+  std::vector<std::uint32_t> marks_;
+  std::uint32_t mark_ = 0;
+
+public:
+  // this thread's, kept from one search to the next; only the first on
+  // each thread pays to allocate it
+  static hnsw_visited& here() {
+    thread_local auto ret = hnsw_visited();
+    return ret;
+  }
+
+  void clear(std::size_t size) {
+    if (marks_.size() < size) {
+      marks_.resize(size, 0);
+    }
+    if (++mark_ == 0) {
+      std::fill(marks_.begin(), marks_.end(), 0);
+      mark_ = 1;
+    }
+  }
+
+  // whether this is the first visit to node since the last clear
+  bool visit(std::uint32_t node) noexcept {
+    if (marks_[node] == mark_) {
+      return false;
+    }
+    marks_[node] = mark_;
+    return true;
+  }
+};
+
+// from node, to whichever of its links is nearest, for as long as that's
+// nearer; distance(node) is from the query, and links(node, f) calls f
+// with each of node's links on the level being searched
+template <typename T, typename Distance, typename Links>
+std::uint32_t hnsw_greedy(
+    std::uint32_t node,
+    T& nearest,
+    Distance const& distance,
+    Links const& links) {
+  for (auto changed = true; changed;) {
+    changed = false;
+    links(node, [&](std::uint32_t next) {
+      auto const d = distance(next);
+      if (d < nearest) {
+        nearest = d;
+        node = next;
+        changed = true;
+      }
+    });
+  }
+  return node;
+}
+
+// best-first from entry, which is at entry_distance; the ef nearest found,
+// as (distance, node) in a heap with the furthest at the front
+template <typename T, typename Distance, typename Links>
+std::vector<std::pair<T, std::uint32_t>> hnsw_search_layer(
+    std::uint32_t entry,
+    T entry_distance,
+    std::size_t ef,
+    Distance const& distance,
+    Links const& links,
+    hnsw_visited& visited) {
+  using entry_type = std::pair<T, std::uint32_t>;
+  auto const nearer = std::greater<entry_type>();
+  ef = std::max<std::size_t>(ef, 1);
+
+  auto found = std::vector<entry_type>{{entry_distance, entry}};
+  // with the nearest at the front
+  auto candidates = found;
+  visited.visit(entry);
+  while (!candidates.empty()) {
+    std::pop_heap(candidates.begin(), candidates.end(), nearer);
+    auto const current = candidates.back();
+    candidates.pop_back();
+    if (found.size() >= ef && current.first > found.front().first) {
+      break;
+    }
+    links(current.second, [&](std::uint32_t next) {
+      if (!visited.visit(next)) {
+        return;
+      }
+      auto const d = distance(next);
+      if (found.size() < ef || d < found.front().first) {
+        candidates.emplace_back(d, next);
+        std::push_heap(candidates.begin(), candidates.end(), nearer);
+        found.emplace_back(d, next);
+        std::push_heap(found.begin(), found.end());
+        if (found.size() > ef) {
+          std::pop_heap(found.begin(), found.end());
+          found.pop_back();
+        }
+      }
+    });
+  }
+  return found;
+}
+
+// the links to keep, out of candidates sorted nearest first: each one only
+// if it's nearer to the base than to any kept already, so that they point
+// different ways. between(a, b) is the distance between two vectors
+template <typename T, typename Between>
+void hnsw_select(
+    std::vector<std::pair<T, std::uint32_t>> const& candidates,
+    std::size_t most,
+    Between const& between,
+    std::vector<std::uint32_t>& kept) {
+  kept.clear();
+  for (auto const& candidate : candidates) {
+    if (kept.size() == most) {
+      break;
+    }
+    auto const nearer_to_kept = [&](std::uint32_t other) {
+      return between(candidate.second, other) < candidate.first;
+    };
+    auto const diverse = candidates.size() <= most ||
+        std::none_of(kept.begin(), kept.end(), nearer_to_kept);
+    if (diverse) {
+      kept.push_back(candidate.second);
+    }
+  }
+}
+
+// f() once on each of `count` of the kernels' threads, this one among
+// them; or count times here, if they're busy
+template <typename F>
+void hnsw_threads(std::size_t count, F const& f) noexcept {
+  count = std::max<std::size_t>(count, 1);
+  kernels::parallel_for(count, count, [&](std::size_t begin, std::size_t end) {
+    for (auto idx = begin; idx < end; ++idx) {
+      f();
+    }
+  });
+}
+
+// a saved index starts with this; then the vectors, their squared norms,
+// their levels, the bottom links, the offsets of the upper links and the
+// upper links, each at the next multiple of 64 bytes into the file
+struct hnsw_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t value_size;
+  std::uint64_t dimension;
+  std::uint64_t size;
+  std::uint64_t metric;
+  std::uint64_t m;
+  std::uint64_t ef_construction;
+  std::uint64_t ef_search;
+  std::uint64_t seed;
+  std::uint64_t entry;
+  std::uint64_t top;
+  std::uint64_t upper_size;
+};
+
+constexpr char hnsw_magic[8] = {'a', 'l', 'g', 'a', 'e', 'h', 'n', 'w'};
+constexpr std::uint32_t hnsw_version = 1;
+// the largest m a file may have
+constexpr std::uint64_t hnsw_max_m = 1 << 16;
+
+struct hnsw_sections {
+  std::size_t vectors;
+  std::size_t norms;
+  std::size_t levels;
+  std::size_t bottom;
+  std::size_t offsets;
+  std::size_t upper;
+  std::size_t end;
+};
+
+// where each section starts, and the last ends; std::nullopt if that's
+// past the end of memory
+template <typename T>
+std::optional<hnsw_sections> hnsw_layout(
+    std::size_t dimension,
+    std::size_t size,
+    std::size_t m,
+    std::size_t upper_size) noexcept {
+  constexpr auto limit = std::numeric_limits<std::size_t>::max() - 64;
+  auto end = sizeof(hnsw_header);
+  auto fits = true;
+  auto const section = [&](std::size_t count, std::size_t each) {
+    auto const start = (end + 63) / 64 * 64;
+    if (count != 0 && each > (limit - start) / count) {
+      fits = false;
+      return start;
+    }
+    end = start + count * each;
+    return start;
+  };
+
+  auto ret = hnsw_sections();
+  if (dimension > limit / sizeof(T) || m > hnsw_max_m) {
+    return std::nullopt;
+  }
+  ret.vectors = section(size, dimension * sizeof(T));
+  ret.norms = section(size, sizeof(T));
+  ret.levels = section(size, sizeof(std::uint32_t));
+  ret.bottom = section(size, hnsw_slot(m, 0) * sizeof(std::uint32_t));
+  ret.offsets = section(size + 1, sizeof(std::uint64_t));
+  ret.upper = section(upper_size, sizeof(std::uint32_t));
+  ret.end = end;
+  if (!fits || size >= hnsw_none) {
+    return std::nullopt;
+  }
+  return ret;
+}
+
+} // namespace algae::impl
+
+namespace algae {
+
+template <typename T, std::size_t N>
+class hnsw_index;
+
+// an hnsw index's arrays, wherever they're kept; see hnsw_index
+template <typename T, std::size_t N>
+class hnsw_graph {
+  friend class hnsw_index<T, N>;
+
+  metric metric_ = metric::squared_euclidean;
+  hnsw_parameters parameters_;
+  std::size_t size_ = 0;
+  std::size_t upper_size_ = 0;
+  std::uint32_t entry_ = impl::hnsw_none;
+  std::uint32_t top_ = 0;
+  T const* vectors_ = nullptr;
+  T const* norms_ = nullptr;
+  std::uint32_t const* levels_ = nullptr;
+  std::uint32_t const* bottom_ = nullptr;
+  std::uint64_t const* offsets_ = nullptr;
+  std::uint32_t const* upper_ = nullptr;
+
+  std::uint32_t const* links(std::size_t node, std::size_t level) const {
+    return impl::hnsw_links(
+        bottom_, upper_, offsets_, parameters_.m, node, level);
+  }
+
+  void search_one(
+      vector<T, N> const& query,
+      std::size_t k,
+      impl::hnsw_visited& visited,
+      std::size_t* indices,
+      T* values) const {
+    auto q = query;
+    if (metric_ == metric::cosine) {
+      impl::hnsw_normalize<T, N>(q.data());
+    }
+    auto const q_squared = impl::hnsw_dot<T, N>(q.data(), q.data());
+    auto const distance = [&](std::uint32_t node) {
+      return impl::hnsw_distance<T, N>(
+          metric_,
+          vectors_ + std::size_t(node) * N,
+          norms_[node],
+          q.data(),
+          q_squared);
+    };
+    auto const links_on = [this](std::size_t level) {
+      return [this, level](std::uint32_t node, auto const& f) {
+        auto const slot = links(node, level);
+        for (std::uint32_t idx = 1; idx <= slot[0]; ++idx) {
+          f(slot[idx]);
+        }
+      };
+    };
+
+    auto heap = std::vector<std::pair<T, std::size_t>>(k);
+    std::size_t heap_size = 0;
+    if (entry_ != impl::hnsw_none) {
+      auto node = entry_;
+      auto nearest = distance(node);
+      for (auto level = top_; level > 0; --level) {
+        node = impl::hnsw_greedy(node, nearest, distance, links_on(level));
+      }
+      visited.clear(size_);
+      auto const found = impl::hnsw_search_layer(
+          node,
+          nearest,
+          std::max(parameters_.ef_search, k),
+          distance,
+          links_on(0),
+          visited);
+      for (auto const& result : found) {
+        impl::top_k_push(
+            heap.data(), heap_size, k, result.first, result.second);
+      }
+    }
+    impl::top_k_finish(
+        heap.data(),
+        heap_size,
+        k,
+        impl::larger_is_nearer(metric_),
+        size_,
+        indices,
+        values);
+  }
+
+public:
+  using value_type = T;
+  static constexpr std::size_t dimension = N;
+
+  hnsw_graph() = default;
+
+  // the arrays of a saved index, in memory at `bytes` (which must be
+  // aligned to 64 bytes, as a mapped file is); std::nullopt if it isn't
+  // a saved hnsw_index<T, N>, or is cut short. Only the header and the
+  // sizes are checked; see valid()
+  static std::optional<hnsw_graph>
+  from_bytes(void const* bytes, std::size_t length) noexcept {
+    auto const base = static_cast<unsigned char const*>(bytes);
+    auto header = impl::hnsw_header();
+    if (length < sizeof(header) ||
+        reinterpret_cast<std::uintptr_t>(bytes) % 64 != 0) {
+      return std::nullopt;
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, impl::hnsw_magic, sizeof(header.magic)) !=
+            0 ||
+        header.version != impl::hnsw_version ||
+        header.value_size != sizeof(T) || header.dimension != N ||
+        header.metric > std::uint64_t(metric::cosine) || header.m < 2 ||
+        header.top >= impl::hnsw_levels) {
+      return std::nullopt;
+    }
+    auto const sections = impl::hnsw_layout<T>(
+        N,
+        std::size_t(header.size),
+        std::size_t(header.m),
+        std::size_t(header.upper_size));
+    if (!sections || sections->end > length ||
+        (header.size == 0 ? header.entry != impl::hnsw_none
+                          : header.entry >= header.size)) {
+      return std::nullopt;
+    }
+
+    auto ret = hnsw_graph();
+    ret.metric_ = metric(header.metric);
+    ret.parameters_.m = std::size_t(header.m);
+    ret.parameters_.ef_construction = std::size_t(header.ef_construction);
+    ret.parameters_.ef_search = std::size_t(header.ef_search);
+    ret.parameters_.seed = header.seed;
+    ret.size_ = std::size_t(header.size);
+    ret.upper_size_ = std::size_t(header.upper_size);
+    ret.entry_ = std::uint32_t(header.entry);
+    ret.top_ = std::uint32_t(header.top);
+    ret.vectors_ = reinterpret_cast<T const*>(base + sections->vectors);
+    ret.norms_ = reinterpret_cast<T const*>(base + sections->norms);
+    ret.levels_ =
+        reinterpret_cast<std::uint32_t const*>(base + sections->levels);
+    ret.bottom_ =
+        reinterpret_cast<std::uint32_t const*>(base + sections->bottom);
+    ret.offsets_ =
+        reinterpret_cast<std::uint64_t const*>(base + sections->offsets);
+    ret.upper_ =
+        reinterpret_cast<std::uint32_t const*>(base + sections->upper);
+    return ret;
+  }
+
+  // whether every level and link is in bounds; this reads all of the
+  // graph, so it's up to the caller whether a mapped file is trusted
+  bool valid() const noexcept {
+    if (size_ != 0 && levels_[entry_] != top_) {
+      return false;
+    }
+    if (offsets_[0] != 0 || offsets_[size_] != upper_size_) {
+      return false;
+    }
+    auto const upper_slot = impl::hnsw_slot(parameters_.m, 1);
+    for (std::size_t node = 0; node < size_; ++node) {
+      if (levels_[node] > top_ || offsets_[node + 1] < offsets_[node] ||
+          offsets_[node + 1] - offsets_[node] != levels_[node] * upper_slot) {
+        return false;
+      }
+    }
+    for (std::size_t node = 0; node < size_; ++node) {
+      for (std::size_t level = 0; level <= levels_[node]; ++level) {
+        auto const slot = links(node, level);
+        if (slot[0] >= impl::hnsw_slot(parameters_.m, level)) {
+          return false;
+        }
+        for (std::uint32_t idx = 1; idx <= slot[0]; ++idx) {
+          if (slot[idx] >= size_ || levels_[slot[idx]] < level) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  metric which() const noexcept { return metric_; }
+  hnsw_parameters const& parameters() const noexcept { return parameters_; }
+  void set_ef_search(std::size_t ef) noexcept { parameters_.ef_search = ef; }
+  std::size_t size() const noexcept { return size_; }
+
+  // the vectors, as the rows of a size() x N matrix; normalized, for
+  // cosines
+  T const* data() const noexcept { return vectors_; }
+
+  // about the k nearest to query; indices and values each hold k
+  void search(
+      vector<T, N> const& query,
+      std::size_t k,
+      std::size_t* indices,
+      T* values) const noexcept {
+    auto& visited = impl::hnsw_visited::here();
+    search_one(query, k, visited, indices, values);
+  }
+
+  // ...and to each of `count` queries, k to a query
+  void search(
+      vector<T, N> const* queries,
+      std::size_t count,
+      std::size_t k,
+      std::size_t* indices,
+      T* values) const noexcept {
+    auto next = std::atomic<std::size_t>(0);
+    impl::hnsw_threads(std::min(kernels::thread_count(), count), [&] {
+      auto& visited = impl::hnsw_visited::here();
+      for (auto query = next++; query < count; query = next++) {
+        search_one(
+            queries[query],
+            k,
+            visited,
+            indices + query * k,
+            values + query * k);
+      }
+    });
+  }
+
+  // false if the file can't be written
+  bool save(std::string const& path) const {
+    auto file = std::ofstream(path, std::ios::binary);
+    if (!file) {
+      return false;
+    }
+    auto header = impl::hnsw_header();
+    std::memcpy(header.magic, impl::hnsw_magic, sizeof(header.magic));
+    header.version = impl::hnsw_version;
+    header.value_size = sizeof(T);
+    header.dimension = N;
+    header.size = size_;
+    header.metric = std::uint64_t(metric_);
+    header.m = parameters_.m;
+    header.ef_construction = parameters_.ef_construction;
+    header.ef_search = parameters_.ef_search;
+    header.seed = parameters_.seed;
+    header.entry = entry_;
+    header.top = top_;
+    header.upper_size = upper_size_;
+    auto const sections =
+        *impl::hnsw_layout<T>(N, size_, parameters_.m, upper_size_);
+
+    std::size_t written = 0;
+    auto const write = [&](std::size_t at, void const* data, std::size_t n) {
+      static constexpr char padding[64] = {};
+      file.write(padding, std::streamsize(at - written));
+      if (n != 0) {
+        file.write(static_cast<char const*>(data), std::streamsize(n));
+      }
+      written = at + n;
+    };
+    write(0, &header, sizeof(header));
+    write(sections.vectors, vectors_, size_ * N * sizeof(T));
+    write(sections.norms, norms_, size_ * sizeof(T));
+    write(sections.levels, levels_, size_ * sizeof(std::uint32_t));
+    write(
+        sections.bottom,
+        bottom_,
+        size_ * impl::hnsw_slot(parameters_.m, 0) * sizeof(std::uint32_t));
+    write(sections.offsets, offsets_, (size_ + 1) * sizeof(std::uint64_t));
+    write(sections.upper, upper_, upper_size_ * sizeof(std::uint32_t));
+    return bool(file);
+  }
+};
+
+template <typename T, std::size_t N>
+class hnsw_index {
+  metric metric_;
+  hnsw_parameters parameters_;
+  std::vector<T> vectors_;
+  std::vector<T> norms_;
+  std::vector<std::uint32_t> levels_;
+  std::vector<std::uint32_t> bottom_;
+  // size() + 1 of them; vector idx's upper slots are from offsets_[idx]
+  std::vector<std::uint64_t> offsets_{0};
+  std::vector<std::uint32_t> upper_;
+  std::uint32_t entry_ = impl::hnsw_none;
+  std::uint32_t top_ = 0;
+
+  std::uint32_t* links(std::size_t node, std::size_t level) noexcept {
+    return impl::hnsw_links(
+        bottom_.data(),
+        upper_.data(),
+        offsets_.data(),
+        parameters_.m,
+        node,
+        level);
+  }
+
+  // stores v, without linking it
+  std::uint32_t append(vector<T, N> const& v) {
+    auto const node = std::uint32_t(size());
+    vectors_.insert(vectors_.end(), v.begin(), v.end());
+    auto const row = vectors_.data() + std::size_t(node) * N;
+    if (metric_ == metric::cosine) {
+      impl::hnsw_normalize<T, N>(row);
+    }
+    norms_.push_back(impl::hnsw_dot<T, N>(row, row));
+    auto const level = impl::hnsw_level(parameters_.seed, node, parameters_.m);
+    levels_.push_back(level);
+    bottom_.resize(bottom_.size() + impl::hnsw_slot(parameters_.m, 0), 0);
+    upper_.resize(
+        upper_.size() + level * impl::hnsw_slot(parameters_.m, 1), 0);
+    offsets_.push_back(upper_.size());
+    return node;
+  }
+
+  // links a stored vector into the graph. `locks` has one mutex for each
+  // vector, and `global` guards the entry point, when other threads are
+  // inserting too; both are nullptr otherwise
+  void insert(
+      std::uint32_t node,
+      std::mutex* locks,
+      std::mutex* global,
+      impl::hnsw_visited& visited) {
+    auto const lock = [](std::mutex* mutex) {
+      return mutex == nullptr ? std::unique_lock<std::mutex>()
+                              : std::unique_lock<std::mutex>(*mutex);
+    };
+    auto const lock_node = [&](std::uint32_t at) {
+      return lock(locks == nullptr ? nullptr : locks + at);
+    };
+
+    // held throughout by an insertion that becomes the new entry point
+    auto top_lock = lock(global);
+    auto const level = levels_[node];
+    if (entry_ == impl::hnsw_none) {
+      entry_ = node;
+      top_ = level;
+      return;
+    }
+    auto nearest_node = entry_;
+    auto const top = top_;
+    if (level <= top && top_lock.owns_lock()) {
+      top_lock.unlock();
+    }
+
+    auto const between = [this](std::uint32_t a, std::uint32_t b) {
+      return impl::hnsw_distance<T, N>(
+          metric_,
+          vectors_.data() + std::size_t(a) * N,
+          norms_[a],
+          vectors_.data() + std::size_t(b) * N,
+          norms_[b]);
+    };
+    auto const distance = [&](std::uint32_t other) {
+      return between(node, other);
+    };
+    auto scratch =
+        std::vector<std::uint32_t>(impl::hnsw_slot(parameters_.m, 0));
+    auto const links_on = [&](std::size_t on) {
+      return [&, on](std::uint32_t at, auto const& f) {
+        {
+          auto const held = lock_node(at);
+          auto const slot = links(at, on);
+          std::copy_n(slot, slot[0] + 1, scratch.begin());
+        }
+        for (std::uint32_t idx = 1; idx <= scratch[0]; ++idx) {
+          f(scratch[idx]);
+        }
+      };
+    };
+
+    auto nearest = distance(nearest_node);
+    for (auto on = top; on > level; --on) {
+      nearest_node =
+          impl::hnsw_greedy(nearest_node, nearest, distance, links_on(on));
+    }
+    auto kept = std::vector<std::uint32_t>();
+    auto pruned = std::vector<std::uint32_t>();
+    auto candidates = std::vector<std::pair<T, std::uint32_t>>();
+    for (auto on = std::size_t(std::min(level, top)) + 1; on-- > 0;) {
+      visited.clear(size());
+      auto found = impl::hnsw_search_layer(
+          nearest_node,
+          nearest,
+          parameters_.ef_construction,
+          distance,
+          links_on(on),
+          visited);
+      std::sort(found.begin(), found.end());
+      nearest = found[0].first;
+      nearest_node = found[0].second;
+      impl::hnsw_select(found, parameters_.m, between, kept);
+      {
+        auto const held = lock_node(node);
+        auto const slot = links(node, on);
+        slot[0] = std::uint32_t(kept.size());
+        std::copy(kept.begin(), kept.end(), slot + 1);
+      }
+
+      // and back, from each of those; a full slot keeps the best of its
+      // links and this one, chosen the same way
+      auto const most = impl::hnsw_slot(parameters_.m, on) - 1;
+      for (auto const other : kept) {
+        auto const held = lock_node(other);
+        auto const slot = links(other, on);
+        if (slot[0] < most) {
+          slot[++slot[0]] = node;
+          continue;
+        }
+        candidates.clear();
+        for (std::uint32_t idx = 1; idx <= slot[0]; ++idx) {
+          candidates.emplace_back(between(other, slot[idx]), slot[idx]);
+        }
+        candidates.emplace_back(between(other, node), node);
+        std::sort(candidates.begin(), candidates.end());
+        impl::hnsw_select(candidates, most, between, pruned);
+        slot[0] = std::uint32_t(pruned.size());
+        std::copy(pruned.begin(), pruned.end(), slot + 1);
+      }
+    }
+    if (level > top) {
+      entry_ = node;
+      top_ = level;
+    }
+  }
+
+public:
+  using value_type = T;
+  static constexpr std::size_t dimension = N;
+
+  explicit hnsw_index(
+      metric which = metric::squared_euclidean,
+      hnsw_parameters parameters = {})
+      : metric_(which), parameters_(parameters) {
+    parameters_.m = std::max<std::size_t>(parameters_.m, 2);
+  }
+  // builds on kernels::thread_count() threads
+  hnsw_index(
+      metric which,
+      vector<T, N> const* vs,
+      std::size_t count,
+      hnsw_parameters parameters = {})
+      : hnsw_index(which, parameters) {
+    vectors_.reserve(count * N);
+    for (std::size_t idx = 0; idx < count; ++idx) {
+      append(vs[idx]);
+    }
+    if (count == 0) {
+      return;
+    }
+
+    auto& visited = impl::hnsw_visited::here();
+    insert(0, nullptr, nullptr, visited);
+    auto next = std::atomic<std::size_t>(1);
+    auto locks = std::make_unique<std::mutex[]>(count);
+    auto global = std::mutex();
+    impl::hnsw_threads(std::min(kernels::thread_count(), count - 1), [&] {
+      auto& visited = impl::hnsw_visited::here();
+      for (auto node = next++; node < count; node = next++) {
+        insert(std::uint32_t(node), locks.get(), &global, visited);
+      }
+    });
+  }
+  // a copy of the graph, which can then be added to
+  explicit hnsw_index(hnsw_graph<T, N> const& graph)
+      : metric_(graph.metric_),
+        parameters_(graph.parameters_),
+        vectors_(graph.vectors_, graph.vectors_ + graph.size_ * N),
+        norms_(graph.norms_, graph.norms_ + graph.size_),
+        levels_(graph.levels_, graph.levels_ + graph.size_),
+        bottom_(
+            graph.bottom_,
+            graph.bottom_ + graph.size_ * impl::hnsw_slot(parameters_.m, 0)),
+        offsets_(graph.offsets_, graph.offsets_ + graph.size_ + 1),
+        upper_(graph.upper_, graph.upper_ + graph.upper_size_),
+        entry_(graph.entry_),
+        top_(graph.top_) {}
+
+  // std::nullopt if the file can't be read, or isn't a valid saved
+  // hnsw_index<T, N>
+  static std::optional<hnsw_index> load(std::string const& path) {
+    auto file = std::ifstream(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+      return std::nullopt;
+    }
+    auto const length = std::size_t(file.tellg());
+    // aligned to 64 bytes, like a mapped file
+    auto bytes = std::make_unique<unsigned char[]>(length + 64);
+    auto const base = bytes.get() +
+        (64 - reinterpret_cast<std::uintptr_t>(bytes.get()) % 64) % 64;
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(base), std::streamsize(length))) {
+      return std::nullopt;
+    }
+    auto const graph = hnsw_graph<T, N>::from_bytes(base, length);
+    if (!graph || !graph->valid()) {
+      return std::nullopt;
+    }
+    return hnsw_index(*graph);
+  }
+
+  metric which() const noexcept { return metric_; }
+  hnsw_parameters const& parameters() const noexcept { return parameters_; }
+  void set_ef_search(std::size_t ef) noexcept { parameters_.ef_search = ef; }
+  std::size_t size() const noexcept { return levels_.size(); }
+
+  // the vectors, as the rows of a size() x N matrix; normalized, for
+  // cosines
+  T const* data() const noexcept { return vectors_.data(); }
+
+  // a view of the index, valid until it's next changed
+  hnsw_graph<T, N> graph() const noexcept {
+    auto ret = hnsw_graph<T, N>();
+    ret.metric_ = metric_;
+    ret.parameters_ = parameters_;
+    ret.size_ = size();
+    ret.upper_size_ = upper_.size();
+    ret.entry_ = entry_;
+    ret.top_ = top_;
+    ret.vectors_ = vectors_.data();
+    ret.norms_ = norms_.data();
+    ret.levels_ = levels_.data();
+    ret.bottom_ = bottom_.data();
+    ret.offsets_ = offsets_.data();
+    ret.upper_ = upper_.data();
+    return ret;
+  }
+
+  // returns the index of v
+  std::size_t add(vector<T, N> const& v) {
+    auto const node = append(v);
+    auto& visited = impl::hnsw_visited::here();
+    insert(node, nullptr, nullptr, visited);
+    return node;
+  }
+
+  // about the k nearest to query; indices and values each hold k
+  void search(
+      vector<T, N> const& query,
+      std::size_t k,
+      std::size_t* indices,
+      T* values) const noexcept {
+    graph().search(query, k, indices, values);
+  }
+
+  // ...and to each of `count` queries, k to a query, on
+  // kernels::thread_count() threads
+  void search(
+      vector<T, N> const* queries,
+      std::size_t count,
+      std::size_t k,
+      std::size_t* indices,
+      T* values) const noexcept {
+    graph().search(queries, count, k, indices, values);
+  }
+
+  // in the format hnsw_graph::from_bytes reads; false if the file can't be
+  // written
+  bool save(std::string const& path) const { return graph().save(path); }
+};
+
+struct pq_parameters {
+  // for each subspace; at most 256, so that a code is a byte
+  std::size_t centroids = 256;
+  // the most rounds of k-means, for each subspace
+  std::size_t iterations = 25;
+  std::uint64_t seed = 0;
+};
+
+// codes a vector as M bytes: for each of its M pieces of N / M elements,
+// the nearest centroid of that piece's subspace
+template <typename T, std::size_t N, std::size_t M>
+class product_quantizer {
+  static_assert(
+      impl::is_dispatched_v<T>,
+      "product quantization is only implemented for float and double");
+  static_assert(M != 0 && N % M == 0, "M must divide N");
+
+  std::size_t centroids_ = 0;
+  // one codebook after another, each centroids() x subdimension
+  std::vector<T> codebooks_;
+
+public:
+  using value_type = T;
+  static constexpr std::size_t dimension = N;
+  static constexpr std::size_t subspaces = M;
+  static constexpr std::size_t subdimension = N / M;
+
+  // untrained; nothing can be coded until it's replaced by one that is
+  product_quantizer() = default;
+  // trained on `count` vectors, by kernels::kmeans in each subspace
+  product_quantizer(
+      vector<T, N> const* vs,
+      std::size_t count,
+      pq_parameters parameters = {})
+      : centroids_(std::clamp<std::size_t>(parameters.centroids, 1, 256)),
+        codebooks_(M * centroids_ * subdimension) {
+    auto const packed = impl::pack_vectors(vs, count);
+    for (std::size_t s = 0; s < M; ++s) {
+      kernels::kmeans(
+          count,
+          subdimension,
+          packed.data() + s * subdimension,
+          N,
+          centroids_,
+          parameters.iterations,
+          parameters.seed + s,
+          codebooks_.data() + s * centroids_ * subdimension);
+    }
+  }
+
+  bool trained() const noexcept { return centroids_ != 0; }
+  std::size_t centroids() const noexcept { return centroids_; }
+
+  // subspace s's centroids, as the rows of a centroids() x subdimension
+  // matrix
+  T const* codebook(std::size_t s) const noexcept {
+    return codebooks_.data() + s * centroids_ * subdimension;
+  }
+
+  // M bytes to each of `count` vectors
+  void encode(
+      vector<T, N> const* vs,
+      std::size_t count,
+      std::uint8_t* codes) const noexcept {
+    auto const packed = impl::pack_vectors(vs, count);
+    auto nearest = std::vector<std::size_t>(count);
+    auto distances = std::vector<T>(count);
+    for (std::size_t s = 0; s < M; ++s) {
+      kernels::pairwise_top_k(
+          metric::squared_euclidean,
+          count,
+          centroids_,
+          subdimension,
+          packed.data() + s * subdimension,
+          N,
+          codebook(s),
+          subdimension,
+          1,
+          nearest.data(),
+          distances.data());
+      for (std::size_t idx = 0; idx < count; ++idx) {
+        codes[idx * M + s] = std::uint8_t(nearest[idx]);
+      }
+    }
+  }
+
+  // the centroids the codes stand for
+  void decode(
+      std::uint8_t const* codes,
+      std::size_t count,
+      vector<T, N>* out) const noexcept {
+    for (std::size_t idx = 0; idx < count; ++idx) {
+      for (std::size_t s = 0; s < M; ++s) {
+        std::copy_n(
+            codebook(s) + codes[idx * M + s] * subdimension,
+            subdimension,
+            out[idx].begin() + s * subdimension);
+      }
+    }
+  }
+
+  // the query's table, M x centroids(): what each centroid adds to the
+  // metric with the query. That's its squared distance from the query's
+  // piece for squared_euclidean, and its inner product with it otherwise
+  // (so, for cosines, the query and the coded vectors should have been
+  // normalized)
+  void table(metric which, vector<T, N> const& query, T* out) const
+      noexcept {
+    auto const piece_metric = which == metric::squared_euclidean
+        ? metric::squared_euclidean
+        : metric::inner_product;
+    for (std::size_t s = 0; s < M; ++s) {
+      kernels::pairwise(
+          piece_metric,
+          1,
+          centroids_,
+          subdimension,
+          query.data() + s * subdimension,
+          N,
+          codebook(s),
+          subdimension,
+          out + s * centroids_,
+          centroids_);
+    }
+  }
+
+  // the metric between the query whose table this is and each of `count`
+  // coded vectors, as decoded
+  void scan(
+      T const* query_table,
+      std::uint8_t const* codes,
+      std::size_t count,
+      T* out) const noexcept {
+    kernels::adc_scan(count, M, centroids_, codes, query_table, out);
+  }
+};
+
+template <typename T, std::size_t N, std::size_t M>
+class pq_index {
+  metric metric_;
+  product_quantizer<T, N, M> quantizer_;
+  // M bytes to a vector
+  std::vector<std::uint8_t> codes_;
+  // added while there was no trained quantizer to code them with; train()
+  // codes them
+  std::vector<vector<T, N>> pending_;
+
+  // the most vectors add() codes at once
+  static constexpr std::size_t add_rows = 1024;
+
+  // normalized, for cosines
+  vector<T, N> prepared(vector<T, N> v) const noexcept {
+    if (metric_ == metric::cosine) {
+      auto const squared = kernels::dot(v.data(), v.data(), N);
+      if (squared > T(0)) {
+        kernels::scal(T(1) / std::sqrt(squared), v.data(), N);
+      }
+    }
+    return v;
+  }
+
+  void train_on(
+      vector<T, N> const* vs,
+      std::size_t count,
+      pq_parameters parameters) {
+    if (metric_ != metric::cosine) {
+      quantizer_ = product_quantizer<T, N, M>(vs, count, parameters);
+    } else {
+      auto inputs = std::vector<vector<T, N>>(count, list_init);
+      for (std::size_t idx = 0; idx < count; ++idx) {
+        inputs[idx] = prepared(vs[idx]);
+      }
+      quantizer_ =
+          product_quantizer<T, N, M>(inputs.data(), count, parameters);
+    }
+  }
+
+public:
+  using value_type = T;
+  static constexpr std::size_t dimension = N;
+  static constexpr std::size_t subspaces = M;
+
+  // with a quantizer, trained or not. The vectors added while it isn't
+  // are kept as they are, and can't be found until train() codes them
+  pq_index(metric which, product_quantizer<T, N, M> quantizer)
+      : metric_(which), quantizer_(std::move(quantizer)) {}
+  // trains the quantizer on vs, then adds them
+  pq_index(
+      metric which,
+      vector<T, N> const* vs,
+      std::size_t count,
+      pq_parameters parameters = {})
+      : metric_(which) {
+    train_on(vs, count, parameters);
+    add(vs, count);
+  }
+
+  metric which() const noexcept { return metric_; }
+  product_quantizer<T, N, M> const& quantizer() const noexcept {
+    return quantizer_;
+  }
+  // the vectors that have been coded, and so can be found
+  std::size_t size() const noexcept { return codes_.size() / M; }
+  // those waiting for train()
+  std::size_t pending() const noexcept { return pending_.size(); }
+
+  // the codes, M bytes to a vector, in the order they were added
+  std::uint8_t const* codes() const noexcept { return codes_.data(); }
+
+  // returns the index of v, which it has once it's coded
+  std::size_t add(vector<T, N> const& v) {
+    auto const ret = size() + pending();
+    add(&v, 1);
+    return ret;
+  }
+  // ...and of each of `count` vectors, from the first one's on; they're
+  // coded add_rows at a time, so that what's copied along the way stays
+  // small however many there are
+  std::size_t add(vector<T, N> const* vs, std::size_t count) {
+    auto const ret = size() + pending();
+    if (!quantizer_.trained()) {
+      pending_.insert(pending_.end(), vs, vs + count);
+      return ret;
+    }
+    codes_.resize(codes_.size() + count * M);
+    auto inputs = std::vector<vector<T, N>>();
+    if (metric_ == metric::cosine) {
+      inputs.resize(std::min(count, add_rows), list_init);
+    }
+    for (std::size_t first = 0; first < count; first += add_rows) {
+      auto const rows = std::min(add_rows, count - first);
+      auto chunk = vs + first;
+      if (metric_ == metric::cosine) {
+        for (std::size_t idx = 0; idx < rows; ++idx) {
+          inputs[idx] = prepared(chunk[idx]);
+        }
+        chunk = inputs.data();
+      }
+      quantizer_.encode(chunk, rows, codes_.data() + (ret + first) * M);
+    }
+    return ret;
+  }
+
+  // with an untrained quantizer, trains one on the vectors added so far
+  // and codes them; with a trained one, or nothing added, does nothing
+  void train(pq_parameters parameters = {}) {
+    if (quantizer_.trained() || pending_.empty()) {
+      return;
+    }
+    auto const vs = std::move(pending_);
+    pending_.clear();
+    train_on(vs.data(), vs.size(), parameters);
+    add(vs.data(), vs.size());
+  }
+
+  // about the k nearest to query, and the metric with their decoded
+  // vectors; indices and values each hold k
+  void search(
+      vector<T, N> const& query,
+      std::size_t k,
+      std::size_t* indices,
+      T* values) const noexcept {
+    search(&query, 1, k, indices, values);
+  }
+
+  // ...and to each of `count` queries, k to a query
+  void search(
+      vector<T, N> const* queries,
+      std::size_t count,
+      std::size_t k,
+      std::size_t* indices,
+      T* values) const noexcept {
+    if (!quantizer_.trained()) {
+      for (std::size_t query = 0; query < count; ++query) {
+        impl::top_k_finish<T>(
+            nullptr,
+            0,
+            k,
+            impl::larger_is_nearer(metric_),
+            size(),
+            indices + query * k,
+            values + query * k);
+      }
+      return;
+    }
+    auto const table_size = M * quantizer_.centroids();
+    auto tables = std::vector<T>(count * table_size);
+    for (std::size_t query = 0; query < count; ++query) {
+      quantizer_.table(
+          metric_,
+          prepared(queries[query]),
+          tables.data() + query * table_size);
+    }
+    kernels::adc_top_k(
+        metric_,
+        size(),
+        M,
+        quantizer_.centroids(),
+        codes_.data(),
+        count,
+        tables.data(),
+        k,
+        indices,
+        values);
+  }
+};
+
+} // namespace algae
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <limits>
+#include <type_traits>
+
+/*
+  what plus and times mean in products: value_type, zero(), one(),
+  plus(a, b) and times(a, b). Passed as an empty last argument.
+*/
+
+namespace algae {
+
+template <typename T>
+struct plus_times {
+  using value_type = T;
+
+  static constexpr T zero() { return T(0); }
+  static constexpr T one() { return T(1); }
+  static constexpr T plus(T const& a, T const& b) { return a + b; }
+  static constexpr T times(T const& a, T const& b) { return a * b; }
+};
+
+namespace impl {
+
+// a + b for integers, held at the largest or lowest value instead of
+// overflowing
+template <typename T>
+constexpr T saturating_add(T const& a, T const& b) {
+  T sum{};
+  if (__builtin_add_overflow(a, b, &sum)) {
+    return b > T(0) ? std::numeric_limits<T>::max()
+                    : std::numeric_limits<T>::lowest();
+  }
+  return sum;
+}
+
+} // namespace impl
+
+// the tropical semiring; zero() is infinity, or for integers the largest
+// value, which times() treats as infinite too. Integer sums that would
+// overflow stop at the largest or lowest value instead
+template <typename T>
+struct min_plus {
+  using value_type = T;
+
+  static constexpr T zero() {
+    if constexpr (std::numeric_limits<T>::has_infinity) {
+      return std::numeric_limits<T>::infinity();
+    } else {
+      return std::numeric_limits<T>::max();
+    }
+  }
+  static constexpr T one() { return T(0); }
+  static constexpr T plus(T const& a, T const& b) { return b < a ? b : a; }
+  static constexpr T times(T const& a, T const& b) {
+    if constexpr (std::numeric_limits<T>::has_infinity) {
+      return a + b;
+    } else {
+      return a == zero() || b == zero() ? zero()
+                                        : impl::saturating_add(a, b);
+    }
+  }
+};
+
+// the other tropical semiring; longest paths. As above, but with minus
+// infinity, or the lowest value
+template <typename T>
+struct max_plus {
+  using value_type = T;
+
+  static constexpr T zero() {
+    if constexpr (std::numeric_limits<T>::has_infinity) {
+      return -std::numeric_limits<T>::infinity();
+    } else {
+      return std::numeric_limits<T>::lowest();
+    }
+  }
+  static constexpr T one() { return T(0); }
+  static constexpr T plus(T const& a, T const& b) { return a < b ? b : a; }
+  static constexpr T times(T const& a, T const& b) {
+    if constexpr (std::numeric_limits<T>::has_infinity) {
+      return a + b;
+    } else {
+      return a == zero() || b == zero() ? zero()
+                                        : impl::saturating_add(a, b);
+    }
+  }
+};
+
+// for non-negative values, like probabilities
+template <typename T>
+struct max_times {
+  using value_type = T;
+
+  static constexpr T zero() { return T(0); }
+  static constexpr T one() { return T(1); }
+  static constexpr T plus(T const& a, T const& b) { return a < b ? b : a; }
+  static constexpr T times(T const& a, T const& b) { return a * b; }
+};
+
+// the boolean semiring
+struct or_and {
+  using value_type = bool;
+
+  static constexpr bool zero() { return false; }
+  static constexpr bool one() { return true; }
+  static constexpr bool plus(bool a, bool b) { return a || b; }
+  static constexpr bool times(bool a, bool b) { return a && b; }
+};
+
+// GF(2), the integers mod 2
+struct xor_and {
+  using value_type = bool;
+
+  static constexpr bool zero() { return false; }
+  static constexpr bool one() { return true; }
+  static constexpr bool plus(bool a, bool b) { return a != b; }
+  static constexpr bool times(bool a, bool b) { return a && b; }
+};
+
+} // namespace algae
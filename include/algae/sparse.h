@@ -0,0 +1,399 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <algae/implementation/sparse.h>
+#include <algae/matrix.h>
+#include <algae/view.h>
+
+/*
+  sparse matrices in compressed sparse row form, sorted by column, and
+  block sparse rows with dense B x B blocks. Shapes are run-time; the
+  parallel products are in algae/kernels.h.
+*/
+
+namespace algae {
+
+template <typename T>
+class csr_matrix {
+  std::size_t height_;
+  std::size_t width_;
+  std::vector<std::size_t> row_offsets_;
+  std::vector<std::size_t> columns_;
+  std::vector<T> values_;
+
+public:
+  using value_type = T;
+
+  csr_matrix() : csr_matrix(0, 0) {}
+
+  // all zeroes
+  csr_matrix(std::size_t height, std::size_t width)
+      : height_(height), width_(width), row_offsets_(height + 1, 0) {}
+
+  // row_offsets must have height + 1 elements, starting at zero; the
+  // columns of each row must be sorted, with no repeats
+  csr_matrix(
+      std::size_t height,
+      std::size_t width,
+      std::vector<std::size_t> row_offsets,
+      std::vector<std::size_t> columns,
+      std::vector<T> values)
+      : height_(height),
+        width_(width),
+        row_offsets_(std::move(row_offsets)),
+        columns_(std::move(columns)),
+        values_(std::move(values)) {}
+
+  // keeps the elements that aren't zero
+  template <std::size_t H, std::size_t W, typename Layout>
+  explicit csr_matrix(matrix<T, H, W, Layout> const& m)
+      : csr_matrix(H, W) {
+    for (std::size_t row = 0; row < H; ++row) {
+      for (std::size_t col = 0; col < W; ++col) {
+        if (!(m(row, col) == T(0))) {
+          columns_.push_back(col);
+          values_.push_back(m(row, col));
+        }
+      }
+      row_offsets_[row + 1] = columns_.size();
+    }
+  }
+
+  std::size_t height() const noexcept { return height_; }
+  std::size_t width() const noexcept { return width_; }
+  std::size_t nonzeros() const noexcept { return columns_.size(); }
+
+  std::vector<std::size_t> const& row_offsets() const noexcept {
+    return row_offsets_;
+  }
+  std::vector<std::size_t> const& columns() const noexcept {
+    return columns_;
+  }
+  // the pattern is fixed, but the values can change
+  std::vector<T>& values() noexcept { return values_; }
+  std::vector<T> const& values() const noexcept { return values_; }
+
+  // zero for the elements that aren't stored
+  T operator()(std::size_t row, std::size_t col) const {
+    auto const begin = columns_.begin() + row_offsets_[row];
+    auto const end = columns_.begin() + row_offsets_[row + 1];
+    auto const found = std::lower_bound(begin, end, col);
+    if (found == end || *found != col) {
+      return T(0);
+    }
+    return values_[found - columns_.begin()];
+  }
+};
+
+// the pattern of a * b, with all of its values zero; a.width() must be
+// b.height()
+template <typename T>
+csr_matrix<T>
+multiply_symbolic(csr_matrix<T> const& a, csr_matrix<T> const& b) {
+  auto offsets = std::vector<std::size_t>(a.height() + 1, 0);
+  impl::spgemm_count(
+      b.width(),
+      a.row_offsets().data(),
+      a.columns().data(),
+      b.row_offsets().data(),
+      b.columns().data(),
+      offsets.data(),
+      0,
+      a.height());
+  for (std::size_t row = 0; row < a.height(); ++row) {
+    offsets[row + 1] += offsets[row];
+  }
+
+  auto columns = std::vector<std::size_t>(offsets.back());
+  impl::spgemm_columns(
+      b.width(),
+      a.row_offsets().data(),
+      a.columns().data(),
+      b.row_offsets().data(),
+      b.columns().data(),
+      offsets.data(),
+      columns.data(),
+      0,
+      a.height());
+
+  auto values = std::vector<T>(columns.size(), T(0));
+  return csr_matrix<T>(
+      a.height(),
+      b.width(),
+      std::move(offsets),
+      std::move(columns),
+      std::move(values));
+}
+
+// fills in the values of c = a * b; c must have the pattern that
+// multiply_symbolic(a, b) gave, though a and b may have new values
+template <typename T>
+void multiply_numeric(
+    csr_matrix<T> const& a, csr_matrix<T> const& b, csr_matrix<T>& c) {
+  impl::spgemm_numeric(
+      b.width(),
+      a.row_offsets().data(),
+      a.columns().data(),
+      a.values().data(),
+      b.row_offsets().data(),
+      b.columns().data(),
+      b.values().data(),
+      c.row_offsets().data(),
+      c.columns().data(),
+      c.values().data(),
+      0,
+      a.height());
+}
+
+template <typename T>
+csr_matrix<T> multiply(csr_matrix<T> const& a, csr_matrix<T> const& b) {
+  auto ret = algae::multiply_symbolic(a, b);
+  algae::multiply_numeric(a, b, ret);
+  return ret;
+}
+
+// out = a * b, for sparse a and dense b; shapes that disagree leave out
+// as it was
+template <
+    typename T,
+    typename B,
+    std::size_t K,
+    std::size_t N,
+    typename C,
+    std::size_t M,
+    std::size_t N2>
+void multiply(
+    csr_matrix<T> const& a,
+    matrix_view<B, K, N> b,
+    matrix_view<C, M, N2> out) {
+  static_assert(impl::extents_match(N, N2), "out must be as wide as b");
+  if (a.width() != b.height() || a.height() != out.height() ||
+      b.width() != out.width()) {
+    return;
+  }
+  impl::spmm(
+      a.row_offsets().data(),
+      a.columns().data(),
+      a.values().data(),
+      b,
+      out,
+      0,
+      a.height());
+}
+
+template <typename T, std::size_t B>
+class bsr_matrix {
+  std::size_t block_height_;
+  std::size_t block_width_;
+  std::vector<std::size_t> row_offsets_;
+  std::vector<std::size_t> columns_;
+  std::vector<matrix<T, B, B>> blocks_;
+
+public:
+  using value_type = T;
+  using block_type = matrix<T, B, B>;
+
+  static constexpr std::size_t block_size = B;
+
+  bsr_matrix() : bsr_matrix(0, 0) {}
+
+  // all zeroes; the sizes are in blocks
+  bsr_matrix(std::size_t block_height, std::size_t block_width)
+      : block_height_(block_height),
+        block_width_(block_width),
+        row_offsets_(block_height + 1, 0) {}
+
+  // like csr_matrix, but the offsets and columns count blocks
+  bsr_matrix(
+      std::size_t block_height,
+      std::size_t block_width,
+      std::vector<std::size_t> row_offsets,
+      std::vector<std::size_t> columns,
+      std::vector<block_type> blocks)
+      : block_height_(block_height),
+        block_width_(block_width),
+        row_offsets_(std::move(row_offsets)),
+        columns_(std::move(columns)),
+        blocks_(std::move(blocks)) {}
+
+  // keeps the blocks that aren't all zeroes
+  template <std::size_t H, std::size_t W, typename Layout>
+  explicit bsr_matrix(matrix<T, H, W, Layout> const& m)
+      : bsr_matrix(H / B, W / B) {
+    static_assert(
+        H % B == 0 && W % B == 0,
+        "the matrix must be a whole number of blocks");
+    for (std::size_t block_row = 0; block_row < H / B; ++block_row) {
+      for (std::size_t block_col = 0; block_col < W / B; ++block_col) {
+        auto block = block_type();
+        auto is_zero = true;
+        for (std::size_t r = 0; r < B; ++r) {
+          for (std::size_t q = 0; q < B; ++q) {
+            block(r, q) = m(block_row * B + r, block_col * B + q);
+            is_zero = is_zero && block(r, q) == T(0);
+          }
+        }
+        if (!is_zero) {
+          columns_.push_back(block_col);
+          blocks_.push_back(block);
+        }
+      }
+      row_offsets_[block_row + 1] = columns_.size();
+    }
+  }
+
+  std::size_t height() const noexcept { return block_height_ * B; }
+  std::size_t width() const noexcept { return block_width_ * B; }
+  std::size_t block_height() const noexcept { return block_height_; }
+  std::size_t block_width() const noexcept { return block_width_; }
+  std::size_t nonzero_blocks() const noexcept { return columns_.size(); }
+
+  std::vector<std::size_t> const& row_offsets() const noexcept {
+    return row_offsets_;
+  }
+  std::vector<std::size_t> const& columns() const noexcept {
+    return columns_;
+  }
+  // the pattern is fixed, but the blocks can change
+  std::vector<block_type>& blocks() noexcept { return blocks_; }
+  std::vector<block_type> const& blocks() const noexcept { return blocks_; }
+
+  // the stored block at (block_row, block_col), or nullptr if it's zero
+  block_type const*
+  find_block(std::size_t block_row, std::size_t block_col) const {
+    auto const begin = columns_.begin() + row_offsets_[block_row];
+    auto const end = columns_.begin() + row_offsets_[block_row + 1];
+    auto const found = std::lower_bound(begin, end, block_col);
+    if (found == end || *found != block_col) {
+      return nullptr;
+    }
+    return &blocks_[found - columns_.begin()];
+  }
+
+  // zero for the elements that aren't stored
+  T operator()(std::size_t row, std::size_t col) const {
+    auto const block = find_block(row / B, col / B);
+    return block ? (*block)(row % B, col % B) : T(0);
+  }
+};
+
+// out = a * x; out can't overlap x, and is left as it was if either isn't
+// a's size
+template <
+    typename T,
+    std::size_t B,
+    typename X,
+    std::size_t N,
+    typename Y,
+    std::size_t M>
+void multiply(
+    bsr_matrix<T, B> const& a, vector_view<X, N> x, vector_view<Y, M> out) {
+  if (x.size() != a.width() || out.size() != a.height()) {
+    return;
+  }
+  impl::bsr_spmv<B>(
+      a.row_offsets().data(),
+      a.columns().data(),
+      a.blocks().data(),
+      x,
+      out,
+      0,
+      a.block_height());
+}
+
+// out = a * b, for block sparse a and dense b; shapes that disagree leave
+// out as it was
+template <
+    typename T,
+    std::size_t B,
+    typename Bm,
+    std::size_t K,
+    std::size_t N,
+    typename C,
+    std::size_t M,
+    std::size_t N2>
+void multiply(
+    bsr_matrix<T, B> const& a,
+    matrix_view<Bm, K, N> b,
+    matrix_view<C, M, N2> out) {
+  static_assert(impl::extents_match(N, N2), "out must be as wide as b");
+  if (a.width() != b.height() || a.height() != out.height() ||
+      b.width() != out.width()) {
+    return;
+  }
+  impl::bsr_spmm<B>(
+      a.row_offsets().data(),
+      a.columns().data(),
+      a.blocks().data(),
+      b,
+      out,
+      0,
+      a.block_height());
+}
+
+// the inverses of the diagonal blocks of a square bsr_matrix; a
+// preconditioner, applied with multiply
+template <typename T, std::size_t B>
+class block_jacobi_preconditioner {
+  std::vector<matrix<T, B, B>> inverses_;
+
+public:
+  explicit block_jacobi_preconditioner(std::vector<matrix<T, B, B>> inverses)
+      : inverses_(std::move(inverses)) {}
+
+  std::size_t height() const noexcept { return inverses_.size() * B; }
+  std::size_t width() const noexcept { return inverses_.size() * B; }
+  std::vector<matrix<T, B, B>> const& inverses() const noexcept {
+    return inverses_;
+  }
+};
+
+// std::nullopt if any diagonal block is missing, or singular
+template <typename T, std::size_t B>
+std::optional<block_jacobi_preconditioner<T, B>>
+block_jacobi(bsr_matrix<T, B> const& a) {
+  auto inverses = std::vector<matrix<T, B, B>>(a.block_height());
+  for (std::size_t idx = 0; idx < a.block_height(); ++idx) {
+    auto const block = a.find_block(idx, idx);
+    if (!block || !impl::invert_block<B>(block->data(), inverses[idx].data())) {
+      return std::nullopt;
+    }
+  }
+  return block_jacobi_preconditioner<T, B>(std::move(inverses));
+}
+
+// out = m^-1 * r, a block at a time; left as it was if r or out isn't m's
+// size
+template <
+    typename T,
+    std::size_t B,
+    typename R,
+    std::size_t N,
+    typename Z,
+    std::size_t M>
+void multiply(
+    block_jacobi_preconditioner<T, B> const& m,
+    vector_view<R, N> r,
+    vector_view<Z, M> out) {
+  if (r.size() != m.width() || out.size() != m.height()) {
+    return;
+  }
+  for (std::size_t idx = 0; idx < m.inverses().size(); ++idx) {
+    T rs[B];
+    T acc[B] = {};
+    for (std::size_t q = 0; q < B; ++q) {
+      rs[q] = r[idx * B + q];
+    }
+    impl::bsr_block_multiply_add<B>(m.inverses()[idx].data(), rs, acc);
+    for (std::size_t q = 0; q < B; ++q) {
+      out[idx * B + q] = acc[q];
+    }
+  }
+}
+
+} // namespace algae
@@ -0,0 +1,373 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <algae/layout.h>
+#include <algae/matrix.h>
+#include <algae/semiring.h>
+#include <algae/vector.h>
+
+/*
+  diagonal, identity and permutation matrices, which keep only what isn't
+  zero, and whose products never build the dense matrix.
+*/
+
+namespace algae {
+
+template <typename T, std::size_t N>
+class diagonal_matrix {
+  vector<T, N> entries_;
+
+public:
+  using value_type = T;
+
+  // all zeroes
+  constexpr diagonal_matrix() : entries_(algae::list_init) {}
+  constexpr explicit diagonal_matrix(vector<T, N> const& entries)
+      : entries_(entries) {}
+
+  static constexpr std::size_t height() noexcept { return N; }
+  static constexpr std::size_t width() noexcept { return N; }
+
+  // the entries on the diagonal
+  constexpr vector<T, N>& entries() noexcept { return entries_; }
+  constexpr vector<T, N> const& entries() const noexcept { return entries_; }
+  constexpr T& operator[](std::size_t idx) { return entries_[idx]; }
+  constexpr T const& operator[](std::size_t idx) const {
+    return entries_[idx];
+  }
+
+  // zero off the diagonal
+  constexpr T operator()(std::size_t row, std::size_t col) const {
+    return row == col ? entries_[row] : T();
+  }
+
+  template <typename Layout = row_major>
+  constexpr matrix<T, N, N, Layout> dense() const {
+    auto ret = matrix<T, N, N, Layout>();
+    for (std::size_t idx = 0; idx < N; ++idx) {
+      ret(idx, idx) = entries_[idx];
+    }
+    return ret;
+  }
+};
+
+template <typename T, std::size_t N>
+class identity_matrix {
+public:
+  using value_type = T;
+
+  static constexpr std::size_t height() noexcept { return N; }
+  static constexpr std::size_t width() noexcept { return N; }
+
+  constexpr T operator()(std::size_t row, std::size_t col) const {
+    return row == col ? T(1) : T(0);
+  }
+
+  template <typename Layout = row_major>
+  constexpr matrix<T, N, N, Layout> dense() const {
+    auto ret = matrix<T, N, N, Layout>();
+    for (std::size_t idx = 0; idx < N; ++idx) {
+      ret(idx, idx) = T(1);
+    }
+    return ret;
+  }
+};
+
+// P * m is m with its rows reordered; row i of P * m is row p[i] of m, and
+// so P has its one in column p[i] of row i
+template <std::size_t N>
+class permutation {
+  std::array<std::size_t, N> image_;
+
+public:
+  // the identity
+  constexpr permutation() : image_{} {
+    for (std::size_t idx = 0; idx < N; ++idx) {
+      image_[idx] = idx;
+    }
+  }
+  // image must hold each of 0 through N - 1 exactly once
+  constexpr explicit permutation(std::array<std::size_t, N> const& image)
+      : image_(image) {}
+
+  static constexpr std::size_t height() noexcept { return N; }
+  static constexpr std::size_t width() noexcept { return N; }
+
+  constexpr std::array<std::size_t, N> const& image() const noexcept {
+    return image_;
+  }
+  constexpr std::size_t operator[](std::size_t idx) const {
+    return image_[idx];
+  }
+  constexpr bool operator()(std::size_t row, std::size_t col) const {
+    return image_[row] == col;
+  }
+
+  // swaps rows i and j of whatever this is applied to next; a row
+  // exchange, as pivoting does
+  constexpr void swap(std::size_t i, std::size_t j) {
+    auto const tmp = image_[i];
+    image_[i] = image_[j];
+    image_[j] = tmp;
+  }
+
+  constexpr permutation inverse() const {
+    auto ret = permutation();
+    for (std::size_t idx = 0; idx < N; ++idx) {
+      ret.image_[image_[idx]] = idx;
+    }
+    return ret;
+  }
+
+  // the determinant; 1 for an even permutation, -1 for an odd one
+  constexpr int sign() const {
+    auto seen = std::array<bool, N>{};
+    auto ret = 1;
+    for (std::size_t start = 0; start < N; ++start) {
+      if (seen[start]) {
+        continue;
+      }
+      // a cycle of length k is k - 1 transpositions
+      seen[start] = true;
+      for (auto idx = image_[start]; idx != start; idx = image_[idx]) {
+        seen[idx] = true;
+        ret = -ret;
+      }
+    }
+    return ret;
+  }
+
+  template <typename T, typename Layout = row_major>
+  constexpr matrix<T, N, N, Layout> dense() const {
+    auto ret = matrix<T, N, N, Layout>();
+    for (std::size_t idx = 0; idx < N; ++idx) {
+      ret(idx, image_[idx]) = T(1);
+    }
+    return ret;
+  }
+};
+
+template <std::size_t N>
+constexpr bool
+operator==(permutation<N> const& lhs, permutation<N> const& rhs) {
+  for (std::size_t idx = 0; idx < N; ++idx) {
+    if (lhs[idx] != rhs[idx]) {
+      return false;
+    }
+  }
+  return true;
+}
+template <std::size_t N>
+constexpr bool
+operator!=(permutation<N> const& lhs, permutation<N> const& rhs) {
+  return !(lhs == rhs);
+}
+
+template <typename T, std::size_t N>
+constexpr bool operator==(
+    diagonal_matrix<T, N> const& lhs, diagonal_matrix<T, N> const& rhs) {
+  return lhs.entries() == rhs.entries();
+}
+template <typename T, std::size_t N>
+constexpr bool operator!=(
+    diagonal_matrix<T, N> const& lhs, diagonal_matrix<T, N> const& rhs) {
+  return !(lhs == rhs);
+}
+
+template <typename T, std::size_t N>
+constexpr diagonal_matrix<T, N> transpose(diagonal_matrix<T, N> const& d) {
+  return d;
+}
+template <typename T, std::size_t N>
+constexpr identity_matrix<T, N> transpose(identity_matrix<T, N> i) {
+  return i;
+}
+template <std::size_t N>
+constexpr permutation<N> transpose(permutation<N> const& p) {
+  return p.inverse();
+}
+
+// diagonal products; each entry is multiplied once
+
+template <
+    typename T,
+    std::size_t N,
+    typename Semiring = plus_times<T>>
+constexpr diagonal_matrix<T, N> multiply(
+    diagonal_matrix<T, N> const& lhs,
+    diagonal_matrix<T, N> const& rhs,
+    Semiring = {}) {
+  auto ret = diagonal_matrix<T, N>();
+  for (std::size_t idx = 0; idx < N; ++idx) {
+    ret[idx] = Semiring::times(lhs[idx], rhs[idx]);
+  }
+  return ret;
+}
+
+// d * m scales row i of m by d[i]
+template <
+    typename T,
+    std::size_t N,
+    std::size_t W,
+    typename Layout,
+    typename Semiring = plus_times<T>>
+constexpr matrix<T, N, W, Layout> multiply(
+    diagonal_matrix<T, N> const& d,
+    matrix<T, N, W, Layout> const& m,
+    Semiring = {}) {
+  auto ret = matrix<T, N, W, Layout>();
+  for (std::size_t i = 0; i < N; ++i) {
+    for (std::size_t j = 0; j < W; ++j) {
+      ret(i, j) = Semiring::times(d[i], m(i, j));
+    }
+  }
+  return ret;
+}
+// m * d scales column j of m by d[j]
+template <
+    typename T,
+    std::size_t H,
+    std::size_t N,
+    typename Layout,
+    typename Semiring = plus_times<T>>
+constexpr matrix<T, H, N, Layout> multiply(
+    matrix<T, H, N, Layout> const& m,
+    diagonal_matrix<T, N> const& d,
+    Semiring = {}) {
+  auto ret = matrix<T, H, N, Layout>();
+  for (std::size_t i = 0; i < H; ++i) {
+    for (std::size_t j = 0; j < N; ++j) {
+      ret(i, j) = Semiring::times(m(i, j), d[j]);
+    }
+  }
+  return ret;
+}
+template <typename T, std::size_t N, typename Semiring = plus_times<T>>
+constexpr vector<T, N> multiply(
+    diagonal_matrix<T, N> const& d, vector<T, N> const& x, Semiring = {}) {
+  auto ret = x;
+  for (std::size_t idx = 0; idx < N; ++idx) {
+    ret[idx] = Semiring::times(d[idx], x[idx]);
+  }
+  return ret;
+}
+template <typename T, std::size_t N, typename Semiring = plus_times<T>>
+constexpr vector<T, N> multiply(
+    vector<T, N> const& x, diagonal_matrix<T, N> const& d, Semiring = {}) {
+  auto ret = x;
+  for (std::size_t idx = 0; idx < N; ++idx) {
+    ret[idx] = Semiring::times(x[idx], d[idx]);
+  }
+  return ret;
+}
+
+// identity products are copies
+
+template <
+    typename T,
+    std::size_t N,
+    typename Semiring = plus_times<T>>
+constexpr identity_matrix<T, N>
+multiply(identity_matrix<T, N> lhs, identity_matrix<T, N>, Semiring = {}) {
+  return lhs;
+}
+template <
+    typename T,
+    std::size_t N,
+    std::size_t W,
+    typename Layout,
+    typename Semiring = plus_times<T>>
+constexpr matrix<T, N, W, Layout> multiply(
+    identity_matrix<T, N>, matrix<T, N, W, Layout> const& m, Semiring = {}) {
+  return m;
+}
+template <
+    typename T,
+    std::size_t H,
+    std::size_t N,
+    typename Layout,
+    typename Semiring = plus_times<T>>
+constexpr matrix<T, H, N, Layout> multiply(
+    matrix<T, H, N, Layout> const& m, identity_matrix<T, N>, Semiring = {}) {
+  return m;
+}
+template <typename T, std::size_t N, typename Semiring = plus_times<T>>
+constexpr vector<T, N>
+multiply(identity_matrix<T, N>, vector<T, N> const& x, Semiring = {}) {
+  return x;
+}
+template <typename T, std::size_t N, typename Semiring = plus_times<T>>
+constexpr vector<T, N>
+multiply(vector<T, N> const& x, identity_matrix<T, N>, Semiring = {}) {
+  return x;
+}
+
+// permutation products are gathers
+
+// p * q applies q first, then p
+template <std::size_t N>
+constexpr permutation<N>
+multiply(permutation<N> const& p, permutation<N> const& q) {
+  auto image = std::array<std::size_t, N>{};
+  for (std::size_t idx = 0; idx < N; ++idx) {
+    image[idx] = q[p[idx]];
+  }
+  return permutation<N>(image);
+}
+
+// row i of p * m is row p[i] of m
+template <
+    std::size_t N,
+    typename T,
+    std::size_t W,
+    typename Layout,
+    typename Semiring = plus_times<T>>
+constexpr matrix<T, N, W, Layout> multiply(
+    permutation<N> const& p, matrix<T, N, W, Layout> const& m, Semiring = {}) {
+  auto ret = matrix<T, N, W, Layout>();
+  for (std::size_t i = 0; i < N; ++i) {
+    for (std::size_t j = 0; j < W; ++j) {
+      ret(i, j) = m(p[i], j);
+    }
+  }
+  return ret;
+}
+// column p[j] of m * p is column j of m
+template <
+    typename T,
+    std::size_t H,
+    std::size_t N,
+    typename Layout,
+    typename Semiring = plus_times<T>>
+constexpr matrix<T, H, N, Layout> multiply(
+    matrix<T, H, N, Layout> const& m, permutation<N> const& p, Semiring = {}) {
+  auto ret = matrix<T, H, N, Layout>();
+  for (std::size_t i = 0; i < H; ++i) {
+    for (std::size_t j = 0; j < N; ++j) {
+      ret(i, p[j]) = m(i, j);
+    }
+  }
+  return ret;
+}
+template <std::size_t N, typename T, typename Semiring = plus_times<T>>
+constexpr vector<T, N>
+multiply(permutation<N> const& p, vector<T, N> const& x, Semiring = {}) {
+  auto ret = x;
+  for (std::size_t idx = 0; idx < N; ++idx) {
+    ret[idx] = x[p[idx]];
+  }
+  return ret;
+}
+template <std::size_t N, typename T, typename Semiring = plus_times<T>>
+constexpr vector<T, N>
+multiply(vector<T, N> const& x, permutation<N> const& p, Semiring = {}) {
+  auto ret = x;
+  for (std::size_t idx = 0; idx < N; ++idx) {
+    ret[p[idx]] = x[idx];
+  }
+  return ret;
+}
+
+} // namespace algae
@@ -0,0 +1,445 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <type_traits>
+
+#include <algae/implementation/triangular.h>
+#include <algae/matrix.h>
+#include <algae/misc.h>
+#include <algae/vector.h>
+#include <algae/view.h>
+
+/*
+  lazy transposes, and read-only triangular and symmetric views that
+  multiply and solve take in place of the matrix.
+*/
+
+namespace algae {
+
+namespace impl {
+
+template <typename T>
+constexpr bool is_complex_v = false;
+template <typename T>
+constexpr bool is_complex_v<std::complex<T>> = true;
+
+// the extent of a square matrix, from whichever of its extents is known
+constexpr std::size_t square_extent(std::size_t height, std::size_t width) {
+  return height == dynamic_extent ? width : height;
+}
+
+template <std::size_t H, std::size_t W>
+constexpr bool is_square_v =
+    H == dynamic_extent || W == dynamic_extent || H == W;
+
+// `m`, with the same extent both ways; it must be square
+template <typename T, std::size_t H, std::size_t W>
+constexpr auto square_view(matrix_view<T, H, W> m) noexcept {
+  static_assert(is_square_v<H, W>, "the matrix must be square");
+  constexpr auto n = square_extent(H, W);
+  return matrix_view<T const, n, n>(
+      m.data(), m.height(), m.width(), m.row_stride(), m.col_stride());
+}
+
+} // namespace impl
+
+// transposes
+
+template <typename T, std::size_t H, std::size_t W>
+constexpr matrix_view<T, W, H> transpose_view(matrix_view<T, H, W> m) noexcept {
+  return matrix_view<T, W, H>(
+      m.data(), m.width(), m.height(), m.col_stride(), m.row_stride());
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr matrix_view<T, W, H>
+transpose_view(matrix<T, H, W, Layout>& m) noexcept {
+  return transpose_view(view(m));
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr matrix_view<T const, W, H>
+transpose_view(matrix<T, H, W, Layout> const& m) noexcept {
+  return transpose_view(view(m));
+}
+
+// the conjugate transpose of a complex matrix; read-only
+template <typename T, std::size_t Height, std::size_t Width>
+class adjoint_matrix_view {
+  matrix_view<T const, Width, Height> base_;
+
+public:
+  using value_type = std::remove_cv_t<T>;
+
+  // `base` is the matrix being conjugated and transposed
+  constexpr explicit adjoint_matrix_view(
+      matrix_view<T const, Width, Height> base) noexcept
+      : base_(base) {}
+
+  constexpr std::size_t height() const noexcept { return base_.width(); }
+  constexpr std::size_t width() const noexcept { return base_.height(); }
+  constexpr matrix_view<T const, Width, Height> base() const noexcept {
+    return base_;
+  }
+
+  constexpr value_type operator()(std::size_t row, std::size_t col) const {
+    return std::conj(base_(col, row));
+  }
+};
+
+template <typename T, std::size_t H, std::size_t W>
+constexpr auto adjoint_view(matrix_view<T, H, W> m) noexcept {
+  if constexpr (impl::is_complex_v<std::remove_cv_t<T>>) {
+    return adjoint_matrix_view<std::remove_cv_t<T>, W, H>(m);
+  } else {
+    return transpose_view(m);
+  }
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr auto adjoint_view(matrix<T, H, W, Layout> const& m) noexcept {
+  return adjoint_view(view(m));
+}
+
+// triangular and symmetric matrices
+
+template <typename T, std::size_t N = dynamic_extent>
+class triangular_view {
+  matrix_view<T const, N, N> base_;
+  triangle tri_;
+  diagonal diag_;
+
+public:
+  using value_type = std::remove_cv_t<T>;
+
+  constexpr triangular_view(
+      matrix_view<T const, N, N> base, triangle tri, diagonal diag) noexcept
+      : base_(base), tri_(tri), diag_(diag) {}
+
+  constexpr std::size_t height() const noexcept { return base_.height(); }
+  constexpr std::size_t width() const noexcept { return base_.height(); }
+  constexpr matrix_view<T const, N, N> base() const noexcept { return base_; }
+  constexpr triangle tri() const noexcept { return tri_; }
+  constexpr diagonal diag() const noexcept { return diag_; }
+
+  // whether (row, col) is off the diagonal, and in the stored half
+  constexpr bool is_stored(std::size_t row, std::size_t col) const noexcept {
+    return tri_ == triangle::lower ? col < row : row < col;
+  }
+
+  // zero outside the triangle
+  constexpr value_type operator()(std::size_t row, std::size_t col) const {
+    if (row == col) {
+      return diag_ == diagonal::unit ? value_type(1) : base_(row, col);
+    }
+    return is_stored(row, col) ? base_(row, col) : value_type(0);
+  }
+};
+
+template <typename T, std::size_t N = dynamic_extent>
+class symmetric_view {
+  matrix_view<T const, N, N> base_;
+  triangle tri_;
+
+public:
+  using value_type = std::remove_cv_t<T>;
+
+  constexpr symmetric_view(
+      matrix_view<T const, N, N> base, triangle tri) noexcept
+      : base_(base), tri_(tri) {}
+
+  constexpr std::size_t height() const noexcept { return base_.height(); }
+  constexpr std::size_t width() const noexcept { return base_.height(); }
+  constexpr matrix_view<T const, N, N> base() const noexcept { return base_; }
+  constexpr triangle tri() const noexcept { return tri_; }
+
+  // whether (row, col) is in the stored half, diagonal included
+  constexpr bool is_stored(std::size_t row, std::size_t col) const noexcept {
+    return tri_ == triangle::lower ? col <= row : row <= col;
+  }
+
+  constexpr value_type operator()(std::size_t row, std::size_t col) const {
+    return is_stored(row, col) ? base_(row, col) : base_(col, row);
+  }
+};
+
+template <typename T, std::size_t H, std::size_t W>
+constexpr auto lower(
+    matrix_view<T, H, W> m, diagonal diag = diagonal::non_unit) noexcept {
+  constexpr auto n = impl::square_extent(H, W);
+  return triangular_view<std::remove_cv_t<T>, n>(
+      impl::square_view(m), triangle::lower, diag);
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr auto lower(
+    matrix<T, H, W, Layout> const& m,
+    diagonal diag = diagonal::non_unit) noexcept {
+  return lower(view(m), diag);
+}
+
+template <typename T, std::size_t H, std::size_t W>
+constexpr auto upper(
+    matrix_view<T, H, W> m, diagonal diag = diagonal::non_unit) noexcept {
+  constexpr auto n = impl::square_extent(H, W);
+  return triangular_view<std::remove_cv_t<T>, n>(
+      impl::square_view(m), triangle::upper, diag);
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr auto upper(
+    matrix<T, H, W, Layout> const& m,
+    diagonal diag = diagonal::non_unit) noexcept {
+  return upper(view(m), diag);
+}
+
+// `tri` is the half that's stored; the other is never read
+template <typename T, std::size_t H, std::size_t W>
+constexpr auto
+symmetric(matrix_view<T, H, W> m, triangle tri = triangle::upper) noexcept {
+  constexpr auto n = impl::square_extent(H, W);
+  return symmetric_view<std::remove_cv_t<T>, n>(impl::square_view(m), tri);
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr auto symmetric(
+    matrix<T, H, W, Layout> const& m, triangle tri = triangle::upper) noexcept {
+  return symmetric(view(m), tri);
+}
+
+// products; out can't overlap the other operands, and shapes that disagree
+// leave it as it was
+
+// a triangular product only visits the triangle; half the multiply-adds
+template <
+    typename T,
+    std::size_t N,
+    typename B,
+    std::size_t K,
+    std::size_t R,
+    typename C,
+    std::size_t M,
+    std::size_t P>
+constexpr void multiply(
+    triangular_view<T, N> a,
+    matrix_view<B, K, R> b,
+    matrix_view<C, M, P> out) {
+  static_assert(
+      impl::extents_match(N, K, M) && impl::extents_match(R, P),
+      "the product's shapes must agree");
+  if (b.height() != a.height() || out.height() != a.height() ||
+      out.width() != b.width()) {
+    return;
+  }
+  auto const n = a.height();
+  auto const base = a.base();
+  for (std::size_t i = 0; i < n; ++i) {
+    auto const p0 = a.tri() == triangle::lower ? 0 : i + 1;
+    auto const p1 = a.tri() == triangle::lower ? i : n;
+    for (std::size_t j = 0; j < out.width(); ++j) {
+      out(i, j) = a.diag() == diagonal::unit ? b(i, j) : base(i, i) * b(i, j);
+    }
+    for (std::size_t p = p0; p < p1; ++p) {
+      auto const& scale = base(i, p);
+      for (std::size_t j = 0; j < out.width(); ++j) {
+        out(i, j) += scale * b(p, j);
+      }
+    }
+  }
+}
+template <
+    typename T,
+    std::size_t N,
+    typename B,
+    std::size_t K,
+    typename C,
+    std::size_t M>
+constexpr void multiply(
+    triangular_view<T, N> a, vector_view<B, K> x, vector_view<C, M> out) {
+  static_assert(
+      impl::extents_match(N, K, M), "the product's shapes must agree");
+  if (x.size() != a.height() || out.size() != a.height()) {
+    return;
+  }
+  auto const n = a.height();
+  auto const base = a.base();
+  for (std::size_t i = 0; i < n; ++i) {
+    auto const p0 = a.tri() == triangle::lower ? 0 : i + 1;
+    auto const p1 = a.tri() == triangle::lower ? i : n;
+    auto sum = C(x[i]);
+    if (a.diag() == diagonal::non_unit) {
+      sum = base(i, i) * x[i];
+    }
+    for (std::size_t p = p0; p < p1; ++p) {
+      sum += base(i, p) * x[p];
+    }
+    out[i] = sum;
+  }
+}
+
+// a symmetric product reads each stored element once, and uses it twice
+template <
+    typename T,
+    std::size_t N,
+    typename B,
+    std::size_t K,
+    std::size_t R,
+    typename C,
+    std::size_t M,
+    std::size_t P>
+constexpr void multiply(
+    symmetric_view<T, N> a,
+    matrix_view<B, K, R> b,
+    matrix_view<C, M, P> out) {
+  static_assert(
+      impl::extents_match(N, K, M) && impl::extents_match(R, P),
+      "the product's shapes must agree");
+  if (b.height() != a.height() || out.height() != a.height() ||
+      out.width() != b.width()) {
+    return;
+  }
+  auto const n = a.height();
+  auto const base = a.base();
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < out.width(); ++j) {
+      out(i, j) = base(i, i) * b(i, j);
+    }
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t p = i + 1; p < n; ++p) {
+      auto const& scale = a.tri() == triangle::lower ? base(p, i) : base(i, p);
+      for (std::size_t j = 0; j < out.width(); ++j) {
+        out(i, j) += scale * b(p, j);
+        out(p, j) += scale * b(i, j);
+      }
+    }
+  }
+}
+template <
+    typename T,
+    std::size_t N,
+    typename B,
+    std::size_t K,
+    typename C,
+    std::size_t M>
+constexpr void multiply(
+    symmetric_view<T, N> a, vector_view<B, K> x, vector_view<C, M> out) {
+  static_assert(
+      impl::extents_match(N, K, M), "the product's shapes must agree");
+  if (x.size() != a.height() || out.size() != a.height()) {
+    return;
+  }
+  auto const n = a.height();
+  auto const base = a.base();
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = base(i, i) * x[i];
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t p = i + 1; p < n; ++p) {
+      auto const& scale = a.tri() == triangle::lower ? base(p, i) : base(i, p);
+      out[i] += scale * x[p];
+      out[p] += scale * x[i];
+    }
+  }
+}
+
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename B,
+    std::size_t K,
+    std::size_t R,
+    typename C,
+    std::size_t M,
+    std::size_t P>
+constexpr void multiply(
+    adjoint_matrix_view<T, H, W> a,
+    matrix_view<B, K, R> b,
+    matrix_view<C, M, P> out) {
+  static_assert(
+      impl::extents_match(W, K) && impl::extents_match(H, M) &&
+          impl::extents_match(R, P),
+      "the product's shapes must agree");
+  if (b.height() != a.width() || out.height() != a.height() ||
+      out.width() != b.width()) {
+    return;
+  }
+  for (std::size_t i = 0; i < out.height(); ++i) {
+    for (std::size_t j = 0; j < out.width(); ++j) {
+      out(i, j) = C(0);
+    }
+    for (std::size_t p = 0; p < a.width(); ++p) {
+      auto const scale = a(i, p);
+      for (std::size_t j = 0; j < out.width(); ++j) {
+        out(i, j) += scale * b(p, j);
+      }
+    }
+  }
+}
+template <
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename B,
+    std::size_t K,
+    typename C,
+    std::size_t M>
+constexpr void multiply(
+    adjoint_matrix_view<T, H, W> a,
+    vector_view<B, K> x,
+    vector_view<C, M> out) {
+  static_assert(
+      impl::extents_match(W, K) && impl::extents_match(H, M),
+      "the product's shapes must agree");
+  if (x.size() != a.width() || out.size() != a.height()) {
+    return;
+  }
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    auto sum = C(0);
+    for (std::size_t p = 0; p < a.width(); ++p) {
+      sum += a(i, p) * x[p];
+    }
+    out[i] = sum;
+  }
+}
+
+// triangular solves; x (or b) starts out holding the right hand side,
+// and is overwritten with the solution, or left as it was if it isn't a's
+// height
+template <typename T, std::size_t N, typename B, std::size_t M>
+void solve(triangular_view<T, N> a, vector_view<B, M> x) {
+  static_assert(impl::extents_match(N, M), "a and x must agree");
+  if (x.size() != a.height()) {
+    return;
+  }
+  impl::trsv(a.tri(), a.diag(), a.base(), x);
+}
+template <typename T, std::size_t N, typename B, std::size_t M, std::size_t R>
+void solve(triangular_view<T, N> a, matrix_view<B, M, R> b) {
+  static_assert(impl::extents_match(N, M), "a and b must agree");
+  if (b.height() != a.height()) {
+    return;
+  }
+  impl::trsm(a.tri(), a.diag(), a.base(), b);
+}
+
+// ...or on owning vectors and matrices, returning the solution
+template <typename T, std::size_t N, std::size_t M>
+vector<T, M> solve(triangular_view<T, N> a, vector<T, M> b) {
+  static_assert(impl::extents_compatible(N, M), "a and b must agree");
+  solve(a, view(b));
+  return b;
+}
+template <
+    typename T,
+    std::size_t N,
+    std::size_t M,
+    std::size_t R,
+    typename Layout>
+matrix<T, M, R, Layout>
+solve(triangular_view<T, N> a, matrix<T, M, R, Layout> b) {
+  static_assert(impl::extents_compatible(N, M), "a and b must agree");
+  static_assert(
+      impl::is_strided_layout_v<Layout>,
+      "the right hand sides must be row- or column-major");
+  solve(a, view(b));
+  return b;
+}
+
+} // namespace algae
@@ -11,6 +11,7 @@
 
 #include <algae/iterator.h>
 #include <algae/misc.h>
+#include <algae/semiring.h>
 
 namespace algae {
 
@@ -55,6 +56,9 @@ public:
     return std::crend(storage_);
   }
 
+  constexpr T* data() noexcept { return storage_; }
+  constexpr T const* data() const noexcept { return storage_; }
+
   constexpr auto& operator[](std::size_t idx) & { return storage_[idx]; }
   constexpr auto const& operator[](std::size_t idx) const & {
     return storage_[idx];
@@ -84,6 +88,20 @@ public:
   }
 };
 
+template <typename T, std::size_t N>
+constexpr bool operator==(vector<T, N> const& lhs, vector<T, N> const& rhs) {
+  for (std::size_t i = 0; i < N; ++i) {
+    if (!(lhs[i] == rhs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+template <typename T, std::size_t N>
+constexpr bool operator!=(vector<T, N> const& lhs, vector<T, N> const& rhs) {
+  return !(lhs == rhs);
+}
+
 template <typename T, typename... Ts>
 constexpr auto make_vector(T&& first, Ts&&... rest) {
   auto constexpr Rows = sizeof...(Ts) + 1;
@@ -94,22 +112,24 @@ constexpr auto make_vector(T&& first, Ts&&... rest) {
 }
 
 namespace impl {
+template <typename Semiring>
 struct dot_op_fn {
   template <typename T, typename Pr>
   constexpr void operator()(T& lhs, Pr const& pr) {
     // if one uses +=, it ICEs MSVC v15.5.6
-    lhs = lhs + (pr.first * pr.second);
+    lhs = Semiring::plus(lhs, Semiring::times(pr.first, pr.second));
   }
 };
 } // namespace impl
 
-template <typename T, std::size_t N>
-constexpr auto dot(vector<T, N> const& lhs, vector<T, N> const& rhs) {
+template <typename T, std::size_t N, typename Semiring = plus_times<T>>
+constexpr auto
+dot(vector<T, N> const& lhs, vector<T, N> const& rhs, Semiring = {}) {
   return iter::accumulate_in_place(
       iter::zip(iter::adl_begin(lhs), iter::adl_begin(rhs)),
       iter::zip(iter::adl_end(lhs), iter::adl_end(rhs)),
-      T(0),
-      impl::dot_op_fn{});
+      Semiring::zero(),
+      impl::dot_op_fn<Semiring>{});
 }
 
 } // namespace algae
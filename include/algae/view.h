@@ -0,0 +1,603 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include <algae/layout.h>
+#include <algae/matrix.h>
+#include <algae/vector.h>
+
+/*
+  non-owning, strided views; compile-time or dynamic extents, and strides
+  in elements. matrix_view converts to and from std::mdspan.
+*/
+
+namespace algae {
+
+inline constexpr std::size_t dynamic_extent = static_cast<std::size_t>(-1);
+
+// counts elements rather than comparing addresses, so that a stride of 0
+// (the one element, over and over) has an end too
+template <typename T>
+class strided_iterator {
+public:
+  using value_type = std::remove_cv_t<T>;
+  using reference = T&;
+  using pointer = T*;
+  using difference_type = std::ptrdiff_t;
+  using iterator_category = std::random_access_iterator_tag;
+
+private:
+  T* data_;
+  std::size_t stride_;
+  difference_type index_;
+
+  constexpr T* current() const {
+    return data_ + index_ * difference_type(stride_);
+  }
+
+public:
+  constexpr strided_iterator() : data_(nullptr), stride_(1), index_(0) {}
+  // element `index` of the `stride`-strided elements starting at data
+  constexpr strided_iterator(
+      T* data, std::size_t stride, difference_type index = 0)
+      : data_(data), stride_(stride), index_(index) {}
+
+  constexpr bool operator==(strided_iterator other) const {
+    return index_ == other.index_;
+  }
+  constexpr bool operator!=(strided_iterator other) const {
+    return index_ != other.index_;
+  }
+  constexpr bool operator<(strided_iterator other) const {
+    return index_ < other.index_;
+  }
+  constexpr bool operator>(strided_iterator other) const {
+    return index_ > other.index_;
+  }
+  constexpr bool operator<=(strided_iterator other) const {
+    return index_ <= other.index_;
+  }
+  constexpr bool operator>=(strided_iterator other) const {
+    return index_ >= other.index_;
+  }
+
+  constexpr reference operator*() const { return *current(); }
+  constexpr pointer operator->() const { return current(); }
+
+  constexpr strided_iterator& operator++() {
+    ++index_;
+    return *this;
+  }
+  constexpr strided_iterator operator++(int) {
+    auto ret = *this;
+    ++index_;
+    return ret;
+  }
+  constexpr strided_iterator& operator--() {
+    --index_;
+    return *this;
+  }
+  constexpr strided_iterator operator--(int) {
+    auto ret = *this;
+    --index_;
+    return ret;
+  }
+
+  constexpr strided_iterator& operator+=(difference_type dif) {
+    index_ += dif;
+    return *this;
+  }
+  constexpr strided_iterator operator+(difference_type dif) const {
+    return strided_iterator(data_, stride_, index_ + dif);
+  }
+  constexpr friend strided_iterator
+  operator+(difference_type dif, strided_iterator self) {
+    return self + dif;
+  }
+  constexpr strided_iterator& operator-=(difference_type dif) {
+    index_ -= dif;
+    return *this;
+  }
+  constexpr strided_iterator operator-(difference_type dif) const {
+    return strided_iterator(data_, stride_, index_ - dif);
+  }
+  constexpr difference_type operator-(strided_iterator other) const {
+    return index_ - other.index_;
+  }
+
+  constexpr reference operator[](difference_type dif) const {
+    return current()[dif * difference_type(stride_)];
+  }
+};
+
+namespace impl {
+
+constexpr bool extents_compatible(std::size_t to, std::size_t from) {
+  return to == dynamic_extent || to == from;
+}
+
+// whether views with these extents can be the same size, which they can
+// unless both are known at compile time
+constexpr bool extents_match(std::size_t a, std::size_t b) {
+  return a == dynamic_extent || b == dynamic_extent || a == b;
+}
+constexpr bool extents_match(std::size_t a, std::size_t b, std::size_t c) {
+  return extents_match(a, b) && extents_match(a, c) && extents_match(b, c);
+}
+
+template <typename From, typename To>
+constexpr bool is_qualification_conversion_v =
+    std::is_convertible_v<From (*)[], To (*)[]>;
+
+// the layouts whose storage a single pair of strides can describe
+template <typename Layout>
+constexpr bool is_strided_layout_v = std::is_same_v<Layout, row_major> ||
+    std::is_same_v<Layout, column_major>;
+
+} // namespace impl
+
+template <typename T, std::size_t Extent = dynamic_extent>
+class vector_view {
+  T* data_;
+  std::size_t size_;
+  std::size_t stride_;
+
+public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using iterator = strided_iterator<T>;
+  using const_iterator = strided_iterator<T const>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static constexpr std::size_t extent = Extent;
+
+  // if Extent isn't dynamic_extent, size must be Extent
+  constexpr vector_view(T* data, std::size_t size, std::size_t stride = 1)
+      : data_(data), size_(size), stride_(stride) {}
+
+  template <
+      std::size_t N,
+      typename = std::enable_if_t<impl::extents_compatible(Extent, N)>>
+  constexpr vector_view(vector<value_type, N>& v) noexcept
+      : data_(v.data()), size_(N), stride_(1) {}
+  template <
+      std::size_t N,
+      typename = std::enable_if_t<
+          std::is_const_v<T> && impl::extents_compatible(Extent, N)>>
+  constexpr vector_view(vector<value_type, N> const& v) noexcept
+      : data_(v.data()), size_(N), stride_(1) {}
+
+  template <
+      typename U,
+      std::size_t N,
+      typename = std::enable_if_t<
+          impl::is_qualification_conversion_v<U, T> &&
+          impl::extents_compatible(Extent, N)>>
+  constexpr vector_view(vector_view<U, N> const& other) noexcept
+      : data_(other.data()), size_(other.size()), stride_(other.stride()) {}
+
+  constexpr std::size_t size() const noexcept {
+    if constexpr (Extent == dynamic_extent) {
+      return size_;
+    } else {
+      return Extent;
+    }
+  }
+  constexpr std::size_t stride() const noexcept { return stride_; }
+  constexpr bool is_contiguous() const noexcept { return stride_ == 1; }
+  constexpr T* data() const noexcept { return data_; }
+
+  constexpr T& operator[](std::size_t idx) const {
+    return data_[idx * stride_];
+  }
+
+  constexpr iterator begin() const { return iterator(data_, stride_); }
+  constexpr iterator end() const {
+    return iterator(data_, stride_, std::ptrdiff_t(size()));
+  }
+  constexpr const_iterator cbegin() const {
+    return const_iterator(data_, stride_);
+  }
+  constexpr const_iterator cend() const {
+    return const_iterator(data_, stride_, std::ptrdiff_t(size()));
+  }
+
+  constexpr reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  constexpr reverse_iterator rend() const { return reverse_iterator(begin()); }
+  constexpr const_reverse_iterator crbegin() const {
+    return const_reverse_iterator(cend());
+  }
+  constexpr const_reverse_iterator crend() const {
+    return const_reverse_iterator(cbegin());
+  }
+};
+
+template <
+    typename T,
+    std::size_t Height = dynamic_extent,
+    std::size_t Width = dynamic_extent>
+class matrix_view {
+  T* data_;
+  std::size_t height_;
+  std::size_t width_;
+  std::size_t row_stride_;
+  std::size_t col_stride_;
+
+  template <typename MdSpan>
+  using mdspan_data_t = decltype(std::declval<MdSpan const&>().data_handle());
+  template <typename MdSpan>
+  using mdspan_stride_t = decltype(std::declval<MdSpan const&>().stride(0));
+
+public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using row_type = vector_view<T, Width>;
+  using column_type = vector_view<T, Height>;
+
+  // element (row, col) is at data[row * row_stride + col * col_stride]
+  // if either extent isn't dynamic_extent, the size passed must match it
+  constexpr matrix_view(
+      T* data,
+      std::size_t height,
+      std::size_t width,
+      std::size_t row_stride,
+      std::size_t col_stride = 1)
+      : data_(data),
+        height_(height),
+        width_(width),
+        row_stride_(row_stride),
+        col_stride_(col_stride) {}
+
+  template <
+      std::size_t H,
+      std::size_t W,
+      typename Layout,
+      typename = std::enable_if_t<
+          impl::is_strided_layout_v<Layout> &&
+          impl::extents_compatible(Height, H) &&
+          impl::extents_compatible(Width, W)>>
+  constexpr matrix_view(matrix<value_type, H, W, Layout>& m) noexcept
+      : matrix_view(
+            m.data(),
+            H,
+            W,
+            std::is_same_v<Layout, row_major> ? W : 1,
+            std::is_same_v<Layout, row_major> ? 1 : H) {}
+  template <
+      std::size_t H,
+      std::size_t W,
+      typename Layout,
+      typename = std::enable_if_t<
+          std::is_const_v<T> && impl::is_strided_layout_v<Layout> &&
+          impl::extents_compatible(Height, H) &&
+          impl::extents_compatible(Width, W)>>
+  constexpr matrix_view(matrix<value_type, H, W, Layout> const& m) noexcept
+      : matrix_view(
+            m.data(),
+            H,
+            W,
+            std::is_same_v<Layout, row_major> ? W : 1,
+            std::is_same_v<Layout, row_major> ? 1 : H) {}
+
+  template <
+      typename U,
+      std::size_t H,
+      std::size_t W,
+      typename = std::enable_if_t<
+          impl::is_qualification_conversion_v<U, T> &&
+          impl::extents_compatible(Height, H) &&
+          impl::extents_compatible(Width, W)>>
+  constexpr matrix_view(matrix_view<U, H, W> const& other) noexcept
+      : matrix_view(
+            other.data(),
+            other.height(),
+            other.width(),
+            other.row_stride(),
+            other.col_stride()) {}
+
+  // from a rank 2 std::mdspan, or anything that looks enough like one
+  template <
+      typename MdSpan,
+      typename = std::enable_if_t<
+          std::is_convertible_v<mdspan_data_t<MdSpan>, T*>>,
+      typename = mdspan_stride_t<MdSpan>>
+  constexpr explicit matrix_view(MdSpan const& m)
+      : matrix_view(
+            m.data_handle(),
+            std::size_t(m.extent(0)),
+            std::size_t(m.extent(1)),
+            std::size_t(m.stride(0)),
+            std::size_t(m.stride(1))) {}
+
+  constexpr std::size_t height() const noexcept {
+    if constexpr (Height == dynamic_extent) {
+      return height_;
+    } else {
+      return Height;
+    }
+  }
+  constexpr std::size_t width() const noexcept {
+    if constexpr (Width == dynamic_extent) {
+      return width_;
+    } else {
+      return Width;
+    }
+  }
+  constexpr std::size_t row_stride() const noexcept { return row_stride_; }
+  constexpr std::size_t col_stride() const noexcept { return col_stride_; }
+  constexpr T* data() const noexcept { return data_; }
+
+  // rows are contiguous, and row_stride() apart; what gemm calls lda
+  constexpr bool has_contiguous_rows() const noexcept {
+    return col_stride_ == 1;
+  }
+  constexpr bool has_contiguous_columns() const noexcept {
+    return row_stride_ == 1;
+  }
+
+  constexpr T& operator()(std::size_t row, std::size_t col) const {
+    return data_[row * row_stride_ + col * col_stride_];
+  }
+
+  constexpr row_type row(std::size_t idx) const {
+    return row_type(data_ + idx * row_stride_, width(), col_stride_);
+  }
+  constexpr column_type column(std::size_t idx) const {
+    return column_type(data_ + idx * col_stride_, height(), row_stride_);
+  }
+
+  // the std::mdspan interface
+  static constexpr std::size_t rank() noexcept { return 2; }
+  static constexpr std::size_t static_extent(std::size_t r) noexcept {
+    return r == 0 ? Height : Width;
+  }
+  constexpr std::size_t extent(std::size_t r) const noexcept {
+    return r == 0 ? height() : width();
+  }
+  constexpr std::size_t stride(std::size_t r) const noexcept {
+    return r == 0 ? row_stride_ : col_stride_;
+  }
+  constexpr T* data_handle() const noexcept { return data_; }
+  constexpr std::size_t size() const noexcept { return height() * width(); }
+};
+
+template <typename T, std::size_t N>
+constexpr vector_view<T, N> view(vector<T, N>& v) noexcept {
+  return vector_view<T, N>(v);
+}
+template <typename T, std::size_t N>
+constexpr vector_view<T const, N> view(vector<T, N> const& v) noexcept {
+  return vector_view<T const, N>(v);
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr matrix_view<T, H, W> view(matrix<T, H, W, Layout>& m) noexcept {
+  return matrix_view<T, H, W>(m);
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr matrix_view<T const, H, W>
+view(matrix<T, H, W, Layout> const& m) noexcept {
+  return matrix_view<T const, H, W>(m);
+}
+
+// sub-blocks; rows [R0, R0 + R) and columns [C0, C0 + C) of `m`
+// the block shares storage with `m`, so writes through it go to `m`
+
+template <
+    std::size_t R0,
+    std::size_t C0,
+    std::size_t R,
+    std::size_t C,
+    typename T,
+    std::size_t H,
+    std::size_t W>
+constexpr matrix_view<T, R, C> block(matrix_view<T, H, W> m) {
+  static_assert(
+      H == dynamic_extent || R0 + R <= H, "block is out of bounds");
+  static_assert(
+      W == dynamic_extent || C0 + C <= W, "block is out of bounds");
+  return matrix_view<T, R, C>(
+      &m(R0, C0), R, C, m.row_stride(), m.col_stride());
+}
+template <
+    std::size_t R0,
+    std::size_t C0,
+    std::size_t R,
+    std::size_t C,
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout>
+constexpr matrix_view<T, R, C> block(matrix<T, H, W, Layout>& m) {
+  return block<R0, C0, R, C>(view(m));
+}
+template <
+    std::size_t R0,
+    std::size_t C0,
+    std::size_t R,
+    std::size_t C,
+    typename T,
+    std::size_t H,
+    std::size_t W,
+    typename Layout>
+constexpr matrix_view<T const, R, C> block(matrix<T, H, W, Layout> const& m) {
+  return block<R0, C0, R, C>(view(m));
+}
+
+// the run-time bounds aren't checked; r0 + r and c0 + c must be in range
+template <typename T, std::size_t H, std::size_t W>
+constexpr matrix_view<T> block(
+    matrix_view<T, H, W> m,
+    std::size_t r0,
+    std::size_t c0,
+    std::size_t r,
+    std::size_t c) {
+  return matrix_view<T>(&m(r0, c0), r, c, m.row_stride(), m.col_stride());
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr matrix_view<T> block(
+    matrix<T, H, W, Layout>& m,
+    std::size_t r0,
+    std::size_t c0,
+    std::size_t r,
+    std::size_t c) {
+  return block(view(m), r0, c0, r, c);
+}
+template <typename T, std::size_t H, std::size_t W, typename Layout>
+constexpr matrix_view<T const> block(
+    matrix<T, H, W, Layout> const& m,
+    std::size_t r0,
+    std::size_t c0,
+    std::size_t r,
+    std::size_t c) {
+  return block(view(m), r0, c0, r, c);
+}
+
+// algorithms on views. The sizes have to agree: when they're known at
+// compile time and don't, it doesn't compile, and when it's only found out
+// at run time, the algorithm does nothing
+
+// ...except that the dot product of mismatched vectors is the one over
+// the shorter one's, and never reads past either
+template <
+    typename T,
+    std::size_t N,
+    typename U,
+    std::size_t M,
+    typename Semiring = plus_times<std::remove_cv_t<T>>>
+constexpr auto
+dot(vector_view<T, N> lhs, vector_view<U, M> rhs, Semiring = {}) {
+  static_assert(impl::extents_match(N, M), "vectors must be the same size");
+  auto const size = lhs.size() < rhs.size() ? lhs.size() : rhs.size();
+  auto ret = Semiring::zero();
+  for (std::size_t i = 0; i < size; ++i) {
+    ret = Semiring::plus(ret, Semiring::times(lhs[i], rhs[i]));
+  }
+  return ret;
+}
+
+// out = lhs * rhs; out can't overlap either of them
+template <
+    typename A,
+    std::size_t M,
+    std::size_t K,
+    typename B,
+    std::size_t K2,
+    std::size_t N,
+    typename C,
+    std::size_t M2,
+    std::size_t N2,
+    typename Semiring = plus_times<C>>
+constexpr void multiply(
+    matrix_view<A, M, K> lhs,
+    matrix_view<B, K2, N> rhs,
+    matrix_view<C, M2, N2> out,
+    Semiring = {}) {
+  static_assert(
+      impl::extents_match(M, M2) && impl::extents_match(K, K2) &&
+          impl::extents_match(N, N2),
+      "the product's shapes must agree");
+  if (lhs.height() != out.height() || lhs.width() != rhs.height() ||
+      rhs.width() != out.width()) {
+    return;
+  }
+  auto const m = out.height();
+  auto const n = out.width();
+  auto const k = lhs.width();
+
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      out(i, j) = Semiring::zero();
+    }
+  }
+
+  if (out.has_contiguous_columns() && !out.has_contiguous_rows()) {
+    // j-k-i, so the inner loop walks columns of `lhs` and `out`
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t p = 0; p < k; ++p) {
+        auto const& scale = rhs(p, j);
+        for (std::size_t i = 0; i < m; ++i) {
+          out(i, j) =
+              Semiring::plus(out(i, j), Semiring::times(lhs(i, p), scale));
+        }
+      }
+    }
+  } else {
+    // i-k-j, so the inner loop walks rows of `rhs` and `out`
+    for (std::size_t i = 0; i < m; ++i) {
+      for (std::size_t p = 0; p < k; ++p) {
+        auto const& scale = lhs(i, p);
+        for (std::size_t j = 0; j < n; ++j) {
+          out(i, j) =
+              Semiring::plus(out(i, j), Semiring::times(scale, rhs(p, j)));
+        }
+      }
+    }
+  }
+}
+
+// out = m * x; out can't overlap either of them
+template <
+    typename A,
+    std::size_t H,
+    std::size_t W,
+    typename B,
+    std::size_t N,
+    typename C,
+    std::size_t P,
+    typename Semiring = plus_times<C>>
+constexpr void multiply(
+    matrix_view<A, H, W> m,
+    vector_view<B, N> x,
+    vector_view<C, P> out,
+    Semiring = {}) {
+  static_assert(
+      impl::extents_match(W, N) && impl::extents_match(H, P),
+      "the product's shapes must agree");
+  if (m.width() != x.size() || m.height() != out.size()) {
+    return;
+  }
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    out[i] = Semiring::zero();
+  }
+  if (m.has_contiguous_columns() && !m.has_contiguous_rows()) {
+    for (std::size_t j = 0; j < m.width(); ++j) {
+      for (std::size_t i = 0; i < m.height(); ++i) {
+        out[i] = Semiring::plus(out[i], Semiring::times(m(i, j), x[j]));
+      }
+    }
+  } else {
+    for (std::size_t i = 0; i < m.height(); ++i) {
+      for (std::size_t j = 0; j < m.width(); ++j) {
+        out[i] = Semiring::plus(out[i], Semiring::times(m(i, j), x[j]));
+      }
+    }
+  }
+}
+
+// out = transpose(in); out can't overlap in
+template <
+    typename A,
+    std::size_t H,
+    std::size_t W,
+    typename B,
+    std::size_t W2,
+    std::size_t H2>
+constexpr void transpose(matrix_view<A, H, W> in, matrix_view<B, W2, H2> out) {
+  static_assert(
+      impl::extents_match(H, H2) && impl::extents_match(W, W2),
+      "out must be in's shape, transposed");
+  if (in.height() != out.width() || in.width() != out.height()) {
+    return;
+  }
+  for (std::size_t i = 0; i < in.height(); ++i) {
+    for (std::size_t j = 0; j < in.width(); ++j) {
+      out(j, i) = in(i, j);
+    }
+  }
+}
+
+} // namespace algae
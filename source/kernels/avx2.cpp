@@ -0,0 +1,285 @@
+#include "kernel_table.h"
+
+#if ALGAE_KERNELS_X86
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(                                                  \
+    __attribute__((target("avx2,fma,popcnt"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma,popcnt")
+#endif
+
+#include "kernel_templates.h"
+
+namespace algae::kernels::implementation {
+namespace {
+
+struct avx2_f32 {
+  using value_type = float;
+  using reg = __m256;
+  static constexpr std::size_t width = 8;
+
+  static reg zero() { return _mm256_setzero_ps(); }
+  static reg broadcast(float x) { return _mm256_set1_ps(x); }
+  static reg load(float const* ptr) { return _mm256_loadu_ps(ptr); }
+  static void store(float* ptr, reg r) { _mm256_storeu_ps(ptr, r); }
+
+  static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+  static reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+  static reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+
+  static reg abs(reg a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+  static reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+  static reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+
+  static float reduce_add(reg r) {
+    auto half =
+        _mm_add_ps(_mm256_castps256_ps128(r), _mm256_extractf128_ps(r, 1));
+    half = _mm_hadd_ps(half, half);
+    half = _mm_hadd_ps(half, half);
+    return _mm_cvtss_f32(half);
+  }
+
+  // each lane's four codes are loaded as one word, and each byte of it
+  // then looks up its row of the table: from registers when a row fits in
+  // two, and with gathers otherwise. The masked gathers, for the same
+  // reason as in avx512.cpp: the plain ones pass an undefined register
+  // through, which GCC 12 warns about
+  static reg lookup4(
+      float const* table,
+      std::size_t centroids,
+      std::uint8_t const* codes,
+      std::size_t stride) {
+    auto const all = _mm256_set1_epi32(-1);
+    auto const words = _mm256_setr_epi32(
+        word(codes),
+        word(codes + stride),
+        word(codes + 2 * stride),
+        word(codes + 3 * stride),
+        word(codes + 4 * stride),
+        word(codes + 5 * stride),
+        word(codes + 6 * stride),
+        word(codes + 7 * stride));
+    if (centroids <= 16) {
+      // vpermps picks by the low three bits of each index, and the fourth
+      // picks the register
+      auto const iota = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+      auto const count = static_cast<int>(centroids);
+      auto const low = _mm256_cmpgt_epi32(_mm256_set1_epi32(count), iota);
+      auto const high =
+          _mm256_cmpgt_epi32(_mm256_set1_epi32(count - 8), iota);
+      auto const lookup = [&](std::size_t b, __m256i index) {
+        auto const entries = table + b * centroids;
+        return _mm256_blendv_ps(
+            _mm256_permutevar8x32_ps(_mm256_maskload_ps(entries, low), index),
+            _mm256_permutevar8x32_ps(
+                _mm256_maskload_ps(entries + 8, high), index),
+            _mm256_castsi256_ps(_mm256_slli_epi32(index, 28)));
+      };
+      auto ret = lookup(0, words);
+      ret = _mm256_add_ps(ret, lookup(1, _mm256_srli_epi32(words, 8)));
+      ret = _mm256_add_ps(ret, lookup(2, _mm256_srli_epi32(words, 16)));
+      return _mm256_add_ps(ret, lookup(3, _mm256_srli_epi32(words, 24)));
+    }
+    auto const byte = _mm256_set1_epi32(0xff);
+    auto const row = _mm256_set1_epi32(static_cast<int>(centroids));
+    auto const gather = [&](__m256i index) {
+      return _mm256_mask_i32gather_ps(
+          _mm256_setzero_ps(), table, index, _mm256_castsi256_ps(all), 4);
+    };
+    auto ret = gather(_mm256_and_si256(words, byte));
+    ret = _mm256_add_ps(
+        ret,
+        gather(_mm256_add_epi32(
+            _mm256_and_si256(_mm256_srli_epi32(words, 8), byte), row)));
+    ret = _mm256_add_ps(
+        ret,
+        gather(_mm256_add_epi32(
+            _mm256_and_si256(_mm256_srli_epi32(words, 16), byte),
+            _mm256_add_epi32(row, row))));
+    return _mm256_add_ps(
+        ret,
+        gather(_mm256_add_epi32(
+            _mm256_srli_epi32(words, 24),
+            _mm256_add_epi32(row, _mm256_add_epi32(row, row)))));
+  }
+};
+
+struct avx2_f64 {
+  using value_type = double;
+  using reg = __m256d;
+  static constexpr std::size_t width = 4;
+
+  static reg zero() { return _mm256_setzero_pd(); }
+  static reg broadcast(double x) { return _mm256_set1_pd(x); }
+  static reg load(double const* ptr) { return _mm256_loadu_pd(ptr); }
+  static void store(double* ptr, reg r) { _mm256_storeu_pd(ptr, r); }
+
+  static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+  static reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+  static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+
+  static reg abs(reg a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+  static reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+  static reg min(reg a, reg b) { return _mm256_min_pd(a, b); }
+
+  static double reduce_add(reg r) {
+    auto half =
+        _mm_add_pd(_mm256_castpd256_pd128(r), _mm256_extractf128_pd(r, 1));
+    return _mm_cvtsd_f64(_mm_hadd_pd(half, half));
+  }
+
+  static reg lookup4(
+      double const* table,
+      std::size_t centroids,
+      std::uint8_t const* codes,
+      std::size_t stride) {
+    auto const words = _mm_setr_epi32(
+        word(codes),
+        word(codes + stride),
+        word(codes + 2 * stride),
+        word(codes + 3 * stride));
+    auto const byte = _mm_set1_epi32(0xff);
+    auto const row = _mm_set1_epi32(static_cast<int>(centroids));
+    auto const gather = [&](__m128i index) {
+      return _mm256_mask_i32gather_pd(
+          _mm256_setzero_pd(),
+          table,
+          index,
+          _mm256_castsi256_pd(_mm256_set1_epi64x(-1)),
+          8);
+    };
+    auto ret = gather(_mm_and_si128(words, byte));
+    ret = _mm256_add_pd(
+        ret,
+        gather(
+            _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(words, 8), byte), row)));
+    ret = _mm256_add_pd(
+        ret,
+        gather(_mm_add_epi32(
+            _mm_and_si128(_mm_srli_epi32(words, 16), byte),
+            _mm_add_epi32(row, row))));
+    return _mm256_add_pd(
+        ret,
+        gather(_mm_add_epi32(
+            _mm_srli_epi32(words, 24),
+            _mm_add_epi32(row, _mm_add_epi32(row, row)))));
+  }
+};
+
+struct avx2_i32 {
+  using value_type = std::int32_t;
+  using reg = __m256i;
+  static constexpr std::size_t width = 8;
+
+  static reg broadcast(std::int32_t x) { return _mm256_set1_epi32(x); }
+  static reg load(std::int32_t const* ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(ptr));
+  }
+  static void store(std::int32_t* ptr, reg r) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), r);
+  }
+
+  static reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+  static reg min(reg a, reg b) { return _mm256_min_epi32(a, b); }
+  static reg select_equal(reg x, reg y, reg a, reg b) {
+    return _mm256_blendv_epi8(b, a, _mm256_cmpeq_epi32(x, y));
+  }
+};
+
+struct avx2_bits {
+  using reg = __m256i;
+  static constexpr std::size_t width = 4;
+
+  static reg load(std::uint64_t const* ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(ptr));
+  }
+  static void store(std::uint64_t* ptr, reg r) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), r);
+  }
+  static reg bit_or(reg a, reg b) { return _mm256_or_si256(a, b); }
+  static reg bit_xor(reg a, reg b) { return _mm256_xor_si256(a, b); }
+};
+
+struct avx2_mod {
+  using reg = __m256i;
+  static constexpr std::size_t width = 8;
+
+  static reg broadcast(std::uint32_t x) {
+    return _mm256_set1_epi32(static_cast<int>(x));
+  }
+  static reg load(std::uint32_t const* ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(ptr));
+  }
+  static void store(std::uint32_t* ptr, reg r) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), r);
+  }
+
+  static reg add(reg a, reg b) { return _mm256_add_epi32(a, b); }
+  static reg sub(reg a, reg b) { return _mm256_sub_epi32(a, b); }
+  static reg min(reg a, reg b) { return _mm256_min_epu32(a, b); }
+  static reg mullo(reg a, reg b) { return _mm256_mullo_epi32(a, b); }
+  static reg mulhi(reg a, reg b) {
+    auto const even = _mm256_mul_epu32(a, b);
+    auto const odd =
+        _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xaa);
+  }
+
+  using wide = __m256i;
+  static constexpr std::size_t wide_width = 4;
+
+  static wide wide_zero() { return _mm256_setzero_si256(); }
+  static wide wide_broadcast(std::uint64_t x) {
+    return _mm256_set1_epi64x(static_cast<long long>(x));
+  }
+  static wide wide_load(std::uint32_t const* ptr) {
+    return _mm256_cvtepu32_epi64(
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(ptr)));
+  }
+  static void wide_store(std::uint64_t* ptr, wide r) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), r);
+  }
+  static wide wide_multiply_add(wide a, wide b, wide acc) {
+    return _mm256_add_epi64(acc, _mm256_mul_epu32(a, b));
+  }
+  static wide wide_fold(wide acc, wide c) {
+    auto const top = _mm256_cmpgt_epi64(_mm256_setzero_si256(), acc);
+    return _mm256_sub_epi64(acc, _mm256_and_si256(top, c));
+  }
+};
+
+} // namespace
+
+kernel_table const& avx2_table() noexcept {
+  static constexpr kernel_table table = {
+      isa::avx2,
+      make_ops<avx2_f32>(),
+      make_ops<avx2_f64>(),
+      make_integer_ops<avx2_i32, avx2_bits, avx2_mod>(),
+  };
+  return table;
+}
+
+} // namespace algae::kernels::implementation
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // ALGAE_KERNELS_X86
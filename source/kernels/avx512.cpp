@@ -0,0 +1,310 @@
+#include "kernel_table.h"
+
+#if ALGAE_KERNELS_X86
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(                                                  \
+    __attribute__((target("avx512f,avx2,fma,popcnt"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx2,fma,popcnt")
+#endif
+
+#include "kernel_templates.h"
+
+namespace algae::kernels::implementation {
+namespace {
+
+struct avx512_f32 {
+  using value_type = float;
+  using reg = __m512;
+  static constexpr std::size_t width = 16;
+
+  static reg zero() { return _mm512_setzero_ps(); }
+  static reg broadcast(float x) { return _mm512_set1_ps(x); }
+  static reg load(float const* ptr) { return _mm512_loadu_ps(ptr); }
+  static void store(float* ptr, reg r) { _mm512_storeu_ps(ptr, r); }
+
+  static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+  static reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+  static reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+
+  static reg abs(reg a) { return _mm512_abs_ps(a); }
+  // the masked forms, for the same reason as reduce_add below; the plain
+  // ones pass an _mm512_undefined_ps() through
+  static reg max(reg a, reg b) { return _mm512_mask_max_ps(a, 0xffff, a, b); }
+  static reg min(reg a, reg b) { return _mm512_mask_min_ps(a, 0xffff, a, b); }
+
+  // not _mm512_reduce_add_ps; with optimizations on, GCC 12 warns about
+  // the _mm256_undefined_pd() inside of it
+  static float reduce_add(reg r) {
+    float lanes[width];
+    _mm512_storeu_ps(lanes, r);
+    auto ret = 0.0f;
+    for (auto lane : lanes) {
+      ret += lane;
+    }
+    return ret;
+  }
+
+  // as in avx2.cpp, but a row of up to 16 fits in one register; with the
+  // masked gathers and permutes for the same reason as max and min
+  static reg lookup4(
+      float const* table,
+      std::size_t centroids,
+      std::uint8_t const* codes,
+      std::size_t stride) {
+    auto const words = _mm512_setr_epi32(
+        word(codes),
+        word(codes + stride),
+        word(codes + 2 * stride),
+        word(codes + 3 * stride),
+        word(codes + 4 * stride),
+        word(codes + 5 * stride),
+        word(codes + 6 * stride),
+        word(codes + 7 * stride),
+        word(codes + 8 * stride),
+        word(codes + 9 * stride),
+        word(codes + 10 * stride),
+        word(codes + 11 * stride),
+        word(codes + 12 * stride),
+        word(codes + 13 * stride),
+        word(codes + 14 * stride),
+        word(codes + 15 * stride));
+    auto const shifted = [&](int by) {
+      return _mm512_mask_srlv_epi32(
+          words, 0xffff, words, _mm512_set1_epi32(by));
+    };
+    if (centroids <= 16) {
+      // vpermps only looks at the low four bits of each index
+      auto const lookup = [&](std::size_t b, __m512i index) {
+        auto const entries = _mm512_maskz_loadu_ps(
+            static_cast<__mmask16>((1u << centroids) - 1),
+            table + b * centroids);
+        return _mm512_mask_permutexvar_ps(entries, 0xffff, index, entries);
+      };
+      auto ret = lookup(0, words);
+      ret = _mm512_add_ps(ret, lookup(1, shifted(8)));
+      ret = _mm512_add_ps(ret, lookup(2, shifted(16)));
+      return _mm512_add_ps(ret, lookup(3, shifted(24)));
+    }
+    auto const byte = _mm512_set1_epi32(0xff);
+    auto const row = _mm512_set1_epi32(static_cast<int>(centroids));
+    auto const gather = [&](__m512i index) {
+      return _mm512_mask_i32gather_ps(
+          _mm512_setzero_ps(), 0xffff, index, table, 4);
+    };
+    auto ret = gather(_mm512_and_si512(words, byte));
+    ret = _mm512_add_ps(
+        ret,
+        gather(_mm512_add_epi32(_mm512_and_si512(shifted(8), byte), row)));
+    ret = _mm512_add_ps(
+        ret,
+        gather(_mm512_add_epi32(
+            _mm512_and_si512(shifted(16), byte), _mm512_add_epi32(row, row))));
+    return _mm512_add_ps(
+        ret,
+        gather(_mm512_add_epi32(
+            shifted(24), _mm512_add_epi32(row, _mm512_add_epi32(row, row)))));
+  }
+};
+
+struct avx512_f64 {
+  using value_type = double;
+  using reg = __m512d;
+  static constexpr std::size_t width = 8;
+
+  static reg zero() { return _mm512_setzero_pd(); }
+  static reg broadcast(double x) { return _mm512_set1_pd(x); }
+  static reg load(double const* ptr) { return _mm512_loadu_pd(ptr); }
+  static void store(double* ptr, reg r) { _mm512_storeu_pd(ptr, r); }
+
+  static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+  static reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+  static reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+
+  static reg abs(reg a) { return _mm512_abs_pd(a); }
+  static reg max(reg a, reg b) { return _mm512_mask_max_pd(a, 0xff, a, b); }
+  static reg min(reg a, reg b) { return _mm512_mask_min_pd(a, 0xff, a, b); }
+
+  static double reduce_add(reg r) {
+    double lanes[width];
+    _mm512_storeu_pd(lanes, r);
+    auto ret = 0.0;
+    for (auto lane : lanes) {
+      ret += lane;
+    }
+    return ret;
+  }
+
+  // as for float, with the rows that fit split over two registers
+  static reg lookup4(
+      double const* table,
+      std::size_t centroids,
+      std::uint8_t const* codes,
+      std::size_t stride) {
+    auto const words = _mm256_setr_epi32(
+        word(codes),
+        word(codes + stride),
+        word(codes + 2 * stride),
+        word(codes + 3 * stride),
+        word(codes + 4 * stride),
+        word(codes + 5 * stride),
+        word(codes + 6 * stride),
+        word(codes + 7 * stride));
+    if (centroids <= 16) {
+      // vpermt2pd picks from two registers by the low four bits
+      auto const count = static_cast<unsigned>(centroids);
+      auto const low = static_cast<__mmask8>((1u << std::min(count, 8u)) - 1);
+      auto const high = static_cast<__mmask8>(
+          (1u << (count > 8 ? count - 8 : 0)) - 1);
+      auto const lookup = [&](std::size_t b, __m256i index) {
+        auto const entries = table + b * centroids;
+        auto const first = _mm512_maskz_loadu_pd(low, entries);
+        return _mm512_mask_permutex2var_pd(
+            first,
+            0xff,
+            _mm512_maskz_cvtepu32_epi64(0xff, index),
+            _mm512_maskz_loadu_pd(high, entries + 8));
+      };
+      auto ret = lookup(0, words);
+      ret = _mm512_add_pd(ret, lookup(1, _mm256_srli_epi32(words, 8)));
+      ret = _mm512_add_pd(ret, lookup(2, _mm256_srli_epi32(words, 16)));
+      return _mm512_add_pd(ret, lookup(3, _mm256_srli_epi32(words, 24)));
+    }
+    auto const byte = _mm256_set1_epi32(0xff);
+    auto const row = _mm256_set1_epi32(static_cast<int>(centroids));
+    auto const gather = [&](__m256i index) {
+      return _mm512_mask_i32gather_pd(
+          _mm512_setzero_pd(), 0xff, index, table, 8);
+    };
+    auto ret = gather(_mm256_and_si256(words, byte));
+    ret = _mm512_add_pd(
+        ret,
+        gather(_mm256_add_epi32(
+            _mm256_and_si256(_mm256_srli_epi32(words, 8), byte), row)));
+    ret = _mm512_add_pd(
+        ret,
+        gather(_mm256_add_epi32(
+            _mm256_and_si256(_mm256_srli_epi32(words, 16), byte),
+            _mm256_add_epi32(row, row))));
+    return _mm512_add_pd(
+        ret,
+        gather(_mm256_add_epi32(
+            _mm256_srli_epi32(words, 24),
+            _mm256_add_epi32(row, _mm256_add_epi32(row, row)))));
+  }
+};
+
+struct avx512_i32 {
+  using value_type = std::int32_t;
+  using reg = __m512i;
+  static constexpr std::size_t width = 16;
+
+  static reg broadcast(std::int32_t x) { return _mm512_set1_epi32(x); }
+  static reg load(std::int32_t const* ptr) { return _mm512_loadu_si512(ptr); }
+  static void store(std::int32_t* ptr, reg r) { _mm512_storeu_si512(ptr, r); }
+
+  static reg add(reg a, reg b) { return _mm512_add_epi32(a, b); }
+  static reg min(reg a, reg b) {
+    return _mm512_mask_min_epi32(a, 0xffff, a, b);
+  }
+  static reg select_equal(reg x, reg y, reg a, reg b) {
+    return _mm512_mask_blend_epi32(_mm512_cmpeq_epi32_mask(x, y), b, a);
+  }
+};
+
+struct avx512_bits {
+  using reg = __m512i;
+  static constexpr std::size_t width = 8;
+
+  static reg load(std::uint64_t const* ptr) { return _mm512_loadu_si512(ptr); }
+  static void store(std::uint64_t* ptr, reg r) { _mm512_storeu_si512(ptr, r); }
+  static reg bit_or(reg a, reg b) { return _mm512_or_si512(a, b); }
+  static reg bit_xor(reg a, reg b) { return _mm512_xor_si512(a, b); }
+};
+
+struct avx512_mod {
+  using reg = __m512i;
+  static constexpr std::size_t width = 16;
+
+  static reg broadcast(std::uint32_t x) {
+    return _mm512_set1_epi32(static_cast<int>(x));
+  }
+  static reg load(std::uint32_t const* ptr) { return _mm512_loadu_si512(ptr); }
+  static void store(std::uint32_t* ptr, reg r) { _mm512_storeu_si512(ptr, r); }
+
+  static reg add(reg a, reg b) { return _mm512_add_epi32(a, b); }
+  static reg sub(reg a, reg b) { return _mm512_sub_epi32(a, b); }
+  static reg min(reg a, reg b) {
+    return _mm512_mask_min_epu32(a, 0xffff, a, b);
+  }
+  static reg mullo(reg a, reg b) { return _mm512_mullo_epi32(a, b); }
+  // masked multiplies, shifts and widening, as with max and min above
+  static reg mulhi(reg a, reg b) {
+    auto const even = _mm512_mask_mul_epu32(a, 0xff, a, b);
+    auto const odd = _mm512_mask_mul_epu32(
+        a,
+        0xff,
+        _mm512_mask_srli_epi64(a, 0xff, a, 32),
+        _mm512_mask_srli_epi64(b, 0xff, b, 32));
+    return _mm512_mask_blend_epi32(
+        0xaaaa, _mm512_mask_srli_epi64(even, 0xff, even, 32), odd);
+  }
+
+  using wide = __m512i;
+  static constexpr std::size_t wide_width = 8;
+
+  static wide wide_zero() { return _mm512_setzero_si512(); }
+  static wide wide_broadcast(std::uint64_t x) {
+    return _mm512_set1_epi64(static_cast<long long>(x));
+  }
+  static wide wide_load(std::uint32_t const* ptr) {
+    return _mm512_maskz_cvtepu32_epi64(
+        0xff, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(ptr)));
+  }
+  static void wide_store(std::uint64_t* ptr, wide r) {
+    _mm512_storeu_si512(ptr, r);
+  }
+  static wide wide_multiply_add(wide a, wide b, wide acc) {
+    return _mm512_add_epi64(acc, _mm512_mask_mul_epu32(a, 0xff, a, b));
+  }
+  static wide wide_fold(wide acc, wide c) {
+    auto const top = _mm512_cmplt_epi64_mask(acc, _mm512_setzero_si512());
+    return _mm512_mask_sub_epi64(acc, top, acc, c);
+  }
+};
+
+} // namespace
+
+kernel_table const& avx512_table() noexcept {
+  static constexpr kernel_table table = {
+      isa::avx512,
+      make_ops<avx512_f32>(),
+      make_ops<avx512_f64>(),
+      make_integer_ops<avx512_i32, avx512_bits, avx512_mod>(),
+  };
+  return table;
+}
+
+} // namespace algae::kernels::implementation
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // ALGAE_KERNELS_X86
@@ -0,0 +1,94 @@
+#include "kernel_table.h"
+
+#if ALGAE_KERNELS_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace algae::kernels::implementation {
+
+#if ALGAE_KERNELS_X86
+
+namespace {
+
+struct cpuid_result {
+  unsigned int eax;
+  unsigned int ebx;
+  unsigned int ecx;
+  unsigned int edx;
+};
+
+cpuid_result cpuid(unsigned int leaf, unsigned int subleaf) noexcept {
+  auto ret = cpuid_result{0, 0, 0, 0};
+#if defined(_MSC_VER)
+  int regs[4];
+  __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(subleaf));
+  ret.eax = static_cast<unsigned int>(regs[0]);
+  ret.ebx = static_cast<unsigned int>(regs[1]);
+  ret.ecx = static_cast<unsigned int>(regs[2]);
+  ret.edx = static_cast<unsigned int>(regs[3]);
+#else
+  __cpuid_count(leaf, subleaf, ret.eax, ret.ebx, ret.ecx, ret.edx);
+#endif
+  return ret;
+}
+
+// which register states the OS saves on a context switch
+unsigned long long xgetbv() noexcept {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  unsigned int eax;
+  unsigned int edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+
+constexpr bool bit(unsigned int reg, int idx) noexcept {
+  return (reg >> idx) & 1u;
+}
+
+} // namespace
+
+cpu_features detect_cpu_features() noexcept {
+  auto ret = cpu_features();
+
+  auto const max_leaf = cpuid(0, 0).eax;
+  if (max_leaf < 1) {
+    return ret;
+  }
+
+  auto const leaf1 = cpuid(1, 0);
+  ret.sse4_2 = bit(leaf1.ecx, 20);
+  ret.popcnt = bit(leaf1.ecx, 23);
+
+  // the CPU supporting AVX isn't enough; the OS also has to save the
+  // ymm (and for AVX-512, the zmm and mask) registers
+  auto const osxsave = bit(leaf1.ecx, 27);
+  auto const xcr0 = osxsave ? xgetbv() : 0;
+  auto const os_avx = (xcr0 & 0x06) == 0x06;
+  auto const os_avx512 = (xcr0 & 0xe6) == 0xe6;
+
+  auto const avx = bit(leaf1.ecx, 28) && os_avx;
+  ret.fma = bit(leaf1.ecx, 12) && avx;
+
+  if (max_leaf >= 7) {
+    auto const leaf7 = cpuid(7, 0);
+    ret.avx2 = bit(leaf7.ebx, 5) && avx;
+    ret.avx512f = bit(leaf7.ebx, 16) && os_avx512;
+  }
+
+  return ret;
+}
+
+#else
+
+cpu_features detect_cpu_features() noexcept { return cpu_features(); }
+
+#endif
+
+} // namespace algae::kernels::implementation
@@ -0,0 +1,933 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <algae/kernels.h>
+
+#include "kernel_table.h"
+#include "parallel.h"
+
+namespace algae::kernels {
+
+namespace implementation {
+namespace {
+
+bool supports(cpu_features const& features, isa level) noexcept {
+  switch (level) {
+  case isa::generic:
+    return true;
+  case isa::sse4_2:
+    return ALGAE_KERNELS_X86 && features.sse4_2 && features.popcnt;
+  case isa::avx2:
+    return ALGAE_KERNELS_X86 && features.avx2 && features.fma &&
+        features.popcnt;
+  case isa::avx512:
+    return ALGAE_KERNELS_X86 && features.avx512f && features.avx2 &&
+        features.fma && features.popcnt;
+  }
+  return false;
+}
+
+kernel_table const& table_for(isa level) noexcept {
+  switch (level) {
+#if ALGAE_KERNELS_X86
+  case isa::sse4_2:
+    return sse4_2_table();
+  case isa::avx2:
+    return avx2_table();
+  case isa::avx512:
+    return avx512_table();
+#endif
+  default:
+    return generic_table();
+  }
+}
+
+cpu_features const& features() noexcept {
+  static auto const ret = detect_cpu_features();
+  return ret;
+}
+
+isa best_isa() noexcept {
+  static auto const ret = [] {
+    for (auto level : {isa::avx512, isa::avx2, isa::sse4_2}) {
+      if (supports(features(), level)) {
+        return level;
+      }
+    }
+    return isa::generic;
+  }();
+  return ret;
+}
+
+// the table is picked the first time a kernel runs, and from then on it's
+// just a load
+std::atomic<kernel_table const*>& current() noexcept {
+  static auto ret = std::atomic<kernel_table const*>(&table_for(best_isa()));
+  return ret;
+}
+
+// do the detection, and read the tuning file, while the program starts up
+// rather than in the middle of whatever first calls a kernel
+[[maybe_unused]] auto const* const startup_table = current().load();
+[[maybe_unused]] auto const* const startup_tuning = &current_tuning();
+
+} // namespace
+
+kernel_table const& active_table() noexcept {
+  return *current().load(std::memory_order_relaxed);
+}
+
+namespace {
+
+template <typename T>
+kernel_ops<T> const& ops() noexcept {
+  return current().load(std::memory_order_relaxed)->ops<T>();
+}
+
+template <typename T>
+blocking const& blocks() noexcept {
+  if constexpr (std::is_same_v<T, float>) {
+    return current_tuning().f32;
+  } else {
+    return current_tuning().f64;
+  }
+}
+
+integer_ops const& integer() noexcept {
+  return current().load(std::memory_order_relaxed)->integer;
+}
+
+// the kernel for min-plus products of T
+template <typename T>
+auto min_plus_kernel() noexcept {
+  if constexpr (std::is_same_v<T, std::int32_t>) {
+    return integer().min_plus_gemm;
+  } else {
+    return ops<T>().min_plus_gemm;
+  }
+}
+
+// rows of `c` are independent, in any semiring; 32-bit integers use the
+// float blocking, and bit words the double one
+template <typename T>
+void min_plus_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    T const* a,
+    std::size_t lda,
+    T const* b,
+    std::size_t ldb,
+    T* c,
+    std::size_t ldc) noexcept {
+  auto const kernel = min_plus_kernel<T>();
+  auto const& tuning =
+      std::is_same_v<T, double> ? blocks<double>() : blocks<float>();
+  parallel_for(
+      m,
+      parallel_chunks(m * n * k, m),
+      [&](std::size_t begin, std::size_t end) {
+        kernel(
+            end - begin,
+            n,
+            k,
+            a + begin * lda,
+            lda,
+            b,
+            ldb,
+            c + begin * ldc,
+            ldc,
+            tuning);
+      });
+}
+
+void or_and_gemm(
+    std::size_t m,
+    std::size_t n_words,
+    std::size_t k,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::uint64_t* c,
+    std::size_t ldc) noexcept {
+  auto const kernel = integer().or_and_gemm;
+  auto const& tuning = blocks<double>();
+  parallel_for(
+      m,
+      parallel_chunks(m * n_words * k, m),
+      [&](std::size_t begin, std::size_t end) {
+        kernel(
+            end - begin,
+            n_words,
+            k,
+            a + begin * lda,
+            lda,
+            b,
+            ldb,
+            c + begin * ldc,
+            ldc,
+            tuning);
+      });
+}
+
+void xor_and_gemm(
+    std::size_t m,
+    std::size_t n_words,
+    std::size_t k,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::uint64_t* c,
+    std::size_t ldc) noexcept {
+  auto const kernel = integer().xor_and_gemm;
+  auto const& tuning = blocks<double>();
+  parallel_for(
+      m,
+      parallel_chunks(m * n_words * k, m),
+      [&](std::size_t begin, std::size_t end) {
+        kernel(
+            end - begin,
+            n_words,
+            k,
+            a + begin * lda,
+            lda,
+            b,
+            ldb,
+            c + begin * ldc,
+            ldc,
+            tuning);
+      });
+}
+
+template <typename Kernel>
+void popcounts(
+    Kernel kernel,
+    std::size_t m,
+    std::size_t n,
+    std::size_t words,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::size_t* out,
+    std::size_t ldo) noexcept {
+  auto const& tuning = blocks<double>();
+  parallel_for(
+      m,
+      parallel_chunks(m * n * words, m),
+      [&](std::size_t begin, std::size_t end) {
+        kernel(
+            end - begin,
+            n,
+            words,
+            a + begin * lda,
+            lda,
+            b,
+            ldb,
+            out + begin * ldo,
+            ldo,
+            tuning);
+      });
+}
+
+void mod_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    std::uint32_t p,
+    std::uint32_t const* a,
+    std::size_t lda,
+    std::uint32_t const* b,
+    std::size_t ldb,
+    std::uint32_t* c,
+    std::size_t ldc) noexcept {
+  auto const kernel = integer().mod_gemm;
+  auto const& tuning = blocks<float>();
+  parallel_for(
+      m,
+      parallel_chunks(m * n * k, m),
+      [&](std::size_t begin, std::size_t end) {
+        kernel(
+            end - begin,
+            n,
+            k,
+            p,
+            a + begin * lda,
+            lda,
+            b,
+            ldb,
+            c + begin * ldc,
+            ldc,
+            tuning);
+      });
+}
+
+// rows of `y` are independent, so gemv splits up the rows of `a`
+template <typename T>
+void gemv(
+    std::size_t m,
+    std::size_t n,
+    T alpha,
+    T const* a,
+    std::size_t lda,
+    T const* x,
+    T beta,
+    T* y) noexcept {
+  auto const& table = ops<T>();
+  parallel_for(
+      m, parallel_chunks(m * n, m), [&](std::size_t begin, std::size_t end) {
+        table.gemv(
+            end - begin, n, alpha, a + begin * lda, lda, x, beta, y + begin);
+      });
+}
+
+// ...but every row of `a` adds into all of `y`, so gemv_t splits up the
+// columns instead
+template <typename T>
+void gemv_t(
+    std::size_t m,
+    std::size_t n,
+    T alpha,
+    T const* a,
+    std::size_t lda,
+    T const* x,
+    T beta,
+    T* y) noexcept {
+  auto const& table = ops<T>();
+  auto const& tuning = blocks<T>();
+  parallel_for(
+      n, parallel_chunks(m * n, n), [&](std::size_t begin, std::size_t end) {
+        table.gemv_t(
+            m, end - begin, alpha, a + begin, lda, x, beta, y + begin, tuning);
+      });
+}
+
+// the columns of b are independent, so trsm splits them up
+template <typename T>
+void trsm(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    std::size_t nrhs,
+    T const* a,
+    std::size_t lda,
+    T* b,
+    std::size_t ldb) noexcept {
+  auto const& table = ops<T>();
+  auto const& tuning = blocks<T>();
+  parallel_for(
+      nrhs,
+      parallel_chunks(n * n * nrhs, nrhs),
+      [&](std::size_t begin, std::size_t end) {
+        table.trsm(
+            tri, diag, n, end - begin, a, lda, b + begin, ldb, tuning);
+      });
+}
+
+// the groups of the batched kernels are independent, and each is about
+// n^3 work per problem
+template <typename T, typename F>
+void batched(std::size_t n, std::size_t groups, F const& f) noexcept {
+  parallel_for(
+      groups,
+      parallel_chunks(groups * batch_lanes<T> * n * n * n, groups),
+      f);
+}
+
+} // namespace
+} // namespace implementation
+
+char const* name(isa level) noexcept {
+  switch (level) {
+  case isa::generic:
+    return "generic";
+  case isa::sse4_2:
+    return "sse4.2";
+  case isa::avx2:
+    return "avx2";
+  case isa::avx512:
+    return "avx512";
+  }
+  return "unknown";
+}
+
+isa detected_isa() noexcept { return implementation::best_isa(); }
+
+isa active_isa() noexcept {
+  return implementation::current().load(std::memory_order_relaxed)->level;
+}
+
+bool select_isa(isa level) noexcept {
+  if (!implementation::supports(implementation::features(), level)) {
+    return false;
+  }
+  implementation::current().store(
+      &implementation::table_for(level), std::memory_order_relaxed);
+  return true;
+}
+
+float dot(float const* lhs, float const* rhs, std::size_t n) noexcept {
+  return implementation::ops<float>().dot(lhs, rhs, n);
+}
+double dot(double const* lhs, double const* rhs, std::size_t n) noexcept {
+  return implementation::ops<double>().dot(lhs, rhs, n);
+}
+
+void add(
+    float const* lhs, float const* rhs, float* out, std::size_t n) noexcept {
+  implementation::ops<float>().add(lhs, rhs, out, n);
+}
+void add(
+    double const* lhs, double const* rhs, double* out, std::size_t n) noexcept {
+  implementation::ops<double>().add(lhs, rhs, out, n);
+}
+void subtract(
+    float const* lhs, float const* rhs, float* out, std::size_t n) noexcept {
+  implementation::ops<float>().subtract(lhs, rhs, out, n);
+}
+void subtract(
+    double const* lhs, double const* rhs, double* out, std::size_t n) noexcept {
+  implementation::ops<double>().subtract(lhs, rhs, out, n);
+}
+void hadamard(
+    float const* lhs, float const* rhs, float* out, std::size_t n) noexcept {
+  implementation::ops<float>().hadamard(lhs, rhs, out, n);
+}
+void hadamard(
+    double const* lhs, double const* rhs, double* out, std::size_t n) noexcept {
+  implementation::ops<double>().hadamard(lhs, rhs, out, n);
+}
+
+void axpy(float alpha, float const* x, float* y, std::size_t n) noexcept {
+  implementation::ops<float>().axpy(alpha, x, y, n);
+}
+void axpy(double alpha, double const* x, double* y, std::size_t n) noexcept {
+  implementation::ops<double>().axpy(alpha, x, y, n);
+}
+
+void axpby(
+    float alpha, float const* x, float beta, float* y, std::size_t n) noexcept {
+  implementation::ops<float>().axpby(alpha, x, beta, y, n);
+}
+void axpby(
+    double alpha,
+    double const* x,
+    double beta,
+    double* y,
+    std::size_t n) noexcept {
+  implementation::ops<double>().axpby(alpha, x, beta, y, n);
+}
+
+void scal(float alpha, float* x, std::size_t n) noexcept {
+  implementation::ops<float>().scal(alpha, x, n);
+}
+void scal(double alpha, double* x, std::size_t n) noexcept {
+  implementation::ops<double>().scal(alpha, x, n);
+}
+
+float nrm2(float const* x, std::size_t n) noexcept {
+  return implementation::ops<float>().nrm2(x, n);
+}
+double nrm2(double const* x, std::size_t n) noexcept {
+  return implementation::ops<double>().nrm2(x, n);
+}
+
+float asum(float const* x, std::size_t n) noexcept {
+  return implementation::ops<float>().asum(x, n);
+}
+double asum(double const* x, std::size_t n) noexcept {
+  return implementation::ops<double>().asum(x, n);
+}
+
+std::size_t iamax(float const* x, std::size_t n) noexcept {
+  return implementation::ops<float>().iamax(x, n);
+}
+std::size_t iamax(double const* x, std::size_t n) noexcept {
+  return implementation::ops<double>().iamax(x, n);
+}
+
+std::size_t iamin(float const* x, std::size_t n) noexcept {
+  return implementation::ops<float>().iamin(x, n);
+}
+std::size_t iamin(double const* x, std::size_t n) noexcept {
+  return implementation::ops<double>().iamin(x, n);
+}
+
+void swap(float* x, float* y, std::size_t n) noexcept {
+  implementation::ops<float>().swap(x, y, n);
+}
+void swap(double* x, double* y, std::size_t n) noexcept {
+  implementation::ops<double>().swap(x, y, n);
+}
+
+void copy(float const* x, float* y, std::size_t n) noexcept {
+  implementation::ops<float>().copy(x, y, n);
+}
+void copy(double const* x, double* y, std::size_t n) noexcept {
+  implementation::ops<double>().copy(x, y, n);
+}
+
+void rot(float* x, float* y, std::size_t n, float c, float s) noexcept {
+  implementation::ops<float>().rot(x, y, n, c, s);
+}
+void rot(double* x, double* y, std::size_t n, double c, double s) noexcept {
+  implementation::ops<double>().rot(x, y, n, c, s);
+}
+
+float axpy_dot(
+    float alpha,
+    float const* x,
+    float* y,
+    float const* z,
+    std::size_t n) noexcept {
+  return implementation::ops<float>().axpy_dot(alpha, x, y, z, n);
+}
+double axpy_dot(
+    double alpha,
+    double const* x,
+    double* y,
+    double const* z,
+    std::size_t n) noexcept {
+  return implementation::ops<double>().axpy_dot(alpha, x, y, z, n);
+}
+
+void gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    float alpha,
+    float const* a,
+    std::size_t lda,
+    float const* b,
+    std::size_t ldb,
+    float beta,
+    float* c,
+    std::size_t ldc) noexcept {
+  implementation::ops<float>().gemm(
+      m,
+      n,
+      k,
+      alpha,
+      a,
+      lda,
+      b,
+      ldb,
+      beta,
+      c,
+      ldc,
+      implementation::blocks<float>());
+}
+void gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    double alpha,
+    double const* a,
+    std::size_t lda,
+    double const* b,
+    std::size_t ldb,
+    double beta,
+    double* c,
+    std::size_t ldc) noexcept {
+  implementation::ops<double>().gemm(
+      m,
+      n,
+      k,
+      alpha,
+      a,
+      lda,
+      b,
+      ldb,
+      beta,
+      c,
+      ldc,
+      implementation::blocks<double>());
+}
+
+void min_plus_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    float const* a,
+    std::size_t lda,
+    float const* b,
+    std::size_t ldb,
+    float* c,
+    std::size_t ldc) noexcept {
+  implementation::min_plus_gemm(m, n, k, a, lda, b, ldb, c, ldc);
+}
+void min_plus_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    double const* a,
+    std::size_t lda,
+    double const* b,
+    std::size_t ldb,
+    double* c,
+    std::size_t ldc) noexcept {
+  implementation::min_plus_gemm(m, n, k, a, lda, b, ldb, c, ldc);
+}
+void min_plus_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    std::int32_t const* a,
+    std::size_t lda,
+    std::int32_t const* b,
+    std::size_t ldb,
+    std::int32_t* c,
+    std::size_t ldc) noexcept {
+  implementation::min_plus_gemm(m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+void or_and_gemm(
+    std::size_t m,
+    std::size_t n_words,
+    std::size_t k,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::uint64_t* c,
+    std::size_t ldc) noexcept {
+  implementation::or_and_gemm(m, n_words, k, a, lda, b, ldb, c, ldc);
+}
+
+void xor_and_gemm(
+    std::size_t m,
+    std::size_t n_words,
+    std::size_t k,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::uint64_t* c,
+    std::size_t ldc) noexcept {
+  implementation::xor_and_gemm(m, n_words, k, a, lda, b, ldb, c, ldc);
+}
+
+void mod_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    std::uint32_t p,
+    std::uint32_t const* a,
+    std::size_t lda,
+    std::uint32_t const* b,
+    std::size_t ldb,
+    std::uint32_t* c,
+    std::size_t ldc) noexcept {
+  implementation::mod_gemm(m, n, k, p, a, lda, b, ldb, c, ldc);
+}
+void mod_axpy(
+    std::uint32_t p,
+    std::uint32_t alpha,
+    std::uint32_t const* x,
+    std::uint32_t* y,
+    std::size_t n) noexcept {
+  implementation::integer().mod_axpy(p, alpha, x, y, n);
+}
+
+void and_popcounts(
+    std::size_t m,
+    std::size_t n,
+    std::size_t words,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::size_t* out,
+    std::size_t ldo) noexcept {
+  implementation::popcounts(
+      implementation::integer().and_popcounts,
+      m,
+      n,
+      words,
+      a,
+      lda,
+      b,
+      ldb,
+      out,
+      ldo);
+}
+void xor_popcounts(
+    std::size_t m,
+    std::size_t n,
+    std::size_t words,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::size_t* out,
+    std::size_t ldo) noexcept {
+  implementation::popcounts(
+      implementation::integer().xor_popcounts,
+      m,
+      n,
+      words,
+      a,
+      lda,
+      b,
+      ldb,
+      out,
+      ldo);
+}
+
+void gemv(
+    std::size_t m,
+    std::size_t n,
+    float alpha,
+    float const* a,
+    std::size_t lda,
+    float const* x,
+    float beta,
+    float* y) noexcept {
+  implementation::gemv(m, n, alpha, a, lda, x, beta, y);
+}
+void gemv(
+    std::size_t m,
+    std::size_t n,
+    double alpha,
+    double const* a,
+    std::size_t lda,
+    double const* x,
+    double beta,
+    double* y) noexcept {
+  implementation::gemv(m, n, alpha, a, lda, x, beta, y);
+}
+
+void gemv_t(
+    std::size_t m,
+    std::size_t n,
+    float alpha,
+    float const* a,
+    std::size_t lda,
+    float const* x,
+    float beta,
+    float* y) noexcept {
+  implementation::gemv_t(m, n, alpha, a, lda, x, beta, y);
+}
+void gemv_t(
+    std::size_t m,
+    std::size_t n,
+    double alpha,
+    double const* a,
+    std::size_t lda,
+    double const* x,
+    double beta,
+    double* y) noexcept {
+  implementation::gemv_t(m, n, alpha, a, lda, x, beta, y);
+}
+
+void trsv(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    float const* a,
+    std::size_t lda,
+    float* x) noexcept {
+  implementation::ops<float>().trsv(tri, diag, n, a, lda, x);
+}
+void trsv(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    double const* a,
+    std::size_t lda,
+    double* x) noexcept {
+  implementation::ops<double>().trsv(tri, diag, n, a, lda, x);
+}
+
+void trsm(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    std::size_t nrhs,
+    float const* a,
+    std::size_t lda,
+    float* b,
+    std::size_t ldb) noexcept {
+  implementation::trsm(tri, diag, n, nrhs, a, lda, b, ldb);
+}
+void trsm(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    std::size_t nrhs,
+    double const* a,
+    std::size_t lda,
+    double* b,
+    std::size_t ldb) noexcept {
+  implementation::trsm(tri, diag, n, nrhs, a, lda, b, ldb);
+}
+
+void transpose(
+    std::size_t m,
+    std::size_t n,
+    float const* a,
+    std::size_t lda,
+    float* b,
+    std::size_t ldb) noexcept {
+  implementation::ops<float>().transpose(
+      m, n, a, lda, b, ldb, implementation::blocks<float>());
+}
+void transpose(
+    std::size_t m,
+    std::size_t n,
+    double const* a,
+    std::size_t lda,
+    double* b,
+    std::size_t ldb) noexcept {
+  implementation::ops<double>().transpose(
+      m, n, a, lda, b, ldb, implementation::blocks<double>());
+}
+
+void column_sums(
+    std::size_t m,
+    std::size_t n,
+    float const* a,
+    std::size_t lda,
+    float* out) noexcept {
+  implementation::ops<float>().column_sums(
+      m, n, a, lda, out, implementation::blocks<float>());
+}
+void column_sums(
+    std::size_t m,
+    std::size_t n,
+    double const* a,
+    std::size_t lda,
+    double* out) noexcept {
+  implementation::ops<double>().column_sums(
+      m, n, a, lda, out, implementation::blocks<double>());
+}
+
+void batched_gemm(
+    std::size_t n,
+    std::size_t groups,
+    float const* a,
+    float const* b,
+    float* c) noexcept {
+  auto const size = n * n * batch_lanes<float>;
+  implementation::batched<float>(
+      n, groups, [&](std::size_t begin, std::size_t end) {
+        implementation::ops<float>().batched_gemm(
+            n,
+            end - begin,
+            a + begin * size,
+            b + begin * size,
+            c + begin * size);
+      });
+}
+void batched_gemm(
+    std::size_t n,
+    std::size_t groups,
+    double const* a,
+    double const* b,
+    double* c) noexcept {
+  auto const size = n * n * batch_lanes<double>;
+  implementation::batched<double>(
+      n, groups, [&](std::size_t begin, std::size_t end) {
+        implementation::ops<double>().batched_gemm(
+            n,
+            end - begin,
+            a + begin * size,
+            b + begin * size,
+            c + begin * size);
+      });
+}
+
+void batched_inverse(
+    std::size_t n,
+    std::size_t groups,
+    float* a,
+    float* out,
+    bool* singular) noexcept {
+  auto const size = n * n * batch_lanes<float>;
+  implementation::batched<float>(
+      n, groups, [&](std::size_t begin, std::size_t end) {
+        implementation::ops<float>().batched_inverse(
+            n,
+            end - begin,
+            a + begin * size,
+            out + begin * size,
+            singular + begin * batch_lanes<float>);
+      });
+}
+void batched_inverse(
+    std::size_t n,
+    std::size_t groups,
+    double* a,
+    double* out,
+    bool* singular) noexcept {
+  auto const size = n * n * batch_lanes<double>;
+  implementation::batched<double>(
+      n, groups, [&](std::size_t begin, std::size_t end) {
+        implementation::ops<double>().batched_inverse(
+            n,
+            end - begin,
+            a + begin * size,
+            out + begin * size,
+            singular + begin * batch_lanes<double>);
+      });
+}
+
+void batched_solve(
+    std::size_t n,
+    std::size_t groups,
+    float* a,
+    float* x,
+    bool* singular) noexcept {
+  constexpr auto lanes = batch_lanes<float>;
+  implementation::batched<float>(
+      n, groups, [&](std::size_t begin, std::size_t end) {
+        implementation::ops<float>().batched_solve(
+            n,
+            end - begin,
+            a + begin * n * n * lanes,
+            x + begin * n * lanes,
+            singular + begin * lanes);
+      });
+}
+void batched_solve(
+    std::size_t n,
+    std::size_t groups,
+    double* a,
+    double* x,
+    bool* singular) noexcept {
+  constexpr auto lanes = batch_lanes<double>;
+  implementation::batched<double>(
+      n, groups, [&](std::size_t begin, std::size_t end) {
+        implementation::ops<double>().batched_solve(
+            n,
+            end - begin,
+            a + begin * n * n * lanes,
+            x + begin * n * lanes,
+            singular + begin * lanes);
+      });
+}
+
+void batched_cholesky(
+    std::size_t n, std::size_t groups, float* a, bool* failed) noexcept {
+  constexpr auto lanes = batch_lanes<float>;
+  implementation::batched<float>(
+      n, groups, [&](std::size_t begin, std::size_t end) {
+        implementation::ops<float>().batched_cholesky(
+            n, end - begin, a + begin * n * n * lanes, failed + begin * lanes);
+      });
+}
+void batched_cholesky(
+    std::size_t n, std::size_t groups, double* a, bool* failed) noexcept {
+  constexpr auto lanes = batch_lanes<double>;
+  implementation::batched<double>(
+      n, groups, [&](std::size_t begin, std::size_t end) {
+        implementation::ops<double>().batched_cholesky(
+            n, end - begin, a + begin * n * n * lanes, failed + begin * lanes);
+      });
+}
+
+} // namespace algae::kernels
@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <algae/kernels.h>
+
+#include "parallel.h"
+
+/*
+  all-pairs distances are a gemm, fixed up per row by norms; b is
+  transposed a tile at a time. Searches split the database, not the
+  queries, across threads.
+*/
+
+namespace algae::kernels {
+
+namespace implementation {
+namespace {
+
+// the rows of a that go through gemm together; a block of them is the
+// unit of work for the threads
+inline constexpr std::size_t distance_rows = 64;
+// the columns of b that the top k take at a time; distance_rows of them is
+// the buffer that has to stay in cache
+inline constexpr std::size_t distance_columns = 512;
+
+// what each row brings to the metric: its squared norm for euclidean
+// distances, one over its norm (or zero) for cosines, and nothing for
+// inner products
+template <typename T>
+std::vector<T> row_norms(
+    metric which, std::size_t m, std::size_t d, T const* a, std::size_t lda) {
+  auto ret = std::vector<T>();
+  if (which == metric::inner_product) {
+    return ret;
+  }
+  ret.resize(m);
+  for (std::size_t i = 0; i < m; ++i) {
+    auto const row = a + i * lda;
+    auto const squared = kernels::dot(row, row, d);
+    if (which == metric::squared_euclidean) {
+      ret[i] = squared;
+    } else {
+      ret[i] = squared > T(0) ? T(1) / std::sqrt(squared) : T(0);
+    }
+  }
+  return ret;
+}
+
+// turns a rows x cols block of dot products into the metric, in place
+template <typename T>
+void finish_block(
+    metric which,
+    std::size_t rows,
+    std::size_t cols,
+    T* block,
+    std::size_t ldb,
+    T const* a_norms,
+    T const* b_norms) noexcept {
+  if (which == metric::inner_product) {
+    return;
+  }
+  for (std::size_t i = 0; i < rows; ++i) {
+    auto const row = block + i * ldb;
+    auto const a_norm = a_norms[i];
+    if (which == metric::squared_euclidean) {
+      // rounding can take the difference of nearly equal vectors below zero
+      for (std::size_t j = 0; j < cols; ++j) {
+        row[j] = std::max(a_norm + b_norms[j] - T(2) * row[j], T(0));
+      }
+    } else {
+      for (std::size_t j = 0; j < cols; ++j) {
+        row[j] = row[j] * a_norm * b_norms[j];
+      }
+    }
+  }
+}
+
+// the norms of both sides, which pairwise and pairwise_top_k share
+template <typename T>
+struct distance_norms {
+  std::vector<T> a_norms;
+  std::vector<T> b_norms;
+
+  distance_norms(
+      metric which,
+      std::size_t m,
+      std::size_t n,
+      std::size_t d,
+      T const* a,
+      std::size_t lda,
+      T const* b,
+      std::size_t ldb)
+      : a_norms(row_norms(which, m, d, a, lda)),
+        b_norms(row_norms(which, n, d, b, ldb)) {}
+
+  // the norms from row `first` on; null for inner products, with none
+  T const* a_norms_from(std::size_t first) const noexcept {
+    return a_norms.empty() ? nullptr : a_norms.data() + first;
+  }
+  T const* b_norms_from(std::size_t first) const noexcept {
+    return b_norms.empty() ? nullptr : b_norms.data() + first;
+  }
+};
+
+// calls f(col, cols, tile) for each distance_columns rows of b, with tile
+// their transpose, d x cols; only a tile of b is ever copied
+template <typename T, typename F>
+void for_each_column_tile(
+    std::size_t n,
+    std::size_t d,
+    T const* b,
+    std::size_t ldb,
+    F const& f) noexcept {
+  auto tile = std::vector<T>(d * std::min(n, distance_columns));
+  for (std::size_t col = 0; col < n; col += distance_columns) {
+    auto const cols = std::min(distance_columns, n - col);
+    kernels::transpose(cols, d, b + col * ldb, ldb, tile.data(), cols);
+    f(col, cols, static_cast<T const*>(tile.data()));
+  }
+}
+
+// the rows of the database that a search scores at a time
+inline constexpr std::size_t search_rows = 256;
+
+// calls f(first, rows) for each block of distance_rows rows of [0, m),
+// split across threads
+template <typename F>
+void for_each_row_block(
+    std::size_t m, std::size_t n, std::size_t d, F const& f) noexcept {
+  auto const row_blocks = (m + distance_rows - 1) / distance_rows;
+  parallel_for(
+      row_blocks,
+      parallel_chunks(m * n * std::max<std::size_t>(d, 1), row_blocks),
+      [&](std::size_t begin, std::size_t end) {
+        for (auto block = begin; block < end; ++block) {
+          auto const first = block * distance_rows;
+          f(first, std::min(distance_rows, m - first));
+        }
+      });
+}
+
+template <typename T>
+void pairwise(
+    metric which,
+    std::size_t m,
+    std::size_t n,
+    std::size_t d,
+    T const* a,
+    std::size_t lda,
+    T const* b,
+    std::size_t ldb,
+    T* out,
+    std::size_t ldo) noexcept {
+  auto const norms = distance_norms<T>(which, m, n, d, a, lda, b, ldb);
+  for_each_column_tile(
+      n, d, b, ldb, [&](std::size_t col, std::size_t cols, T const* tile) {
+        for_each_row_block(
+            m, cols, d, [&](std::size_t first, std::size_t rows) {
+              auto const block = out + first * ldo + col;
+              kernels::gemm(
+                  rows,
+                  cols,
+                  d,
+                  T(1),
+                  a + first * lda,
+                  lda,
+                  tile,
+                  cols,
+                  T(0),
+                  block,
+                  ldo);
+              finish_block(
+                  which,
+                  rows,
+                  cols,
+                  block,
+                  ldo,
+                  norms.a_norms_from(first),
+                  norms.b_norms_from(col));
+            });
+      });
+}
+
+template <typename T>
+void pairwise_top_k(
+    metric which,
+    std::size_t m,
+    std::size_t n,
+    std::size_t d,
+    T const* a,
+    std::size_t lda,
+    T const* b,
+    std::size_t ldb,
+    std::size_t k,
+    std::size_t* indices,
+    T* values) noexcept {
+  auto const norms = distance_norms<T>(which, m, n, d, a, lda, b, ldb);
+  auto const negated = impl::larger_is_nearer(which);
+  auto heaps = std::vector<std::pair<T, std::size_t>>(m * k);
+  auto sizes = std::vector<std::size_t>(m, 0);
+  for_each_column_tile(
+      n, d, b, ldb, [&](std::size_t col, std::size_t cols, T const* tile) {
+        for_each_row_block(
+            m, cols, d, [&](std::size_t first, std::size_t rows) {
+              // this thread's, from one tile to the next
+              thread_local auto block = std::vector<T>();
+              block.resize(distance_rows * distance_columns);
+              kernels::gemm(
+                  rows,
+                  cols,
+                  d,
+                  T(1),
+                  a + first * lda,
+                  lda,
+                  tile,
+                  cols,
+                  T(0),
+                  block.data(),
+                  distance_columns);
+              finish_block(
+                  which,
+                  rows,
+                  cols,
+                  block.data(),
+                  distance_columns,
+                  norms.a_norms_from(first),
+                  norms.b_norms_from(col));
+              for (std::size_t i = 0; i < rows; ++i) {
+                auto const row = block.data() + i * distance_columns;
+                for (std::size_t j = 0; j < cols; ++j) {
+                  impl::top_k_push(
+                      heaps.data() + (first + i) * k,
+                      sizes[first + i],
+                      k,
+                      impl::top_k_key(row[j], negated),
+                      col + j);
+                }
+              }
+            });
+      });
+  for (std::size_t i = 0; i < m; ++i) {
+    impl::top_k_finish(
+        heaps.data() + i * k,
+        sizes[i],
+        k,
+        negated,
+        n,
+        indices + i * k,
+        values + i * k);
+  }
+}
+
+template <typename T>
+void inner_product_top_k(
+    std::size_t n,
+    std::size_t d,
+    T const* database,
+    std::size_t ldd,
+    T const* scales,
+    std::size_t q,
+    T const* queries,
+    std::size_t ldq,
+    std::size_t k,
+    std::size_t* indices,
+    T* values) noexcept {
+  using entry = std::pair<T, std::size_t>;
+  // the keys are the negated scores, so that smaller is better
+  auto const inf = std::numeric_limits<T>::infinity();
+
+  auto queries_transposed = std::vector<T>(d * q);
+  kernels::transpose(q, d, queries, ldq, queries_transposed.data(), q);
+
+  auto const blocks = (n + search_rows - 1) / search_rows;
+  auto const chunks =
+      parallel_chunks(n * q * std::max<std::size_t>(d, 1), blocks);
+  auto heaps = std::vector<entry>(chunks * q * k);
+  auto sizes = std::vector<std::size_t>(chunks * q, 0);
+  parallel_for(chunks, chunks, [&](std::size_t begin, std::size_t end) {
+    auto scores = std::vector<T>(search_rows * q);
+    auto thresholds = std::vector<T>(q);
+    for (auto chunk = begin; chunk < end; ++chunk) {
+      auto const chunk_heaps = heaps.data() + chunk * q * k;
+      auto const chunk_sizes = sizes.data() + chunk * q;
+      std::fill(thresholds.begin(), thresholds.end(), inf);
+
+      auto const first_row = n * chunk / chunks;
+      auto const last_row = n * (chunk + 1) / chunks;
+      for (auto row = first_row; row < last_row; row += search_rows) {
+        auto const rows = std::min(search_rows, last_row - row);
+        if (q == 1) {
+          kernels::gemv(
+              rows,
+              d,
+              T(1),
+              database + row * ldd,
+              ldd,
+              queries,
+              T(0),
+              scores.data());
+        } else {
+          kernels::gemm(
+              rows,
+              q,
+              d,
+              T(1),
+              database + row * ldd,
+              ldd,
+              queries_transposed.data(),
+              q,
+              T(0),
+              scores.data(),
+              q);
+        }
+        for (std::size_t r = 0; r < rows; ++r) {
+          auto const scale = scales ? scales[row + r] : T(1);
+          for (std::size_t query = 0; query < q; ++query) {
+            // rows only go up within a chunk, so a tie never wins
+            auto const key =
+                impl::top_k_key(scores[r * q + query] * scale, true);
+            if (!(key < thresholds[query])) {
+              continue;
+            }
+            auto& size = chunk_sizes[query];
+            impl::top_k_push(
+                chunk_heaps + query * k, size, k, key, row + r);
+            if (size == k) {
+              thresholds[query] = chunk_heaps[query * k].first;
+            }
+          }
+        }
+      }
+    }
+  });
+
+  // each chunk's top k, into the first chunk's heap
+  for (std::size_t query = 0; query < q; ++query) {
+    auto const heap = heaps.data() + query * k;
+    auto& size = sizes[query];
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+      auto const other = heaps.data() + (chunk * q + query) * k;
+      for (std::size_t idx = 0; idx < sizes[chunk * q + query]; ++idx) {
+        impl::top_k_push(heap, size, k, other[idx].first, other[idx].second);
+      }
+    }
+    impl::top_k_finish(
+        heap, size, k, true, n, indices + query * k, values + query * k);
+  }
+}
+
+} // namespace
+} // namespace implementation
+
+void pairwise(
+    metric which,
+    std::size_t m,
+    std::size_t n,
+    std::size_t d,
+    float const* a,
+    std::size_t lda,
+    float const* b,
+    std::size_t ldb,
+    float* out,
+    std::size_t ldo) noexcept {
+  implementation::pairwise(which, m, n, d, a, lda, b, ldb, out, ldo);
+}
+void pairwise(
+    metric which,
+    std::size_t m,
+    std::size_t n,
+    std::size_t d,
+    double const* a,
+    std::size_t lda,
+    double const* b,
+    std::size_t ldb,
+    double* out,
+    std::size_t ldo) noexcept {
+  implementation::pairwise(which, m, n, d, a, lda, b, ldb, out, ldo);
+}
+
+void pairwise_top_k(
+    metric which,
+    std::size_t m,
+    std::size_t n,
+    std::size_t d,
+    float const* a,
+    std::size_t lda,
+    float const* b,
+    std::size_t ldb,
+    std::size_t k,
+    std::size_t* indices,
+    float* values) noexcept {
+  implementation::pairwise_top_k(
+      which, m, n, d, a, lda, b, ldb, k, indices, values);
+}
+void pairwise_top_k(
+    metric which,
+    std::size_t m,
+    std::size_t n,
+    std::size_t d,
+    double const* a,
+    std::size_t lda,
+    double const* b,
+    std::size_t ldb,
+    std::size_t k,
+    std::size_t* indices,
+    double* values) noexcept {
+  implementation::pairwise_top_k(
+      which, m, n, d, a, lda, b, ldb, k, indices, values);
+}
+
+void inner_product_top_k(
+    std::size_t n,
+    std::size_t d,
+    float const* database,
+    std::size_t ldd,
+    float const* scales,
+    std::size_t q,
+    float const* queries,
+    std::size_t ldq,
+    std::size_t k,
+    std::size_t* indices,
+    float* values) noexcept {
+  implementation::inner_product_top_k(
+      n, d, database, ldd, scales, q, queries, ldq, k, indices, values);
+}
+void inner_product_top_k(
+    std::size_t n,
+    std::size_t d,
+    double const* database,
+    std::size_t ldd,
+    double const* scales,
+    std::size_t q,
+    double const* queries,
+    std::size_t ldq,
+    std::size_t k,
+    std::size_t* indices,
+    double* values) noexcept {
+  implementation::inner_product_top_k(
+      n, d, database, ldd, scales, q, queries, ldq, k, indices, values);
+}
+
+} // namespace algae::kernels
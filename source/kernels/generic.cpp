@@ -0,0 +1,23 @@
+#include <cstdint>
+
+#include "kernel_table.h"
+#include "kernel_templates.h"
+
+// portable kernels; whatever the compiler makes of these by default
+
+namespace algae::kernels::implementation {
+
+kernel_table const& generic_table() noexcept {
+  static constexpr kernel_table table = {
+      isa::generic,
+      make_ops<scalar_simd<float>>(),
+      make_ops<scalar_simd<double>>(),
+      make_integer_ops<
+          scalar_simd<std::int32_t>,
+          scalar_simd<std::uint64_t>,
+          scalar_mod>(),
+  };
+  return table;
+}
+
+} // namespace algae::kernels::implementation
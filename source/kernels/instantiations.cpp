@@ -0,0 +1,4 @@
+#include <algae/implementation/instantiations.h>
+#include <algae/kernels.h>
+
+ALGAE_FOR_EACH_INSTANTIATED_TYPE(ALGAE_INSTANTIATE_ALGORITHMS, template)
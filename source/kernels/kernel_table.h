@@ -0,0 +1,230 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <algae/kernels.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||           \
+    defined(_M_IX86)
+#define ALGAE_KERNELS_X86 1
+#else
+#define ALGAE_KERNELS_X86 0
+#endif
+
+namespace algae::kernels::implementation {
+
+// one set of kernels for a single element type
+template <typename T>
+struct kernel_ops {
+  T (*dot)(T const*, T const*, std::size_t);
+
+  void (*add)(T const*, T const*, T*, std::size_t);
+  void (*subtract)(T const*, T const*, T*, std::size_t);
+  void (*hadamard)(T const*, T const*, T*, std::size_t);
+  void (*axpy)(T, T const*, T*, std::size_t);
+
+  void (*axpby)(T, T const*, T, T*, std::size_t);
+  void (*scal)(T, T*, std::size_t);
+  T (*nrm2)(T const*, std::size_t);
+  T (*asum)(T const*, std::size_t);
+  std::size_t (*iamax)(T const*, std::size_t);
+  std::size_t (*iamin)(T const*, std::size_t);
+  void (*swap)(T*, T*, std::size_t);
+  void (*copy)(T const*, T*, std::size_t);
+  void (*rot)(T*, T*, std::size_t, T, T);
+  T (*axpy_dot)(T, T const*, T*, T const*, std::size_t);
+
+  void (*gemm)(
+      std::size_t,
+      std::size_t,
+      std::size_t,
+      T,
+      T const*,
+      std::size_t,
+      T const*,
+      std::size_t,
+      T,
+      T*,
+      std::size_t,
+      blocking const&);
+  void (*min_plus_gemm)(
+      std::size_t,
+      std::size_t,
+      std::size_t,
+      T const*,
+      std::size_t,
+      T const*,
+      std::size_t,
+      T*,
+      std::size_t,
+      blocking const&);
+
+  void (*gemv)(
+      std::size_t, std::size_t, T, T const*, std::size_t, T const*, T, T*);
+  void (*gemv_t)(
+      std::size_t,
+      std::size_t,
+      T,
+      T const*,
+      std::size_t,
+      T const*,
+      T,
+      T*,
+      blocking const&);
+
+  void (*trsv)(triangle, diagonal, std::size_t, T const*, std::size_t, T*);
+  void (*trsm)(
+      triangle,
+      diagonal,
+      std::size_t,
+      std::size_t,
+      T const*,
+      std::size_t,
+      T*,
+      std::size_t,
+      blocking const&);
+
+  void (*transpose)(
+      std::size_t,
+      std::size_t,
+      T const*,
+      std::size_t,
+      T*,
+      std::size_t,
+      blocking const&);
+  void (*column_sums)(
+      std::size_t, std::size_t, T const*, std::size_t, T*, blocking const&);
+
+  void (*batched_gemm)(std::size_t, std::size_t, T const*, T const*, T*);
+  void (*batched_inverse)(std::size_t, std::size_t, T*, T*, bool*);
+  void (*batched_solve)(std::size_t, std::size_t, T*, T*, bool*);
+  void (*batched_cholesky)(std::size_t, std::size_t, T*, bool*);
+
+  void (*adc_block)(
+      std::size_t,
+      std::size_t,
+      std::size_t,
+      std::uint8_t const*,
+      T const*,
+      T*);
+};
+
+// the semiring kernels for 32-bit integers and for packed bits, and the
+// modular ones
+struct integer_ops {
+  void (*min_plus_gemm)(
+      std::size_t,
+      std::size_t,
+      std::size_t,
+      std::int32_t const*,
+      std::size_t,
+      std::int32_t const*,
+      std::size_t,
+      std::int32_t*,
+      std::size_t,
+      blocking const&);
+  void (*or_and_gemm)(
+      std::size_t,
+      std::size_t,
+      std::size_t,
+      std::uint64_t const*,
+      std::size_t,
+      std::uint64_t const*,
+      std::size_t,
+      std::uint64_t*,
+      std::size_t,
+      blocking const&);
+  void (*xor_and_gemm)(
+      std::size_t,
+      std::size_t,
+      std::size_t,
+      std::uint64_t const*,
+      std::size_t,
+      std::uint64_t const*,
+      std::size_t,
+      std::uint64_t*,
+      std::size_t,
+      blocking const&);
+  void (*and_popcounts)(
+      std::size_t,
+      std::size_t,
+      std::size_t,
+      std::uint64_t const*,
+      std::size_t,
+      std::uint64_t const*,
+      std::size_t,
+      std::size_t*,
+      std::size_t,
+      blocking const&);
+  void (*xor_popcounts)(
+      std::size_t,
+      std::size_t,
+      std::size_t,
+      std::uint64_t const*,
+      std::size_t,
+      std::uint64_t const*,
+      std::size_t,
+      std::size_t*,
+      std::size_t,
+      blocking const&);
+  void (*mod_gemm)(
+      std::size_t,
+      std::size_t,
+      std::size_t,
+      std::uint32_t,
+      std::uint32_t const*,
+      std::size_t,
+      std::uint32_t const*,
+      std::size_t,
+      std::uint32_t*,
+      std::size_t,
+      blocking const&);
+  void (*mod_axpy)(
+      std::uint32_t,
+      std::uint32_t,
+      std::uint32_t const*,
+      std::uint32_t*,
+      std::size_t);
+};
+
+// every kernel, compiled for a single instruction set
+struct kernel_table {
+  isa level;
+  kernel_ops<float> f32;
+  kernel_ops<double> f64;
+  integer_ops integer;
+
+  template <typename T>
+  constexpr kernel_ops<T> const& ops() const noexcept {
+    if constexpr (std::is_same_v<T, float>) {
+      return f32;
+    } else {
+      return f64;
+    }
+  }
+};
+
+struct cpu_features {
+  bool sse4_2 = false;
+  bool popcnt = false;
+  bool avx2 = false;
+  bool fma = false;
+  bool avx512f = false;
+};
+
+cpu_features detect_cpu_features() noexcept;
+
+// the table in use; for the kernels built on top of the others, in their
+// own translation units
+kernel_table const& active_table() noexcept;
+
+kernel_table const& generic_table() noexcept;
+#if ALGAE_KERNELS_X86
+kernel_table const& sse4_2_table() noexcept;
+kernel_table const& avx2_table() noexcept;
+kernel_table const& avx512_table() noexcept;
+#endif
+
+} // namespace algae::kernels::implementation
@@ -0,0 +1,1743 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "kernel_table.h"
+
+/*
+  the kernels, written once against a `Simd` wrapper of one register
+  (zero, broadcast, load, store, add, sub, mul, fmadd, ...). Everything is
+  in an anonymous namespace, compiled again for each instruction set.
+*/
+
+namespace algae::kernels::implementation {
+namespace {
+
+// product quantization's lookups: the sum of table[b * centroids +
+// codes[b]] over the four b, in that order, so that every way of getting
+// a row's sum gets the same one
+template <typename T>
+T adc_quad(T const* table, std::size_t centroids, std::uint8_t const* codes) {
+  auto ret = table[codes[0]];
+  ret = ret + table[centroids + codes[1]];
+  ret = ret + table[2 * centroids + codes[2]];
+  ret = ret + table[3 * centroids + codes[3]];
+  return ret;
+}
+
+// four code bytes as one word, for the gathers to pull apart
+inline int word(std::uint8_t const* codes) {
+  std::int32_t ret;
+  std::memcpy(&ret, codes, sizeof ret);
+  return ret;
+}
+
+// a "register" of one element; used for the portable kernels, and for the
+// tails of the vectorized ones
+template <typename T>
+struct scalar_simd {
+  using value_type = T;
+  using reg = T;
+  static constexpr std::size_t width = 1;
+
+  static reg zero() { return T(0); }
+  static reg broadcast(T x) { return x; }
+  static reg load(T const* ptr) { return *ptr; }
+  static void store(T* ptr, reg r) { *ptr = r; }
+
+  // integers wrap, as they do in a register
+  static reg add(reg a, reg b) {
+    if constexpr (std::is_integral_v<T>) {
+      using U = std::make_unsigned_t<T>;
+      return T(U(a) + U(b));
+    } else {
+      return a + b;
+    }
+  }
+  static reg sub(reg a, reg b) { return a - b; }
+  static reg mul(reg a, reg b) { return a * b; }
+  static reg fmadd(reg a, reg b, reg c) { return a * b + c; }
+
+  static reg abs(reg a) { return a < T(0) ? -a : a; }
+  static reg max(reg a, reg b) { return a < b ? b : a; }
+  static reg min(reg a, reg b) { return b < a ? b : a; }
+
+  static T reduce_add(reg r) { return r; }
+
+  static reg select_equal(reg x, reg y, reg a, reg b) { return x == y ? a : b; }
+  static reg bit_or(reg a, reg b) { return a | b; }
+  static reg bit_xor(reg a, reg b) { return a ^ b; }
+
+  // adc_quad in each lane, where each lane's codes are `stride` bytes on
+  // from the last one's
+  static reg lookup4(
+      T const* table,
+      std::size_t centroids,
+      std::uint8_t const* codes,
+      std::size_t) {
+    return adc_quad(table, centroids, codes);
+  }
+};
+
+// the same, for the modular kernels
+struct scalar_mod {
+  using reg = std::uint32_t;
+  static constexpr std::size_t width = 1;
+
+  static reg broadcast(std::uint32_t x) { return x; }
+  static reg load(std::uint32_t const* ptr) { return *ptr; }
+  static void store(std::uint32_t* ptr, reg r) { *ptr = r; }
+
+  static reg add(reg a, reg b) { return a + b; }
+  static reg sub(reg a, reg b) { return a - b; }
+  static reg min(reg a, reg b) { return b < a ? b : a; }
+  static reg mullo(reg a, reg b) { return a * b; }
+  static reg mulhi(reg a, reg b) {
+    return static_cast<reg>((std::uint64_t(a) * b) >> 32);
+  }
+
+  using wide = std::uint64_t;
+  static constexpr std::size_t wide_width = 1;
+
+  static wide wide_zero() { return 0; }
+  static wide wide_broadcast(std::uint64_t x) { return x; }
+  static wide wide_load(std::uint32_t const* ptr) { return *ptr; }
+  static void wide_store(std::uint64_t* ptr, wide r) { *ptr = r; }
+  static wide wide_multiply_add(wide a, wide b, wide acc) {
+    return acc + a * b;
+  }
+  static wide wide_fold(wide acc, wide c) { return acc >> 63 ? acc - c : acc; }
+};
+
+template <typename Simd>
+typename Simd::value_type dot(
+    typename Simd::value_type const* lhs,
+    typename Simd::value_type const* rhs,
+    std::size_t n) {
+  constexpr auto w = Simd::width;
+
+  // four independent accumulators, to hide the latency of the fmadd
+  auto acc0 = Simd::zero();
+  auto acc1 = Simd::zero();
+  auto acc2 = Simd::zero();
+  auto acc3 = Simd::zero();
+  std::size_t i = 0;
+  for (; i + 4 * w <= n; i += 4 * w) {
+    acc0 = Simd::fmadd(Simd::load(lhs + i), Simd::load(rhs + i), acc0);
+    acc1 = Simd::fmadd(
+        Simd::load(lhs + i + w), Simd::load(rhs + i + w), acc1);
+    acc2 = Simd::fmadd(
+        Simd::load(lhs + i + 2 * w), Simd::load(rhs + i + 2 * w), acc2);
+    acc3 = Simd::fmadd(
+        Simd::load(lhs + i + 3 * w), Simd::load(rhs + i + 3 * w), acc3);
+  }
+  for (; i + w <= n; i += w) {
+    acc0 = Simd::fmadd(Simd::load(lhs + i), Simd::load(rhs + i), acc0);
+  }
+
+  auto ret = Simd::reduce_add(
+      Simd::add(Simd::add(acc0, acc1), Simd::add(acc2, acc3)));
+  for (; i < n; ++i) {
+    ret += lhs[i] * rhs[i];
+  }
+  return ret;
+}
+
+struct add_op {
+  template <typename Simd, typename Reg>
+  static Reg apply(Reg lhs, Reg rhs) {
+    return Simd::add(lhs, rhs);
+  }
+};
+struct subtract_op {
+  template <typename Simd, typename Reg>
+  static Reg apply(Reg lhs, Reg rhs) {
+    return Simd::sub(lhs, rhs);
+  }
+};
+struct hadamard_op {
+  template <typename Simd, typename Reg>
+  static Reg apply(Reg lhs, Reg rhs) {
+    return Simd::mul(lhs, rhs);
+  }
+};
+
+template <typename Simd, typename Op>
+void elementwise(
+    typename Simd::value_type const* lhs,
+    typename Simd::value_type const* rhs,
+    typename Simd::value_type* out,
+    std::size_t n) {
+  using scalar = scalar_simd<typename Simd::value_type>;
+  constexpr auto w = Simd::width;
+
+  std::size_t i = 0;
+  for (; i + w <= n; i += w) {
+    Simd::store(
+        out + i,
+        Op::template apply<Simd>(Simd::load(lhs + i), Simd::load(rhs + i)));
+  }
+  for (; i < n; ++i) {
+    out[i] = Op::template apply<scalar>(lhs[i], rhs[i]);
+  }
+}
+
+template <typename Simd>
+void axpy(
+    typename Simd::value_type alpha,
+    typename Simd::value_type const* x,
+    typename Simd::value_type* y,
+    std::size_t n) {
+  constexpr auto w = Simd::width;
+  auto const a = Simd::broadcast(alpha);
+
+  std::size_t i = 0;
+  for (; i + 2 * w <= n; i += 2 * w) {
+    Simd::store(y + i, Simd::fmadd(a, Simd::load(x + i), Simd::load(y + i)));
+    Simd::store(
+        y + i + w,
+        Simd::fmadd(a, Simd::load(x + i + w), Simd::load(y + i + w)));
+  }
+  for (; i + w <= n; i += w) {
+    Simd::store(y + i, Simd::fmadd(a, Simd::load(x + i), Simd::load(y + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] += alpha * x[i];
+  }
+}
+
+// c[0, n) += a0 * b0[0, n) + a1 * b1[0, n) + a2 * b2[0, n) + a3 * b3[0, n)
+// four rows of `b` at once means a quarter of the loads and stores of `c`
+template <typename Simd>
+void axpy4(
+    typename Simd::value_type const (&alpha)[4],
+    typename Simd::value_type const* const (&x)[4],
+    typename Simd::value_type* y,
+    std::size_t n) {
+  constexpr auto w = Simd::width;
+  auto const a0 = Simd::broadcast(alpha[0]);
+  auto const a1 = Simd::broadcast(alpha[1]);
+  auto const a2 = Simd::broadcast(alpha[2]);
+  auto const a3 = Simd::broadcast(alpha[3]);
+
+  std::size_t i = 0;
+  for (; i + w <= n; i += w) {
+    auto acc = Simd::load(y + i);
+    acc = Simd::fmadd(a0, Simd::load(x[0] + i), acc);
+    acc = Simd::fmadd(a1, Simd::load(x[1] + i), acc);
+    acc = Simd::fmadd(a2, Simd::load(x[2] + i), acc);
+    acc = Simd::fmadd(a3, Simd::load(x[3] + i), acc);
+    Simd::store(y + i, acc);
+  }
+  for (; i < n; ++i) {
+    y[i] += alpha[0] * x[0][i] + alpha[1] * x[1][i] + alpha[2] * x[2][i] +
+        alpha[3] * x[3][i];
+  }
+}
+
+// level 1 BLAS
+
+// y = alpha * x + beta * y
+template <typename Simd>
+void axpby(
+    typename Simd::value_type alpha,
+    typename Simd::value_type const* x,
+    typename Simd::value_type beta,
+    typename Simd::value_type* y,
+    std::size_t n) {
+  constexpr auto w = Simd::width;
+  auto const a = Simd::broadcast(alpha);
+  auto const b = Simd::broadcast(beta);
+
+  std::size_t i = 0;
+  for (; i + w <= n; i += w) {
+    Simd::store(
+        y + i,
+        Simd::fmadd(a, Simd::load(x + i), Simd::mul(b, Simd::load(y + i))));
+  }
+  for (; i < n; ++i) {
+    y[i] = alpha * x[i] + beta * y[i];
+  }
+}
+
+template <typename Simd>
+void scal(
+    typename Simd::value_type alpha,
+    typename Simd::value_type* x,
+    std::size_t n) {
+  constexpr auto w = Simd::width;
+  auto const a = Simd::broadcast(alpha);
+
+  std::size_t i = 0;
+  for (; i + w <= n; i += w) {
+    Simd::store(x + i, Simd::mul(a, Simd::load(x + i)));
+  }
+  for (; i < n; ++i) {
+    x[i] *= alpha;
+  }
+}
+
+template <typename Simd>
+typename Simd::value_type
+asum(typename Simd::value_type const* x, std::size_t n) {
+  constexpr auto w = Simd::width;
+
+  auto acc0 = Simd::zero();
+  auto acc1 = Simd::zero();
+  std::size_t i = 0;
+  for (; i + 2 * w <= n; i += 2 * w) {
+    acc0 = Simd::add(acc0, Simd::abs(Simd::load(x + i)));
+    acc1 = Simd::add(acc1, Simd::abs(Simd::load(x + i + w)));
+  }
+  for (; i + w <= n; i += w) {
+    acc0 = Simd::add(acc0, Simd::abs(Simd::load(x + i)));
+  }
+
+  auto ret = Simd::reduce_add(Simd::add(acc0, acc1));
+  for (; i < n; ++i) {
+    ret += scalar_simd<typename Simd::value_type>::abs(x[i]);
+  }
+  return ret;
+}
+
+// the largest (Is_max) or smallest (!Is_max) absolute value in x[0, n)
+// n must not be zero
+template <typename Simd, bool Is_max>
+typename Simd::value_type
+abs_extreme(typename Simd::value_type const* x, std::size_t n) {
+  using T = typename Simd::value_type;
+  using scalar = scalar_simd<T>;
+  constexpr auto w = Simd::width;
+
+  auto ret = scalar::abs(x[0]);
+  std::size_t i = 0;
+  if (n >= w) {
+    auto acc = Simd::abs(Simd::load(x));
+    for (i = w; i + w <= n; i += w) {
+      auto const v = Simd::abs(Simd::load(x + i));
+      acc = Is_max ? Simd::max(acc, v) : Simd::min(acc, v);
+    }
+    T lanes[w];
+    Simd::store(lanes, acc);
+    for (auto lane : lanes) {
+      ret = Is_max ? scalar::max(ret, lane) : scalar::min(ret, lane);
+    }
+  }
+  for (; i < n; ++i) {
+    auto const v = scalar::abs(x[i]);
+    ret = Is_max ? scalar::max(ret, v) : scalar::min(ret, v);
+  }
+  return ret;
+}
+
+// the first index of the largest (or smallest) absolute value; 0 if n is 0
+// finding the value is vectorized, and then it's a scan for the first
+// element that has it, which stops as soon as it gets there
+template <typename Simd, bool Is_max>
+std::size_t
+index_abs_extreme(typename Simd::value_type const* x, std::size_t n) {
+  using scalar = scalar_simd<typename Simd::value_type>;
+  if (n == 0) {
+    return 0;
+  }
+  auto const target = abs_extreme<Simd, Is_max>(x, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (scalar::abs(x[i]) == target) {
+      return i;
+    }
+  }
+  // only if there are NaNs about
+  return 0;
+}
+
+// sum of (scale * x[i])^2
+template <typename Simd>
+typename Simd::value_type sum_squares(
+    typename Simd::value_type const* x,
+    std::size_t n,
+    typename Simd::value_type scale) {
+  constexpr auto w = Simd::width;
+  auto const s = Simd::broadcast(scale);
+
+  auto acc0 = Simd::zero();
+  auto acc1 = Simd::zero();
+  std::size_t i = 0;
+  for (; i + 2 * w <= n; i += 2 * w) {
+    auto const v0 = Simd::mul(s, Simd::load(x + i));
+    auto const v1 = Simd::mul(s, Simd::load(x + i + w));
+    acc0 = Simd::fmadd(v0, v0, acc0);
+    acc1 = Simd::fmadd(v1, v1, acc1);
+  }
+  for (; i + w <= n; i += w) {
+    auto const v = Simd::mul(s, Simd::load(x + i));
+    acc0 = Simd::fmadd(v, v, acc0);
+  }
+
+  auto ret = Simd::reduce_add(Simd::add(acc0, acc1));
+  for (; i < n; ++i) {
+    auto const v = scale * x[i];
+    ret += v * v;
+  }
+  return ret;
+}
+
+/*
+  the euclidean norm, scaled by a power of two when squaring the largest
+  element could overflow or underflow.
+*/
+template <typename Simd>
+typename Simd::value_type
+nrm2(typename Simd::value_type const* x, std::size_t n) {
+  using T = typename Simd::value_type;
+  using limits = std::numeric_limits<T>;
+  if (n == 0) {
+    return T(0);
+  }
+
+  auto const largest = abs_extreme<Simd, true>(x, n);
+  if (!(largest > T(0) && largest <= limits::max())) {
+    // zero, infinity, or NaN
+    return largest;
+  }
+
+  auto const small = std::sqrt(limits::min());
+  auto const big = std::sqrt(limits::max() / T(n));
+  if (largest > small && largest < big) {
+    return std::sqrt(sum_squares<Simd>(x, n, T(1)));
+  }
+
+  auto const exponent = std::max(std::ilogb(largest), limits::min_exponent);
+  auto const scaled = sum_squares<Simd>(x, n, std::ldexp(T(1), -exponent));
+  return std::ldexp(std::sqrt(scaled), exponent);
+}
+
+template <typename Simd>
+void swap(
+    typename Simd::value_type* x,
+    typename Simd::value_type* y,
+    std::size_t n) {
+  constexpr auto w = Simd::width;
+
+  std::size_t i = 0;
+  for (; i + w <= n; i += w) {
+    auto const xs = Simd::load(x + i);
+    Simd::store(x + i, Simd::load(y + i));
+    Simd::store(y + i, xs);
+  }
+  for (; i < n; ++i) {
+    auto const tmp = x[i];
+    x[i] = y[i];
+    y[i] = tmp;
+  }
+}
+
+// y = x
+template <typename Simd>
+void copy(
+    typename Simd::value_type const* x,
+    typename Simd::value_type* y,
+    std::size_t n) {
+  constexpr auto w = Simd::width;
+
+  std::size_t i = 0;
+  for (; i + w <= n; i += w) {
+    Simd::store(y + i, Simd::load(x + i));
+  }
+  for (; i < n; ++i) {
+    y[i] = x[i];
+  }
+}
+
+// (x, y) = (c * x + s * y, c * y - s * x)
+template <typename Simd>
+void rot(
+    typename Simd::value_type* x,
+    typename Simd::value_type* y,
+    std::size_t n,
+    typename Simd::value_type c,
+    typename Simd::value_type s) {
+  constexpr auto w = Simd::width;
+  auto const cs = Simd::broadcast(c);
+  auto const ss = Simd::broadcast(s);
+
+  std::size_t i = 0;
+  for (; i + w <= n; i += w) {
+    auto const xs = Simd::load(x + i);
+    auto const ys = Simd::load(y + i);
+    Simd::store(x + i, Simd::fmadd(cs, xs, Simd::mul(ss, ys)));
+    Simd::store(y + i, Simd::sub(Simd::mul(cs, ys), Simd::mul(ss, xs)));
+  }
+  for (; i < n; ++i) {
+    auto const xi = x[i];
+    auto const yi = y[i];
+    x[i] = c * xi + s * yi;
+    y[i] = c * yi - s * xi;
+  }
+}
+
+// y = alpha * x + y, and then returns dot(y, z); one pass over memory
+// rather than two
+template <typename Simd>
+typename Simd::value_type axpy_dot(
+    typename Simd::value_type alpha,
+    typename Simd::value_type const* x,
+    typename Simd::value_type* y,
+    typename Simd::value_type const* z,
+    std::size_t n) {
+  constexpr auto w = Simd::width;
+  auto const a = Simd::broadcast(alpha);
+
+  auto acc0 = Simd::zero();
+  auto acc1 = Simd::zero();
+  std::size_t i = 0;
+  for (; i + 2 * w <= n; i += 2 * w) {
+    auto const y0 = Simd::fmadd(a, Simd::load(x + i), Simd::load(y + i));
+    auto const y1 =
+        Simd::fmadd(a, Simd::load(x + i + w), Simd::load(y + i + w));
+    Simd::store(y + i, y0);
+    Simd::store(y + i + w, y1);
+    acc0 = Simd::fmadd(y0, Simd::load(z + i), acc0);
+    acc1 = Simd::fmadd(y1, Simd::load(z + i + w), acc1);
+  }
+  for (; i + w <= n; i += w) {
+    auto const y0 = Simd::fmadd(a, Simd::load(x + i), Simd::load(y + i));
+    Simd::store(y + i, y0);
+    acc0 = Simd::fmadd(y0, Simd::load(z + i), acc0);
+  }
+
+  auto ret = Simd::reduce_add(Simd::add(acc0, acc1));
+  for (; i < n; ++i) {
+    y[i] += alpha * x[i];
+    ret += y[i] * z[i];
+  }
+  return ret;
+}
+
+template <typename T>
+void scale_matrix(std::size_t m, std::size_t n, T beta, T* c, std::size_t ldc) {
+  if (beta == T(1)) {
+    return;
+  }
+  for (std::size_t i = 0; i < m; ++i) {
+    auto const row = c + i * ldc;
+    if (beta == T(0)) {
+      std::fill(row, row + n, T(0));
+    } else {
+      for (std::size_t j = 0; j < n; ++j) {
+        row[j] *= beta;
+      }
+    }
+  }
+}
+
+template <typename Simd>
+void gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    typename Simd::value_type alpha,
+    typename Simd::value_type const* a,
+    std::size_t lda,
+    typename Simd::value_type const* b,
+    std::size_t ldb,
+    typename Simd::value_type beta,
+    typename Simd::value_type* c,
+    std::size_t ldc,
+    blocking const& blocks) {
+  using T = typename Simd::value_type;
+
+  scale_matrix(m, n, beta, c, ldc);
+  if (alpha == T(0)) {
+    return;
+  }
+
+  // each kc x nc panel of `b` is streamed through every row of `c` while
+  // it's still in cache
+  for (std::size_t jc = 0; jc < n; jc += blocks.gemm_nc) {
+    auto const nb = std::min(blocks.gemm_nc, n - jc);
+    for (std::size_t pc = 0; pc < k; pc += blocks.gemm_kc) {
+      auto const kb = std::min(blocks.gemm_kc, k - pc);
+      for (std::size_t i = 0; i < m; ++i) {
+        auto const a_row = a + i * lda;
+        auto const c_row = c + i * ldc + jc;
+
+        std::size_t p = pc;
+        for (; p + 4 <= pc + kb; p += 4) {
+          T const scales[4] = {
+              alpha * a_row[p],
+              alpha * a_row[p + 1],
+              alpha * a_row[p + 2],
+              alpha * a_row[p + 3]};
+          T const* const rows[4] = {
+              b + p * ldb + jc,
+              b + (p + 1) * ldb + jc,
+              b + (p + 2) * ldb + jc,
+              b + (p + 3) * ldb + jc};
+          axpy4<Simd>(scales, rows, c_row, nb);
+        }
+        for (; p < pc + kb; ++p) {
+          axpy<Simd>(alpha * a_row[p], b + p * ldb + jc, c_row, nb);
+        }
+      }
+    }
+  }
+}
+
+// semirings
+
+// a + b over min-plus; for integers, where there's no infinity, the
+// largest value stands in for it, and has to stay that way. The sum wraps
+// when either one is infinite, and is thrown away; finite weights have to
+// stay below half the largest value for their sums not to wrap as well
+template <typename Simd>
+typename Simd::reg tropical_times(
+    typename Simd::reg a, typename Simd::reg b, typename Simd::reg inf) {
+  if constexpr (std::numeric_limits<typename Simd::value_type>::has_infinity) {
+    static_cast<void>(inf);
+    return Simd::add(a, b);
+  } else {
+    return Simd::select_equal(
+        a, inf, inf, Simd::select_equal(b, inf, inf, Simd::add(a, b)));
+  }
+}
+
+// c[0, n) = min(c, a[0] + b[0][0, n), ..., a[Rows - 1] + b[Rows - 1][0, n))
+template <typename Simd, std::size_t Rows>
+void min_plus_rows(
+    typename Simd::value_type const* a,
+    typename Simd::value_type const* const* b,
+    typename Simd::value_type* c,
+    std::size_t n) {
+  using T = typename Simd::value_type;
+  using scalar = scalar_simd<T>;
+  constexpr auto w = Simd::width;
+  constexpr auto inf = min_plus<T>::zero();
+  auto const inf_reg = Simd::broadcast(inf);
+
+  typename Simd::reg scales[Rows];
+  for (std::size_t r = 0; r < Rows; ++r) {
+    scales[r] = Simd::broadcast(a[r]);
+  }
+
+  std::size_t j = 0;
+  for (; j + w <= n; j += w) {
+    auto acc = Simd::load(c + j);
+    for (std::size_t r = 0; r < Rows; ++r) {
+      acc = Simd::min(
+          acc, tropical_times<Simd>(scales[r], Simd::load(b[r] + j), inf_reg));
+    }
+    Simd::store(c + j, acc);
+  }
+  for (; j < n; ++j) {
+    for (std::size_t r = 0; r < Rows; ++r) {
+      c[j] = scalar::min(c[j], tropical_times<scalar>(a[r], b[r][j], inf));
+    }
+  }
+}
+
+// c = min(c, a (min-plus) b), where a is m x k and b is k x n; blocked the
+// same way as gemm. Infinite elements of `a` are skipped over, which for
+// the adjacency matrix of a sparse graph is most of them
+template <typename Simd>
+void min_plus_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    typename Simd::value_type const* a,
+    std::size_t lda,
+    typename Simd::value_type const* b,
+    std::size_t ldb,
+    typename Simd::value_type* c,
+    std::size_t ldc,
+    blocking const& blocks) {
+  using T = typename Simd::value_type;
+  constexpr auto inf = min_plus<T>::zero();
+
+  for (std::size_t jc = 0; jc < n; jc += blocks.gemm_nc) {
+    auto const nb = std::min(blocks.gemm_nc, n - jc);
+    for (std::size_t pc = 0; pc < k; pc += blocks.gemm_kc) {
+      auto const kb = std::min(blocks.gemm_kc, k - pc);
+      for (std::size_t i = 0; i < m; ++i) {
+        auto const a_row = a + i * lda;
+        auto const c_row = c + i * ldc + jc;
+
+        T scales[4];
+        T const* rows[4];
+        std::size_t count = 0;
+        for (std::size_t p = pc; p < pc + kb; ++p) {
+          if (!(a_row[p] < inf)) {
+            continue;
+          }
+          scales[count] = a_row[p];
+          rows[count] = b + p * ldb + jc;
+          if (++count == 4) {
+            min_plus_rows<Simd, 4>(scales, rows, c_row, nb);
+            count = 0;
+          }
+        }
+        for (std::size_t r = 0; r < count; ++r) {
+          min_plus_rows<Simd, 1>(scales + r, rows + r, c_row, nb);
+        }
+      }
+    }
+  }
+}
+
+// c |= a (or-and) b, for bit matrices with 64 bits to a word, lowest bit
+// first; a is m x k bits, and b is k x (64 * n_words). Every set bit of a
+// row of `a` ors a row of `b` into `c`, and zero words are skipped whole
+template <typename Bits>
+void or_and_gemm(
+    std::size_t m,
+    std::size_t n_words,
+    std::size_t k,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::uint64_t* c,
+    std::size_t ldc,
+    blocking const& blocks) {
+  constexpr auto w = Bits::width;
+
+  for (std::size_t jc = 0; jc < n_words; jc += blocks.gemm_nc) {
+    auto const nb = std::min(blocks.gemm_nc, n_words - jc);
+    for (std::size_t i = 0; i < m; ++i) {
+      auto const a_row = a + i * lda;
+      auto const c_row = c + i * ldc + jc;
+      for (std::size_t p = 0; p < k; ++p) {
+        auto const word = a_row[p / 64];
+        if (word == 0) {
+          p += 63 - p % 64;
+          continue;
+        }
+        if (((word >> (p % 64)) & 1) == 0) {
+          continue;
+        }
+
+        auto const b_row = b + p * ldb + jc;
+        std::size_t j = 0;
+        for (; j + w <= nb; j += w) {
+          Bits::store(
+              c_row + j,
+              Bits::bit_or(Bits::load(c_row + j), Bits::load(b_row + j)));
+        }
+        for (; j < nb; ++j) {
+          c_row[j] |= b_row[j];
+        }
+      }
+    }
+  }
+}
+
+// the number of bits set; a single instruction, where the target has it
+std::size_t popcount(std::uint64_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  x = x - ((x >> 1) & 0x5555555555555555ull);
+  x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+  return static_cast<std::size_t>((x * 0x0101010101010101ull) >> 56);
+#else
+  return static_cast<std::size_t>(__builtin_popcountll(x));
+#endif
+}
+
+// dst = x ^ y, for n words
+template <typename Bits>
+void xor_words(
+    std::uint64_t* dst,
+    std::uint64_t const* x,
+    std::uint64_t const* y,
+    std::size_t n) {
+  constexpr auto w = Bits::width;
+  std::size_t j = 0;
+  for (; j + w <= n; j += w) {
+    Bits::store(dst + j, Bits::bit_xor(Bits::load(x + j), Bits::load(y + j)));
+  }
+  for (; j < n; ++j) {
+    dst[j] = x[j] ^ y[j];
+  }
+}
+
+// c ^= a (xor-and) b, the product over GF(2), packed as for or_and_gemm.
+// This is the Method of Four Russians: for eight rows of b at a time, a
+// table holds all 256 sums of them, and each row of c adds in the one its
+// byte of a picks out. The table covers a panel of 16 words of b, so it
+// stays in L1. For only a few rows of a, building the table costs more
+// than it saves, and each set bit of a adds in its row of b instead
+template <typename Bits>
+void xor_and_gemm(
+    std::size_t m,
+    std::size_t n_words,
+    std::size_t k,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::uint64_t* c,
+    std::size_t ldc,
+    blocking const&) {
+  constexpr std::size_t panel = 16;
+
+  if (m < 64) {
+    for (std::size_t i = 0; i < m; ++i) {
+      auto const c_row = c + i * ldc;
+      for (std::size_t p0 = 0; p0 < k; p0 += 64) {
+        auto word = a[i * lda + p0 / 64];
+        if (k - p0 < 64) {
+          word &= (std::uint64_t(1) << (k - p0)) - 1;
+        }
+        for (; word != 0; word &= word - 1) {
+          auto const p = p0 + popcount((word & (~word + 1)) - 1);
+          xor_words<Bits>(c_row, c_row, b + p * ldb, n_words);
+        }
+      }
+    }
+    return;
+  }
+
+  std::uint64_t table[256 * panel];
+  for (std::size_t jc = 0; jc < n_words; jc += panel) {
+    auto const nb = std::min(panel, n_words - jc);
+    std::fill(table, table + nb, std::uint64_t(0));
+    for (std::size_t p0 = 0; p0 < k; p0 += 8) {
+      auto const rows = std::min(std::size_t(8), k - p0);
+
+      // every entry is the one with its lowest bit cleared, plus a row
+      for (std::size_t s = 1; s < (std::size_t(1) << rows); ++s) {
+        auto const low = popcount((s & (~s + 1)) - 1);
+        xor_words<Bits>(
+            table + s * nb,
+            table + (s & (s - 1)) * nb,
+            b + (p0 + low) * ldb + jc,
+            nb);
+      }
+
+      auto const mask = (std::uint64_t(1) << rows) - 1;
+      for (std::size_t i = 0; i < m; ++i) {
+        auto const byte = (a[i * lda + p0 / 64] >> (p0 % 64)) & mask;
+        if (byte != 0) {
+          auto const c_row = c + i * ldc + jc;
+          xor_words<Bits>(c_row, c_row, table + byte * nb, nb);
+        }
+      }
+    }
+  }
+}
+
+// out[i, j] = the number of bits set in (row i of a) & (row j of b), or ^
+// for Xor, where a has m rows and b has n, each `words` words long. A
+// panel of rows of b, about the size of a gemm panel, stays in cache while
+// all of a goes past, and four rows of a share every load from b
+template <bool Xor>
+void popcounts(
+    std::size_t m,
+    std::size_t n,
+    std::size_t words,
+    std::uint64_t const* a,
+    std::size_t lda,
+    std::uint64_t const* b,
+    std::size_t ldb,
+    std::size_t* out,
+    std::size_t ldo,
+    blocking const& blocks) {
+  auto const op = [](std::uint64_t x, std::uint64_t y) {
+    return Xor ? x ^ y : x & y;
+  };
+  auto const nc = std::max(
+      std::size_t(1),
+      blocks.gemm_kc * blocks.gemm_nc / std::max(std::size_t(1), words));
+
+  for (std::size_t jc = 0; jc < n; jc += nc) {
+    auto const j1 = std::min(n, jc + nc);
+    std::size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+      auto const a0 = a + i * lda;
+      auto const a1 = a0 + lda;
+      auto const a2 = a1 + lda;
+      auto const a3 = a2 + lda;
+      for (auto j = jc; j < j1; ++j) {
+        auto const b_row = b + j * ldb;
+        std::size_t s0 = 0;
+        std::size_t s1 = 0;
+        std::size_t s2 = 0;
+        std::size_t s3 = 0;
+        for (std::size_t word = 0; word < words; ++word) {
+          auto const bw = b_row[word];
+          s0 += popcount(op(a0[word], bw));
+          s1 += popcount(op(a1[word], bw));
+          s2 += popcount(op(a2[word], bw));
+          s3 += popcount(op(a3[word], bw));
+        }
+        out[i * ldo + j] = s0;
+        out[(i + 1) * ldo + j] = s1;
+        out[(i + 2) * ldo + j] = s2;
+        out[(i + 3) * ldo + j] = s3;
+      }
+    }
+    for (; i < m; ++i) {
+      auto const a_row = a + i * lda;
+      for (auto j = jc; j < j1; ++j) {
+        auto const b_row = b + j * ldb;
+        std::size_t sum = 0;
+        for (std::size_t word = 0; word < words; ++word) {
+          sum += popcount(op(a_row[word], b_row[word]));
+        }
+        out[i * ldo + j] = sum;
+      }
+    }
+  }
+}
+
+/*
+  the modular kernels, on montgomery residues mod an odd p < 2^31.
+  mod_gemm sums unreduced products in 64 bits, folding every few.
+*/
+
+// -1 / p mod 2^32; newton's method doubles the correct bits each time,
+// and p is its own inverse mod 8
+std::uint32_t negated_inverse(std::uint32_t p) {
+  auto inv = p;
+  for (int i = 0; i < 4; ++i) {
+    inv *= 2u - p * inv;
+  }
+  return 0u - inv;
+}
+
+// x / 2^32 mod p, for x < p * 2^32
+std::uint32_t
+montgomery_reduce(std::uint64_t x, std::uint32_t p, std::uint32_t neg_inv) {
+  auto const m = static_cast<std::uint32_t>(x) * neg_inv;
+  auto const t = static_cast<std::uint32_t>((x + std::uint64_t(m) * p) >> 32);
+  return t >= p ? t - p : t;
+}
+
+// x / 2^32 mod p, for any x
+std::uint32_t
+montgomery_finish(std::uint64_t x, std::uint32_t p, std::uint32_t neg_inv) {
+  return montgomery_reduce(
+      ((x >> 32) % p << 32) | (x & 0xffffffff), p, neg_inv);
+}
+
+// a * b / 2^32 mod p, where inv is 1 / p mod 2^32. m * p has the same low
+// half as a * b, so (a * b - m * p) / 2^32 is the difference of the high
+// halves, somewhere in (-p, p)
+template <typename Mod>
+typename Mod::reg montgomery_multiply(
+    typename Mod::reg a,
+    typename Mod::reg b,
+    typename Mod::reg p,
+    typename Mod::reg inv) {
+  auto const m = Mod::mullo(Mod::mullo(a, b), inv);
+  auto const r = Mod::add(Mod::sub(Mod::mulhi(a, b), Mod::mulhi(m, p)), p);
+  return Mod::min(r, Mod::sub(r, p));
+}
+
+// y = y + alpha * x mod p; what an elimination step does to a row
+template <typename Mod>
+void mod_axpy(
+    std::uint32_t p,
+    std::uint32_t alpha,
+    std::uint32_t const* x,
+    std::uint32_t* y,
+    std::size_t n) {
+  constexpr auto w = Mod::width;
+  auto const neg_inv = negated_inverse(p);
+  auto const vp = Mod::broadcast(p);
+  auto const vinv = Mod::broadcast(0u - neg_inv);
+  auto const valpha = Mod::broadcast(alpha);
+
+  std::size_t i = 0;
+  for (; i + w <= n; i += w) {
+    auto const product =
+        montgomery_multiply<Mod>(valpha, Mod::load(x + i), vp, vinv);
+    auto const sum = Mod::add(Mod::load(y + i), product);
+    Mod::store(y + i, Mod::min(sum, Mod::sub(sum, vp)));
+  }
+  for (; i < n; ++i) {
+    auto const sum =
+        y[i] + montgomery_reduce(std::uint64_t(alpha) * x[i], p, neg_inv);
+    y[i] = sum >= p ? sum - p : sum;
+  }
+}
+
+// the unreduced sums for Rows rows of c, and two wide registers of columns
+template <typename Mod, std::size_t Rows>
+void mod_gemm_rows(
+    std::size_t k,
+    std::uint32_t const* a,
+    std::size_t lda,
+    std::uint32_t const* b,
+    std::size_t ldb,
+    std::uint32_t* c,
+    std::size_t ldc,
+    std::uint32_t p,
+    std::uint32_t neg_inv,
+    std::uint64_t fold_every,
+    typename Mod::wide fold_by) {
+  constexpr auto w = Mod::wide_width;
+  typename Mod::wide acc[Rows][2];
+  for (std::size_t r = 0; r < Rows; ++r) {
+    acc[r][0] = Mod::wide_zero();
+    acc[r][1] = Mod::wide_zero();
+  }
+
+  std::uint64_t since_fold = 0;
+  for (std::size_t idx = 0; idx < k; ++idx) {
+    auto const b0 = Mod::wide_load(b + idx * ldb);
+    auto const b1 = Mod::wide_load(b + idx * ldb + w);
+    for (std::size_t r = 0; r < Rows; ++r) {
+      auto const av = Mod::wide_broadcast(a[r * lda + idx]);
+      acc[r][0] = Mod::wide_multiply_add(av, b0, acc[r][0]);
+      acc[r][1] = Mod::wide_multiply_add(av, b1, acc[r][1]);
+    }
+    if (++since_fold == fold_every) {
+      for (std::size_t r = 0; r < Rows; ++r) {
+        acc[r][0] = Mod::wide_fold(acc[r][0], fold_by);
+        acc[r][1] = Mod::wide_fold(acc[r][1], fold_by);
+      }
+      since_fold = 0;
+    }
+  }
+
+  std::uint64_t sums[2 * w];
+  for (std::size_t r = 0; r < Rows; ++r) {
+    Mod::wide_store(sums, acc[r][0]);
+    Mod::wide_store(sums + w, acc[r][1]);
+    for (std::size_t j = 0; j < 2 * w; ++j) {
+      c[r * ldc + j] = montgomery_finish(sums[j], p, neg_inv);
+    }
+  }
+}
+
+// c = a * b mod p, where a is m x k and b is k x n. Four rows at a time,
+// so every load of b is used four times, over a panel of columns of b
+// about the size of a gemm panel
+template <typename Mod>
+void mod_gemm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t k,
+    std::uint32_t p,
+    std::uint32_t const* a,
+    std::size_t lda,
+    std::uint32_t const* b,
+    std::size_t ldb,
+    std::uint32_t* c,
+    std::size_t ldc,
+    blocking const& blocks) {
+  constexpr auto cols = 2 * Mod::wide_width;
+  auto const neg_inv = negated_inverse(p);
+
+  // a sum under 2^63 + p, plus fold_every products, still fits in 64 bits;
+  // folding it takes off a multiple of p just under 2^63
+  auto const top = std::uint64_t(1) << 63;
+  auto const largest = std::uint64_t(p - 1) * (p - 1);
+  auto const fold_every = std::max(std::uint64_t(1), (top - p) / largest);
+  auto const fold_c = top / p * p;
+  auto const fold_by = Mod::wide_broadcast(fold_c);
+
+  // the columns that don't fill two wide registers
+  auto const single = [&](std::size_t i, std::size_t j) {
+    auto sum = std::uint64_t(0);
+    for (std::size_t idx = 0; idx < k; ++idx) {
+      sum += std::uint64_t(a[i * lda + idx]) * b[idx * ldb + j];
+      if (sum >= top) {
+        sum -= fold_c;
+      }
+    }
+    c[i * ldc + j] = montgomery_finish(sum, p, neg_inv);
+  };
+
+  auto const nc = std::max(
+      cols, blocks.gemm_kc * blocks.gemm_nc / std::max(std::size_t(1), k));
+  for (std::size_t jc = 0; jc < n; jc += nc) {
+    auto const j1 = std::min(n, jc + nc);
+    std::size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+      auto j = jc;
+      for (; j + cols <= j1; j += cols) {
+        mod_gemm_rows<Mod, 4>(
+            k,
+            a + i * lda,
+            lda,
+            b + j,
+            ldb,
+            c + i * ldc + j,
+            ldc,
+            p,
+            neg_inv,
+            fold_every,
+            fold_by);
+      }
+      for (; j < j1; ++j) {
+        for (std::size_t r = 0; r < 4; ++r) {
+          single(i + r, j);
+        }
+      }
+    }
+    for (; i < m; ++i) {
+      auto j = jc;
+      for (; j + cols <= j1; j += cols) {
+        mod_gemm_rows<Mod, 1>(
+            k,
+            a + i * lda,
+            lda,
+            b + j,
+            ldb,
+            c + i * ldc + j,
+            ldc,
+            p,
+            neg_inv,
+            fold_every,
+            fold_by);
+      }
+      for (; j < j1; ++j) {
+        single(i, j);
+      }
+    }
+  }
+}
+
+// y[i] = alpha * dot(row i of a, x) + beta * y[i], where a is m x n
+// four rows at a time, so that every load of `x` feeds four fmadds
+template <typename Simd>
+void gemv(
+    std::size_t m,
+    std::size_t n,
+    typename Simd::value_type alpha,
+    typename Simd::value_type const* a,
+    std::size_t lda,
+    typename Simd::value_type const* x,
+    typename Simd::value_type beta,
+    typename Simd::value_type* y) {
+  using T = typename Simd::value_type;
+  constexpr auto w = Simd::width;
+
+  // if beta is zero, y is never read
+  auto const finish = [&](std::size_t i, T sum) {
+    y[i] = beta == T(0) ? alpha * sum : alpha * sum + beta * y[i];
+  };
+
+  std::size_t i = 0;
+  for (; i + 4 <= m; i += 4) {
+    auto const r0 = a + i * lda;
+    auto const r1 = r0 + lda;
+    auto const r2 = r1 + lda;
+    auto const r3 = r2 + lda;
+
+    auto acc0 = Simd::zero();
+    auto acc1 = Simd::zero();
+    auto acc2 = Simd::zero();
+    auto acc3 = Simd::zero();
+    std::size_t j = 0;
+    for (; j + w <= n; j += w) {
+      auto const xs = Simd::load(x + j);
+      acc0 = Simd::fmadd(Simd::load(r0 + j), xs, acc0);
+      acc1 = Simd::fmadd(Simd::load(r1 + j), xs, acc1);
+      acc2 = Simd::fmadd(Simd::load(r2 + j), xs, acc2);
+      acc3 = Simd::fmadd(Simd::load(r3 + j), xs, acc3);
+    }
+
+    T sums[4] = {
+        Simd::reduce_add(acc0),
+        Simd::reduce_add(acc1),
+        Simd::reduce_add(acc2),
+        Simd::reduce_add(acc3)};
+    for (; j < n; ++j) {
+      sums[0] += r0[j] * x[j];
+      sums[1] += r1[j] * x[j];
+      sums[2] += r2[j] * x[j];
+      sums[3] += r3[j] * x[j];
+    }
+    for (std::size_t r = 0; r < 4; ++r) {
+      finish(i + r, sums[r]);
+    }
+  }
+  for (; i < m; ++i) {
+    finish(i, dot<Simd>(a + i * lda, x, n));
+  }
+}
+
+// y[j] = alpha * dot(column j of a, x) + beta * y[j], where a is m x n
+// that's a sum of the rows of `a`, so it's all axpys; done a strip of
+// reduction_nc columns at a time, so that strip of `y` stays in cache
+template <typename Simd>
+void gemv_t(
+    std::size_t m,
+    std::size_t n,
+    typename Simd::value_type alpha,
+    typename Simd::value_type const* a,
+    std::size_t lda,
+    typename Simd::value_type const* x,
+    typename Simd::value_type beta,
+    typename Simd::value_type* y,
+    blocking const& blocks) {
+  using T = typename Simd::value_type;
+
+  scale_matrix(1, n, beta, y, n);
+  if (alpha == T(0)) {
+    return;
+  }
+
+  for (std::size_t jb = 0; jb < n; jb += blocks.reduction_nc) {
+    auto const nb = std::min(blocks.reduction_nc, n - jb);
+    std::size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+      T const scales[4] = {
+          alpha * x[i], alpha * x[i + 1], alpha * x[i + 2], alpha * x[i + 3]};
+      T const* const rows[4] = {
+          a + i * lda + jb,
+          a + (i + 1) * lda + jb,
+          a + (i + 2) * lda + jb,
+          a + (i + 3) * lda + jb};
+      axpy4<Simd>(scales, rows, y + jb, nb);
+    }
+    for (; i < m; ++i) {
+      axpy<Simd>(alpha * x[i], a + i * lda + jb, y + jb, nb);
+    }
+  }
+}
+
+// solves a * x = b for x, in place; a is n x n and triangular
+// one dot product per row, against the part of x that's already solved
+template <typename Simd>
+void trsv(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    typename Simd::value_type const* a,
+    std::size_t lda,
+    typename Simd::value_type* x) {
+  if (tri == triangle::lower) {
+    for (std::size_t i = 0; i < n; ++i) {
+      auto const row = a + i * lda;
+      x[i] -= dot<Simd>(row, x, i);
+      if (diag == diagonal::non_unit) {
+        x[i] /= row[i];
+      }
+    }
+  } else {
+    for (std::size_t i = n; i-- > 0;) {
+      auto const row = a + i * lda;
+      x[i] -= dot<Simd>(row + i + 1, x + i + 1, n - i - 1);
+      if (diag == diagonal::non_unit) {
+        x[i] /= row[i];
+      }
+    }
+  }
+}
+
+/*
+  solves a * x = b in place in b, for a triangular n x n: a block of the
+  diagonal directly, then a gemm for the rows below it.
+*/
+template <typename Simd>
+void trsm(
+    triangle tri,
+    diagonal diag,
+    std::size_t n,
+    std::size_t nrhs,
+    typename Simd::value_type const* a,
+    std::size_t lda,
+    typename Simd::value_type* b,
+    std::size_t ldb,
+    blocking const& blocks) {
+  using T = typename Simd::value_type;
+
+  // the block is the k of the gemm updates, so it shouldn't be more than
+  // gemm_kc; smaller means more of the work goes to gemm
+  auto const nb = std::min<std::size_t>(blocks.gemm_kc, 64);
+
+  auto const solve_row = [&](std::size_t i, std::size_t j0, std::size_t j1) {
+    auto const b_row = b + i * ldb;
+    for (std::size_t j = j0; j < j1; ++j) {
+      axpy<Simd>(-a[i * lda + j], b + j * ldb, b_row, nrhs);
+    }
+    if (diag == diagonal::non_unit) {
+      scal<Simd>(T(1) / a[i * lda + i], b_row, nrhs);
+    }
+  };
+
+  if (tri == triangle::lower) {
+    for (std::size_t k0 = 0; k0 < n; k0 += nb) {
+      auto const k1 = std::min(k0 + nb, n);
+      for (std::size_t i = k0; i < k1; ++i) {
+        solve_row(i, k0, i);
+      }
+      if (k1 < n) {
+        gemm<Simd>(
+            n - k1,
+            nrhs,
+            k1 - k0,
+            T(-1),
+            a + k1 * lda + k0,
+            lda,
+            b + k0 * ldb,
+            ldb,
+            T(1),
+            b + k1 * ldb,
+            ldb,
+            blocks);
+      }
+    }
+  } else {
+    for (std::size_t k1 = n; k1 > 0;) {
+      auto const k0 = k1 > nb ? k1 - nb : 0;
+      for (std::size_t i = k1; i-- > k0;) {
+        solve_row(i, i + 1, k1);
+      }
+      if (k0 > 0) {
+        gemm<Simd>(
+            k0,
+            nrhs,
+            k1 - k0,
+            T(-1),
+            a + k0,
+            lda,
+            b + k0 * ldb,
+            ldb,
+            T(1),
+            b,
+            ldb,
+            blocks);
+      }
+      k1 = k0;
+    }
+  }
+}
+
+// b = transpose(a), where a is m x n
+// done a tile at a time, so that both the reads and the writes stay in cache
+template <typename T>
+void transpose(
+    std::size_t m,
+    std::size_t n,
+    T const* a,
+    std::size_t lda,
+    T* b,
+    std::size_t ldb,
+    blocking const& blocks) {
+  auto const tile = blocks.transpose_tile;
+  for (std::size_t ib = 0; ib < m; ib += tile) {
+    auto const ie = std::min(ib + tile, m);
+    for (std::size_t jb = 0; jb < n; jb += tile) {
+      auto const je = std::min(jb + tile, n);
+      for (std::size_t i = ib; i < ie; ++i) {
+        for (std::size_t j = jb; j < je; ++j) {
+          b[j * ldb + i] = a[i * lda + j];
+        }
+      }
+    }
+  }
+}
+
+// out[j] = sum over i of a[i, j], where a is m x n
+// a strip of reduction_nc columns at a time, so the sums stay in cache
+template <typename Simd>
+void column_sums(
+    std::size_t m,
+    std::size_t n,
+    typename Simd::value_type const* a,
+    std::size_t lda,
+    typename Simd::value_type* out,
+    blocking const& blocks) {
+  using T = typename Simd::value_type;
+  constexpr auto w = Simd::width;
+
+  std::fill(out, out + n, T(0));
+  for (std::size_t jb = 0; jb < n; jb += blocks.reduction_nc) {
+    auto const nb = std::min(blocks.reduction_nc, n - jb);
+    auto const sums = out + jb;
+    for (std::size_t i = 0; i < m; ++i) {
+      auto const row = a + i * lda + jb;
+      std::size_t j = 0;
+      for (; j + w <= nb; j += w) {
+        Simd::store(
+            sums + j, Simd::add(Simd::load(sums + j), Simd::load(row + j)));
+      }
+      for (; j < nb; ++j) {
+        sums[j] += row[j];
+      }
+    }
+  }
+}
+
+/*
+  the batched kernels, on groups of batch_lanes interleaved problems, one
+  to a lane. Pivots and square roots are done a lane at a time.
+*/
+
+// c = a * b
+template <typename Simd>
+void batched_gemm(
+    std::size_t n,
+    std::size_t groups,
+    typename Simd::value_type const* a,
+    typename Simd::value_type const* b,
+    typename Simd::value_type* c) {
+  using T = typename Simd::value_type;
+  constexpr auto lanes = batch_lanes<T>;
+  constexpr auto w = Simd::width;
+
+  auto const size = n * n * lanes;
+  for (std::size_t group = 0; group < groups; ++group) {
+    auto const ga = a + group * size;
+    auto const gb = b + group * size;
+    auto const gc = c + group * size;
+    for (std::size_t lane = 0; lane < lanes; lane += w) {
+      for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+          auto acc = Simd::zero();
+          for (std::size_t p = 0; p < n; ++p) {
+            acc = Simd::fmadd(
+                Simd::load(ga + (i * n + p) * lanes + lane),
+                Simd::load(gb + (p * n + j) * lanes + lane),
+                acc);
+          }
+          Simd::store(gc + (i * n + j) * lanes + lane, acc);
+        }
+      }
+    }
+  }
+}
+
+// swaps rows i and j of the problem in `lane`, from column `first` on
+template <typename T>
+void batched_swap_rows(
+    T* m,
+    std::size_t n,
+    std::size_t lane,
+    std::size_t i,
+    std::size_t j,
+    std::size_t first) {
+  constexpr auto lanes = batch_lanes<T>;
+  for (auto col = first; col < n; ++col) {
+    std::swap(m[(i * n + col) * lanes + lane], m[(j * n + col) * lanes + lane]);
+  }
+}
+
+// partial pivoting on column k of each problem in the group `a`; the rows
+// exchanged in `a` are exchanged in `rhs` too, which has `rhs_width`
+// columns. Fills in scale with the reciprocals of the pivots, or zero for
+// a problem with no pivot, which is then flagged as singular
+template <typename T>
+void batched_pivot(
+    T* a,
+    T* rhs,
+    std::size_t n,
+    std::size_t rhs_width,
+    std::size_t k,
+    T* scale,
+    bool* singular) {
+  constexpr auto lanes = batch_lanes<T>;
+  for (std::size_t lane = 0; lane < lanes; ++lane) {
+    auto const column = a + k * lanes + lane;
+    auto pivot = k;
+    for (auto row = k + 1; row < n; ++row) {
+      if (std::abs(column[row * n * lanes]) >
+          std::abs(column[pivot * n * lanes])) {
+        pivot = row;
+      }
+    }
+    if (pivot != k) {
+      batched_swap_rows(a, n, lane, k, pivot, k);
+      batched_swap_rows(rhs, rhs_width, lane, k, pivot, 0);
+    }
+    auto const value = column[k * n * lanes];
+    if (value == T(0)) {
+      singular[lane] = true;
+      scale[lane] = T(0);
+    } else {
+      scale[lane] = T(1) / value;
+    }
+  }
+}
+
+// out = a^-1, by gauss-jordan elimination; a is overwritten
+template <typename Simd>
+void batched_inverse(
+    std::size_t n,
+    std::size_t groups,
+    typename Simd::value_type* a,
+    typename Simd::value_type* out,
+    bool* singular) {
+  using T = typename Simd::value_type;
+  constexpr auto lanes = batch_lanes<T>;
+  constexpr auto w = Simd::width;
+
+  auto const size = n * n * lanes;
+  T scale[lanes];
+  for (std::size_t group = 0; group < groups; ++group) {
+    auto const ga = a + group * size;
+    auto const gout = out + group * size;
+    auto const flags = singular + group * lanes;
+    auto const at = [&](T* m, std::size_t i, std::size_t j) {
+      return m + (i * n + j) * lanes;
+    };
+
+    std::fill(gout, gout + size, T(0));
+    for (std::size_t i = 0; i < n; ++i) {
+      std::fill(at(gout, i, i), at(gout, i, i) + lanes, T(1));
+    }
+    std::fill(flags, flags + lanes, false);
+
+    for (std::size_t k = 0; k < n; ++k) {
+      batched_pivot(ga, gout, n, n, k, scale, flags);
+      for (std::size_t lane = 0; lane < lanes; lane += w) {
+        // row k gets a one on the diagonal...
+        auto const s = Simd::load(scale + lane);
+        for (auto j = k; j < n; ++j) {
+          auto const ptr = at(ga, k, j) + lane;
+          Simd::store(ptr, Simd::mul(Simd::load(ptr), s));
+        }
+        for (std::size_t j = 0; j < n; ++j) {
+          auto const ptr = at(gout, k, j) + lane;
+          Simd::store(ptr, Simd::mul(Simd::load(ptr), s));
+        }
+        // ...and is taken out of every other row, above and below
+        for (std::size_t i = 0; i < n; ++i) {
+          if (i == k) {
+            continue;
+          }
+          auto const f =
+              Simd::sub(Simd::zero(), Simd::load(at(ga, i, k) + lane));
+          for (auto j = k; j < n; ++j) {
+            auto const ptr = at(ga, i, j) + lane;
+            Simd::store(
+                ptr,
+                Simd::fmadd(
+                    f, Simd::load(at(ga, k, j) + lane), Simd::load(ptr)));
+          }
+          for (std::size_t j = 0; j < n; ++j) {
+            auto const ptr = at(gout, i, j) + lane;
+            Simd::store(
+                ptr,
+                Simd::fmadd(
+                    f, Simd::load(at(gout, k, j) + lane), Simd::load(ptr)));
+          }
+        }
+      }
+    }
+  }
+}
+
+// solves a * x = b, in place in x; a is overwritten
+template <typename Simd>
+void batched_solve(
+    std::size_t n,
+    std::size_t groups,
+    typename Simd::value_type* a,
+    typename Simd::value_type* x,
+    bool* singular) {
+  using T = typename Simd::value_type;
+  constexpr auto lanes = batch_lanes<T>;
+  constexpr auto w = Simd::width;
+
+  auto const size = n * n * lanes;
+  T scale[lanes];
+  for (std::size_t group = 0; group < groups; ++group) {
+    auto const ga = a + group * size;
+    auto const gx = x + group * n * lanes;
+    auto const flags = singular + group * lanes;
+    auto const at = [&](std::size_t i, std::size_t j) {
+      return ga + (i * n + j) * lanes;
+    };
+    std::fill(flags, flags + lanes, false);
+
+    // forward elimination, leaving a unit upper triangle behind
+    for (std::size_t k = 0; k < n; ++k) {
+      batched_pivot(ga, gx, n, 1, k, scale, flags);
+      for (std::size_t lane = 0; lane < lanes; lane += w) {
+        auto const s = Simd::load(scale + lane);
+        for (auto j = k + 1; j < n; ++j) {
+          auto const ptr = at(k, j) + lane;
+          Simd::store(ptr, Simd::mul(Simd::load(ptr), s));
+        }
+        auto const xk = Simd::mul(Simd::load(gx + k * lanes + lane), s);
+        Simd::store(gx + k * lanes + lane, xk);
+        for (auto i = k + 1; i < n; ++i) {
+          auto const f = Simd::sub(Simd::zero(), Simd::load(at(i, k) + lane));
+          for (auto j = k + 1; j < n; ++j) {
+            auto const ptr = at(i, j) + lane;
+            Simd::store(
+                ptr,
+                Simd::fmadd(f, Simd::load(at(k, j) + lane), Simd::load(ptr)));
+          }
+          auto const ptr = gx + i * lanes + lane;
+          Simd::store(ptr, Simd::fmadd(f, xk, Simd::load(ptr)));
+        }
+      }
+    }
+    // back substitution; each x[k] is taken out of the rows above it
+    for (std::size_t lane = 0; lane < lanes; lane += w) {
+      for (std::size_t k = n; k-- > 0;) {
+        auto const xk = Simd::load(gx + k * lanes + lane);
+        for (std::size_t i = 0; i < k; ++i) {
+          auto const f = Simd::sub(Simd::zero(), Simd::load(at(i, k) + lane));
+          auto const ptr = gx + i * lanes + lane;
+          Simd::store(ptr, Simd::fmadd(f, xk, Simd::load(ptr)));
+        }
+      }
+    }
+  }
+}
+
+// a = L L^T, in place, a column of L at a time
+template <typename Simd>
+void batched_cholesky(
+    std::size_t n,
+    std::size_t groups,
+    typename Simd::value_type* a,
+    bool* failed) {
+  using T = typename Simd::value_type;
+  constexpr auto lanes = batch_lanes<T>;
+  constexpr auto w = Simd::width;
+
+  auto const size = n * n * lanes;
+  T scale[lanes];
+  for (std::size_t group = 0; group < groups; ++group) {
+    auto const ga = a + group * size;
+    auto const flags = failed + group * lanes;
+    auto const at = [&](std::size_t i, std::size_t j) {
+      return ga + (i * n + j) * lanes;
+    };
+    std::fill(flags, flags + lanes, false);
+
+    for (std::size_t j = 0; j < n; ++j) {
+      // the diagonal; what's left of a[j, j] after the columns before it
+      for (std::size_t lane = 0; lane < lanes; lane += w) {
+        auto d = Simd::load(at(j, j) + lane);
+        for (std::size_t p = 0; p < j; ++p) {
+          auto const l = Simd::load(at(j, p) + lane);
+          d = Simd::fmadd(Simd::sub(Simd::zero(), l), l, d);
+        }
+        Simd::store(at(j, j) + lane, d);
+      }
+      for (std::size_t lane = 0; lane < lanes; ++lane) {
+        auto& d = at(j, j)[lane];
+        if (d > T(0)) {
+          d = std::sqrt(d);
+          scale[lane] = T(1) / d;
+        } else {
+          flags[lane] = true;
+          scale[lane] = T(0);
+        }
+      }
+      // and the rest of column j
+      for (std::size_t lane = 0; lane < lanes; lane += w) {
+        auto const s = Simd::load(scale + lane);
+        for (auto i = j + 1; i < n; ++i) {
+          auto acc = Simd::load(at(i, j) + lane);
+          for (std::size_t p = 0; p < j; ++p) {
+            acc = Simd::fmadd(
+                Simd::sub(Simd::zero(), Simd::load(at(i, p) + lane)),
+                Simd::load(at(j, p) + lane),
+                acc);
+          }
+          Simd::store(at(i, j) + lane, Simd::mul(acc, s));
+        }
+      }
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      std::fill(at(i, i + 1), at(i, n), T(0));
+    }
+  }
+}
+
+// the sums for `rows` rows of product quantization codes, m bytes to a
+// row: each row's is the sum over s of table[s * centroids + its code s].
+// A register of rows at a time, four codes to a row at a time; the rows
+// and codes left over go a row at a time, in the same order
+template <typename Simd>
+void adc_block(
+    std::size_t rows,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    typename Simd::value_type const* table,
+    typename Simd::value_type* out) noexcept {
+  using T = typename Simd::value_type;
+  constexpr auto w = Simd::width;
+  auto const quads = m - m % 4;
+
+  std::size_t r = 0;
+  for (; r + w <= rows; r += w) {
+    auto acc = Simd::zero();
+    for (std::size_t s = 0; s < quads; s += 4) {
+      auto const quad =
+          Simd::lookup4(table + s * centroids, centroids, codes + r * m + s, m);
+      acc = Simd::add(acc, quad);
+    }
+    Simd::store(out + r, acc);
+  }
+  for (; r < rows; ++r) {
+    auto sum = T(0);
+    for (std::size_t s = 0; s < quads; s += 4) {
+      sum = sum + adc_quad(table + s * centroids, centroids, codes + r * m + s);
+    }
+    out[r] = sum;
+  }
+  for (auto s = quads; s < m; ++s) {
+    for (r = 0; r < rows; ++r) {
+      out[r] = out[r] + table[s * centroids + codes[r * m + s]];
+    }
+  }
+}
+
+template <typename Simd>
+constexpr kernel_ops<typename Simd::value_type> make_ops() {
+  return {
+      &dot<Simd>,
+      &elementwise<Simd, add_op>,
+      &elementwise<Simd, subtract_op>,
+      &elementwise<Simd, hadamard_op>,
+      &axpy<Simd>,
+      &axpby<Simd>,
+      &scal<Simd>,
+      &nrm2<Simd>,
+      &asum<Simd>,
+      &index_abs_extreme<Simd, true>,
+      &index_abs_extreme<Simd, false>,
+      &swap<Simd>,
+      &copy<Simd>,
+      &rot<Simd>,
+      &axpy_dot<Simd>,
+      &gemm<Simd>,
+      &min_plus_gemm<Simd>,
+      &gemv<Simd>,
+      &gemv_t<Simd>,
+      &trsv<Simd>,
+      &trsm<Simd>,
+      &transpose<typename Simd::value_type>,
+      &column_sums<Simd>,
+      &batched_gemm<Simd>,
+      &batched_inverse<Simd>,
+      &batched_solve<Simd>,
+      &batched_cholesky<Simd>,
+      &adc_block<Simd>,
+  };
+}
+
+template <typename Simd_i32, typename Bits, typename Mod>
+constexpr integer_ops make_integer_ops() {
+  return {
+      &min_plus_gemm<Simd_i32>,
+      &or_and_gemm<Bits>,
+      &xor_and_gemm<Bits>,
+      &popcounts<false>,
+      &popcounts<true>,
+      &mod_gemm<Mod>,
+      &mod_axpy<Mod>,
+  };
+}
+
+} // namespace
+} // namespace algae::kernels::implementation
@@ -0,0 +1,203 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <algae/kernels.h>
+
+#include "parallel.h"
+
+namespace algae::kernels {
+
+namespace implementation {
+namespace {
+
+struct job {
+  void (*body)(void const*, std::size_t, std::size_t);
+  void const* ctx;
+  std::size_t n;
+  std::size_t chunks;
+  std::atomic<std::size_t> next;
+
+  // whoever's free takes the next chunk, until there aren't any left
+  void run() noexcept {
+    for (;;) {
+      auto const chunk = next.fetch_add(1, std::memory_order_relaxed);
+      if (chunk >= chunks) {
+        return;
+      }
+      body(ctx, n * chunk / chunks, n * (chunk + 1) / chunks);
+    }
+  }
+};
+
+// whether this thread is running a job's chunks already; a parallel_for
+// from inside one runs where it is, rather than waiting on the pool it's
+// part of
+thread_local bool in_pool = false;
+
+// runs the job's chunks on this thread, as part of the pool
+void run_in_pool(job& to_run) noexcept {
+  in_pool = true;
+  to_run.run();
+  in_pool = false;
+}
+
+std::size_t default_thread_count() noexcept {
+  auto const ret = std::thread::hardware_concurrency();
+  return ret == 0 ? 1 : ret;
+}
+
+class thread_pool {
+  // held for the whole of a run, and while resizing
+  std::mutex running_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::vector<std::thread> workers_;
+  job* job_ = nullptr;
+  std::size_t generation_ = 0;
+  std::size_t busy_ = 0;
+  bool stopping_ = false;
+
+  // the number of threads to use, counting the caller
+  std::atomic<std::size_t> size_{default_thread_count()};
+
+  void work(std::size_t seen) noexcept {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    for (;;) {
+      wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+      if (stopping_) {
+        return;
+      }
+      seen = generation_;
+      auto* const current = job_;
+      if (current == nullptr) {
+        continue;
+      }
+
+      ++busy_;
+      lock.unlock();
+      run_in_pool(*current);
+      lock.lock();
+      if (--busy_ == 0) {
+        done_.notify_one();
+      }
+    }
+  }
+
+  // with running_ held
+  void start() noexcept {
+    auto const generation = [&] {
+      auto lock = std::unique_lock<std::mutex>(mutex_);
+      stopping_ = false;
+      return generation_;
+    }();
+    auto const count = size_.load(std::memory_order_relaxed) - 1;
+    workers_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      // if the system won't give us any more threads, make do with the
+      // ones we've got
+      try {
+        workers_.emplace_back([this, generation] { work(generation); });
+      } catch (...) {
+        break;
+      }
+    }
+  }
+
+  // with running_ held
+  void stop() noexcept {
+    {
+      auto lock = std::unique_lock<std::mutex>(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+    workers_.clear();
+  }
+
+public:
+  ~thread_pool() { stop(); }
+
+  std::size_t size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  void resize(std::size_t count) noexcept {
+    auto lock = std::unique_lock<std::mutex>(running_);
+    stop();
+    size_.store(count == 0 ? default_thread_count() : count);
+  }
+
+  void run(job& to_run) noexcept {
+    // running_ may be this thread's already, and locking it again, even
+    // with try_lock, isn't allowed
+    if (in_pool) {
+      to_run.run();
+      return;
+    }
+    // ...while another thread's run just means the pool is taken
+    auto running = std::unique_lock<std::mutex>(running_, std::try_to_lock);
+    if (!running.owns_lock() || size() <= 1) {
+      run_in_pool(to_run);
+      return;
+    }
+    if (workers_.empty()) {
+      start();
+    }
+
+    {
+      auto lock = std::unique_lock<std::mutex>(mutex_);
+      job_ = &to_run;
+      ++generation_;
+    }
+    wake_.notify_all();
+    run_in_pool(to_run);
+
+    // once job_ is cleared, no more workers can pick it up; wait for the
+    // ones that already did
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    job_ = nullptr;
+    done_.wait(lock, [&] { return busy_ == 0; });
+  }
+};
+
+thread_pool& pool() noexcept {
+  static auto ret = thread_pool();
+  return ret;
+}
+
+} // namespace
+
+void parallel_for_impl(
+    std::size_t n,
+    std::size_t chunks,
+    void (*body)(void const*, std::size_t, std::size_t),
+    void const* ctx) noexcept {
+  auto to_run = job{body, ctx, n, chunks, {0}};
+  pool().run(to_run);
+}
+
+} // namespace implementation
+
+std::size_t thread_count() noexcept { return implementation::pool().size(); }
+
+void set_thread_count(std::size_t count) noexcept {
+  implementation::pool().resize(count);
+}
+
+void parallel_for(
+    std::size_t n,
+    std::size_t chunks,
+    void (*body)(void const*, std::size_t, std::size_t),
+    void const* ctx) noexcept {
+  implementation::parallel_for_impl(n, chunks, body, ctx);
+}
+
+} // namespace algae::kernels
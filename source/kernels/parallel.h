@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include <algae/kernels.h>
+
+/*
+  a persistent pool of threads, started on first use. One parallel_for
+  runs on it at a time; any other runs on the calling thread.
+*/
+
+namespace algae::kernels::implementation {
+
+// the least work (in elements touched) that's worth a thread of its own
+inline constexpr std::size_t parallel_grain = std::size_t(1) << 15;
+
+// how many pieces to split `work` elements of work into; never more than
+// `max_chunks`, which should be the number of independent pieces there are
+inline std::size_t
+parallel_chunks(std::size_t work, std::size_t max_chunks) noexcept {
+  auto const chunks =
+      std::min({thread_count(), work / parallel_grain, max_chunks});
+  return chunks == 0 ? 1 : chunks;
+}
+
+// what kernels::parallel_for runs on
+void parallel_for_impl(
+    std::size_t n,
+    std::size_t chunks,
+    void (*body)(void const*, std::size_t, std::size_t),
+    void const* ctx) noexcept;
+
+} // namespace algae::kernels::implementation
@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <algae/kernels.h>
+
+#include "kernel_table.h"
+#include "parallel.h"
+
+/*
+  product quantization: k-means by pairwise_top_k from k-means++ picks,
+  and codes scored by the instruction set's adc_block, a register of rows
+  at a time.
+*/
+
+namespace algae::kernels {
+
+namespace implementation {
+namespace {
+
+// the codes each block of a search sums up before going through the heaps
+inline constexpr std::size_t code_rows = 256;
+
+// splitmix64
+std::uint64_t mix(std::uint64_t x) noexcept {
+  x += 0x9e3779b97f4a7c15u;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+  return x ^ (x >> 31);
+}
+
+template <typename T>
+void kmeans(
+    std::size_t n,
+    std::size_t d,
+    T const* points,
+    std::size_t ldp,
+    std::size_t clusters,
+    std::size_t iterations,
+    std::uint64_t seed,
+    T* centroids) noexcept {
+  if (n == 0) {
+    std::fill(centroids, centroids + clusters * d, T(0));
+    return;
+  }
+
+  // k-means++: each centroid after the first is a row picked with odds in
+  // proportion to its squared distance from the nearest centroid so far
+  auto closest = std::vector<T>(n, std::numeric_limits<T>::infinity());
+  auto from_new = std::vector<T>(n);
+  auto state = seed;
+  for (std::size_t c = 0; c < clusters; ++c) {
+    auto const bits = mix(state++);
+    auto picked = std::size_t(bits % n);
+    auto const total = c == 0
+        ? 0.0
+        : std::accumulate(closest.begin(), closest.end(), 0.0);
+    if (total > 0.0) {
+      auto left = double(bits >> 11) * 0x1p-53 * total;
+      for (picked = 0; picked + 1 < n; ++picked) {
+        left -= double(closest[picked]);
+        if (left < 0.0) {
+          break;
+        }
+      }
+    }
+    auto const row = points + picked * ldp;
+    std::copy(row, row + d, centroids + c * d);
+    kernels::pairwise(
+        metric::squared_euclidean,
+        n,
+        1,
+        d,
+        points,
+        ldp,
+        centroids + c * d,
+        d,
+        from_new.data(),
+        1);
+    for (std::size_t idx = 0; idx < n; ++idx) {
+      closest[idx] = std::min(closest[idx], from_new[idx]);
+    }
+  }
+
+  auto nearest = std::vector<std::size_t>(n);
+  auto previous = std::vector<std::size_t>(n, clusters);
+  auto distances = std::vector<T>(n);
+  auto sums = std::vector<T>(clusters * d);
+  auto counts = std::vector<std::size_t>(clusters);
+  for (std::size_t round = 0; round < iterations; ++round) {
+    kernels::pairwise_top_k(
+        metric::squared_euclidean,
+        n,
+        clusters,
+        d,
+        points,
+        ldp,
+        centroids,
+        d,
+        1,
+        nearest.data(),
+        distances.data());
+    if (nearest == previous) {
+      break;
+    }
+    previous = nearest;
+
+    std::fill(sums.begin(), sums.end(), T(0));
+    std::fill(counts.begin(), counts.end(), 0);
+    for (std::size_t idx = 0; idx < n; ++idx) {
+      kernels::axpy(
+          T(1), points + idx * ldp, sums.data() + nearest[idx] * d, d);
+      ++counts[nearest[idx]];
+    }
+    for (std::size_t c = 0; c < clusters; ++c) {
+      auto const centroid = centroids + c * d;
+      if (counts[c] != 0) {
+        std::copy_n(sums.data() + c * d, d, centroid);
+        kernels::scal(T(1) / T(counts[c]), centroid, d);
+        continue;
+      }
+      // empty; it takes over the worst-served row, which no other empty
+      // centroid will then take
+      auto const worst = std::size_t(
+          std::max_element(distances.begin(), distances.end()) -
+          distances.begin());
+      auto const row = points + worst * ldp;
+      std::copy(row, row + d, centroid);
+      distances[worst] = -std::numeric_limits<T>::infinity();
+    }
+  }
+}
+
+template <typename T>
+void adc_scan(
+    std::size_t n,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    T const* table,
+    T* out) noexcept {
+  auto const adc_block = active_table().ops<T>().adc_block;
+  auto const blocks = (n + code_rows - 1) / code_rows;
+  auto const chunks = parallel_chunks(n * m, blocks);
+  parallel_for(blocks, chunks, [&](std::size_t begin, std::size_t end) {
+    for (auto block = begin; block < end; ++block) {
+      auto const row = block * code_rows;
+      adc_block(
+          std::min(code_rows, n - row),
+          m,
+          centroids,
+          codes + row * m,
+          table,
+          out + row);
+    }
+  });
+}
+
+template <typename T>
+void adc_top_k(
+    metric which,
+    std::size_t n,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    std::size_t q,
+    T const* tables,
+    std::size_t k,
+    std::size_t* indices,
+    T* values) noexcept {
+  using entry = std::pair<T, std::size_t>;
+  auto const negated = impl::larger_is_nearer(which);
+  auto const inf = std::numeric_limits<T>::infinity();
+  auto const table_size = m * centroids;
+  auto const adc_block = active_table().ops<T>().adc_block;
+
+  auto const blocks = (n + code_rows - 1) / code_rows;
+  auto const chunks =
+      parallel_chunks(n * q * std::max<std::size_t>(m, 1), blocks);
+  auto heaps = std::vector<entry>(chunks * q * k);
+  auto sizes = std::vector<std::size_t>(chunks * q, 0);
+  parallel_for(chunks, chunks, [&](std::size_t begin, std::size_t end) {
+    auto sums = std::vector<T>(code_rows);
+    for (auto chunk = begin; chunk < end; ++chunk) {
+      auto const first_row = n * chunk / chunks;
+      auto const last_row = n * (chunk + 1) / chunks;
+      for (std::size_t query = 0; query < q; ++query) {
+        auto const heap = heaps.data() + (chunk * q + query) * k;
+        auto& size = sizes[chunk * q + query];
+        auto threshold = inf;
+        for (auto row = first_row; row < last_row; row += code_rows) {
+          auto const rows = std::min(code_rows, last_row - row);
+          adc_block(
+              rows,
+              m,
+              centroids,
+              codes + row * m,
+              tables + query * table_size,
+              sums.data());
+          for (std::size_t r = 0; r < rows; ++r) {
+            // rows only go up within a chunk, so a tie never wins
+            auto const key = impl::top_k_key(sums[r], negated);
+            if (!(key < threshold)) {
+              continue;
+            }
+            impl::top_k_push(heap, size, k, key, row + r);
+            if (size == k) {
+              threshold = heap[0].first;
+            }
+          }
+        }
+      }
+    }
+  });
+
+  // each chunk's top k, into the first chunk's heap
+  for (std::size_t query = 0; query < q; ++query) {
+    auto const heap = heaps.data() + query * k;
+    auto& size = sizes[query];
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+      auto const other = heaps.data() + (chunk * q + query) * k;
+      for (std::size_t idx = 0; idx < sizes[chunk * q + query]; ++idx) {
+        impl::top_k_push(heap, size, k, other[idx].first, other[idx].second);
+      }
+    }
+    impl::top_k_finish(
+        heap, size, k, negated, n, indices + query * k, values + query * k);
+  }
+}
+
+} // namespace
+} // namespace implementation
+
+void kmeans(
+    std::size_t n,
+    std::size_t d,
+    float const* points,
+    std::size_t ldp,
+    std::size_t clusters,
+    std::size_t iterations,
+    std::uint64_t seed,
+    float* centroids) noexcept {
+  implementation::kmeans(
+      n, d, points, ldp, clusters, iterations, seed, centroids);
+}
+void kmeans(
+    std::size_t n,
+    std::size_t d,
+    double const* points,
+    std::size_t ldp,
+    std::size_t clusters,
+    std::size_t iterations,
+    std::uint64_t seed,
+    double* centroids) noexcept {
+  implementation::kmeans(
+      n, d, points, ldp, clusters, iterations, seed, centroids);
+}
+
+void adc_scan(
+    std::size_t n,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    float const* table,
+    float* out) noexcept {
+  implementation::adc_scan(n, m, centroids, codes, table, out);
+}
+void adc_scan(
+    std::size_t n,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    double const* table,
+    double* out) noexcept {
+  implementation::adc_scan(n, m, centroids, codes, table, out);
+}
+
+void adc_top_k(
+    metric which,
+    std::size_t n,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    std::size_t q,
+    float const* tables,
+    std::size_t k,
+    std::size_t* indices,
+    float* values) noexcept {
+  implementation::adc_top_k(
+      which, n, m, centroids, codes, q, tables, k, indices, values);
+}
+void adc_top_k(
+    metric which,
+    std::size_t n,
+    std::size_t m,
+    std::size_t centroids,
+    std::uint8_t const* codes,
+    std::size_t q,
+    double const* tables,
+    std::size_t k,
+    std::size_t* indices,
+    double* values) noexcept {
+  implementation::adc_top_k(
+      which, n, m, centroids, codes, q, tables, k, indices, values);
+}
+
+} // namespace algae::kernels
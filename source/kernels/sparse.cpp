@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <algae/implementation/sparse.h>
+#include <algae/kernels.h>
+
+#include "parallel.h"
+
+/*
+  the parallel sparse products, split so each thread gets about the same
+  number of products rather than of rows.
+*/
+
+namespace algae::kernels {
+
+namespace implementation {
+namespace {
+
+// calls f(begin, end) on pieces of the rows [0, m), with roughly the same
+// work in each; work_before[row] is the work in the rows before `row`,
+// and `scale` the cost of each unit of it
+template <typename F>
+void parallel_rows(
+    std::size_t m,
+    std::size_t const* work_before,
+    std::size_t scale,
+    F const& f) noexcept {
+  auto const total = work_before[m];
+  auto const chunks = parallel_chunks(total * scale, m);
+  auto const row_at = [&](std::size_t chunk) {
+    if (chunk == chunks) {
+      return m;
+    }
+    auto const work = total * chunk / chunks;
+    return std::size_t(
+        std::lower_bound(work_before, work_before + m, work) - work_before);
+  };
+  parallel_for(chunks, chunks, [&](std::size_t begin, std::size_t end) {
+    for (auto chunk = begin; chunk < end; ++chunk) {
+      f(row_at(chunk), row_at(chunk + 1));
+    }
+  });
+}
+
+std::vector<std::size_t> products_before(
+    std::size_t m,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    std::size_t const* b_offsets) {
+  auto ret = std::vector<std::size_t>(m + 1, 0);
+  for (std::size_t row = 0; row < m; ++row) {
+    ret[row + 1] = ret[row] +
+        impl::spgemm_row_products(a_offsets, a_columns, b_offsets, row);
+  }
+  return ret;
+}
+
+template <typename T>
+void spgemm_numeric(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    T const* a_values,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    T const* b_values,
+    std::size_t const* c_offsets,
+    std::size_t const* c_columns,
+    T* c_values) noexcept {
+  auto const work = products_before(m, a_offsets, a_columns, b_offsets);
+  parallel_rows(m, work.data(), 1, [&](std::size_t begin, std::size_t end) {
+    impl::spgemm_numeric(
+        n,
+        a_offsets,
+        a_columns,
+        a_values,
+        b_offsets,
+        b_columns,
+        b_values,
+        c_offsets,
+        c_columns,
+        c_values,
+        begin,
+        end);
+  });
+}
+
+// each nonzero of a adds a row of b into a row of c, with the axpy kernel
+template <typename T>
+void spmm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    T const* a_values,
+    T const* b,
+    std::size_t ldb,
+    T* c,
+    std::size_t ldc) noexcept {
+  parallel_rows(m, a_offsets, n, [&](std::size_t begin, std::size_t end) {
+    for (auto row = begin; row < end; ++row) {
+      auto const c_row = c + row * ldc;
+      std::fill(c_row, c_row + n, T(0));
+      for (auto idx = a_offsets[row]; idx < a_offsets[row + 1]; ++idx) {
+        kernels::axpy(a_values[idx], b + a_columns[idx] * ldb, c_row, n);
+      }
+    }
+  });
+}
+
+} // namespace
+} // namespace implementation
+
+void spgemm_offsets(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    std::size_t* c_offsets) noexcept {
+  auto const work =
+      implementation::products_before(m, a_offsets, a_columns, b_offsets);
+  c_offsets[0] = 0;
+  implementation::parallel_rows(
+      m, work.data(), 1, [&](std::size_t begin, std::size_t end) {
+        impl::spgemm_count(
+            n,
+            a_offsets,
+            a_columns,
+            b_offsets,
+            b_columns,
+            c_offsets,
+            begin,
+            end);
+      });
+  for (std::size_t row = 0; row < m; ++row) {
+    c_offsets[row + 1] += c_offsets[row];
+  }
+}
+
+void spgemm_columns(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    std::size_t const* c_offsets,
+    std::size_t* c_columns) noexcept {
+  auto const work =
+      implementation::products_before(m, a_offsets, a_columns, b_offsets);
+  implementation::parallel_rows(
+      m, work.data(), 1, [&](std::size_t begin, std::size_t end) {
+        impl::spgemm_columns(
+            n,
+            a_offsets,
+            a_columns,
+            b_offsets,
+            b_columns,
+            c_offsets,
+            c_columns,
+            begin,
+            end);
+      });
+}
+
+void spgemm_numeric(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    float const* a_values,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    float const* b_values,
+    std::size_t const* c_offsets,
+    std::size_t const* c_columns,
+    float* c_values) noexcept {
+  implementation::spgemm_numeric(
+      m,
+      n,
+      a_offsets,
+      a_columns,
+      a_values,
+      b_offsets,
+      b_columns,
+      b_values,
+      c_offsets,
+      c_columns,
+      c_values);
+}
+void spgemm_numeric(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    double const* a_values,
+    std::size_t const* b_offsets,
+    std::size_t const* b_columns,
+    double const* b_values,
+    std::size_t const* c_offsets,
+    std::size_t const* c_columns,
+    double* c_values) noexcept {
+  implementation::spgemm_numeric(
+      m,
+      n,
+      a_offsets,
+      a_columns,
+      a_values,
+      b_offsets,
+      b_columns,
+      b_values,
+      c_offsets,
+      c_columns,
+      c_values);
+}
+
+void spmm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    float const* a_values,
+    float const* b,
+    std::size_t ldb,
+    float* c,
+    std::size_t ldc) noexcept {
+  implementation::spmm(m, n, a_offsets, a_columns, a_values, b, ldb, c, ldc);
+}
+void spmm(
+    std::size_t m,
+    std::size_t n,
+    std::size_t const* a_offsets,
+    std::size_t const* a_columns,
+    double const* a_values,
+    double const* b,
+    std::size_t ldb,
+    double* c,
+    std::size_t ldc) noexcept {
+  implementation::spmm(m, n, a_offsets, a_columns, a_values, b, ldb, c, ldc);
+}
+
+} // namespace algae::kernels
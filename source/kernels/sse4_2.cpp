@@ -0,0 +1,209 @@
+#include "kernel_table.h"
+
+#if ALGAE_KERNELS_X86
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(                                                  \
+    __attribute__((target("sse4.2,popcnt"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse4.2,popcnt")
+#endif
+
+#include "kernel_templates.h"
+
+namespace algae::kernels::implementation {
+namespace {
+
+struct sse4_2_f32 {
+  using value_type = float;
+  using reg = __m128;
+  static constexpr std::size_t width = 4;
+
+  static reg zero() { return _mm_setzero_ps(); }
+  static reg broadcast(float x) { return _mm_set1_ps(x); }
+  static reg load(float const* ptr) { return _mm_loadu_ps(ptr); }
+  static void store(float* ptr, reg r) { _mm_storeu_ps(ptr, r); }
+
+  static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+  static reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+  static reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+  static reg fmadd(reg a, reg b, reg c) {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+  }
+
+  static reg abs(reg a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+  static reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+  static reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+
+  static float reduce_add(reg r) {
+    r = _mm_hadd_ps(r, r);
+    r = _mm_hadd_ps(r, r);
+    return _mm_cvtss_f32(r);
+  }
+
+  // there's no gather before AVX2
+  static reg lookup4(
+      float const* table,
+      std::size_t centroids,
+      std::uint8_t const* codes,
+      std::size_t stride) {
+    return _mm_setr_ps(
+        adc_quad(table, centroids, codes),
+        adc_quad(table, centroids, codes + stride),
+        adc_quad(table, centroids, codes + 2 * stride),
+        adc_quad(table, centroids, codes + 3 * stride));
+  }
+};
+
+struct sse4_2_f64 {
+  using value_type = double;
+  using reg = __m128d;
+  static constexpr std::size_t width = 2;
+
+  static reg zero() { return _mm_setzero_pd(); }
+  static reg broadcast(double x) { return _mm_set1_pd(x); }
+  static reg load(double const* ptr) { return _mm_loadu_pd(ptr); }
+  static void store(double* ptr, reg r) { _mm_storeu_pd(ptr, r); }
+
+  static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+  static reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+  static reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+  static reg fmadd(reg a, reg b, reg c) {
+    return _mm_add_pd(_mm_mul_pd(a, b), c);
+  }
+
+  static reg abs(reg a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+  static reg max(reg a, reg b) { return _mm_max_pd(a, b); }
+  static reg min(reg a, reg b) { return _mm_min_pd(a, b); }
+
+  static double reduce_add(reg r) { return _mm_cvtsd_f64(_mm_hadd_pd(r, r)); }
+
+  static reg lookup4(
+      double const* table,
+      std::size_t centroids,
+      std::uint8_t const* codes,
+      std::size_t stride) {
+    return _mm_setr_pd(
+        adc_quad(table, centroids, codes),
+        adc_quad(table, centroids, codes + stride));
+  }
+};
+
+struct sse4_2_i32 {
+  using value_type = std::int32_t;
+  using reg = __m128i;
+  static constexpr std::size_t width = 4;
+
+  static reg broadcast(std::int32_t x) { return _mm_set1_epi32(x); }
+  static reg load(std::int32_t const* ptr) {
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(ptr));
+  }
+  static void store(std::int32_t* ptr, reg r) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), r);
+  }
+
+  static reg add(reg a, reg b) { return _mm_add_epi32(a, b); }
+  static reg min(reg a, reg b) { return _mm_min_epi32(a, b); }
+  static reg select_equal(reg x, reg y, reg a, reg b) {
+    return _mm_blendv_epi8(b, a, _mm_cmpeq_epi32(x, y));
+  }
+};
+
+struct sse4_2_bits {
+  using reg = __m128i;
+  static constexpr std::size_t width = 2;
+
+  static reg load(std::uint64_t const* ptr) {
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(ptr));
+  }
+  static void store(std::uint64_t* ptr, reg r) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), r);
+  }
+  static reg bit_or(reg a, reg b) { return _mm_or_si128(a, b); }
+  static reg bit_xor(reg a, reg b) { return _mm_xor_si128(a, b); }
+};
+
+// 32-bit residues, for the modular kernels
+struct sse4_2_mod {
+  using reg = __m128i;
+  static constexpr std::size_t width = 4;
+
+  static reg broadcast(std::uint32_t x) {
+    return _mm_set1_epi32(static_cast<int>(x));
+  }
+  static reg load(std::uint32_t const* ptr) {
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(ptr));
+  }
+  static void store(std::uint32_t* ptr, reg r) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), r);
+  }
+
+  static reg add(reg a, reg b) { return _mm_add_epi32(a, b); }
+  static reg sub(reg a, reg b) { return _mm_sub_epi32(a, b); }
+  static reg min(reg a, reg b) { return _mm_min_epu32(a, b); }
+  static reg mullo(reg a, reg b) { return _mm_mullo_epi32(a, b); }
+  // there's only an even-lane 32 x 32 -> 64 multiply; the odd lanes are
+  // shifted down into the even ones for a second
+  static reg mulhi(reg a, reg b) {
+    auto const even = _mm_mul_epu32(a, b);
+    auto const odd =
+        _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_blend_epi16(_mm_srli_epi64(even, 32), odd, 0xcc);
+  }
+
+  using wide = __m128i;
+  static constexpr std::size_t wide_width = 2;
+
+  static wide wide_zero() { return _mm_setzero_si128(); }
+  static wide wide_broadcast(std::uint64_t x) {
+    return _mm_set1_epi64x(static_cast<long long>(x));
+  }
+  static wide wide_load(std::uint32_t const* ptr) {
+    return _mm_cvtepu32_epi64(
+        _mm_loadl_epi64(reinterpret_cast<__m128i const*>(ptr)));
+  }
+  static void wide_store(std::uint64_t* ptr, wide r) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), r);
+  }
+  static wide wide_multiply_add(wide a, wide b, wide acc) {
+    return _mm_add_epi64(acc, _mm_mul_epu32(a, b));
+  }
+  // lanes with their top bit set are the negative ones
+  static wide wide_fold(wide acc, wide c) {
+    auto const top = _mm_cmpgt_epi64(_mm_setzero_si128(), acc);
+    return _mm_sub_epi64(acc, _mm_and_si128(top, c));
+  }
+};
+
+} // namespace
+
+kernel_table const& sse4_2_table() noexcept {
+  static constexpr kernel_table table = {
+      isa::sse4_2,
+      make_ops<sse4_2_f32>(),
+      make_ops<sse4_2_f64>(),
+      make_integer_ops<sse4_2_i32, sse4_2_bits, sse4_2_mod>(),
+  };
+  return table;
+}
+
+} // namespace algae::kernels::implementation
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // ALGAE_KERNELS_X86
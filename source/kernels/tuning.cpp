@@ -0,0 +1,200 @@
+#include <charconv>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <algae/kernels.h>
+
+namespace algae::kernels {
+
+namespace {
+
+struct type_entry {
+  char const* name;
+  blocking tuning::*member;
+};
+constexpr type_entry types[] = {
+    {"float", &tuning::f32},
+    {"double", &tuning::f64},
+};
+
+struct parameter_entry {
+  char const* name;
+  std::size_t blocking::*member;
+};
+constexpr parameter_entry parameters[] = {
+    {"gemm_kc", &blocking::gemm_kc},
+    {"gemm_nc", &blocking::gemm_nc},
+    {"transpose_tile", &blocking::transpose_tile},
+    {"reduction_nc", &blocking::reduction_nc},
+};
+
+template <typename T>
+constexpr blocking default_blocking() noexcept {
+  return {
+      256,
+      4096 / sizeof(T),
+      128 / sizeof(T),
+      8192 / sizeof(T),
+  };
+}
+
+std::optional<std::string> environment(char const* name) {
+#if defined(_MSC_VER)
+  char* buffer = nullptr;
+  std::size_t length = 0;
+  if (_dupenv_s(&buffer, &length, name) != 0 || buffer == nullptr) {
+    return std::nullopt;
+  }
+  auto ret = std::string(buffer);
+  std::free(buffer);
+  return ret;
+#else
+  auto const* const ret = std::getenv(name);
+  if (ret == nullptr) {
+    return std::nullopt;
+  }
+  return std::string(ret);
+#endif
+}
+
+std::string_view trim(std::string_view sv) noexcept {
+  auto const is_space = [](char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  };
+  while (!sv.empty() && is_space(sv.front())) {
+    sv.remove_prefix(1);
+  }
+  while (!sv.empty() && is_space(sv.back())) {
+    sv.remove_suffix(1);
+  }
+  return sv;
+}
+
+// false if `key` is a known parameter but `value` isn't a valid setting for
+// it; unknown keys are skipped, so that old libraries can read new files
+bool set_parameter(tuning& to, std::string_view key, std::string_view value) {
+  for (auto const& type : types) {
+    for (auto const& parameter : parameters) {
+      auto const name =
+          std::string(type.name) + '.' + std::string(parameter.name);
+      if (key != name) {
+        continue;
+      }
+
+      auto parsed = std::size_t(0);
+      auto const last = value.data() + value.size();
+      auto const [ptr, ec] = std::from_chars(value.data(), last, parsed);
+      if (ec != std::errc() || ptr != last || parsed == 0) {
+        return false;
+      }
+      (to.*type.member).*parameter.member = parsed;
+      return true;
+    }
+  }
+  return true;
+}
+
+tuning& tuning_storage() noexcept {
+  static auto ret = [] {
+    auto const path = default_tuning_path();
+    if (path.empty()) {
+      return default_tuning();
+    }
+    return read_tuning(path).value_or(default_tuning());
+  }();
+  return ret;
+}
+
+} // namespace
+
+tuning default_tuning() noexcept {
+  return {default_blocking<float>(), default_blocking<double>()};
+}
+
+tuning const& current_tuning() noexcept { return tuning_storage(); }
+
+void set_tuning(tuning const& new_tuning) noexcept {
+  tuning_storage() = new_tuning;
+}
+
+std::string default_tuning_path() {
+  if (auto file = environment("ALGAE_TUNING_FILE")) {
+    return *file;
+  }
+
+  auto directory = std::filesystem::path();
+#if defined(_WIN32)
+  if (auto app_data = environment("APPDATA")) {
+    directory = *app_data;
+  }
+#else
+  if (auto config = environment("XDG_CONFIG_HOME")) {
+    directory = *config;
+  } else if (auto home = environment("HOME")) {
+    directory = std::filesystem::path(*home) / ".config";
+  }
+#endif
+  // not relative to wherever the program happens to be running
+  if (directory.empty()) {
+    return std::string();
+  }
+  return (directory / "algae" / "tuning.conf").string();
+}
+
+std::optional<tuning> read_tuning(std::string const& path) {
+  auto file = std::ifstream(path);
+  if (!file) {
+    return std::nullopt;
+  }
+
+  auto ret = default_tuning();
+  auto line = std::string();
+  while (std::getline(file, line)) {
+    auto content = std::string_view(line);
+    content = trim(content.substr(0, content.find('#')));
+    if (content.empty()) {
+      continue;
+    }
+
+    auto const equals = content.find('=');
+    if (equals == std::string_view::npos) {
+      return std::nullopt;
+    }
+    auto const key = trim(content.substr(0, equals));
+    auto const value = trim(content.substr(equals + 1));
+    if (!set_parameter(ret, key, value)) {
+      return std::nullopt;
+    }
+  }
+
+  return ret;
+}
+
+bool write_tuning(tuning const& to_write, std::string const& path) {
+  auto const parent = std::filesystem::path(path).parent_path();
+  if (!parent.empty()) {
+    auto ec = std::error_code();
+    std::filesystem::create_directories(parent, ec);
+  }
+
+  auto file = std::ofstream(path);
+  if (!file) {
+    return false;
+  }
+
+  file << "# algae kernel tuning; see algae/kernels.h\n";
+  for (auto const& type : types) {
+    for (auto const& parameter : parameters) {
+      file << type.name << '.' << parameter.name << " = "
+           << (to_write.*type.member).*parameter.member << '\n';
+    }
+  }
+  return bool(file);
+}
+
+} // namespace algae::kernels
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <algae/kernels.h>
+
+/*
+  algae_tune: finds the cache blocking for the algae_kernels that runs
+  fastest on this machine, and writes it to the tuning file that the
+  library reads at start-up.
+
+    algae_tune [output-file]
+
+  The file defaults to algae::kernels::default_tuning_path().
+*/
+
+namespace kern = algae::kernels;
+
+namespace {
+
+struct cache_sizes {
+  std::size_t l1d = 32 * 1024;
+  std::size_t l2 = 256 * 1024;
+  std::size_t l3 = 8 * 1024 * 1024;
+};
+
+std::string read_line(std::string const& path) {
+  auto file = std::ifstream(path);
+  auto ret = std::string();
+  std::getline(file, ret);
+  return ret;
+}
+
+// "48K" -> 49152
+std::size_t parse_size(std::string const& str) {
+  auto ret = std::size_t(0);
+  auto idx = std::size_t(0);
+  for (; idx < str.size() && str[idx] >= '0' && str[idx] <= '9'; ++idx) {
+    ret = ret * 10 + std::size_t(str[idx] - '0');
+  }
+  if (idx < str.size()) {
+    switch (str[idx]) {
+    case 'K':
+      return ret * 1024;
+    case 'M':
+      return ret * 1024 * 1024;
+    case 'G':
+      return ret * 1024 * 1024 * 1024;
+    }
+  }
+  return ret;
+}
+
+// linux describes each of cpu0's caches in its own index<n> directory;
+// anything we can't find keeps its (typical desktop) default
+cache_sizes read_cache_sizes() {
+  auto ret = cache_sizes();
+  for (int idx = 0;; ++idx) {
+    auto const dir =
+        "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(idx) + '/';
+    auto const level = read_line(dir + "level");
+    if (level.empty()) {
+      break;
+    }
+    auto const type = read_line(dir + "type");
+    auto const size = parse_size(read_line(dir + "size"));
+    if (size == 0 || type == "Instruction") {
+      continue;
+    }
+
+    if (level == "1") {
+      ret.l1d = size;
+    } else if (level == "2") {
+      ret.l2 = size;
+    } else if (level == "3") {
+      ret.l3 = size;
+    }
+  }
+  return ret;
+}
+
+// the best of a few runs, in seconds
+template <typename F>
+double time(F&& f) {
+  auto best = 0.0;
+  for (int run = 0; run < 3; ++run) {
+    auto const start = std::chrono::steady_clock::now();
+    f();
+    auto const elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start);
+    if (run == 0 || elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+  return best;
+}
+
+template <typename T>
+kern::blocking& blocks_for(kern::tuning& t) {
+  if constexpr (std::is_same_v<T, float>) {
+    return t.f32;
+  } else {
+    return t.f64;
+  }
+}
+
+template <typename T>
+std::vector<T> filled(std::size_t n) {
+  auto ret = std::vector<T>(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    ret[i] = T(int(i % 13) - 6) / T(8);
+  }
+  return ret;
+}
+
+// try every candidate for `member`, with everything else held fixed
+// returns the fastest
+template <typename T, typename Bench>
+std::size_t tune_parameter(
+    kern::tuning& tuning,
+    std::size_t kern::blocking::*member,
+    std::vector<std::size_t> const& candidates,
+    Bench&& bench) {
+  auto best = blocks_for<T>(tuning).*member;
+  auto best_time = -1.0;
+  for (auto candidate : candidates) {
+    blocks_for<T>(tuning).*member = candidate;
+    kern::set_tuning(tuning);
+    auto const t = time(bench);
+    std::cout << "    " << candidate << ": " << t * 1000.0 << "ms\n";
+    if (best_time < 0.0 || t < best_time) {
+      best = candidate;
+      best_time = t;
+    }
+  }
+  blocks_for<T>(tuning).*member = best;
+  kern::set_tuning(tuning);
+  return best;
+}
+
+template <typename T>
+void tune_type(kern::tuning& tuning, cache_sizes const& caches) {
+  auto const fits = [](std::size_t elements, std::size_t cache) {
+    return elements * sizeof(T) <= cache;
+  };
+
+  {
+    std::size_t const m = 128, n = 2048, k = 1024;
+    auto const a = filled<T>(m * k);
+    auto const b = filled<T>(k * n);
+    auto c = std::vector<T>(m * n);
+    auto const bench = [&] {
+      kern::gemm(m, n, k, T(1), a.data(), k, b.data(), n, T(0), c.data(), n);
+    };
+
+    // the panel of b has to fit in L2; kc first, then nc given that kc
+    auto kcs = std::vector<std::size_t>();
+    for (std::size_t kc : {64, 128, 192, 256, 384, 512}) {
+      if (fits(kc * 64, caches.l2)) {
+        kcs.push_back(kc);
+      }
+    }
+    std::cout << "  gemm_kc\n";
+    auto const kc =
+        tune_parameter<T>(tuning, &kern::blocking::gemm_kc, kcs, bench);
+
+    auto ncs = std::vector<std::size_t>();
+    for (std::size_t nc : {64, 128, 256, 512, 1024, 2048}) {
+      if (fits(kc * nc, caches.l2)) {
+        ncs.push_back(nc);
+      }
+    }
+    if (ncs.empty()) {
+      ncs.push_back(64);
+    }
+    std::cout << "  gemm_nc\n";
+    tune_parameter<T>(tuning, &kern::blocking::gemm_nc, ncs, bench);
+  }
+
+  {
+    std::size_t const m = 1536, n = 1024;
+    auto const a = filled<T>(m * n);
+    auto b = std::vector<T>(m * n);
+    auto const bench = [&] {
+      kern::transpose(m, n, a.data(), n, b.data(), m);
+    };
+
+    // a tile of the source and one of the destination live in L1
+    auto tiles = std::vector<std::size_t>();
+    for (std::size_t tile : {4, 8, 16, 32, 64, 128}) {
+      if (fits(2 * tile * tile, caches.l1d)) {
+        tiles.push_back(tile);
+      }
+    }
+    std::cout << "  transpose_tile\n";
+    tune_parameter<T>(tuning, &kern::blocking::transpose_tile, tiles, bench);
+  }
+
+  {
+    std::size_t const m = 256, n = 32768;
+    auto const a = filled<T>(m * n);
+    auto out = std::vector<T>(n);
+    auto const bench = [&] {
+      kern::column_sums(m, n, a.data(), n, out.data());
+    };
+
+    auto strips = std::vector<std::size_t>();
+    for (std::size_t nc = 256; nc <= n; nc *= 2) {
+      if (fits(nc, caches.l2)) {
+        strips.push_back(nc);
+      }
+    }
+    std::cout << "  reduction_nc\n";
+    tune_parameter<T>(tuning, &kern::blocking::reduction_nc, strips, bench);
+  }
+}
+
+void print(char const* type, kern::blocking const& blocks) {
+  std::cout << type << ": gemm " << blocks.gemm_kc << 'x' << blocks.gemm_nc
+            << ", transpose " << blocks.transpose_tile << ", reduction "
+            << blocks.reduction_nc << '\n';
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+    std::cerr << "usage: " << argv[0] << " [output-file]\n";
+    return 1;
+  }
+  auto const path =
+      argc == 2 ? std::string(argv[1]) : kern::default_tuning_path();
+  if (path.empty()) {
+    std::cerr << argv[0]
+              << ": no configuration directory; give an output file\n";
+    return 1;
+  }
+
+  auto const caches = read_cache_sizes();
+  std::cout << "isa: " << kern::name(kern::active_isa()) << '\n'
+            << "caches: L1d " << caches.l1d / 1024 << "K, L2 "
+            << caches.l2 / 1024 << "K, L3 " << caches.l3 / 1024 << "K\n";
+
+  // start from scratch, rather than from whatever was tuned last time
+  auto tuning = kern::default_tuning();
+  kern::set_tuning(tuning);
+
+  std::cout << "float\n";
+  tune_type<float>(tuning, caches);
+  std::cout << "double\n";
+  tune_type<double>(tuning, caches);
+
+  print("float", tuning.f32);
+  print("double", tuning.f64);
+
+  if (!kern::write_tuning(tuning, path)) {
+    std::cerr << "couldn't write " << path << '\n';
+    return 1;
+  }
+  std::cout << "wrote " << path << '\n';
+  return 0;
+}
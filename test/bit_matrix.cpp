@@ -0,0 +1,173 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <algae/bit_matrix.h>
+#include <algae/matrix.h>
+#include <algae/semiring.h>
+
+#include "fixtures.h"
+
+namespace {
+
+// something irregular, that crosses words
+template <std::size_t H, std::size_t W>
+algae::matrix<bool, H, W> pattern(std::size_t seed) {
+  return fixtures::generate<bool, H, W>([=](std::size_t row, std::size_t col) {
+    return (row * 7 + col * 3 + seed) % 5 < 2;
+  });
+}
+
+// the [7, 4] hamming code; its parity checks, as rows
+constexpr algae::bit_matrix<3, 7> hamming_checks() {
+  auto ret = algae::bit_matrix<3, 7>();
+  for (std::size_t col = 0; col < 7; ++col) {
+    for (std::size_t row = 0; row < 3; ++row) {
+      ret.set(row, col, (((col + 1) >> row) & 1) != 0);
+    }
+  }
+  return ret;
+}
+
+} // namespace
+
+TEST_CASE("bit matrices", "[bit_matrix]") {
+  auto m = algae::bit_matrix<3, 70>();
+  REQUIRE(m.row_words == 2);
+  REQUIRE(m.storage_size() == 6);
+  REQUIRE(!m(1, 65));
+
+  m.set(1, 65);
+  m.set(2, 3);
+  REQUIRE(m(1, 65));
+  REQUIRE(m.row_data(1)[1] == 2);
+  m.flip(2, 3);
+  m.set(1, 65, false);
+  REQUIRE(m == algae::bit_matrix<3, 70>());
+
+  auto const bools = pattern<5, 130>(1);
+  auto const packed = algae::bit_matrix<5, 130>(bools);
+  REQUIRE(packed.unpack() == bools);
+  REQUIRE(packed.unpack<algae::column_major>() == bools);
+  // nothing past the width
+  REQUIRE((packed.row_data(4)[2] >> 2) == 0);
+
+  auto const small =
+      algae::bit_matrix<2, 3>(std::array<std::array<bool, 3>, 2>{
+          {{true, false, true}, {false, true, false}}});
+  REQUIRE(small(0, 2));
+  REQUIRE(!small(1, 2));
+  REQUIRE(small.data()[0] == 5);
+}
+
+TEST_CASE("bit matrix transposes", "[bit_matrix]") {
+  auto const bools = pattern<70, 130>(2);
+  auto const t = transpose(algae::bit_matrix<70, 130>(bools));
+  for (std::size_t row = 0; row < 70; ++row) {
+    for (std::size_t col = 0; col < 130; ++col) {
+      REQUIRE(t(col, row) == bools(row, col));
+    }
+  }
+  REQUIRE(transpose(t) == algae::bit_matrix<70, 130>(bools));
+}
+
+TEST_CASE("bit matrix products", "[bit_matrix]") {
+  auto const a = pattern<33, 131>(3);
+  auto const b = pattern<131, 600>(4);
+  auto const bits_a = algae::bit_matrix<33, 131>(a);
+  auto const bits_b = algae::bit_matrix<131, 600>(b);
+
+  SECTION("or-and") {
+    auto const expected = multiply(a, b, algae::or_and());
+    REQUIRE(multiply(bits_a, bits_b, algae::or_and()).unpack() == expected);
+  }
+  SECTION("GF(2)") {
+    auto const expected = multiply(a, b, algae::xor_and());
+    REQUIRE(multiply(bits_a, bits_b, algae::xor_and()).unpack() == expected);
+  }
+  SECTION("popcounts") {
+    auto const c = pattern<9, 131>(5);
+    auto const both = and_popcounts(bits_a, algae::bit_matrix<9, 131>(c));
+    auto const differ = xor_popcounts(bits_a, algae::bit_matrix<9, 131>(c));
+    for (std::size_t i = 0; i < 33; ++i) {
+      for (std::size_t j = 0; j < 9; ++j) {
+        std::size_t expected_both = 0;
+        std::size_t expected_differ = 0;
+        for (std::size_t k = 0; k < 131; ++k) {
+          expected_both += a(i, k) && c(j, k);
+          expected_differ += a(i, k) != c(j, k);
+        }
+        REQUIRE(both(i, j) == expected_both);
+        REQUIRE(differ(i, j) == expected_differ);
+      }
+    }
+  }
+  SECTION("constexpr") {
+    // every codeword has a zero syndrome
+    constexpr auto codeword = algae::bit_matrix<7, 1>(
+        std::array<std::array<bool, 1>, 7>{
+            {{true}, {true}, {true}, {false}, {false}, {false}, {false}}});
+    constexpr auto syndrome =
+        multiply(hamming_checks(), codeword, algae::xor_and());
+    static_assert(syndrome == algae::bit_matrix<3, 1>());
+  }
+}
+
+TEST_CASE("GF(2) elimination", "[bit_matrix]") {
+  SECTION("rank") {
+    REQUIRE(rank(hamming_checks()) == 3);
+    REQUIRE(rank(algae::bit_matrix<4, 100>()) == 0);
+
+    // the third row is the sum of the first two
+    auto const m = algae::bit_matrix<3, 4>(std::array<std::array<bool, 4>, 3>{
+        {{true, true, false, true},
+         {false, true, true, false},
+         {true, false, true, true}}});
+    REQUIRE(rank(m) == 2);
+    REQUIRE(rank(transpose(m)) == 2);
+
+    auto reduced = m;
+    REQUIRE(row_reduce(reduced) == 2);
+    auto const expected =
+        algae::bit_matrix<3, 4>(std::array<std::array<bool, 4>, 3>{
+            {{true, false, true, true},
+             {false, true, true, false},
+             {false, false, false, false}}});
+    REQUIRE(reduced == expected);
+
+    static_assert(rank(hamming_checks()) == 3);
+  }
+  SECTION("wide and tall") {
+    // row i has bits i and i + 1, across word boundaries; the sum of all of
+    // them is bits 0 and 150
+    auto m = algae::bit_matrix<150, 151>();
+    for (std::size_t row = 0; row < 150; ++row) {
+      m.set(row, row);
+      m.set(row, row + 1);
+    }
+    REQUIRE(rank(m) == 150);
+    REQUIRE(rank(transpose(m)) == 150);
+  }
+  SECTION("solve") {
+    // the syndrome of a single flipped bit is its position
+    auto syndrome = algae::bit_matrix<3, 1>();
+    syndrome.set(0, 0);
+    syndrome.set(2, 0);
+    auto const x = solve(hamming_checks(), syndrome);
+    REQUIRE(x.has_value());
+    REQUIRE(multiply(hamming_checks(), *x, algae::xor_and()) == syndrome);
+
+    // x + y = 1 and x + y = 0
+    auto const a = algae::bit_matrix<2, 2>(
+        std::array<std::array<bool, 2>, 2>{{{true, true}, {true, true}}});
+    auto b = algae::bit_matrix<2, 1>();
+    b.set(0, 0);
+    REQUIRE(!solve(a, b).has_value());
+    b.set(1, 0);
+    auto const y = solve(a, b);
+    REQUIRE(y.has_value());
+    REQUIRE(multiply(a, *y, algae::xor_and()) == b);
+  }
+}
@@ -0,0 +1,204 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include <algae/exact.h>
+#include <algae/matrix.h>
+#include <algae/modint.h>
+
+#include "fixtures.h"
+
+namespace {
+
+// x^i for each x in xs; its determinant is the product of the differences
+constexpr algae::matrix<std::int64_t, 5, 5> vandermonde() {
+  auto const xs = std::array<std::int64_t, 5>{{-3, 1, 2, 4, 9}};
+  auto ret = algae::matrix<std::int64_t, 5, 5>();
+  for (std::size_t row = 0; row < 5; ++row) {
+    auto x = std::int64_t(1);
+    for (std::size_t col = 0; col < 5; ++col) {
+      ret(row, col) = x;
+      x *= xs[row];
+    }
+  }
+  return ret;
+}
+
+constexpr std::int64_t vandermonde_determinant() {
+  auto const xs = std::array<std::int64_t, 5>{{-3, 1, 2, 4, 9}};
+  auto ret = std::int64_t(1);
+  for (std::size_t i = 0; i < 5; ++i) {
+    for (std::size_t j = i + 1; j < 5; ++j) {
+      ret *= xs[j] - xs[i];
+    }
+  }
+  return ret;
+}
+
+// small entries, some of them repeated rows
+template <std::size_t H, std::size_t W>
+algae::matrix<std::int64_t, H, W> pattern(std::size_t seed) {
+  return fixtures::generate<std::int64_t, H, W>(
+      [=](std::size_t row, std::size_t col) {
+        auto const source = row % 3 == 2 ? row - 1 : row;
+        return std::int64_t((source * 7 + col * 13 + seed) % 11) - 5;
+      });
+}
+
+} // namespace
+
+TEST_CASE("exact determinants", "[exact]") {
+  auto const m = vandermonde();
+  auto const expected = vandermonde_determinant();
+
+  REQUIRE(determinant(m) == expected);
+  REQUIRE(determinant(m, algae::checked) == expected);
+  REQUIRE(determinant(m, algae::multimodular) == expected);
+
+  using col = algae::matrix<std::int64_t, 5, 5, algae::column_major>;
+  REQUIRE(determinant(col(m)) == expected);
+
+  // a row swap
+  auto const swapped = algae::matrix<int, 2, 2>(
+      std::array<std::array<int, 2>, 2>{{{0, 2}, {3, 1}}});
+  REQUIRE(determinant(swapped) == -6);
+  REQUIRE(determinant(swapped, algae::multimodular) == -6);
+
+  auto const singular = algae::matrix<int, 3, 3>(
+      std::array<std::array<int, 3>, 3>{{{1, 2, 3}, {4, 5, 6}, {7, 8, 9}}});
+  REQUIRE(determinant(singular) == 0);
+  REQUIRE(determinant(singular, algae::checked) == 0);
+  REQUIRE(determinant(singular, algae::multimodular) == 0);
+
+  static_assert(determinant(vandermonde()) == vandermonde_determinant());
+  static_assert(
+      *determinant(vandermonde(), algae::multimodular) ==
+      vandermonde_determinant());
+}
+
+TEST_CASE("exact determinants, with overflow", "[exact]") {
+  constexpr auto big = std::int64_t(1) << 35;
+
+  SECTION("the products don't fit, but the minors do") {
+    auto const m = algae::matrix<std::int64_t, 2, 2>(
+        std::array<std::array<std::int64_t, 2>, 2>{
+            {{big, big + 1}, {big - 1, big}}});
+    REQUIRE(determinant(m, algae::checked) == 1);
+    REQUIRE(determinant(m, algae::multimodular) == 1);
+  }
+  SECTION("the minors don't fit, but the determinant does") {
+    // the leading 2 by 2 minor is 2^70; the determinant is -2^36
+    auto const m = algae::matrix<std::int64_t, 3, 3>(
+        std::array<std::array<std::int64_t, 3>, 3>{
+            {{big, 0, 1}, {0, big, 1}, {1, 1, 0}}});
+    REQUIRE(!determinant(m, algae::checked).has_value());
+    REQUIRE(determinant(m, algae::multimodular) == -(std::int64_t(1) << 36));
+  }
+  SECTION("the determinant doesn't fit") {
+    auto m = algae::matrix<std::int64_t, 2, 2>();
+    m(0, 0) = std::int64_t(1) << 32;
+    m(1, 1) = std::int64_t(1) << 31;
+    REQUIRE(!determinant(m, algae::checked).has_value());
+    REQUIRE(!determinant(m, algae::multimodular).has_value());
+  }
+  SECTION("the extremes") {
+    constexpr auto min = std::numeric_limits<std::int64_t>::min();
+    constexpr auto max = std::numeric_limits<std::int64_t>::max();
+    auto m = algae::matrix<std::int64_t, 2, 2>();
+    m(0, 0) = max;
+    m(1, 1) = 1;
+    REQUIRE(determinant(m, algae::checked) == max);
+    REQUIRE(determinant(m, algae::multimodular) == max);
+    m(1, 1) = -1;
+    REQUIRE(determinant(m, algae::multimodular) == -max);
+    m(0, 0) = min;
+    REQUIRE(!determinant(m, algae::checked).has_value());
+    REQUIRE(!determinant(m, algae::multimodular).has_value());
+    m(1, 1) = 1;
+    REQUIRE(determinant(m, algae::checked) == min);
+    REQUIRE(determinant(m, algae::multimodular) == min);
+    m(1, 1) = 2;
+    REQUIRE(!determinant(m, algae::checked).has_value());
+    REQUIRE(!determinant(m, algae::multimodular).has_value());
+  }
+  SECTION("against modular arithmetic") {
+    using mod = algae::modint<998244353>;
+    // small entries, all different
+    auto const m = fixtures::generate<std::int64_t, 8, 8>(
+        [](std::size_t row, std::size_t col) {
+          auto const x = row * 8 + col + 3;
+          return std::int64_t(x * x * x % 17) - 8;
+        });
+    auto const reduced = fixtures::generate<mod, 8, 8>(
+        [&](std::size_t row, std::size_t col) { return mod(m(row, col)); });
+    auto const exact = determinant(m, algae::multimodular);
+    REQUIRE(exact.has_value());
+    REQUIRE(*exact == 14031528);
+    REQUIRE(determinant(m, algae::checked) == exact);
+    REQUIRE(mod(*exact) == determinant(reduced));
+  }
+}
+
+TEST_CASE("exact ranks", "[exact]") {
+  // every third row repeats the one before it
+  auto const m = pattern<9, 13>(1);
+  REQUIRE(rank(m) == 6);
+  REQUIRE(rank(m, algae::checked) == 6);
+  REQUIRE(rank(m, algae::multimodular) == 6);
+  REQUIRE(rank(transpose(m)) == 6);
+
+  // every entry is 0 mod 3
+  auto const threes = algae::matrix<int, 3, 2>(
+      std::array<std::array<int, 2>, 3>{{{3, 6}, {9, 12}, {15, 18}}});
+  REQUIRE(rank(threes) == 2);
+  REQUIRE(rank(threes, algae::multimodular) == 2);
+
+  constexpr auto big = std::int64_t(1) << 40;
+  auto const wide = algae::matrix<std::int64_t, 2, 3>(
+      std::array<std::array<std::int64_t, 3>, 2>{
+          {{big, big, 1}, {big, big, 1}}});
+  REQUIRE(rank(wide, algae::checked) == 1);
+  REQUIRE(rank(wide, algae::multimodular) == 1);
+
+  static_assert(rank(algae::matrix<int, 3, 2>()) == 0);
+}
+
+TEST_CASE("exact solutions", "[exact]") {
+  auto const a = vandermonde();
+  auto const b = pattern<5, 2>(4);
+
+  auto const x = solve(a, b);
+  REQUIRE(x.has_value());
+  REQUIRE(x->denominator > 0);
+  REQUIRE(x->denominator == vandermonde_determinant());
+  // a * numerators = denominator * b
+  auto const product = multiply(a, x->numerators);
+  for (std::size_t row = 0; row < 5; ++row) {
+    for (std::size_t col = 0; col < 2; ++col) {
+      REQUIRE(product(row, col) == x->denominator * b(row, col));
+    }
+  }
+
+  auto const y = solve(a, b, algae::checked);
+  REQUIRE(y.has_value());
+  REQUIRE(y->numerators == x->numerators);
+
+  // a zero in the first pivot
+  auto const swapped = algae::matrix<int, 2, 2>(
+      std::array<std::array<int, 2>, 2>{{{0, 2}, {3, 1}}});
+  auto c = algae::matrix<int, 2, 1>();
+  c(0, 0) = 4;
+  c(1, 0) = 5;
+  auto const z = solve(swapped, c);
+  REQUIRE(z.has_value());
+  REQUIRE(z->denominator == 6);
+  REQUIRE(z->numerators(0, 0) == 6);
+  REQUIRE(z->numerators(1, 0) == 12);
+
+  auto const singular = algae::matrix<int, 2, 2>(
+      std::array<std::array<int, 2>, 2>{{{1, 2}, {2, 4}}});
+  REQUIRE(!solve(singular, c).has_value());
+}
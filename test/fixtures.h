@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+#include <algae/matrix.h>
+
+/*
+  matrices for the tests, filled in from a function of row and column;
+  each test picks the pattern it needs
+*/
+
+namespace fixtures {
+
+// an H x W matrix, with f(row, col) in each place
+template <typename T, std::size_t H, std::size_t W, typename F>
+constexpr algae::matrix<T, H, W> generate(F const& f) {
+  auto ret = algae::matrix<T, H, W>();
+  for (std::size_t row = 0; row < H; ++row) {
+    for (std::size_t col = 0; col < W; ++col) {
+      ret(row, col) = f(row, col);
+    }
+  }
+  return ret;
+}
+
+} // namespace fixtures
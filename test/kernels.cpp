@@ -0,0 +1,1777 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <algae/bit_matrix.h>
+#include <algae/kernels.h>
+#include <algae/literals.h>
+#include <algae/matrix.h>
+#include <algae/modint.h>
+#include <algae/semiring.h>
+#include <algae/sparse.h>
+#include <algae/structured.h>
+#include <algae/vector.h>
+#include <algae/view.h>
+
+namespace kern = algae::kernels;
+namespace lit = algae::literals;
+
+namespace {
+
+constexpr kern::isa all_isas[] = {
+    kern::isa::generic,
+    kern::isa::sse4_2,
+    kern::isa::avx2,
+    kern::isa::avx512,
+};
+
+// small integers, so that every variant gets exactly the same answer
+template <typename T>
+std::vector<T> iota_mod(std::size_t n, int start) {
+  auto ret = std::vector<T>(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    ret[i] = T(int((i + start) % 7) - 3);
+  }
+  return ret;
+}
+
+template <typename T>
+void check_level1(std::vector<T> const& x, std::vector<T> const& y) {
+  auto const n = x.size();
+
+  auto out = y;
+  kern::axpby(T(2), x.data(), T(-3), out.data(), n);
+  for (std::size_t i = 0; i < n; ++i) {
+    REQUIRE(out[i] == T(2) * x[i] - T(3) * y[i]);
+  }
+  kern::scal(T(-2), out.data(), n);
+  for (std::size_t i = 0; i < n; ++i) {
+    REQUIRE(out[i] == T(-4) * x[i] + T(6) * y[i]);
+  }
+
+  auto sum_squares = T(0);
+  auto sum_abs = T(0);
+  std::size_t max_idx = 0;
+  std::size_t min_idx = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    auto const a = x[i] < T(0) ? -x[i] : x[i];
+    sum_squares += x[i] * x[i];
+    sum_abs += a;
+    if (a > (x[max_idx] < T(0) ? -x[max_idx] : x[max_idx])) {
+      max_idx = i;
+    }
+    if (a < (x[min_idx] < T(0) ? -x[min_idx] : x[min_idx])) {
+      min_idx = i;
+    }
+  }
+  REQUIRE(kern::asum(x.data(), n) == sum_abs);
+  REQUIRE(kern::iamax(x.data(), n) == max_idx);
+  REQUIRE(kern::iamin(x.data(), n) == min_idx);
+  REQUIRE(
+      kern::nrm2(x.data(), n) ==
+      Approx(std::sqrt(double(sum_squares))).epsilon(1e-6));
+
+  auto a = x;
+  auto b = y;
+  kern::swap(a.data(), b.data(), n);
+  REQUIRE(a == y);
+  REQUIRE(b == x);
+  kern::copy(x.data(), b.data(), n);
+  REQUIRE(b == x);
+
+  kern::rot(a.data(), b.data(), n, T(3), T(2));
+  for (std::size_t i = 0; i < n; ++i) {
+    REQUIRE(a[i] == T(3) * y[i] + T(2) * x[i]);
+    REQUIRE(b[i] == T(3) * x[i] - T(2) * y[i]);
+  }
+
+  out = y;
+  auto expected_dot = T(0);
+  for (std::size_t i = 0; i < n; ++i) {
+    expected_dot += (T(2) * x[i] + y[i]) * x[i];
+  }
+  REQUIRE(kern::axpy_dot(T(2), x.data(), out.data(), x.data(), n) ==
+          expected_dot);
+  for (std::size_t i = 0; i < n; ++i) {
+    REQUIRE(out[i] == T(2) * x[i] + y[i]);
+  }
+}
+
+template <typename T>
+void check_raw_kernels() {
+  for (std::size_t n : {0, 1, 3, 8, 17, 64, 100}) {
+    INFO("n = " << n);
+    auto const x = iota_mod<T>(n, 0);
+    auto const y = iota_mod<T>(n, 2);
+
+    auto expected_dot = T(0);
+    for (std::size_t i = 0; i < n; ++i) {
+      expected_dot += x[i] * y[i];
+    }
+    REQUIRE(kern::dot(x.data(), y.data(), n) == expected_dot);
+
+    auto out = std::vector<T>(n);
+    kern::add(x.data(), y.data(), out.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+      REQUIRE(out[i] == x[i] + y[i]);
+    }
+    kern::subtract(x.data(), y.data(), out.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+      REQUIRE(out[i] == x[i] - y[i]);
+    }
+    kern::hadamard(x.data(), y.data(), out.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+      REQUIRE(out[i] == x[i] * y[i]);
+    }
+
+    out = y;
+    kern::axpy(T(2), x.data(), out.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+      REQUIRE(out[i] == T(2) * x[i] + y[i]);
+    }
+
+    check_level1(x, y);
+  }
+}
+
+template <typename T>
+void check_gemm(std::size_t m, std::size_t n, std::size_t k) {
+  INFO("m = " << m << ", n = " << n << ", k = " << k);
+  auto const a = iota_mod<T>(m * k, 0);
+  auto const b = iota_mod<T>(k * n, 5);
+  auto c = iota_mod<T>(m * n, 1);
+
+  auto expected = std::vector<T>(m * n);
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      auto acc = T(0);
+      for (std::size_t p = 0; p < k; ++p) {
+        acc += a[i * k + p] * b[p * n + j];
+      }
+      expected[i * n + j] = T(2) * acc - c[i * n + j];
+    }
+  }
+
+  kern::gemm(m, n, k, T(2), a.data(), k, b.data(), n, T(-1), c.data(), n);
+  REQUIRE(c == expected);
+}
+
+template <typename T>
+void check_gemv(std::size_t m, std::size_t n) {
+  INFO("m = " << m << ", n = " << n);
+  auto const a = iota_mod<T>(m * n, 0);
+  auto const x = iota_mod<T>(n, 3);
+  auto const x_t = iota_mod<T>(m, 4);
+
+  auto y = iota_mod<T>(m, 1);
+  auto expected = std::vector<T>(m);
+  for (std::size_t i = 0; i < m; ++i) {
+    auto acc = T(0);
+    for (std::size_t j = 0; j < n; ++j) {
+      acc += a[i * n + j] * x[j];
+    }
+    expected[i] = T(2) * acc - y[i];
+  }
+  kern::gemv(m, n, T(2), a.data(), n, x.data(), T(-1), y.data());
+  REQUIRE(y == expected);
+
+  auto y_t = iota_mod<T>(n, 1);
+  auto expected_t = std::vector<T>(n);
+  for (std::size_t j = 0; j < n; ++j) {
+    auto acc = T(0);
+    for (std::size_t i = 0; i < m; ++i) {
+      acc += a[i * n + j] * x_t[i];
+    }
+    expected_t[j] = T(2) * acc - y_t[j];
+  }
+  kern::gemv_t(m, n, T(2), a.data(), n, x_t.data(), T(-1), y_t.data());
+  REQUIRE(y_t == expected_t);
+}
+
+// a well-conditioned triangular matrix, with NaNs in the half that
+// shouldn't be read (and on the diagonal, for diagonal::unit)
+template <typename T>
+std::vector<T>
+triangular(algae::triangle tri, algae::diagonal diag, std::size_t n) {
+  auto ret = iota_mod<T>(n * n, 0);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      auto& x = ret[i * n + j];
+      auto const inside =
+          tri == algae::triangle::lower ? j < i : j > i;
+      if (i == j) {
+        x = diag == algae::diagonal::unit ? std::nan("") : T(2) + x / T(4);
+      } else if (inside) {
+        x /= T(4 * n);
+      } else {
+        x = std::nan("");
+      }
+    }
+  }
+  return ret;
+}
+
+template <typename T>
+void check_trsm(std::size_t n, std::size_t nrhs) {
+  for (auto tri : {algae::triangle::lower, algae::triangle::upper}) {
+    for (auto diag : {algae::diagonal::non_unit, algae::diagonal::unit}) {
+      INFO(
+          "n = " << n << ", nrhs = " << nrhs << ", lower = "
+                 << (tri == algae::triangle::lower)
+                 << ", unit = " << (diag == algae::diagonal::unit));
+      auto const a = triangular<T>(tri, diag, n);
+      auto const x = iota_mod<T>(n * nrhs, 1);
+
+      // b = a * x, using only the right half of a
+      auto b = std::vector<T>(n * nrhs);
+      for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+          auto const inside =
+              tri == algae::triangle::lower ? j < i : j > i;
+          auto const coefficient = i == j
+              ? (diag == algae::diagonal::unit ? T(1) : a[i * n + j])
+              : (inside ? a[i * n + j] : T(0));
+          for (std::size_t c = 0; c < nrhs; ++c) {
+            b[i * nrhs + c] += coefficient * x[j * nrhs + c];
+          }
+        }
+      }
+
+      if (nrhs == 1) {
+        kern::trsv(tri, diag, n, a.data(), n, b.data());
+      } else {
+        kern::trsm(tri, diag, n, nrhs, a.data(), n, b.data(), nrhs);
+      }
+      for (std::size_t i = 0; i < n * nrhs; ++i) {
+        REQUIRE(b[i] == Approx(x[i]).margin(1e-4));
+      }
+    }
+  }
+}
+
+// roughly one element in `every`, plus all of the first row, so that the
+// rows have very different amounts of work in them
+template <typename T>
+algae::csr_matrix<T> sparse_pattern(
+    std::size_t height, std::size_t width, std::size_t every, int start) {
+  auto offsets = std::vector<std::size_t>{0};
+  auto columns = std::vector<std::size_t>();
+  auto values = std::vector<T>();
+  for (std::size_t row = 0; row < height; ++row) {
+    for (std::size_t col = 0; col < width; ++col) {
+      if (row == 0 || (row * 7919 + col * 104729) % every == 0) {
+        columns.push_back(col);
+        values.push_back(T(int((row + col + start) % 7) - 3));
+      }
+    }
+    offsets.push_back(columns.size());
+  }
+  return algae::csr_matrix<T>(
+      height, width, std::move(offsets), std::move(columns), std::move(values));
+}
+
+template <typename T>
+void check_spgemm(
+    std::size_t m,
+    std::size_t k,
+    std::size_t n,
+    std::size_t a_every,
+    std::size_t b_every) {
+  INFO("m = " << m << ", k = " << k << ", n = " << n);
+  auto a = sparse_pattern<T>(m, k, a_every, 0);
+  auto const b = sparse_pattern<T>(k, n, b_every, 3);
+
+  auto const check = [&](algae::csr_matrix<T> const& c) {
+    REQUIRE(c.height() == m);
+    REQUIRE(c.width() == n);
+    for (std::size_t row = 0; row < m; ++row) {
+      auto expected = std::map<std::size_t, T>();
+      for (auto i = a.row_offsets()[row]; i < a.row_offsets()[row + 1]; ++i) {
+        auto const p = a.columns()[i];
+        for (auto j = b.row_offsets()[p]; j < b.row_offsets()[p + 1]; ++j) {
+          expected[b.columns()[j]] += a.values()[i] * b.values()[j];
+        }
+      }
+      auto idx = c.row_offsets()[row];
+      REQUIRE(c.row_offsets()[row + 1] - idx == expected.size());
+      for (auto const& [col, value] : expected) {
+        REQUIRE(c.columns()[idx] == col);
+        REQUIRE(c.values()[idx] == value);
+        ++idx;
+      }
+    }
+  };
+
+  auto c = kern::multiply(a, b);
+  check(c);
+
+  for (auto& x : a.values()) {
+    x = x * T(2) + T(1);
+  }
+  kern::multiply_numeric(a, b, c);
+  check(c);
+}
+
+template <typename T>
+void check_spmm(std::size_t m, std::size_t k, std::size_t n) {
+  INFO("m = " << m << ", k = " << k << ", n = " << n);
+  auto const a = sparse_pattern<T>(m, k, 11, 0);
+  auto const b = iota_mod<T>(k * n, 2);
+  auto out = std::vector<T>(m * n, T(100));
+  kern::multiply(
+      a,
+      algae::matrix_view<T const>(b.data(), k, n, n),
+      algae::matrix_view<T>(out.data(), m, n, n));
+
+  for (std::size_t row = 0; row < m; ++row) {
+    for (std::size_t col = 0; col < n; ++col) {
+      auto expected = T(0);
+      for (std::size_t p = 0; p < k; ++p) {
+        expected += a(row, p) * b[p * n + col];
+      }
+      REQUIRE(out[row * n + col] == expected);
+    }
+  }
+
+  // b a row short doesn't fit a, so out is left as it was
+  auto const before = out;
+  kern::multiply(
+      a,
+      algae::matrix_view<T const>(b.data(), k - 1, n, n),
+      algae::matrix_view<T>(out.data(), m, n, n));
+  REQUIRE(out == before);
+}
+
+// against the obvious triple loop; about a third of `a` is infinite, and
+// some of `b`, so that the skipping (and for integers, the saturating)
+// gets exercised
+template <typename T>
+void check_min_plus(std::size_t m, std::size_t n, std::size_t k) {
+  INFO("m = " << m << ", n = " << n << ", k = " << k);
+  using semiring = algae::min_plus<T>;
+  auto a = iota_mod<T>(m * k, 0);
+  auto b = iota_mod<T>(k * n, 2);
+  for (std::size_t i = 0; i < a.size(); i += 3) {
+    a[i] = semiring::zero();
+  }
+  for (std::size_t i = 0; i < b.size(); i += 5) {
+    b[i] = semiring::zero();
+  }
+  auto c = std::vector<T>(m * n, T(2));
+  kern::min_plus_gemm(m, n, k, a.data(), k, b.data(), n, c.data(), n);
+
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      auto expected = T(2);
+      for (std::size_t p = 0; p < k; ++p) {
+        expected = semiring::plus(
+            expected, semiring::times(a[i * k + p], b[p * n + j]));
+      }
+      REQUIRE(c[i * n + j] == expected);
+    }
+  }
+}
+
+std::vector<std::uint64_t> random_bits(std::size_t count, std::uint64_t seed) {
+  auto ret = std::vector<std::uint64_t>(count);
+  for (auto& x : ret) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    x = seed;
+  }
+  return ret;
+}
+
+void check_or_and(std::size_t m, std::size_t n_words, std::size_t k) {
+  INFO("m = " << m << ", n_words = " << n_words << ", k = " << k);
+  auto const k_words = (k + 63) / 64;
+  auto a = random_bits(m * k_words, 1);
+  // some all-zero words, for the skipping
+  for (std::size_t i = 0; i < a.size(); i += 3) {
+    a[i] = 0;
+  }
+  auto const b = random_bits(k * n_words, 2);
+  auto c = random_bits(m * n_words, 3);
+  auto const original = c;
+  kern::or_and_gemm(
+      m, n_words, k, a.data(), k_words, b.data(), n_words, c.data(), n_words);
+
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n_words; ++j) {
+      auto expected = original[i * n_words + j];
+      for (std::size_t p = 0; p < k; ++p) {
+        if ((a[i * k_words + p / 64] >> (p % 64)) & 1) {
+          expected |= b[p * n_words + j];
+        }
+      }
+      REQUIRE(c[i * n_words + j] == expected);
+    }
+  }
+}
+
+// big enough m goes through the four russians tables
+void check_xor_and(std::size_t m, std::size_t n_words, std::size_t k) {
+  INFO("m = " << m << ", n_words = " << n_words << ", k = " << k);
+  auto const k_words = (k + 63) / 64;
+  auto const a = random_bits(m * k_words, 4);
+  auto const b = random_bits(k * n_words, 5);
+  auto c = random_bits(m * n_words, 6);
+  auto const original = c;
+  kern::xor_and_gemm(
+      m, n_words, k, a.data(), k_words, b.data(), n_words, c.data(), n_words);
+
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n_words; ++j) {
+      auto expected = original[i * n_words + j];
+      for (std::size_t p = 0; p < k; ++p) {
+        if ((a[i * k_words + p / 64] >> (p % 64)) & 1) {
+          expected ^= b[p * n_words + j];
+        }
+      }
+      REQUIRE(c[i * n_words + j] == expected);
+    }
+  }
+}
+
+void check_popcounts(std::size_t m, std::size_t n, std::size_t words) {
+  INFO("m = " << m << ", n = " << n << ", words = " << words);
+  auto const a = random_bits(m * words, 7);
+  auto const b = random_bits(n * words, 8);
+  auto both = std::vector<std::size_t>(m * n);
+  auto differ = std::vector<std::size_t>(m * n);
+  kern::and_popcounts(
+      m, n, words, a.data(), words, b.data(), words, both.data(), n);
+  kern::xor_popcounts(
+      m, n, words, a.data(), words, b.data(), words, differ.data(), n);
+
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      std::size_t expected_both = 0;
+      std::size_t expected_differ = 0;
+      for (std::size_t bit = 0; bit < 64 * words; ++bit) {
+        auto const x = (a[i * words + bit / 64] >> (bit % 64)) & 1;
+        auto const y = (b[j * words + bit / 64] >> (bit % 64)) & 1;
+        expected_both += x & y;
+        expected_differ += x ^ y;
+      }
+      REQUIRE(both[i * n + j] == expected_both);
+      REQUIRE(differ[i * n + j] == expected_differ);
+    }
+  }
+}
+
+template <typename T>
+void check_adc(std::size_t n, std::size_t m, std::size_t centroids) {
+  INFO("n = " << n << ", m = " << m << ", centroids = " << centroids);
+  auto codes = std::vector<std::uint8_t>(n * m);
+  for (std::size_t idx = 0; idx < codes.size(); ++idx) {
+    codes[idx] = std::uint8_t((idx * 37 + idx / 5) % centroids);
+  }
+  auto table = std::vector<T>(m * centroids);
+  for (std::size_t idx = 0; idx < table.size(); ++idx) {
+    table[idx] = T(int((idx * 13) % 29) - 14) / T(8);
+  }
+
+  auto sums = std::vector<T>(n);
+  kern::adc_scan(n, m, centroids, codes.data(), table.data(), sums.data());
+  for (std::size_t row = 0; row < n; ++row) {
+    auto expected = T(0);
+    for (std::size_t s = 0; s < m; ++s) {
+      expected += table[s * centroids + codes[row * m + s]];
+    }
+    // eighths, so every sum is exact
+    REQUIRE(sums[row] == expected);
+  }
+
+  // the same sums, whichever rows a thread gets
+  auto const k = std::min<std::size_t>(n, 3);
+  auto indices = std::vector<std::size_t>(k);
+  auto values = std::vector<T>(k);
+  kern::adc_top_k(
+      algae::metric::squared_euclidean,
+      n,
+      m,
+      centroids,
+      codes.data(),
+      1,
+      table.data(),
+      k,
+      indices.data(),
+      values.data());
+  auto sorted = sums;
+  std::sort(sorted.begin(), sorted.end());
+  for (std::size_t q = 0; q < k; ++q) {
+    REQUIRE(values[q] == sorted[q]);
+    REQUIRE(sums[indices[q]] == values[q]);
+  }
+}
+
+// the largest prime below 2^31, so the products need folding often
+using mod_big = algae::modint<2147483647>;
+
+template <typename T>
+std::vector<std::uint32_t>
+random_residues(std::size_t count, std::uint64_t seed) {
+  auto const bits = random_bits(count, seed);
+  auto ret = std::vector<std::uint32_t>(count);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    ret[idx] = T(bits[idx] >> 1).montgomery();
+  }
+  // and some of the largest values
+  for (std::size_t idx = 0; idx < count; idx += 5) {
+    ret[idx] = T(-1).montgomery();
+  }
+  return ret;
+}
+
+template <typename T>
+void check_mod_gemm(std::size_t m, std::size_t n, std::size_t k) {
+  INFO("p = " << T::modulus() << ", m = " << m << ", n = " << n);
+  auto const a = random_residues<T>(m * k, 9);
+  auto const b = random_residues<T>(k * n, 10);
+  auto c = std::vector<std::uint32_t>(m * n);
+  kern::mod_gemm(m, n, k, T::modulus(), a.data(), k, b.data(), n, c.data(), n);
+
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      auto expected = T();
+      for (std::size_t p = 0; p < k; ++p) {
+        expected += T::from_montgomery(a[i * k + p]) *
+            T::from_montgomery(b[p * n + j]);
+      }
+      REQUIRE(c[i * n + j] == expected.montgomery());
+    }
+  }
+}
+
+template <typename T>
+void check_mod_axpy(std::size_t n) {
+  INFO("p = " << T::modulus() << ", n = " << n);
+  auto const x = random_residues<T>(n, 11);
+  auto y = random_residues<T>(n, 12);
+  auto const original = y;
+  auto const alpha = T(-3);
+  kern::mod_axpy(T::modulus(), alpha.montgomery(), x.data(), y.data(), n);
+  for (std::size_t idx = 0; idx < n; ++idx) {
+    auto const expected = T::from_montgomery(original[idx]) +
+        alpha * T::from_montgomery(x[idx]);
+    REQUIRE(y[idx] == expected.montgomery());
+  }
+}
+
+
+// `count` different well-conditioned matrices; a small leading element, so
+// that the solves have to pivot, and every seventh one singular if asked
+template <typename T, std::size_t N>
+std::vector<algae::matrix<T, N, N>>
+batch_of(std::size_t count, bool with_singular) {
+  auto ret = std::vector<algae::matrix<T, N, N>>(count);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    auto& m = ret[idx];
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j < N; ++j) {
+        m(i, j) = T(int((idx * 5 + i * 3 + j * 7) % 11) - 5) / T(4);
+      }
+      m(i, i) += T(2 * N);
+    }
+    m(0, 0) = T(0.125);
+    if (with_singular && idx % 7 == 3) {
+      // a zero column stays exactly zero through the elimination
+      for (std::size_t i = 0; i < N; ++i) {
+        m(i, N - 1) = T(0);
+      }
+    }
+  }
+  return ret;
+}
+
+template <typename T, std::size_t N>
+void check_batched(std::size_t count) {
+  INFO("N = " << N << ", count = " << count);
+  auto const tolerance = std::is_same_v<T, float> ? 1e-4 : 1e-10;
+  auto const a = batch_of<T, N>(count, true);
+  auto const b = batch_of<T, N>(count + 3, false);
+
+  auto product = std::vector<algae::matrix<T, N, N>>(count);
+  kern::batched_multiply(a.data(), b.data() + 3, product.data(), count);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    auto const expected = algae::multiply(a[idx], b[idx + 3]);
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j < N; ++j) {
+        REQUIRE(product[idx](i, j) == Approx(expected(i, j)).margin(1e-4));
+      }
+    }
+  }
+
+  auto inverse = std::vector<algae::matrix<T, N, N>>(count);
+  auto singular = std::vector<char>(count);
+  auto flags = std::make_unique<bool[]>(count);
+  auto const failures =
+      kern::batched_inverse(a.data(), inverse.data(), count, flags.get());
+  std::size_t expected_failures = 0;
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    singular[idx] = idx % 7 == 3;
+    expected_failures += singular[idx];
+    REQUIRE(flags[idx] == bool(singular[idx]));
+    if (singular[idx]) {
+      continue;
+    }
+    auto const identity = algae::multiply(a[idx], inverse[idx]);
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j < N; ++j) {
+        REQUIRE(
+            identity(i, j) == Approx(i == j ? 1.0 : 0.0).margin(tolerance));
+      }
+    }
+  }
+  REQUIRE(failures == expected_failures);
+
+  // b[idx] times a vector, solved for that vector again
+  auto x = std::vector<algae::vector<T, N>>(count, algae::list_init);
+  auto rhs = x;
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    for (std::size_t i = 0; i < N; ++i) {
+      x[idx][i] = T(int((idx + i) % 5) - 2);
+    }
+    rhs[idx] = algae::multiply(b[idx], x[idx]);
+  }
+  REQUIRE(kern::batched_solve(b.data(), rhs.data(), count) == 0);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    for (std::size_t i = 0; i < N; ++i) {
+      REQUIRE(rhs[idx][i] == Approx(x[idx][i]).margin(tolerance));
+    }
+  }
+  REQUIRE(kern::batched_solve(a.data(), rhs.data(), count) ==
+          expected_failures);
+
+  // b b^T is positive definite, until one of them has a negative diagonal
+  auto spd = std::vector<algae::matrix<T, N, N>>(count);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    spd[idx] = algae::multiply(b[idx], algae::transpose(b[idx]));
+  }
+  spd[count / 2](N - 1, N - 1) = T(-1);
+  auto factors = std::vector<algae::matrix<T, N, N>>(count);
+  REQUIRE(kern::batched_cholesky(
+              spd.data(), factors.data(), count, flags.get()) == 1);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    REQUIRE(flags[idx] == (idx == count / 2));
+    if (idx == count / 2) {
+      continue;
+    }
+    auto const& l = factors[idx];
+    auto const again = algae::multiply(l, algae::transpose(l));
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j < N; ++j) {
+        if (j > i) {
+          REQUIRE(l(i, j) == T(0));
+        }
+        REQUIRE(
+            again(i, j) ==
+            Approx(spd[idx](i, j)).epsilon(tolerance).margin(tolerance));
+      }
+    }
+  }
+}
+
+
+// small integers, so that the euclidean distances and inner products are
+// exact, whichever way they're worked out, and there are plenty of ties
+template <typename T, std::size_t N>
+std::vector<algae::vector<T, N>> point_set(std::size_t count, int seed) {
+  auto ret = std::vector<algae::vector<T, N>>(count, algae::list_init);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    for (std::size_t i = 0; i < N; ++i) {
+      ret[idx][i] = T(int((idx * 7 + i * 13 + seed) % 9) - 4);
+    }
+  }
+  return ret;
+}
+
+template <typename T, std::size_t N>
+void check_pairwise(algae::metric which, std::size_t m, std::size_t n) {
+  INFO("metric = " << int(which) << ", m = " << m << ", n = " << n);
+  auto const a = point_set<T, N>(m, 1);
+  auto const b = point_set<T, N>(n, 5);
+  auto const exact = which != algae::metric::cosine;
+  auto const nearer = [&](T lhs, T rhs) {
+    return which == algae::metric::squared_euclidean ? lhs < rhs : lhs > rhs;
+  };
+
+  auto out = std::vector<T>(m * n);
+  kern::pairwise(which, a.data(), m, b.data(), n, out.data());
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      auto const expected = algae::impl::compare(which, a[i], b[j]);
+      if (exact) {
+        REQUIRE(out[i * n + j] == expected);
+      } else {
+        REQUIRE(out[i * n + j] == Approx(expected).margin(1e-5));
+      }
+    }
+  }
+
+  for (std::size_t k : {std::size_t(1), std::size_t(10), n + 2}) {
+    INFO("k = " << k);
+    auto indices = std::vector<std::size_t>(m * k);
+    auto values = std::vector<T>(m * k);
+    kern::pairwise_top_k(
+        which, a.data(), m, b.data(), n, k, indices.data(), values.data());
+    for (std::size_t i = 0; i < m; ++i) {
+      auto const row = out.data() + i * n;
+      // the full row, sorted; ties go to the lower index
+      auto order = std::vector<std::size_t>(n);
+      for (std::size_t j = 0; j < n; ++j) {
+        order[j] = j;
+      }
+      std::stable_sort(order.begin(), order.end(), [&](auto l, auto r) {
+        return nearer(row[l], row[r]);
+      });
+      for (std::size_t q = 0; q < k; ++q) {
+        auto const idx = indices[i * k + q];
+        if (q >= n) {
+          using limits = std::numeric_limits<T>;
+          auto const worst = which == algae::metric::squared_euclidean
+              ? (limits::has_infinity ? limits::infinity() : limits::max())
+              : (limits::has_infinity ? -limits::infinity()
+                                      : limits::lowest());
+          REQUIRE(idx == n);
+          REQUIRE(values[i * k + q] == worst);
+          continue;
+        }
+        REQUIRE(values[i * k + q] == Approx(row[idx]).margin(1e-5));
+        if (exact) {
+          REQUIRE(idx == order[q]);
+        } else {
+          REQUIRE(values[i * k + q] == Approx(row[order[q]]).margin(1e-5));
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("kernel dispatch", "[kernels]") {
+  REQUIRE(kern::select_isa(kern::isa::generic));
+  REQUIRE(kern::active_isa() == kern::isa::generic);
+
+  REQUIRE(kern::select_isa(kern::detected_isa()));
+  REQUIRE(kern::active_isa() == kern::detected_isa());
+}
+
+TEST_CASE("raw kernels agree across instruction sets", "[kernels]") {
+  auto const original = kern::active_isa();
+  for (auto level : all_isas) {
+    if (!kern::select_isa(level)) {
+      continue;
+    }
+    INFO("isa = " << kern::name(level));
+
+    check_raw_kernels<float>();
+    check_raw_kernels<double>();
+
+    check_gemm<float>(1, 1, 1);
+    check_gemm<float>(5, 7, 3);
+    check_gemm<float>(33, 65, 300);
+    check_gemm<double>(4, 4, 4);
+    check_gemm<double>(17, 1100, 9);
+
+    check_gemv<float>(0, 3);
+    check_gemv<float>(1, 1);
+    check_gemv<float>(7, 33);
+    check_gemv<double>(9, 5);
+    check_gemv<double>(64, 100);
+
+    check_trsm<float>(1, 1);
+    check_trsm<float>(17, 1);
+    check_trsm<float>(150, 7);
+    check_trsm<double>(64, 1);
+    check_trsm<double>(65, 20);
+
+    check_min_plus<float>(1, 1, 1);
+    check_min_plus<float>(13, 37, 9);
+    check_min_plus<double>(20, 33, 70);
+    check_min_plus<std::int32_t>(17, 41, 30);
+    check_or_and(5, 3, 130);
+    check_or_and(9, 17, 64);
+    check_xor_and(5, 3, 130);
+    check_xor_and(70, 20, 77);
+    check_popcounts(1, 1, 1);
+    check_popcounts(9, 13, 5);
+    check_adc<float>(1, 1, 1);
+    check_adc<float>(37, 4, 16);
+    check_adc<float>(70, 9, 5);
+    check_adc<float>(300, 11, 256);
+    check_adc<double>(21, 8, 200);
+    check_adc<double>(53, 8, 3);
+    check_adc<double>(40, 12, 13);
+    check_adc<double>(300, 7, 256);
+    check_mod_gemm<mod_big>(1, 1, 1);
+    check_mod_gemm<mod_big>(9, 37, 50);
+    check_mod_gemm<algae::modint<998244353>>(6, 70, 300);
+    check_mod_gemm<algae::modint<7>>(5, 40, 9);
+    check_mod_axpy<mod_big>(37);
+    check_mod_axpy<algae::modint<65537>>(5);
+  }
+  kern::select_isa(original);
+}
+
+TEST_CASE("kernels split big problems across threads", "[kernels]") {
+  kern::set_thread_count(4);
+  REQUIRE(kern::thread_count() == 4);
+  check_gemv<float>(301, 500);
+  check_gemv<double>(5, 40000);
+  check_gemv<double>(40000, 3);
+  check_trsm<double>(100, 40);
+  check_spgemm<double>(300, 200, 2000, 5, 7);
+  check_spmm<float>(2000, 100, 24);
+  check_min_plus<std::int32_t>(100, 100, 50);
+  check_or_and(200, 8, 300);
+  check_xor_and(300, 4, 200);
+  check_popcounts(300, 50, 8);
+  check_mod_gemm<mod_big>(200, 64, 100);
+  check_adc<float>(40000, 8, 256);
+
+  kern::set_thread_count(1);
+  check_gemv<float>(301, 500);
+
+  kern::set_thread_count(0);
+  REQUIRE(kern::thread_count() >= 1);
+}
+
+TEST_CASE("parallel_for nests", "[kernels]") {
+  for (std::size_t threads : {1, 4}) {
+    INFO("threads = " << threads);
+    kern::set_thread_count(threads);
+    // every outer piece runs an inner parallel_for of its own, whether it's
+    // on the calling thread or on one of the pool's
+    auto counts = std::vector<std::size_t>(8 * 100, 0);
+    kern::parallel_for(8, 8, [&](std::size_t begin, std::size_t end) {
+      for (auto outer = begin; outer < end; ++outer) {
+        kern::parallel_for(100, 4, [&](std::size_t first, std::size_t last) {
+          for (auto inner = first; inner < last; ++inner) {
+            ++counts[outer * 100 + inner];
+          }
+        });
+      }
+    });
+    REQUIRE(
+        std::count(counts.begin(), counts.end(), 1) ==
+        std::ptrdiff_t(counts.size()));
+
+    // and a kernel from inside a body
+    auto const x = std::vector<double>(50000, 1.0);
+    auto sums = std::vector<double>(4, 0.0);
+    kern::parallel_for(4, 4, [&](std::size_t begin, std::size_t end) {
+      for (auto idx = begin; idx < end; ++idx) {
+        sums[idx] = kern::dot(x.data(), x.data(), x.size());
+      }
+    });
+    REQUIRE(sums == std::vector<double>(4, 50000.0));
+  }
+  kern::set_thread_count(0);
+}
+
+TEST_CASE("kernels on algae types", "[kernels]") {
+  SECTION("vector") {
+    auto v = lit::vec | 1.0f | 2.0f | 3.0f | lit::end;
+    auto u = lit::vec | 4.0f | -5.0f | 6.0f | lit::end;
+    REQUIRE(kern::dot(v, u) == dot(v, u));
+
+    auto sum = kern::add(v, u);
+    REQUIRE(sum[0] == 5.0f);
+    REQUIRE(sum[1] == -3.0f);
+    REQUIRE(sum[2] == 9.0f);
+
+    kern::axpy(2.0f, v, u);
+    REQUIRE(u[0] == 6.0f);
+    REQUIRE(u[1] == -1.0f);
+    REQUIRE(u[2] == 12.0f);
+  }
+  SECTION("matrix") {
+    auto a = algae::matrix<double, 2, 3>(
+        std::array<std::array<double, 3>, 2>{{{1, 2, 3}, {4, 5, 6}}});
+    auto b = algae::matrix<double, 3, 2>(
+        std::array<std::array<double, 2>, 3>{{{7, 8}, {9, 10}, {11, 12}}});
+
+    auto const expected = multiply(a, b);
+    auto const c = kern::multiply(a, b);
+    REQUIRE(expected(0, 0) == 58);
+    REQUIRE(expected(1, 1) == 154);
+    for (std::size_t i = 0; i < 2; ++i) {
+      for (std::size_t j = 0; j < 2; ++j) {
+        REQUIRE(c(i, j) == expected(i, j));
+      }
+    }
+
+    // (b * a) * b is 36 multiply-adds, and b * (a * b) is 24
+    auto const chain = kern::multiply_chain(b, a, b);
+    auto const expected_chain = multiply(b, expected);
+    for (std::size_t i = 0; i < 3; ++i) {
+      for (std::size_t j = 0; j < 2; ++j) {
+        REQUIRE(chain(i, j) == expected_chain(i, j));
+      }
+    }
+  }
+}
+
+TEST_CASE("level 1 BLAS", "[kernels]") {
+  SECTION("nrm2 doesn't overflow or underflow") {
+    for (auto scale : {1e-200, 1e-160, 1.0, 1e160, 1e300}) {
+      INFO("scale = " << scale);
+      double const x[] = {3 * scale, 0.0, -4 * scale, 0.0, 0.0, 0.0, 0.0};
+      REQUIRE(kern::nrm2(x, 7) == Approx(5 * scale));
+    }
+    float const big[] = {3e30f, -4e30f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    REQUIRE(kern::nrm2(big, 8) == Approx(5e30f));
+    // subnormal
+    double const tiny[] = {3e-320, 4e-320};
+    REQUIRE(kern::nrm2(tiny, 2) == Approx(5e-320).epsilon(1e-3));
+    REQUIRE(kern::nrm2(tiny, 0) == 0.0);
+  }
+  SECTION("rotg") {
+    auto a = 3.0;
+    auto b = 4.0;
+    auto c = 0.0;
+    auto s = 0.0;
+    kern::rotg(a, b, c, s);
+    REQUIRE(a == Approx(5.0));
+    REQUIRE(c == Approx(0.6));
+    REQUIRE(s == Approx(0.8));
+
+    // and the rotation does what it says
+    auto x = lit::vec | 3.0 | 1.0 | lit::end;
+    auto y = lit::vec | 4.0 | 2.0 | lit::end;
+    kern::rot(x, y, c, s);
+    REQUIRE(x[0] == Approx(5.0));
+    REQUIRE(y[0] == Approx(0.0).margin(1e-12));
+  }
+  SECTION("vectors and strided views") {
+    auto v = lit::vec | 1.0f | -2.0f | 3.0f | -4.0f | 5.0f | -6.0f | lit::end;
+    REQUIRE(kern::asum(v) == 21.0f);
+    REQUIRE(kern::iamax(v) == 5);
+    REQUIRE(kern::iamin(v) == 0);
+    REQUIRE(kern::nrm2(v) == Approx(std::sqrt(91.0f)));
+
+    auto const odd = algae::vector_view<float>(v.data() + 1, 3, 2);
+    auto const even = algae::vector_view<float>(v.data(), 3, 2);
+    REQUIRE(kern::asum(odd) == 12.0f);
+    REQUIRE(kern::iamax(even) == 2);
+    REQUIRE(kern::nrm2(odd) == Approx(std::sqrt(56.0f)));
+
+    kern::swap(odd, even);
+    REQUIRE(v[0] == -2.0f);
+    REQUIRE(v[1] == 1.0f);
+    kern::scal(2.0f, odd);
+    REQUIRE(v[1] == 2.0f);
+    REQUIRE(v[0] == -2.0f);
+    kern::copy(odd, even);
+    REQUIRE(v[0] == 2.0f);
+    REQUIRE(v[4] == 10.0f);
+
+    auto w = lit::vec | 1.0f | 1.0f | 1.0f | 1.0f | 1.0f | 1.0f | lit::end;
+    kern::axpby(2.0f, algae::view(w), -1.0f, algae::view(v));
+    REQUIRE(v[0] == 0.0f);
+    REQUIRE(v[5] == 2.0f - 10.0f);
+
+    auto const ones = algae::vector_view<float const>(w.data(), 3, 2);
+    REQUIRE(kern::axpy_dot(1.0f, ones, even, ones) == 1.0f - 3.0f - 7.0f);
+    REQUIRE(v[4] == -7.0f);
+
+    // sizes that disagree do nothing
+    auto const before = v;
+    auto const short_odd = algae::vector_view<float>(v.data() + 1, 2, 2);
+    kern::swap(short_odd, even);
+    kern::copy(even, short_odd);
+    kern::rot(even, short_odd, 0.0f, 1.0f);
+    kern::axpby(2.0f, ones, -1.0f, short_odd);
+    REQUIRE(kern::axpy_dot(1.0f, ones, short_odd, ones) == 0.0f);
+    REQUIRE(v == before);
+  }
+  SECTION("non-dispatched element types") {
+    auto v = lit::vec | std::int32_t(1) | -7 | 3 | 7 | lit::end;
+    REQUIRE(kern::asum(v) == 18);
+    REQUIRE(kern::iamax(v) == 1);
+    REQUIRE(kern::iamin(v) == 0);
+
+    using c = std::complex<double>;
+    auto z = lit::vec | c(3, 4) | c(0, 0) | lit::end;
+    REQUIRE(kern::nrm2(z) == Approx(5.0));
+    REQUIRE(kern::asum(z) == Approx(5.0));
+    kern::scal(c(0, 1), z);
+    REQUIRE(z[0] == c(-4, 3));
+  }
+}
+
+TEST_CASE("triangular solves", "[kernels]") {
+  using tri = algae::triangle;
+  using diag = algae::diagonal;
+  auto const a = algae::matrix<double, 3, 3>(
+      std::array<std::array<double, 3>, 3>{{{2, 0, 0}, {1, 4, 0}, {-1, 2, 8}}});
+  auto const x = lit::vec | 1.0 | -2.0 | 0.5 | lit::end;
+  auto const b = multiply(a, x);
+
+  auto const check = [&](auto const& solved) {
+    for (std::size_t i = 0; i < 3; ++i) {
+      REQUIRE(solved[i] == Approx(x[i]));
+    }
+  };
+  check(kern::solve_triangular(tri::lower, diag::non_unit, a, b));
+  check(kern::solve_triangular(
+      tri::lower,
+      diag::non_unit,
+      algae::matrix<double, 3, 3, algae::column_major>(a),
+      b));
+  check(kern::solve_triangular(
+      tri::lower,
+      diag::non_unit,
+      algae::matrix<double, 3, 3, algae::tiled<2>>(a),
+      b));
+
+  // upper, by way of the transpose
+  auto const a_t = transpose(a);
+  check(kern::solve_triangular(
+      tri::upper, diag::non_unit, a_t, multiply(a_t, x)));
+
+  SECTION("mismatched sizes do nothing") {
+    auto short_b = algae::vector<double, 2>(algae::list_init, 1.0, 2.0);
+    kern::trsv(
+        tri::lower,
+        diag::non_unit,
+        algae::view(a),
+        algae::vector_view<double>(short_b.data(), 2));
+    REQUIRE(short_b[0] == 1.0);
+    auto bs = algae::matrix<double, 2, 2>();
+    bs(0, 0) = 1.0;
+    kern::trsm(
+        tri::lower,
+        diag::non_unit,
+        algae::matrix_view<double const>(a.data(), 3, 2, 3),
+        algae::matrix_view<double>(bs.data(), 2, 2, 2));
+    REQUIRE(bs(0, 0) == 1.0);
+  }
+  SECTION("many right hand sides") {
+    auto const xs = algae::matrix<double, 3, 2>(
+        std::array<std::array<double, 2>, 3>{{{1, 0}, {-2, 1}, {0.5, 3}}});
+    auto const bs = multiply(a, xs);
+    auto const solved =
+        kern::solve_triangular(tri::lower, diag::non_unit, a, bs);
+    auto const solved_col = kern::solve_triangular(
+        tri::lower,
+        diag::non_unit,
+        a,
+        algae::matrix<double, 3, 2, algae::column_major>(bs));
+    for (std::size_t i = 0; i < 3; ++i) {
+      for (std::size_t j = 0; j < 2; ++j) {
+        REQUIRE(solved(i, j) == Approx(xs(i, j)));
+        REQUIRE(solved_col(i, j) == Approx(xs(i, j)));
+      }
+    }
+  }
+  SECTION("non-dispatched element types") {
+    using c = std::complex<double>;
+    auto const ac = algae::matrix<c, 2, 2>(std::array<std::array<c, 2>, 2>{
+        {{c(1, 1), c(5, 5)}, {c(0, 0), c(0, 2)}}});
+    auto const xc = lit::vec | c(1, 0) | c(0, 1) | lit::end;
+    auto const solved = kern::solve_triangular(
+        tri::upper, diag::non_unit, ac, multiply(ac, xc));
+    REQUIRE(std::abs(solved[0] - xc[0]) < 1e-12);
+    REQUIRE(std::abs(solved[1] - xc[1]) < 1e-12);
+  }
+}
+
+TEST_CASE("parallel sparse products", "[kernels]") {
+  check_spgemm<float>(1, 1, 1, 1, 1);
+  check_spgemm<float>(50, 40, 30, 3, 4);
+  check_spgemm<double>(40, 60, 50, 2, 9);
+  // few products per row, in a very wide product, so the rows hash
+  check_spgemm<double>(100, 300, 100000, 50, 5000);
+  check_spgemm<int>(30, 20, 10, 3, 3);
+
+  check_spmm<float>(37, 29, 19);
+  check_spmm<double>(64, 64, 1);
+
+  SECTION("strided views and other element types") {
+    auto const a = sparse_pattern<double>(5, 4, 2, 0);
+    auto const b = algae::matrix<double, 4, 3, algae::column_major>(
+        std::array<std::array<double, 3>, 4>{
+            {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}, {0, 1, 0}}});
+    auto out = algae::matrix<double, 5, 3>();
+    kern::multiply(a, algae::view(b), algae::view(out));
+    for (std::size_t row = 0; row < 5; ++row) {
+      for (std::size_t col = 0; col < 3; ++col) {
+        auto expected = 0.0;
+        for (std::size_t p = 0; p < 4; ++p) {
+          expected += a(row, p) * b(p, col);
+        }
+        REQUIRE(out(row, col) == expected);
+      }
+    }
+  }
+}
+
+TEST_CASE("semiring products", "[kernels]") {
+  auto const inf = std::numeric_limits<float>::infinity();
+  auto const d = algae::matrix<float, 3, 3>(
+      std::array<std::array<float, 3>, 3>{
+          {{0, 1, inf}, {inf, 0, 2}, {inf, inf, 0}}});
+  auto const expected = algae::multiply(d, d, algae::min_plus<float>());
+  REQUIRE(expected(0, 2) == 3);
+  REQUIRE(kern::multiply(d, d, algae::min_plus<float>()) == expected);
+
+  using col = algae::matrix<float, 3, 3, algae::column_major>;
+  using tiled = algae::matrix<float, 3, 3, algae::tiled<2>>;
+  REQUIRE(kern::multiply(col(d), col(d), algae::min_plus<float>()) == expected);
+  REQUIRE(
+      kern::multiply(tiled(d), tiled(d), algae::min_plus<float>()) ==
+      expected);
+
+  SECTION("mismatched shapes do nothing") {
+    auto out = algae::matrix<float, 3, 3>();
+    kern::multiply(
+        algae::view(d),
+        algae::matrix_view<float const>(d.data(), 2, 3, 3),
+        algae::view(out),
+        algae::min_plus<float>());
+    REQUIRE(out == algae::matrix<float, 3, 3>());
+  }
+  SECTION("integers") {
+    auto const i_inf = std::numeric_limits<std::int32_t>::max();
+    auto const di = algae::matrix<std::int32_t, 3, 3>(
+        std::array<std::array<std::int32_t, 3>, 3>{
+            {{0, -1, i_inf}, {i_inf, 0, 2}, {i_inf, i_inf, 0}}});
+    auto const two = kern::multiply(di, di, algae::min_plus<std::int32_t>());
+    REQUIRE(two == algae::multiply(di, di, algae::min_plus<std::int32_t>()));
+    REQUIRE(two(0, 2) == 1);
+    REQUIRE(two(2, 0) == i_inf);
+  }
+  SECTION("booleans") {
+    auto edges = algae::matrix<bool, 70, 130>();
+    auto more = algae::matrix<bool, 130, 90>();
+    for (std::size_t i = 0; i < 70; ++i) {
+      for (std::size_t j = 0; j < 130; ++j) {
+        edges(i, j) = (i * 7 + j * 3) % 11 == 0;
+        more(j, i) = (i + j * 5) % 13 == 0;
+      }
+    }
+    REQUIRE(
+        kern::multiply(edges, more, algae::or_and()) ==
+        algae::multiply(edges, more, algae::or_and()));
+    REQUIRE(
+        kern::multiply(edges, more, algae::xor_and()) ==
+        algae::multiply(edges, more, algae::xor_and()));
+  }
+  SECTION("bit matrices") {
+    auto a = algae::bit_matrix<100, 130>();
+    auto b = algae::bit_matrix<130, 70>();
+    for (std::size_t i = 0; i < 130; ++i) {
+      for (std::size_t j = 0; j < 100; ++j) {
+        a.set(j, i, (i * 7 + j * 3) % 11 == 0);
+        if (j < 70) {
+          b.set(i, j, (i + j * 5) % 3 == 0);
+        }
+      }
+    }
+    REQUIRE(
+        kern::multiply(a, b, algae::or_and()) ==
+        algae::multiply(a, b, algae::or_and()));
+    REQUIRE(
+        kern::multiply(a, b, algae::xor_and()) ==
+        algae::multiply(a, b, algae::xor_and()));
+
+    auto const bt = transpose(b);
+    REQUIRE(kern::and_popcounts(a, bt) == algae::and_popcounts(a, bt));
+    REQUIRE(kern::xor_popcounts(a, bt) == algae::xor_popcounts(a, bt));
+  }
+  SECTION("other semirings") {
+    auto const p = algae::matrix<double, 2, 2>(
+        std::array<std::array<double, 2>, 2>{{{1.0, 0.5}, {0.9, 1.0}}});
+    REQUIRE(
+        kern::multiply(p, p, algae::max_times<double>()) ==
+        algae::multiply(p, p, algae::max_times<double>()));
+  }
+}
+
+TEST_CASE("modular products and elimination", "[kernels]") {
+  using mod = algae::modint<998244353>;
+  auto a = algae::matrix<mod, 20, 30>();
+  auto b = algae::matrix<mod, 30, 25>();
+  for (std::size_t i = 0; i < 30; ++i) {
+    for (std::size_t j = 0; j < 25; ++j) {
+      b(i, j) = mod(i * 1000003 + j * 7919);
+      if (j < 20) {
+        a(j, i) = mod(-static_cast<int>(i * j + 1));
+      }
+    }
+  }
+  auto const expected = algae::multiply(a, b);
+  REQUIRE(kern::multiply(a, b) == expected);
+
+  using col_a = algae::matrix<mod, 20, 30, algae::column_major>;
+  using col_b = algae::matrix<mod, 30, 25, algae::column_major>;
+  REQUIRE(kern::multiply(col_a(a), col_b(b)) == expected);
+
+  // too big a modulus for the kernels
+  using mod61 = algae::modint<(std::uint64_t(1) << 61) - 1>;
+  auto const big = algae::matrix<mod61, 2, 2>(
+      std::array<std::array<mod61, 2>, 2>{{{-1, 2}, {3, -4}}});
+  REQUIRE(kern::multiply(big, big) == algae::multiply(big, big));
+
+  auto square = algae::matrix<mod, 30, 30>();
+  for (std::size_t i = 0; i < 30; ++i) {
+    for (std::size_t j = 0; j < 30; ++j) {
+      square(i, j) = b(i, j % 25);
+    }
+  }
+  auto const power = algae::pow(square, 37);
+  REQUIRE(kern::pow(square, 37) == power);
+  REQUIRE(kern::pow<37>(square) == power);
+
+  auto reduced = a;
+  auto expected_reduced = a;
+  REQUIRE(kern::row_reduce(reduced) == algae::row_reduce(expected_reduced));
+  REQUIRE(reduced == expected_reduced);
+}
+
+TEST_CASE("matrix-vector products", "[kernels]") {
+  auto const a = algae::matrix<float, 2, 3>(
+      std::array<std::array<float, 3>, 2>{{{1, 2, 3}, {4, 5, 6}}});
+  auto const x = lit::vec | 1.0f | -1.0f | 2.0f | lit::end;
+  auto const x_t = lit::vec | 3.0f | -1.0f | lit::end;
+
+  auto const expected = multiply(a, x);
+  auto const expected_t = multiply(x_t, a);
+  REQUIRE(expected[0] == 5.0f);
+  REQUIRE(expected[1] == 11.0f);
+  REQUIRE(expected_t[0] == -1.0f);
+  REQUIRE(expected_t[2] == 3.0f);
+
+  auto const check = [&](auto const& m) {
+    auto const y = kern::multiply(m, x);
+    auto const y_t = kern::multiply(x_t, m);
+    for (std::size_t i = 0; i < 2; ++i) {
+      REQUIRE(y[i] == expected[i]);
+    }
+    for (std::size_t j = 0; j < 3; ++j) {
+      REQUIRE(y_t[j] == expected_t[j]);
+    }
+  };
+  check(a);
+  check(algae::matrix<float, 2, 3, algae::column_major>(a));
+  check(algae::matrix<float, 2, 3, algae::tiled<2>>(a));
+
+  auto out = algae::vector<float, 2>(algae::list_init);
+  kern::multiply(algae::view(a), algae::view(x), algae::view(out));
+  REQUIRE(out[1] == 11.0f);
+  // a transposed view has contiguous columns
+  auto const a_t = algae::matrix_view<float const>(a.data(), 3, 2, 1, 3);
+  auto out_t = algae::vector<float, 3>(algae::list_init);
+  kern::multiply(a_t, algae::view(x_t), algae::view(out_t));
+  REQUIRE(out_t[0] == -1.0f);
+  REQUIRE(out_t[2] == 3.0f);
+
+  // an x too short for a does nothing
+  auto untouched = algae::vector<float, 2>(algae::list_init);
+  kern::multiply(
+      algae::view(a),
+      algae::vector_view<float const>(x.data(), 2),
+      algae::view(untouched));
+  REQUIRE(untouched[0] == 0.0f);
+  REQUIRE(untouched[1] == 0.0f);
+}
+
+TEST_CASE("kernels on other layouts", "[kernels]") {
+  auto const a = algae::matrix<float, 2, 3>(
+      std::array<std::array<float, 3>, 2>{{{1, 2, 3}, {4, 5, 6}}});
+  auto const b = algae::matrix<float, 3, 2>(
+      std::array<std::array<float, 2>, 3>{{{7, 8}, {9, 10}, {11, 12}}});
+  auto const expected = multiply(a, b);
+
+  SECTION("column-major") {
+    using col = algae::column_major;
+    auto const a_col = algae::matrix<float, 2, 3, col>(a);
+    auto const b_col = algae::matrix<float, 3, 2, col>(b);
+    REQUIRE(kern::multiply(a_col, b_col) == expected);
+    REQUIRE(kern::transpose(a_col) == transpose(a));
+    REQUIRE(kern::add(a_col, a_col) == kern::add(a, a));
+
+    auto const sums = kern::column_sums(a_col);
+    REQUIRE(sums[0] == 5.0f);
+    REQUIRE(sums[2] == 9.0f);
+  }
+  SECTION("tiled") {
+    using tile = algae::tiled<2>;
+    auto const a_tiled = algae::matrix<float, 2, 3, tile>(a);
+    auto const b_tiled = algae::matrix<float, 3, 2, tile>(b);
+    REQUIRE(kern::multiply(a_tiled, b_tiled) == expected);
+    REQUIRE(kern::multiply(a_tiled, b) == expected);
+    REQUIRE(kern::transpose(a_tiled) == transpose(a));
+    REQUIRE(kern::hadamard(a_tiled, a_tiled) == kern::hadamard(a, a));
+  }
+}
+
+TEST_CASE("kernels on views", "[kernels]") {
+  auto const a = algae::matrix<float, 2, 3>(
+      std::array<std::array<float, 3>, 2>{{{1, 2, 3}, {4, 5, 6}}});
+  auto const b = algae::matrix<float, 3, 2>(
+      std::array<std::array<float, 2>, 3>{{{7, 8}, {9, 10}, {11, 12}}});
+  auto const expected = multiply(a, b);
+
+  SECTION("sub-blocks of a bigger buffer") {
+    // a and b, each sitting in the corner of a 4 x 5 buffer
+    auto buffer_a = algae::matrix<float, 4, 5>();
+    auto buffer_b = algae::matrix<float, 4, 5>();
+    auto buffer_c = algae::matrix<float, 4, 5>();
+    for (std::size_t i = 0; i < 3; ++i) {
+      for (std::size_t j = 0; j < 3; ++j) {
+        if (i < 2) {
+          buffer_a(i, j) = a(i, j);
+        }
+        if (j < 2) {
+          buffer_b(i, j) = b(i, j);
+        }
+      }
+    }
+    auto const va = algae::matrix_view<float const>(buffer_a.data(), 2, 3, 5);
+    auto const vb = algae::matrix_view<float const>(buffer_b.data(), 3, 2, 5);
+    auto const vc = algae::matrix_view<float>(buffer_c.data(), 2, 2, 5);
+    kern::multiply(va, vb, vc);
+    for (std::size_t i = 0; i < 2; ++i) {
+      for (std::size_t j = 0; j < 2; ++j) {
+        REQUIRE(vc(i, j) == expected(i, j));
+      }
+    }
+    // nothing outside the view was touched
+    REQUIRE(buffer_c(0, 2) == 0.0f);
+    REQUIRE(buffer_c(2, 0) == 0.0f);
+
+    auto sums = algae::vector<float, 3>(algae::list_init);
+    kern::column_sums(va, algae::view(sums));
+    REQUIRE(sums[0] == 5.0f);
+    REQUIRE(sums[2] == 9.0f);
+  }
+  SECTION("blocks") {
+    auto big = algae::matrix<double, 6, 6>();
+    for (std::size_t i = 0; i < 6; ++i) {
+      for (std::size_t j = 0; j < 6; ++j) {
+        big(i, j) = double(int(i + 2 * j) % 5 - 2);
+      }
+    }
+    // the top left 3 x 3 times the top right 3 x 3, into the bottom left
+    kern::multiply(
+        algae::block<0, 0, 3, 3>(big),
+        algae::block<0, 3, 3, 3>(big),
+        algae::block(big, 3, 0, 3, 3));
+    for (std::size_t i = 0; i < 3; ++i) {
+      for (std::size_t j = 0; j < 3; ++j) {
+        auto sum = 0.0;
+        for (std::size_t k = 0; k < 3; ++k) {
+          sum += big(i, k) * big(k, j + 3);
+        }
+        REQUIRE(big(i + 3, j) == sum);
+      }
+    }
+  }
+  SECTION("column-major and strided") {
+    auto const a_col = algae::matrix<float, 2, 3, algae::column_major>(a);
+    auto const b_col = algae::matrix<float, 3, 2, algae::column_major>(b);
+    auto c_col = algae::matrix<float, 2, 2, algae::column_major>();
+    kern::multiply(algae::view(a_col), algae::view(b_col), algae::view(c_col));
+    REQUIRE(c_col == expected);
+
+    // mixed; a_col is packed into a row-major copy for gemm
+    auto c = algae::matrix<float, 2, 2>();
+    kern::multiply(algae::view(a_col), algae::view(b), algae::view(c));
+    REQUIRE(c == expected);
+
+    auto t = algae::matrix<float, 3, 2>();
+    kern::transpose(algae::view(a), algae::view(t));
+    REQUIRE(t == transpose(a));
+    kern::transpose(algae::view(a_col), algae::view(t));
+    REQUIRE(t == transpose(a));
+  }
+  SECTION("vectors") {
+    auto v = lit::vec | 1.0 | 2.0 | 3.0 | 4.0 | lit::end;
+    auto u = lit::vec | 4.0 | -5.0 | 6.0 | 1.0 | lit::end;
+    REQUIRE(kern::dot(algae::view(v), algae::view(u)) == dot(v, u));
+
+    auto const odd = algae::vector_view<double const>(v.data() + 1, 2, 2);
+    auto const even = algae::vector_view<double>(u.data(), 2, 2);
+    REQUIRE(kern::dot(odd, even) == 2.0 * 4.0 + 4.0 * 6.0);
+
+    kern::axpy(2.0, odd, even);
+    REQUIRE(u[0] == 8.0);
+    REQUIRE(u[1] == -5.0);
+    REQUIRE(u[2] == 14.0);
+
+    kern::add(algae::view(v), algae::view(v), algae::view(u));
+    REQUIRE(u[3] == 8.0);
+    kern::hadamard(odd, odd, even);
+    REQUIRE(u[0] == 4.0);
+    REQUIRE(u[2] == 16.0);
+  }
+  SECTION("mismatched sizes do nothing") {
+    auto v = lit::vec | 1.0 | 2.0 | 3.0 | 4.0 | lit::end;
+    auto u = lit::vec | 4.0 | -5.0 | 6.0 | 1.0 | lit::end;
+    auto const first = algae::vector_view<double const>(v.data(), 3);
+    auto const before = u;
+    kern::add(first, algae::view(v), algae::view(u));
+    kern::axpy(2.0, first, algae::view(u));
+    REQUIRE(u == before);
+
+    auto c = algae::matrix<float, 2, 2>();
+    auto const short_b = algae::matrix_view<float const>(b.data(), 2, 2, 2);
+    kern::multiply(algae::view(a), short_b, algae::view(c));
+    REQUIRE(c == algae::matrix<float, 2, 2>());
+    auto sums = algae::vector<float, 2>(algae::list_init);
+    kern::column_sums(
+        algae::view(a), algae::vector_view<float>(sums.data(), 2));
+    REQUIRE(sums[0] == 0.0f);
+  }
+}
+
+TEST_CASE("kernels on structured views", "[kernels]") {
+  // more than one block of rows; small integers, so the sums are exact
+  constexpr std::size_t n = 150;
+  using square = algae::matrix<double, n, n>;
+  auto a = square();
+  auto b = algae::matrix<double, n, 3>();
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      a(i, j) = double(int((i * 5 + j * 3) % 7) - 3);
+    }
+    for (std::size_t j = 0; j < 3; ++j) {
+      b(i, j) = double(int((i + j) % 5) - 2);
+    }
+  }
+  auto x = algae::vector<double, n>(algae::list_init);
+  for (std::size_t i = 0; i < n; ++i) {
+    x[i] = double(int(i % 3) - 1);
+  }
+
+  // the product, and matrix-vector product, of `a` materialized
+  auto const check = [&](auto const& structured) {
+    auto full = square();
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t j = 0; j < n; ++j) {
+        full(i, j) = structured(i, j);
+      }
+    }
+    auto out = algae::matrix<double, n, 3>();
+    kern::multiply(structured, algae::view(b), algae::view(out));
+    REQUIRE(out == multiply(full, b));
+
+    auto y = algae::vector<double, n>(algae::list_init);
+    kern::multiply(structured, algae::view(x), algae::view(y));
+    REQUIRE(y == multiply(full, x));
+  };
+
+  SECTION("transposes") {
+    auto const a_t = transpose(a);
+    auto out = algae::matrix<double, n, 3>();
+    kern::multiply(algae::transpose_view(a), algae::view(b), algae::view(out));
+    REQUIRE(out == multiply(a_t, b));
+
+    // both transposed, into a column-major out
+    auto const b_t = transpose(b);
+    auto out_col = algae::matrix<double, n, 3, algae::column_major>();
+    kern::multiply(
+        algae::transpose_view(a),
+        algae::transpose_view(b_t),
+        algae::view(out_col));
+    REQUIRE(out_col == multiply(a_t, b));
+
+    auto y = algae::vector<double, n>(algae::list_init);
+    kern::multiply(algae::adjoint_view(a), algae::view(x), algae::view(y));
+    REQUIRE(y == multiply(a_t, x));
+  }
+  SECTION("triangular") {
+    check(algae::lower(a));
+    check(algae::upper(a));
+    check(algae::lower(a, algae::diagonal::unit));
+    check(algae::upper(a, algae::diagonal::unit));
+  }
+  SECTION("symmetric") {
+    check(algae::symmetric(a));
+    check(algae::symmetric(a, algae::triangle::lower));
+    // any layout; the panels are packed from it
+    auto const a_col = algae::matrix<double, n, n, algae::column_major>(a);
+    check(algae::symmetric(a_col));
+  }
+  SECTION("mismatched sizes do nothing") {
+    auto const smaller = algae::block(a, 0, 0, n - 1, n - 1);
+    auto out = algae::matrix<double, n, 3>();
+    auto y = algae::vector<double, n>(algae::list_init);
+    for (auto const& tri : {algae::lower(smaller), algae::upper(smaller)}) {
+      kern::multiply(tri, algae::view(b), algae::view(out));
+      kern::multiply(tri, algae::view(x), algae::view(y));
+    }
+    kern::multiply(algae::symmetric(smaller), algae::view(b), algae::view(out));
+    kern::multiply(algae::symmetric(smaller), algae::view(x), algae::view(y));
+    REQUIRE(out == algae::matrix<double, n, 3>());
+    REQUIRE(y == algae::vector<double, n>(algae::list_init));
+  }
+  SECTION("solves") {
+    // a well-conditioned triangle
+    auto t = a;
+    for (std::size_t i = 0; i < n; ++i) {
+      t(i, i) = 100.0;
+    }
+    for (auto const& tri : {algae::lower(t), algae::upper(t)}) {
+      auto rhs = algae::vector<double, n>(algae::list_init);
+      kern::multiply(tri, algae::view(x), algae::view(rhs));
+      auto const solved = kern::solve(tri, rhs);
+
+      auto rhs_many = algae::matrix<double, n, 3>();
+      kern::multiply(tri, algae::view(b), algae::view(rhs_many));
+      auto const solved_many = kern::solve(tri, rhs_many);
+      for (std::size_t i = 0; i < n; ++i) {
+        REQUIRE(solved[i] == Approx(x[i]).margin(1e-12));
+        for (std::size_t j = 0; j < 3; ++j) {
+          REQUIRE(solved_many(i, j) == Approx(b(i, j)).margin(1e-12));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("kernels on non-dispatched element types", "[kernels]") {
+  SECTION("int32") {
+    auto v = lit::vec | std::int32_t(1) | 2 | 3 | 4 | lit::end;
+    auto u = lit::vec | std::int32_t(-1) | 5 | 0 | 2 | lit::end;
+    REQUIRE(kern::dot(v, u) == 17);
+
+    auto diff = kern::subtract(v, u);
+    REQUIRE(diff[0] == 2);
+    REQUIRE(diff[1] == -3);
+    REQUIRE(diff[2] == 3);
+    REQUIRE(diff[3] == 2);
+  }
+  SECTION("complex") {
+    using c = std::complex<double>;
+    auto v = lit::vec | c(1, 1) | c(0, 2) | lit::end;
+    auto u = lit::vec | c(2, 0) | c(1, -1) | lit::end;
+    // not conjugated, same as algae::dot
+    REQUIRE(kern::dot(v, u) == dot(v, u));
+    REQUIRE(kern::dot(v, u) == c(4, 4));
+
+    auto a = algae::matrix<c, 2, 2>(std::array<std::array<c, 2>, 2>{
+        {{c(0, 1), c(1, 0)}, {c(2, 0), c(0, 0)}}});
+    auto const product = kern::multiply(a, a);
+    auto const expected = multiply(a, a);
+    for (std::size_t i = 0; i < 2; ++i) {
+      for (std::size_t j = 0; j < 2; ++j) {
+        REQUIRE(product(i, j) == expected(i, j));
+      }
+    }
+  }
+  SECTION("anything else comes from the headers") {
+    auto v = lit::vec | 1L | 2L | 3L | 4L | 5L | lit::end;
+    REQUIRE(kern::dot(v, v) == 55L);
+  }
+}
+
+TEST_CASE("kernel tuning", "[kernels]") {
+  auto const original = kern::current_tuning();
+
+  SECTION("results don't depend on the blocking") {
+    auto tiny = kern::default_tuning();
+    tiny.f32 = {3, 5, 2, 7};
+    tiny.f64 = {1, 1, 1, 1};
+    kern::set_tuning(tiny);
+
+    check_gemm<float>(9, 31, 17);
+    check_gemm<double>(3, 10, 4);
+
+    auto a = algae::matrix<float, 2, 3>(
+        std::array<std::array<float, 3>, 2>{{{1, 2, 3}, {4, 5, 6}}});
+    auto const t = kern::transpose(a);
+    auto const sums = kern::column_sums(a);
+    for (std::size_t i = 0; i < 2; ++i) {
+      for (std::size_t j = 0; j < 3; ++j) {
+        REQUIRE(t(j, i) == a(i, j));
+      }
+    }
+    REQUIRE(sums[0] == 5.0f);
+    REQUIRE(sums[1] == 7.0f);
+    REQUIRE(sums[2] == 9.0f);
+  }
+  SECTION("tuning files") {
+    auto const path = std::string("algae_test_tuning.conf");
+    auto written = kern::default_tuning();
+    written.f32.gemm_kc = 17;
+    written.f64.reduction_nc = 33;
+    REQUIRE(kern::write_tuning(written, path));
+
+    auto const read = kern::read_tuning(path);
+    REQUIRE(read);
+    REQUIRE(read->f32.gemm_kc == 17);
+    REQUIRE(read->f64.reduction_nc == 33);
+    REQUIRE(read->f64.gemm_kc == written.f64.gemm_kc);
+
+    REQUIRE(!kern::read_tuning("this file does not exist"));
+
+    {
+      auto bad = std::ofstream(path);
+      bad << "float.gemm_kc = 0\n";
+    }
+    REQUIRE(!kern::read_tuning(path));
+    {
+      auto partial = std::ofstream(path);
+      partial << "# comment\n\nfloat.transpose_tile = 8 # inline\n"
+              << "some.future_parameter = 4\n";
+    }
+    auto const partial = kern::read_tuning(path);
+    REQUIRE(partial);
+    REQUIRE(partial->f32.transpose_tile == 8);
+    REQUIRE(partial->f32.gemm_kc == kern::default_tuning().f32.gemm_kc);
+
+    std::remove(path.c_str());
+  }
+#if !defined(_WIN32)
+  SECTION("no configuration directory") {
+    char const* const names[] = {
+        "ALGAE_TUNING_FILE", "XDG_CONFIG_HOME", "HOME"};
+    auto saved = std::vector<std::optional<std::string>>();
+    for (auto name : names) {
+      auto const value = std::getenv(name);
+      saved.push_back(value ? std::optional(std::string(value)) : std::nullopt);
+      unsetenv(name);
+    }
+    // rather than a path relative to the current directory
+    REQUIRE(kern::default_tuning_path().empty());
+    for (std::size_t idx = 0; idx < saved.size(); ++idx) {
+      if (saved[idx]) {
+        setenv(names[idx], saved[idx]->c_str(), 1);
+      }
+    }
+  }
+#endif
+
+  kern::set_tuning(original);
+}
+
+TEST_CASE("batched small matrices", "[kernels]") {
+  auto const original = kern::active_isa();
+  for (auto level : all_isas) {
+    if (!kern::select_isa(level)) {
+      continue;
+    }
+    INFO("isa = " << kern::name(level));
+    // not a whole number of groups, and more than one chunk
+    check_batched<float, 3>(37);
+    check_batched<double, 4>(8);
+    check_batched<float, 8>(1100);
+    check_batched<double, 5>(600);
+  }
+  kern::select_isa(original);
+
+  SECTION("other element types go a matrix at a time") {
+    check_batched<long double, 3>(20);
+  }
+}
+
+TEST_CASE("pairwise distances", "[kernels]") {
+  auto const original = kern::active_isa();
+  for (auto level : all_isas) {
+    if (!kern::select_isa(level)) {
+      continue;
+    }
+    INFO("isa = " << kern::name(level));
+    for (auto which :
+         {algae::metric::squared_euclidean,
+          algae::metric::inner_product,
+          algae::metric::cosine}) {
+      // more rows than a block, and more columns than a tile
+      check_pairwise<float, 5>(which, 70, 600);
+      check_pairwise<double, 3>(which, 9, 20);
+    }
+  }
+  kern::select_isa(original);
+
+  SECTION("across threads") {
+    kern::set_thread_count(4);
+    check_pairwise<float, 16>(algae::metric::squared_euclidean, 300, 700);
+    kern::set_thread_count(0);
+  }
+  SECTION("other element types compare directly") {
+    check_pairwise<long double, 4>(algae::metric::inner_product, 5, 30);
+    check_pairwise<long double, 4>(algae::metric::cosine, 5, 30);
+    check_pairwise<int, 4>(algae::metric::squared_euclidean, 5, 30);
+    check_pairwise<int, 4>(algae::metric::inner_product, 5, 30);
+
+    // the lowest integer score is the worst
+    auto const lowest = std::numeric_limits<std::int32_t>::lowest();
+    auto const a = algae::vector<std::int32_t, 1>(algae::list_init, 1);
+    std::array<algae::vector<std::int32_t, 1>, 3> const b = {
+        algae::vector<std::int32_t, 1>(algae::list_init, lowest),
+        algae::vector<std::int32_t, 1>(algae::list_init, 5),
+        algae::vector<std::int32_t, 1>(algae::list_init, -3)};
+    std::size_t indices[4];
+    std::int32_t values[4];
+    kern::pairwise_top_k(
+        algae::metric::inner_product, &a, 1, b.data(), 3, 4, indices, values);
+    REQUIRE(indices[0] == 1);
+    REQUIRE(indices[1] == 2);
+    REQUIRE(indices[2] == 0);
+    REQUIRE(values[2] == lowest);
+    REQUIRE(indices[3] == 3);
+    REQUIRE(values[3] == lowest);
+  }
+}
+
+TEST_CASE("k-means", "[kernels]") {
+  // four tight groups, far apart
+  double const centers[4][2] = {{0, 0}, {10, 0}, {0, 10}, {10, 10}};
+  auto points = std::vector<double>();
+  for (std::size_t idx = 0; idx < 200; ++idx) {
+    points.push_back(centers[idx % 4][0] + double(idx % 7) * 0.01);
+    points.push_back(centers[idx % 4][1] - double(idx % 5) * 0.01);
+  }
+
+  auto const original = kern::active_isa();
+  for (auto level : all_isas) {
+    if (!kern::select_isa(level)) {
+      continue;
+    }
+    INFO("isa = " << kern::name(level));
+    for (std::uint64_t seed = 0; seed < 4; ++seed) {
+      auto found = std::vector<double>(8);
+      kern::kmeans(200, 2, points.data(), 2, 4, 20, seed, found.data());
+      // a centroid in each group, at its mean
+      for (auto const& center : centers) {
+        auto near = 0;
+        for (std::size_t c = 0; c < 4; ++c) {
+          near += std::abs(found[c * 2] - (center[0] + 0.03)) < 1e-2 &&
+              std::abs(found[c * 2 + 1] - (center[1] - 0.02)) < 1e-2;
+        }
+        REQUIRE(near == 1);
+      }
+    }
+  }
+  kern::select_isa(original);
+
+  SECTION("more centroids than rows") {
+    float const few[] = {1, 2, 3, 4};
+    float found[6];
+    kern::kmeans(2, 2, few, 2, 3, 10, 0, found);
+    for (std::size_t c = 0; c < 3; ++c) {
+      auto const first = found[c * 2] == 1.0f && found[c * 2 + 1] == 2.0f;
+      auto const second = found[c * 2] == 3.0f && found[c * 2 + 1] == 4.0f;
+      REQUIRE((first || second));
+    }
+  }
+}
@@ -0,0 +1,247 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <algae/layout.h>
+#include <algae/matrix.h>
+
+namespace {
+
+template <typename Layout>
+using mat3x4 = algae::matrix<int, 3, 4, Layout>;
+
+template <typename Layout>
+constexpr mat3x4<Layout> counting() {
+  return mat3x4<Layout>(std::array<std::array<int, 4>, 3>{
+      {{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9, 10, 11}}});
+}
+
+} // namespace
+
+TEST_CASE("matrix layouts", "[matrix]") {
+  SECTION("row-major") {
+    auto const m = counting<algae::row_major>();
+    REQUIRE(m.storage_size() == 12);
+    for (std::size_t i = 0; i < 12; ++i) {
+      REQUIRE(m.data()[i] == int(i));
+    }
+  }
+  SECTION("column-major") {
+    auto const m = counting<algae::column_major>();
+    int const expected[] = {0, 4, 8, 1, 5, 9, 2, 6, 10, 3, 7, 11};
+    REQUIRE(m.storage_size() == 12);
+    for (std::size_t i = 0; i < 12; ++i) {
+      REQUIRE(m.data()[i] == expected[i]);
+    }
+  }
+  SECTION("tiled") {
+    auto const m = counting<algae::tiled<2>>();
+    // 2 x 2 tiles of 2 x 2; the bottom row of tiles is half padding
+    int const expected[] = {
+        0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 0, 0, 10, 11, 0, 0};
+    REQUIRE(m.storage_size() == 16);
+    for (std::size_t i = 0; i < 16; ++i) {
+      REQUIRE(m.data()[i] == expected[i]);
+    }
+  }
+  SECTION("morton") {
+    auto const m = algae::matrix<int, 4, 4, algae::morton<1>>(
+        std::array<std::array<int, 4>, 4>{
+            {{0, 1, 4, 5}, {2, 3, 6, 7}, {8, 9, 12, 13}, {10, 11, 14, 15}}});
+    for (std::size_t i = 0; i < 16; ++i) {
+      REQUIRE(m.data()[i] == int(i));
+    }
+    // a 3 x 4 grid of tiles is padded out to 4 x 4
+    REQUIRE(counting<algae::morton<1>>().storage_size() == 16);
+  }
+  SECTION("every layout sees the same matrix") {
+    auto const row = counting<algae::row_major>();
+    REQUIRE(row == counting<algae::column_major>());
+    REQUIRE(row == counting<algae::tiled<2, 3>>());
+    REQUIRE(row == counting<algae::morton<2>>());
+
+    auto const relayout = mat3x4<algae::tiled<2>>(row);
+    REQUIRE(relayout == row);
+    REQUIRE(relayout(2, 3) == 11);
+  }
+}
+
+TEST_CASE("matrix rows and columns", "[matrix]") {
+  auto m = counting<algae::tiled<2>>();
+
+  int expected = 0;
+  for (auto row : m) {
+    REQUIRE(row.size() == 4);
+    for (auto x : row) {
+      REQUIRE(x == expected);
+      ++expected;
+    }
+  }
+
+  auto const col = m.column(1);
+  REQUIRE(col.size() == 3);
+  REQUIRE(col[0] == 1);
+  REQUIRE(col[1] == 5);
+  REQUIRE(col[2] == 9);
+  REQUIRE(*col.rbegin() == 9);
+
+  for (auto column : m.columns()) {
+    for (auto& x : column) {
+      x *= 2;
+    }
+  }
+  REQUIRE(m(2, 3) == 22);
+  REQUIRE(m.row(1)[2] == 12);
+}
+
+TEST_CASE("matrix algorithms on every layout", "[matrix]") {
+  auto const a = counting<algae::row_major>();
+  auto const b = algae::matrix<int, 4, 2>(
+      std::array<std::array<int, 2>, 4>{{{1, 0}, {0, 1}, {2, -1}, {-1, 2}}});
+  auto const expected = algae::matrix<int, 3, 2>(
+      std::array<std::array<int, 2>, 3>{{{1, 5}, {9, 13}, {17, 21}}});
+
+  SECTION("multiply") {
+    REQUIRE(multiply(a, b) == expected);
+
+    auto const a_col = mat3x4<algae::column_major>(a);
+    auto const b_col = algae::matrix<int, 4, 2, algae::column_major>(b);
+    REQUIRE(multiply(a_col, b_col) == expected);
+    REQUIRE(multiply(a_col, b) == expected);
+
+    auto const a_tiled = mat3x4<algae::tiled<2>>(a);
+    auto const b_tiled = algae::matrix<int, 4, 2, algae::morton<3>>(b);
+    REQUIRE(multiply(a_tiled, b_tiled) == expected);
+  }
+  SECTION("transpose") {
+    auto const t = transpose(counting<algae::tiled<2, 3>>());
+    auto const t_col = transpose(counting<algae::column_major>());
+    for (std::size_t i = 0; i < 3; ++i) {
+      for (std::size_t j = 0; j < 4; ++j) {
+        REQUIRE(t(j, i) == a(i, j));
+        REQUIRE(t_col(j, i) == a(i, j));
+      }
+    }
+  }
+  SECTION("matrix-vector") {
+    auto const x = algae::make_vector(1, 0, -1, 2);
+    auto const expected = algae::make_vector(4, 12, 20);
+    auto const x_t = algae::make_vector(1, 1, -1);
+    auto const expected_t = algae::make_vector(-4, -3, -2, -1);
+
+    REQUIRE(multiply(a, x) == expected);
+    REQUIRE(multiply(x_t, a) == expected_t);
+    REQUIRE(multiply(counting<algae::column_major>(), x) == expected);
+    REQUIRE(multiply(x_t, counting<algae::column_major>()) == expected_t);
+    REQUIRE(multiply(counting<algae::morton<2>>(), x) == expected);
+
+    constexpr auto y = multiply(counting<algae::tiled<2>>(), x);
+    static_assert(y[2] == 20);
+  }
+  SECTION("constexpr") {
+    constexpr auto product = multiply(
+        counting<algae::tiled<2>>(), transpose(counting<algae::row_major>()));
+    static_assert(product(0, 0) == 0 + 1 + 4 + 9);
+    static_assert(product(2, 1) == 32 + 45 + 60 + 77);
+  }
+}
+
+TEST_CASE("matrix chains", "[matrix]") {
+  SECTION("order") {
+    // (a * b) * c takes 10 * 100 * 5 + 10 * 5 * 50 = 7500 multiply-adds,
+    // and a * (b * c) takes 75000
+    constexpr auto order = algae::impl::order_chain<3>({10, 100, 5, 50});
+    static_assert(order.cost[0][2] == 7500);
+    static_assert(order.split[0][2] == 1);
+
+    constexpr auto reversed = algae::impl::order_chain<3>({50, 5, 100, 10});
+    static_assert(reversed.cost[0][2] == 7500);
+    static_assert(reversed.split[0][2] == 0);
+
+    // the usual textbook example: ((a (b c)) ((d e) f))
+    constexpr auto six =
+        algae::impl::order_chain<6>({30, 35, 15, 5, 10, 20, 25});
+    static_assert(six.cost[0][5] == 15125);
+    static_assert(six.split[0][5] == 2);
+    static_assert(six.split[0][2] == 0);
+    static_assert(six.split[3][5] == 4);
+  }
+  SECTION("products") {
+    auto const a = counting<algae::row_major>();
+    auto const b = algae::matrix<int, 4, 2>(
+        std::array<std::array<int, 2>, 4>{{{1, 0}, {0, 1}, {2, -1}, {-1, 2}}});
+    auto const c = algae::matrix<int, 2, 3, algae::column_major>(
+        std::array<std::array<int, 3>, 2>{{{1, 2, 3}, {0, -1, 1}}});
+    auto const d = transpose(counting<algae::row_major>());
+
+    auto const expected = multiply(multiply(multiply(a, b), c), a);
+    REQUIRE(algae::multiply_chain(a, b, c, a) == expected);
+    REQUIRE(algae::multiply_chain(a, d, a) == multiply(a, multiply(d, a)));
+    REQUIRE(algae::multiply_chain(a) == a);
+
+    constexpr auto product = algae::multiply_chain(
+        counting<algae::tiled<2>>(),
+        transpose(counting<algae::row_major>()),
+        counting<algae::column_major>());
+    static_assert(product(0, 0) == 14 * 0 + 38 * 4 + 62 * 8);
+  }
+}
+
+TEST_CASE("matrix powers", "[matrix]") {
+  // the fibonacci numbers; [[1, 1], [1, 0]]^k has F(k + 1), F(k), F(k - 1)
+  auto const fib = algae::matrix<std::uint64_t, 2, 2>(
+      std::array<std::array<std::uint64_t, 2>, 2>{{{1, 1}, {1, 0}}});
+  auto fibonacci = std::array<std::uint64_t, 94>();
+  fibonacci[1] = 1;
+  for (std::size_t idx = 2; idx < 94; ++idx) {
+    fibonacci[idx] = fibonacci[idx - 1] + fibonacci[idx - 2];
+  }
+
+  SECTION("run time") {
+    REQUIRE(pow(fib, 0) == algae::matrix<std::uint64_t, 2, 2>(
+                               std::array<std::array<std::uint64_t, 2>, 2>{
+                                   {{1, 0}, {0, 1}}}));
+    REQUIRE(pow(fib, 1) == fib);
+    for (std::uint64_t k = 1; k < 93; ++k) {
+      auto const m = pow(fib, k);
+      REQUIRE(m(0, 0) == fibonacci[k + 1]);
+      REQUIRE(m(0, 1) == fibonacci[k]);
+    }
+  }
+  SECTION("compile time") {
+    REQUIRE(algae::pow<0>(fib) == pow(fib, 0));
+    REQUIRE(algae::pow<1>(fib) == fib);
+    REQUIRE(algae::pow<15>(fib) == pow(fib, 15));
+    REQUIRE(algae::pow<92>(fib)(0, 1) == fibonacci[92]);
+    // past the search, and with every window
+    REQUIRE(algae::pow<0xfedcba987>(fib) == pow(fib, 0xfedcba987));
+    REQUIRE(algae::pow<1024>(fib) == pow(fib, 1024));
+
+    static_assert(algae::pow<10>(algae::matrix<int, 2, 2>(
+                      std::array<std::array<int, 2>, 2>{{{1, 1}, {1, 0}}}))(
+                      0, 1) == 55);
+  }
+  SECTION("addition chains") {
+    // 1 2 3 6 12 15, where binary takes 1 2 3 6 7 14 15
+    static_assert(algae::impl::make_addition_chain(15).length == 6);
+    // the shortest chain for 191 has 12 values, and binary takes 14
+    static_assert(algae::impl::make_addition_chain(191).length == 12);
+    static_assert(algae::impl::make_addition_chain(1).length == 1);
+    // windows from 256 up: 1 2 3 5 ... 15, then 15 * 16 + 15, then * 4 + 3,
+    // where binary takes 19
+    static_assert(algae::impl::make_addition_chain(1023).length == 17);
+
+    constexpr auto big = algae::impl::make_addition_chain(0xfedcba987);
+    static_assert(big.values[big.length - 1] == 0xfedcba987);
+  }
+  SECTION("semirings") {
+    // two hops at most, from 0 to 2
+    auto const d = algae::matrix<int, 3, 3>(std::array<std::array<int, 3>, 3>{
+        {{0, 1, 100}, {100, 0, 1}, {100, 100, 0}}});
+    REQUIRE(pow(d, 2, algae::min_plus<int>())(0, 2) == 2);
+    REQUIRE(algae::pow<2>(d, algae::min_plus<int>())(0, 2) == 2);
+    REQUIRE(pow(d, 0, algae::min_plus<int>())(0, 0) == 0);
+  }
+}
@@ -0,0 +1,169 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <algae/matrix.h>
+#include <algae/modint.h>
+#include <algae/vector.h>
+
+namespace {
+
+// a small prime, one that's used for number theoretic transforms, and a
+// mersenne prime that needs the 64-bit form
+using mod7 = algae::modint<7>;
+using mod998 = algae::modint<998244353>;
+using mod61 = algae::modint<(std::uint64_t(1) << 61) - 1>;
+
+// the same sum, one product and reduction at a time
+template <typename T>
+std::uint64_t slow_dot(std::uint64_t const* lhs, std::uint64_t const* rhs) {
+  auto ret = std::uint64_t(0);
+  for (std::size_t idx = 0; idx < 64; ++idx) {
+    ret = (T(ret) + T(lhs[idx]) * T(rhs[idx])).value();
+  }
+  return ret;
+}
+
+} // namespace
+
+TEST_CASE("modular integers", "[modint]") {
+  static_assert(sizeof(mod998) == 4);
+  static_assert(sizeof(mod61) == 8);
+
+  REQUIRE(mod7(10).value() == 3);
+  REQUIRE(mod7(-1).value() == 6);
+  REQUIRE(mod7(-14).value() == 0);
+  REQUIRE(mod7(3) + mod7(5) == mod7(1));
+  REQUIRE(mod7(3) - mod7(5) == mod7(5));
+  REQUIRE(mod7(3) * mod7(5) == mod7(1));
+  REQUIRE(-mod7(3) == mod7(4));
+  REQUIRE(mod7(3) * 5 == 1);
+  REQUIRE(mod7(2) / mod7(4) == mod7(4));
+
+  auto x = mod998(123456789);
+  REQUIRE((x * x.inverse()).value() == 1);
+  REQUIRE(x.pow(998244352) == mod998(1));
+  REQUIRE(x.pow(0) == mod998(1));
+  x *= x;
+  REQUIRE(x.value() == 123456789ull * 123456789ull % 998244353);
+
+  auto const big = mod61(-2);
+  REQUIRE(big.value() == mod61::modulus() - 2);
+  REQUIRE((big * big).value() == 4);
+  REQUIRE((big * big.inverse()).value() == 1);
+  REQUIRE(mod61(std::uint64_t(1) << 62).value() == 2);
+
+  static_assert(mod7(3).inverse() == mod7(5));
+  static_assert((mod61(5) * mod61(7)).value() == 35);
+  static_assert(mod998::from_montgomery(mod998(9).montgomery()) == 9);
+}
+
+TEST_CASE("modular dot products", "[modint]") {
+  // the largest values, which need the most folding
+  auto lhs = std::array<std::uint64_t, 64>();
+  auto rhs = std::array<std::uint64_t, 64>();
+  for (std::size_t idx = 0; idx < 64; ++idx) {
+    lhs[idx] = (std::uint64_t(1) << 61) - 2 - idx;
+    rhs[idx] = (std::uint64_t(1) << 61) - 2 - idx * idx;
+  }
+
+  SECTION("32 bits") {
+    auto a = algae::vector<mod998, 64>(algae::list_init);
+    auto b = algae::vector<mod998, 64>(algae::list_init);
+    for (std::size_t idx = 0; idx < 64; ++idx) {
+      a[idx] = lhs[idx];
+      b[idx] = rhs[idx];
+    }
+    REQUIRE(dot(a, b).value() == slow_dot<mod998>(lhs.data(), rhs.data()));
+  }
+  SECTION("64 bits") {
+    auto a = algae::vector<mod61, 64>(algae::list_init);
+    auto b = algae::vector<mod61, 64>(algae::list_init);
+    for (std::size_t idx = 0; idx < 64; ++idx) {
+      a[idx] = lhs[idx];
+      b[idx] = rhs[idx];
+    }
+    REQUIRE(dot(a, b).value() == slow_dot<mod61>(lhs.data(), rhs.data()));
+  }
+}
+
+TEST_CASE("modular matrices", "[modint]") {
+  auto const m = algae::matrix<mod7, 3, 3>(std::array<std::array<mod7, 3>, 3>{
+      {{1, 2, 3}, {4, 5, 6}, {0, 1, 5}}});
+
+  SECTION("products") {
+    auto const square = multiply(m, m);
+    REQUIRE(square(0, 0) == mod7(1 + 8 + 0));
+    REQUIRE(square(2, 2) == mod7(0 + 6 + 25));
+
+    using col = algae::matrix<mod7, 3, 3, algae::column_major>;
+    REQUIRE(multiply(col(m), col(m)) == square);
+  }
+  SECTION("elimination") {
+    // 1 * (25 - 6) - 2 * 20 + 3 * 4 = -9
+    REQUIRE(determinant(m) == mod7(-9));
+    REQUIRE(rank(m) == 3);
+
+    auto reduced = m;
+    REQUIRE(row_reduce(reduced) == 3);
+    REQUIRE(
+        reduced ==
+        algae::matrix<mod7, 3, 3>(std::array<std::array<mod7, 3>, 3>{
+            {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}}));
+
+    // the third row is the sum of the first two, mod 7
+    auto const singular =
+        algae::matrix<mod7, 3, 3>(std::array<std::array<mod7, 3>, 3>{
+            {{1, 2, 3}, {4, 5, 6}, {5, 0, 2}}});
+    REQUIRE(rank(singular) == 2);
+    REQUIRE(determinant(singular) == mod7(0));
+
+    static_assert(rank(algae::matrix<mod7, 2, 2>()) == 0);
+  }
+  SECTION("powers") {
+    // F(k) mod P, for the fibonacci numbers
+    auto const fib = algae::matrix<mod998, 2, 2>(
+        std::array<std::array<mod998, 2>, 2>{{{1, 1}, {1, 0}}});
+    auto a = mod998(0);
+    auto b = mod998(1);
+    for (std::size_t k = 0; k < 1000; ++k) {
+      auto const next = a + b;
+      a = b;
+      b = next;
+    }
+    REQUIRE(pow(fib, 1000)(0, 1) == a);
+    REQUIRE(algae::pow<1000>(fib)(0, 1) == a);
+
+    constexpr auto k = std::uint64_t(1000000000000000000);
+    auto const half = pow(fib, k / 2);
+    REQUIRE(pow(fib, k) == multiply(half, half));
+
+    // x^(P - 1) = 1, for each entry of a diagonal matrix
+    auto const d = algae::matrix<mod7, 2, 2>(
+        std::array<std::array<mod7, 2>, 2>{{{3, 0}, {0, 5}}});
+    static_assert(
+        algae::pow<6>(algae::matrix<mod7, 2, 2>(
+            std::array<std::array<mod7, 2>, 2>{{{3, 0}, {0, 5}}}))(1, 1) ==
+        mod7(1));
+    REQUIRE(pow(d, 6)(0, 0) == mod7(1));
+  }
+  SECTION("solve") {
+    auto b = algae::matrix<mod7, 3, 1>();
+    b(0, 0) = 1;
+    b(2, 0) = 3;
+    auto const x = solve(m, b);
+    REQUIRE(x.has_value());
+    REQUIRE(multiply(m, *x) == b);
+
+    auto const singular =
+        algae::matrix<mod7, 2, 2>(std::array<std::array<mod7, 2>, 2>{
+            {{1, 2}, {2, 4}}});
+    auto c = algae::matrix<mod7, 2, 1>();
+    c(0, 0) = 1;
+    REQUIRE(!solve(singular, c).has_value());
+    c(1, 0) = 2;
+    REQUIRE(solve(singular, c).has_value());
+  }
+}
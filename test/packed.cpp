@@ -0,0 +1,192 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstddef>
+
+#include <algae/literals.h>
+#include <algae/matrix.h>
+#include <algae/packed.h>
+#include <algae/vector.h>
+#include <algae/view.h>
+
+namespace lit = algae::literals;
+
+namespace {
+
+// b^T b + 6 I, for an irregular b; symmetric and positive definite
+algae::matrix<double, 6, 6> positive_definite() {
+  auto b = algae::matrix<double, 6, 6>();
+  for (std::size_t row = 0; row < 6; ++row) {
+    for (std::size_t col = 0; col < 6; ++col) {
+      b(row, col) = double(int(row * 7 + col * 3) % 5 - 2);
+    }
+  }
+  auto ret = multiply(transpose(b), b);
+  for (std::size_t idx = 0; idx < 6; ++idx) {
+    ret(idx, idx) += 6.0;
+  }
+  return ret;
+}
+
+// two bands below, one above; the small diagonal makes lu pivot
+algae::matrix<double, 7, 7> banded() {
+  auto ret = algae::matrix<double, 7, 7>();
+  for (std::size_t row = 0; row < 7; ++row) {
+    for (std::size_t col = 0; col < 7; ++col) {
+      if (col + 2 >= row && col <= row + 1) {
+        ret(row, col) = row == col ? 0.25 : double(int(row + col * 2) % 5 + 1);
+      }
+    }
+  }
+  return ret;
+}
+
+} // namespace
+
+TEST_CASE("symmetric packed matrices", "[packed]") {
+  auto const dense = positive_definite();
+  auto a = algae::symmetric_packed_matrix<double>(dense);
+  REQUIRE(a.height() == 6);
+  REQUIRE(a.storage_size() == 21);
+  for (std::size_t row = 0; row < 6; ++row) {
+    for (std::size_t col = 0; col < 6; ++col) {
+      REQUIRE(a(row, col) == dense(row, col));
+    }
+  }
+  REQUIRE(&a(1, 4) == &a(4, 1));
+  REQUIRE(a.data()[4 * 5 / 2 + 1] == dense(4, 1));
+
+  auto const x = lit::vec | 1.0 | -2.0 | 0.5 | 3.0 | 0.0 | -1.0 | lit::end;
+  auto out = algae::vector<double, 6>(algae::list_init);
+  multiply(a, algae::view(x), algae::view(out));
+  REQUIRE(out == multiply(dense, x));
+  // an x that isn't a's size leaves out as it was
+  multiply(
+      a,
+      algae::vector_view<double const>(x.data(), 5),
+      algae::view(out));
+  REQUIRE(out == multiply(dense, x));
+
+  SECTION("cholesky") {
+    auto const c = cholesky(a);
+    REQUIRE(c.has_value());
+    // L L^T is a again
+    auto const& l = c->factor();
+    for (std::size_t row = 0; row < 6; ++row) {
+      for (std::size_t col = 0; col <= row; ++col) {
+        auto sum = 0.0;
+        for (std::size_t p = 0; p <= col; ++p) {
+          sum += l(row, p) * l(col, p);
+        }
+        REQUIRE(sum == Approx(dense(row, col)));
+      }
+    }
+
+    auto b = multiply(dense, x);
+    solve(*c, algae::view(b));
+    for (std::size_t idx = 0; idx < 6; ++idx) {
+      REQUIRE(b[idx] == Approx(x[idx]).margin(1e-12));
+    }
+    auto const before = b;
+    solve(*c, algae::vector_view<double>(b.data(), 5));
+    REQUIRE(b == before);
+
+    auto const xs = multiply(transpose(dense), dense);
+    auto bs = multiply(dense, xs);
+    solve(*c, algae::view(bs));
+    for (std::size_t row = 0; row < 6; ++row) {
+      for (std::size_t col = 0; col < 6; ++col) {
+        REQUIRE(bs(row, col) == Approx(xs(row, col)));
+      }
+    }
+  }
+  SECTION("not positive definite") {
+    a(3, 3) = -1.0;
+    REQUIRE(!cholesky(a).has_value());
+    REQUIRE(!cholesky(algae::symmetric_packed_matrix<double>(2)).has_value());
+  }
+}
+
+TEST_CASE("banded matrices", "[packed]") {
+  auto const dense = banded();
+  auto const a = algae::banded_matrix<double>(dense, 2, 1);
+  REQUIRE(a.lower_bandwidth() == 2);
+  REQUIRE(a.upper_bandwidth() == 1);
+  REQUIRE(a.storage_size() == 7 * 4);
+  REQUIRE(!a.in_band(0, 2));
+  REQUIRE(a.in_band(3, 1));
+  for (std::size_t row = 0; row < 7; ++row) {
+    for (std::size_t col = 0; col < 7; ++col) {
+      REQUIRE(a(row, col) == dense(row, col));
+    }
+  }
+
+  auto const x =
+      lit::vec | 1.0 | -2.0 | 0.5 | 3.0 | 0.0 | -1.0 | 2.0 | lit::end;
+  auto out = algae::vector<double, 7>(algae::list_init);
+  multiply(a, algae::view(x), algae::view(out));
+  REQUIRE(out == multiply(dense, x));
+  multiply(a, algae::view(x), algae::vector_view<double>(out.data(), 6));
+  REQUIRE(out == multiply(dense, x));
+
+  SECTION("lu") {
+    auto const f = lu(a);
+    REQUIRE(f.has_value());
+    REQUIRE(f->factors().upper_bandwidth() == 3);
+    // the diagonal is the smallest entry in its column, so it pivots
+    REQUIRE(f->pivots()[0] != 0);
+
+    auto b = multiply(dense, x);
+    solve(*f, algae::view(b));
+    for (std::size_t idx = 0; idx < 7; ++idx) {
+      REQUIRE(b[idx] == Approx(x[idx]).margin(1e-12));
+    }
+    auto const before = b;
+    solve(*f, algae::vector_view<double>(b.data(), 6));
+    REQUIRE(b == before);
+
+    auto xs = algae::matrix<double, 7, 2, algae::column_major>();
+    for (std::size_t row = 0; row < 7; ++row) {
+      xs(row, 0) = x[row];
+      xs(row, 1) = double(row);
+    }
+    auto bs = multiply(dense, xs);
+    solve(*f, algae::view(bs));
+    for (std::size_t row = 0; row < 7; ++row) {
+      REQUIRE(bs(row, 0) == Approx(xs(row, 0)).margin(1e-12));
+      REQUIRE(bs(row, 1) == Approx(xs(row, 1)).margin(1e-12));
+    }
+  }
+  SECTION("singular") {
+    // a zero column
+    auto singular = a;
+    for (std::size_t row = 2; row < 6; ++row) {
+      singular(row, 3) = 0.0;
+    }
+    REQUIRE(!lu(singular).has_value());
+  }
+  SECTION("tridiagonal") {
+    // the second difference operator; diagonally dominant, so no pivoting
+    auto t = algae::banded_matrix<double>(50, 1, 1);
+    for (std::size_t row = 0; row < 50; ++row) {
+      t(row, row) = 2.0;
+      if (row > 0) {
+        t(row, row - 1) = -1.0;
+      }
+      if (row + 1 < 50) {
+        t(row, row + 1) = -1.0;
+      }
+    }
+    REQUIRE(t.storage_size() == 150);
+    auto b = std::array<double, 50>{};
+    b[0] = 1.0;
+    b[49] = 1.0;
+    // the solution is all ones
+    auto const f = lu(t);
+    REQUIRE(f.has_value());
+    solve(*f, algae::vector_view<double>(b.data(), 50));
+    for (auto const& element : b) {
+      REQUIRE(element == Approx(1.0));
+    }
+  }
+}
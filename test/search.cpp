@@ -0,0 +1,556 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <algae/kernels.h>
+#include <algae/misc.h>
+#include <algae/search.h>
+#include <algae/vector.h>
+
+namespace kern = algae::kernels;
+
+namespace {
+
+// small integers, scattered; the inner products are exact, with ties
+template <typename T, std::size_t N>
+std::vector<algae::vector<T, N>> scattered(std::size_t count, unsigned seed) {
+  auto ret = std::vector<algae::vector<T, N>>(count, algae::list_init);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    for (std::size_t i = 0; i < N; ++i) {
+      auto const hash = std::uint32_t(idx * 2654435761u + i * 40503u + seed);
+      ret[idx][i] = T(int(hash >> 9) % 17 - 8);
+    }
+  }
+  return ret;
+}
+
+// the index's results against scoring everything and sorting it
+template <typename T, std::size_t N>
+void check_flat(
+    algae::metric which,
+    std::vector<algae::vector<T, N>> const& database,
+    std::vector<algae::vector<T, N>> const& queries,
+    std::size_t k) {
+  INFO("metric = " << int(which) << ", k = " << k);
+  auto const index =
+      algae::flat_index<T, N>(which, database.data(), database.size());
+  REQUIRE(index.size() == database.size());
+  auto const n = database.size();
+  // small integers come out exact, but cosines divide
+  auto const exact = which != algae::metric::cosine;
+  auto const larger = algae::impl::larger_is_nearer(which);
+
+  auto indices = std::vector<std::size_t>(queries.size() * k);
+  auto values = std::vector<T>(queries.size() * k);
+  index.search(
+      queries.data(), queries.size(), k, indices.data(), values.data());
+  for (std::size_t query = 0; query < queries.size(); ++query) {
+    auto scores = std::vector<T>(n);
+    auto order = std::vector<std::size_t>(n);
+    for (std::size_t idx = 0; idx < n; ++idx) {
+      scores[idx] =
+          algae::impl::compare(which, queries[query], database[idx]);
+      order[idx] = idx;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](auto l, auto r) {
+      return larger ? scores[l] > scores[r] : scores[l] < scores[r];
+    });
+
+    // and one query on its own gets the same answer
+    auto one_index = std::vector<std::size_t>(k);
+    auto one_value = std::vector<T>(k);
+    index.search(queries[query], k, one_index.data(), one_value.data());
+
+    for (std::size_t q = 0; q < k; ++q) {
+      auto const idx = indices[query * k + q];
+      auto const value = values[query * k + q];
+      // a query on its own is a matrix-vector product, rounded differently
+      REQUIRE(one_value[q] == Approx(value).margin(1e-5));
+      if (exact) {
+        REQUIRE(one_index[q] == idx);
+      }
+      if (q >= n) {
+        REQUIRE(idx == n);
+        REQUIRE(std::isinf(value));
+        REQUIRE((value < T(0)) == larger);
+        continue;
+      }
+      if (exact) {
+        REQUIRE(idx == order[q]);
+        REQUIRE(value == scores[idx]);
+      } else {
+        REQUIRE(value == Approx(scores[idx]).margin(1e-5));
+        REQUIRE(value == Approx(scores[order[q]]).margin(1e-5));
+      }
+    }
+  }
+}
+
+// uniform in [-1, 1); unlike scattered(), nothing ties
+template <typename T, std::size_t N>
+std::vector<algae::vector<T, N>> spread(std::size_t count, unsigned seed) {
+  auto ret = std::vector<algae::vector<T, N>>(count, algae::list_init);
+  for (std::size_t idx = 0; idx < count; ++idx) {
+    for (std::size_t i = 0; i < N; ++i) {
+      auto hash = std::uint64_t(idx * N + i) * 0x9e3779b97f4a7c15u + seed;
+      hash = (hash ^ (hash >> 31)) * 0xbf58476d1ce4e5b9u;
+      hash ^= hash >> 29;
+      ret[idx][i] = T(double(hash >> 11) * 0x1p-52 - 1.0);
+    }
+  }
+  return ret;
+}
+
+// the fraction of the true k nearest the index finds
+template <typename Index, typename T, std::size_t N>
+double recall(
+    Index const& index,
+    std::vector<algae::vector<T, N>> const& database,
+    std::vector<algae::vector<T, N>> const& queries,
+    std::size_t k) {
+  auto const which = index.which();
+  auto indices = std::vector<std::size_t>(queries.size() * k);
+  auto values = std::vector<T>(queries.size() * k);
+  index.search(
+      queries.data(), queries.size(), k, indices.data(), values.data());
+
+  std::size_t hits = 0;
+  auto order = std::vector<std::size_t>(database.size());
+  auto scores = std::vector<T>(database.size());
+  for (std::size_t query = 0; query < queries.size(); ++query) {
+    for (std::size_t idx = 0; idx < database.size(); ++idx) {
+      scores[idx] =
+          algae::impl::compare(which, queries[query], database[idx]);
+      order[idx] = idx;
+    }
+    auto const nearer = [&](std::size_t l, std::size_t r) {
+      return algae::impl::larger_is_nearer(which) ? scores[l] > scores[r]
+                                                  : scores[l] < scores[r];
+    };
+    std::partial_sort(order.begin(), order.begin() + k, order.end(), nearer);
+    for (std::size_t q = 0; q < k; ++q) {
+      auto const idx = indices[query * k + q];
+      REQUIRE(idx < database.size());
+      REQUIRE(values[query * k + q] == Approx(scores[idx]).margin(1e-4));
+      hits += std::count(order.begin(), order.begin() + k, idx);
+    }
+  }
+  return double(hits) / double(queries.size() * k);
+}
+
+// the same results, from the same graph
+template <typename T, std::size_t N>
+void check_same(
+    algae::hnsw_graph<T, N> const& lhs,
+    algae::hnsw_graph<T, N> const& rhs,
+    std::vector<algae::vector<T, N>> const& queries,
+    std::size_t k) {
+  REQUIRE(lhs.size() == rhs.size());
+  REQUIRE(lhs.which() == rhs.which());
+  auto lhs_indices = std::vector<std::size_t>(queries.size() * k);
+  auto rhs_indices = lhs_indices;
+  auto lhs_values = std::vector<T>(queries.size() * k);
+  auto rhs_values = lhs_values;
+  lhs.search(
+      queries.data(), queries.size(), k, lhs_indices.data(), lhs_values.data());
+  rhs.search(
+      queries.data(), queries.size(), k, rhs_indices.data(), rhs_values.data());
+  REQUIRE(lhs_indices == rhs_indices);
+  REQUIRE(lhs_values == rhs_values);
+}
+
+template <typename T, std::size_t N>
+algae::vector<T, N> normalized(algae::vector<T, N> v) {
+  auto const squared =
+      algae::impl::compare(algae::metric::inner_product, v, v);
+  for (auto& element : v) {
+    element /= std::sqrt(squared);
+  }
+  return v;
+}
+
+} // namespace
+
+TEST_CASE("flat index", "[search]") {
+  auto const database = scattered<float, 8>(5000, 1);
+  auto const queries = scattered<float, 8>(3, 77);
+  for (auto which :
+       {algae::metric::squared_euclidean,
+        algae::metric::inner_product,
+        algae::metric::cosine}) {
+    check_flat(which, database, queries, 1);
+    check_flat(which, database, queries, 10);
+  }
+
+  SECTION("split across threads") {
+    // each thread keeps its own top k, so the merge has to get it right
+    kern::set_thread_count(4);
+    auto const big = scattered<float, 16>(40000, 3);
+    check_flat(
+        algae::metric::inner_product, big, scattered<float, 16>(1, 5), 20);
+    check_flat(algae::metric::cosine, big, scattered<float, 16>(2, 6), 5);
+    kern::set_thread_count(0);
+  }
+  SECTION("fewer vectors than k") {
+    auto const few = scattered<double, 4>(7, 2);
+    check_flat(
+        algae::metric::inner_product, few, scattered<double, 4>(2, 9), 10);
+    check_flat(
+        algae::metric::squared_euclidean,
+        few,
+        scattered<double, 4>(2, 9),
+        10);
+  }
+  SECTION("adding") {
+    auto index = algae::flat_index<float, 8>(algae::metric::cosine);
+    REQUIRE(index.add(database[0]) == 0);
+    auto longer = database[1];
+    for (auto& element : longer) {
+      element *= 2.0f;
+    }
+    REQUIRE(index.add(longer) == 1);
+    std::size_t idx[2];
+    float value[2];
+    index.search(database[1], 2, idx, value);
+    // the same direction, whatever the length
+    REQUIRE(idx[0] == 1);
+    REQUIRE(value[0] == Approx(1.0f));
+  }
+  SECTION("other element types score directly") {
+    auto const small = scattered<long double, 3>(50, 4);
+    for (auto which :
+         {algae::metric::squared_euclidean, algae::metric::inner_product}) {
+      check_flat(which, small, scattered<long double, 3>(2, 8), 4);
+    }
+  }
+}
+
+TEST_CASE("hnsw index", "[search]") {
+  auto const database = spread<float, 16>(3000, 1);
+  auto const queries = spread<float, 16>(40, 2);
+  auto parameters = algae::hnsw_parameters();
+  parameters.m = 12;
+  parameters.ef_construction = 100;
+  parameters.ef_search = 80;
+
+  for (auto which :
+       {algae::metric::squared_euclidean,
+        algae::metric::inner_product,
+        algae::metric::cosine}) {
+    INFO("metric = " << int(which));
+    kern::set_thread_count(1);
+    auto const index = algae::hnsw_index<float, 16>(
+        which, database.data(), database.size(), parameters);
+    kern::set_thread_count(0);
+    REQUIRE(index.size() == database.size());
+    REQUIRE(index.graph().valid());
+    REQUIRE(recall(index, database, queries, 10) >= 0.9);
+
+    // a query on its own gets the same answer as in a batch
+    std::size_t idx[10];
+    float value[10];
+    auto batch_idx = std::vector<std::size_t>(queries.size() * 10);
+    auto batch_value = std::vector<float>(queries.size() * 10);
+    index.search(
+        queries.data(), queries.size(), 10, batch_idx.data(),
+        batch_value.data());
+    for (std::size_t query = 0; query < queries.size(); ++query) {
+      index.search(queries[query], 10, idx, value);
+      for (std::size_t q = 0; q < 10; ++q) {
+        REQUIRE(idx[q] == batch_idx[query * 10 + q]);
+        REQUIRE(value[q] == batch_value[query * 10 + q]);
+      }
+    }
+  }
+
+  SECTION("built across threads") {
+    kern::set_thread_count(4);
+    auto const index = algae::hnsw_index<float, 16>(
+        algae::metric::squared_euclidean,
+        database.data(),
+        database.size(),
+        parameters);
+    REQUIRE(index.graph().valid());
+    REQUIRE(recall(index, database, queries, 10) >= 0.9);
+    kern::set_thread_count(0);
+  }
+  SECTION("adding one at a time") {
+    auto index = algae::hnsw_index<double, 16>(
+        algae::metric::cosine, parameters);
+    auto const doubles = spread<double, 16>(1000, 3);
+    for (std::size_t idx = 0; idx < doubles.size(); ++idx) {
+      REQUIRE(index.add(doubles[idx]) == idx);
+    }
+    REQUIRE(index.graph().valid());
+    REQUIRE(recall(index, doubles, spread<double, 16>(20, 4), 5) >= 0.9);
+  }
+  SECTION("fewer vectors than k") {
+    auto index = algae::hnsw_index<float, 16>();
+    std::size_t idx[4];
+    float value[4];
+    index.search(queries[0], 4, idx, value);
+    REQUIRE(idx[0] == 0);
+    REQUIRE(std::isinf(value[0]));
+
+    index.add(database[0]);
+    index.add(database[1]);
+    index.search(queries[0], 4, idx, value);
+    REQUIRE(((idx[0] == 0 && idx[1] == 1) || (idx[0] == 1 && idx[1] == 0)));
+    REQUIRE(value[0] <= value[1]);
+    REQUIRE(idx[2] == 2);
+    REQUIRE(idx[3] == 2);
+    REQUIRE(std::isinf(value[3]));
+  }
+  SECTION("other element types") {
+    auto const small = spread<long double, 3>(200, 5);
+    auto const index = algae::hnsw_index<long double, 3>(
+        algae::metric::squared_euclidean, small.data(), small.size());
+    REQUIRE(recall(index, small, spread<long double, 3>(5, 6), 3) >= 0.9);
+  }
+  SECTION("saving and loading") {
+    auto const path = std::string("algae_test_hnsw.bin");
+    auto index = algae::hnsw_index<float, 16>(
+        algae::metric::cosine, database.data(), 500, parameters);
+    REQUIRE(index.save(path));
+
+    auto loaded = algae::hnsw_index<float, 16>::load(path);
+    REQUIRE(loaded);
+    REQUIRE(loaded->parameters().m == 12);
+    check_same(index.graph(), loaded->graph(), queries, 10);
+    // and it can still be added to
+    REQUIRE(index.add(database[500]) == loaded->add(database[500]));
+    check_same(index.graph(), loaded->graph(), queries, 10);
+
+    // searched where it lies, as a mapped file would be
+    auto file = std::ifstream(path, std::ios::binary | std::ios::ate);
+    auto const length = std::size_t(file.tellg());
+    file.seekg(0);
+    auto words = std::vector<std::uint64_t>(length / 8 + 16);
+    auto const base = reinterpret_cast<char*>(words.data()) +
+        (64 - reinterpret_cast<std::uintptr_t>(words.data()) % 64) % 64;
+    file.read(base, std::streamsize(length));
+    auto const view = algae::hnsw_graph<float, 16>::from_bytes(base, length);
+    REQUIRE(view);
+    REQUIRE(view->valid());
+    check_same(
+        algae::hnsw_index<float, 16>::load(path)->graph(),
+        *view,
+        queries,
+        10);
+
+    REQUIRE(!algae::hnsw_graph<float, 16>::from_bytes(base, length - 1));
+    REQUIRE(!algae::hnsw_graph<float, 16>::from_bytes(base + 8, length));
+    REQUIRE(!algae::hnsw_graph<double, 16>::from_bytes(base, length));
+    REQUIRE(!algae::hnsw_graph<float, 8>::from_bytes(base, length));
+    REQUIRE(!algae::hnsw_index<float, 16>::load("this file does not exist"));
+
+    // a link out of bounds reads fine, but isn't valid
+    auto const bottom = reinterpret_cast<std::uint32_t*>(
+        base + (sizeof(algae::impl::hnsw_header) + 63) / 64 * 64 +
+        (500 * 16 * sizeof(float) + 63) / 64 * 64 +
+        (500 * sizeof(float) + 63) / 64 * 64 +
+        (500 * sizeof(std::uint32_t) + 63) / 64 * 64);
+    REQUIRE(bottom[0] != 0);
+    bottom[1] = 100000;
+    auto const broken = algae::hnsw_graph<float, 16>::from_bytes(base, length);
+    REQUIRE(broken);
+    REQUIRE(!broken->valid());
+    {
+      auto out = std::ofstream(path, std::ios::binary);
+      out.write(base, std::streamsize(length));
+    }
+    REQUIRE(!algae::hnsw_index<float, 16>::load(path));
+    std::remove(path.c_str());
+  }
+}
+
+TEST_CASE("product quantization", "[search]") {
+  auto const database = spread<float, 16>(2000, 7);
+  auto const queries = spread<float, 16>(10, 8);
+  auto parameters = algae::pq_parameters();
+  parameters.centroids = 64;
+  auto const quantizer = algae::product_quantizer<float, 16, 4>(
+      database.data(), database.size(), parameters);
+  REQUIRE(quantizer.trained());
+  REQUIRE(quantizer.centroids() == 64);
+
+  auto codes = std::vector<std::uint8_t>(database.size() * 4);
+  quantizer.encode(database.data(), database.size(), codes.data());
+  auto decoded =
+      std::vector<algae::vector<float, 16>>(database.size(), algae::list_init);
+  quantizer.decode(codes.data(), database.size(), decoded.data());
+
+  SECTION("codes are the nearest centroids") {
+    for (std::size_t idx = 0; idx < 100; ++idx) {
+      for (std::size_t s = 0; s < 4; ++s) {
+        auto const code = codes[idx * 4 + s];
+        REQUIRE(code < 64);
+        auto const piece = database[idx].data() + s * 4;
+        auto const distance = [&](std::size_t c) {
+          auto const centroid = quantizer.codebook(s) + c * 4;
+          auto ret = 0.0f;
+          for (std::size_t i = 0; i < 4; ++i) {
+            ret += (piece[i] - centroid[i]) * (piece[i] - centroid[i]);
+          }
+          return ret;
+        };
+        for (std::size_t c = 0; c < 64; ++c) {
+          REQUIRE(distance(code) <= distance(c) + 1e-5f);
+        }
+      }
+    }
+
+    // and closer than one centroid (the mean) would have been
+    auto const coarse = algae::product_quantizer<float, 16, 4>(
+        database.data(), database.size(), algae::pq_parameters{1, 25, 0});
+    auto coarse_codes = std::vector<std::uint8_t>(database.size() * 4);
+    coarse.encode(database.data(), database.size(), coarse_codes.data());
+    auto coarse_decoded = decoded;
+    coarse.decode(
+        coarse_codes.data(), database.size(), coarse_decoded.data());
+    auto error = 0.0f;
+    auto coarse_error = 0.0f;
+    for (std::size_t idx = 0; idx < database.size(); ++idx) {
+      error += algae::impl::compare(
+          algae::metric::squared_euclidean, database[idx], decoded[idx]);
+      coarse_error += algae::impl::compare(
+          algae::metric::squared_euclidean,
+          database[idx],
+          coarse_decoded[idx]);
+    }
+    REQUIRE(error < 0.5f * coarse_error);
+  }
+  SECTION("tables score the decoded vectors") {
+    for (auto which :
+         {algae::metric::squared_euclidean, algae::metric::inner_product}) {
+      auto table = std::vector<float>(4 * 64);
+      quantizer.table(which, queries[0], table.data());
+      auto scores = std::vector<float>(database.size());
+      quantizer.scan(
+          table.data(), codes.data(), database.size(), scores.data());
+      for (std::size_t idx = 0; idx < database.size(); ++idx) {
+        REQUIRE(
+            scores[idx] ==
+            Approx(algae::impl::compare(which, queries[0], decoded[idx]))
+                .margin(1e-4));
+      }
+    }
+  }
+  SECTION("searching") {
+    for (auto which :
+         {algae::metric::squared_euclidean,
+          algae::metric::inner_product,
+          algae::metric::cosine}) {
+      INFO("metric = " << int(which));
+      auto const index = algae::pq_index<float, 16, 4>(
+          which, database.data(), database.size(), parameters);
+      REQUIRE(index.size() == database.size());
+      auto indices = std::vector<std::size_t>(queries.size() * 10);
+      auto values = std::vector<float>(queries.size() * 10);
+      index.search(
+          queries.data(), queries.size(), 10, indices.data(), values.data());
+
+      auto index_decoded = decoded;
+      index.quantizer().decode(
+          index.codes(), database.size(), index_decoded.data());
+      auto const nearer = [&](float l, float r) {
+        return algae::impl::larger_is_nearer(which) ? l > r : l < r;
+      };
+      for (std::size_t query = 0; query < queries.size(); ++query) {
+        // the best of the decoded vectors, by their scores
+        auto scores = std::vector<float>(database.size());
+        for (std::size_t idx = 0; idx < database.size(); ++idx) {
+          scores[idx] = algae::impl::compare(
+              which == algae::metric::cosine ? algae::metric::inner_product
+                                             : which,
+              which == algae::metric::cosine
+                  ? normalized(queries[query])
+                  : queries[query],
+              index_decoded[idx]);
+        }
+        std::sort(scores.begin(), scores.end(), nearer);
+        for (std::size_t q = 0; q < 10; ++q) {
+          auto const idx = indices[query * 10 + q];
+          REQUIRE(idx < database.size());
+          REQUIRE(values[query * 10 + q] == Approx(scores[q]).margin(1e-4));
+        }
+      }
+    }
+  }
+  SECTION("split across threads") {
+    auto const big = spread<float, 16>(40000, 9);
+    auto index = algae::pq_index<float, 16, 4>(
+        algae::metric::squared_euclidean, quantizer);
+    REQUIRE(index.add(big.data(), 100) == 0);
+    REQUIRE(index.add(big[100]) == 100);
+    REQUIRE(index.add(big.data() + 101, big.size() - 101) == 101);
+    REQUIRE(index.size() == big.size());
+    auto one_thread = std::vector<std::size_t>(queries.size() * 5);
+    auto four_threads = one_thread;
+    auto one_values = std::vector<float>(queries.size() * 5);
+    auto four_values = one_values;
+    kern::set_thread_count(1);
+    index.search(
+        queries.data(),
+        queries.size(),
+        5,
+        one_thread.data(),
+        one_values.data());
+    kern::set_thread_count(4);
+    index.search(
+        queries.data(),
+        queries.size(),
+        5,
+        four_threads.data(),
+        four_values.data());
+    kern::set_thread_count(0);
+    REQUIRE(one_thread == four_threads);
+    REQUIRE(one_values == four_values);
+  }
+  SECTION("fewer vectors than k") {
+    auto index = algae::pq_index<float, 16, 4>(
+        algae::metric::inner_product, quantizer);
+    index.add(database[0]);
+    std::size_t idx[3];
+    float value[3];
+    index.search(queries[0], 3, idx, value);
+    REQUIRE(idx[0] == 0);
+    REQUIRE(idx[1] == 1);
+    REQUIRE(std::isinf(value[2]));
+    REQUIRE(value[2] < 0.0f);
+  }
+  SECTION("untrained") {
+    auto index = algae::pq_index<float, 16, 4>(
+        algae::metric::squared_euclidean, {});
+    REQUIRE(index.add(database.data(), 3) == 0);
+    REQUIRE(index.add(database[3]) == 3);
+    REQUIRE(index.size() == 0);
+    REQUIRE(index.pending() == 4);
+    std::size_t idx[2];
+    float value[2];
+    index.search(queries[0], 2, idx, value);
+    REQUIRE(idx[0] == 0);
+    REQUIRE(idx[1] == 0);
+    REQUIRE(std::isinf(value[0]));
+    REQUIRE(value[0] > 0.0f);
+
+    // nothing's lost: training codes what was waiting
+    index.train(algae::pq_parameters{4, 25, 0});
+    REQUIRE(index.quantizer().trained());
+    REQUIRE(index.size() == 4);
+    REQUIRE(index.pending() == 0);
+    REQUIRE(index.add(database[4]) == 4);
+    index.search(database[1], 2, idx, value);
+    REQUIRE(idx[0] < 5);
+    REQUIRE(idx[1] < 5);
+    REQUIRE(std::isfinite(value[1]));
+  }
+}
@@ -0,0 +1,131 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#include <algae/literals.h>
+#include <algae/matrix.h>
+#include <algae/semiring.h>
+#include <algae/vector.h>
+#include <algae/view.h>
+
+namespace lit = algae::literals;
+
+namespace {
+
+constexpr auto inf = std::numeric_limits<int>::max();
+
+// edge weights of a small directed graph; 0 -> 1 -> 2 -> 3, and a long way
+// round from 0 straight to 2
+constexpr algae::matrix<int, 4, 4> distances() {
+  return algae::matrix<int, 4, 4>(std::array<std::array<int, 4>, 4>{{
+      {0, 1, 5, inf},
+      {inf, 0, 2, inf},
+      {inf, inf, 0, 3},
+      {inf, inf, inf, 0},
+  }});
+}
+
+} // namespace
+
+TEST_CASE("semiring dot products", "[semiring]") {
+  auto const x = lit::vec | 1 | 5 | 3 | lit::end;
+  auto const y = lit::vec | 4 | 0 | 1 | lit::end;
+
+  REQUIRE(dot(x, y) == 7);
+  REQUIRE(dot(x, y, algae::plus_times<int>()) == 7);
+  REQUIRE(dot(x, y, algae::min_plus<int>()) == 4);
+  REQUIRE(dot(x, y, algae::max_plus<int>()) == 5);
+  REQUIRE(dot(x, y, algae::max_times<int>()) == 4);
+
+  auto const a = lit::vec | true | false | true | lit::end;
+  auto const b = lit::vec | false | true | true | lit::end;
+  auto const c = lit::vec | false | true | false | lit::end;
+  REQUIRE(dot(a, b, algae::or_and()));
+  REQUIRE(!dot(a, c, algae::or_and()));
+
+  SECTION("views") {
+    REQUIRE(dot(view(x), view(y), algae::min_plus<int>()) == 4);
+  }
+  SECTION("infinity") {
+    auto const unreachable = lit::vec | inf | 2 | lit::end;
+    auto const weights = lit::vec | -5 | inf | lit::end;
+    REQUIRE(dot(unreachable, weights, algae::min_plus<int>()) == inf);
+
+    auto const f = lit::vec | 1.0f | 2.0f | lit::end;
+    auto const g = lit::vec | std::numeric_limits<float>::infinity() | 0.5f |
+        lit::end;
+    REQUIRE(dot(f, g, algae::min_plus<float>()) == 2.5f);
+  }
+}
+
+TEST_CASE("semiring matrix products", "[semiring]") {
+  SECTION("shortest paths") {
+    auto const d = distances();
+    auto const two_hops = multiply(d, d, algae::min_plus<int>());
+    CHECK(two_hops(0, 2) == 3);
+    CHECK(two_hops(0, 3) == 8);
+    CHECK(two_hops(1, 3) == 5);
+    CHECK(two_hops(3, 0) == inf);
+
+    auto const three_hops = multiply(two_hops, d, algae::min_plus<int>());
+    CHECK(three_hops(0, 3) == 6);
+
+    // every layout gets the same answer
+    using col = algae::matrix<int, 4, 4, algae::column_major>;
+    using tiled = algae::matrix<int, 4, 4, algae::tiled<3>>;
+    CHECK(multiply(col(d), col(d), algae::min_plus<int>()) == two_hops);
+    CHECK(multiply(tiled(d), tiled(d), algae::min_plus<int>()) == two_hops);
+
+    auto out = algae::matrix<int, 4, 4>();
+    multiply(view(d), view(d), view(out), algae::min_plus<int>());
+    CHECK(out == two_hops);
+  }
+  SECTION("reachability") {
+    auto const edges = algae::matrix<bool, 3, 3>(
+        std::array<std::array<bool, 3>, 3>{
+            {{true, true, false}, {false, true, true}, {false, false, true}}});
+    auto const reach = multiply(edges, edges, algae::or_and());
+    CHECK(reach(0, 2));
+    CHECK(!reach(2, 0));
+
+    // one step of a breadth first search, from vertex 0
+    auto const frontier = lit::vec | true | false | false | lit::end;
+    auto const next = multiply(frontier, edges, algae::or_and());
+    CHECK(next == (lit::vec | true | true | false | lit::end));
+  }
+  SECTION("most reliable paths") {
+    auto const p = algae::matrix<double, 2, 2>(
+        std::array<std::array<double, 2>, 2>{{{1.0, 0.5}, {0.9, 1.0}}});
+    auto const two = multiply(p, p, algae::max_times<double>());
+    CHECK(two(0, 1) == 0.5);
+    CHECK(two(1, 0) == 0.9);
+    CHECK(two(0, 0) == 1.0);
+  }
+  SECTION("constexpr") {
+    constexpr auto two_hops =
+        multiply(distances(), distances(), algae::min_plus<int>());
+    static_assert(two_hops(0, 3) == 8);
+    static_assert(dot(
+                      lit::vec | 1 | 2 | lit::end,
+                      lit::vec | 3 | 0 | lit::end,
+                      algae::min_plus<int>()) == 2);
+  }
+  SECTION("integer sums saturate") {
+    using shortest = algae::min_plus<int>;
+    using longest = algae::max_plus<int>;
+    constexpr auto big = std::numeric_limits<int>::max() - 1;
+    constexpr auto small = std::numeric_limits<int>::lowest() + 1;
+    static_assert(shortest::times(big, 5) == shortest::zero());
+    static_assert(shortest::times(small, -5) == small - 1);
+    static_assert(longest::times(small, -5) == longest::zero());
+    static_assert(longest::times(big, 5) == big + 1);
+    CHECK(shortest::times(big, -5) == big - 5);
+    auto const d = algae::matrix<int, 2, 2>(
+        std::array<std::array<int, 2>, 2>{{{0, big}, {big, 0}}});
+    auto const two_hops = multiply(d, d, shortest());
+    CHECK(two_hops(0, 1) == big);
+    CHECK(two_hops(0, 0) == 0);
+  }
+}
@@ -0,0 +1,193 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <algae/matrix.h>
+#include <algae/sparse.h>
+#include <algae/view.h>
+
+TEST_CASE("sparse matrices", "[sparse]") {
+  auto const dense = algae::matrix<int, 3, 4>(
+      std::array<std::array<int, 4>, 3>{
+          {{1, 0, 0, 2}, {0, 0, 0, 0}, {0, 3, 4, 0}}});
+  auto const a = algae::csr_matrix<int>(dense);
+
+  REQUIRE(a.height() == 3);
+  REQUIRE(a.width() == 4);
+  REQUIRE(a.nonzeros() == 4);
+  REQUIRE(a.row_offsets() == std::vector<std::size_t>{0, 2, 2, 4});
+  REQUIRE(a.columns() == std::vector<std::size_t>{0, 3, 1, 2});
+  REQUIRE(a.values() == std::vector<int>{1, 2, 3, 4});
+  for (std::size_t row = 0; row < 3; ++row) {
+    for (std::size_t col = 0; col < 4; ++col) {
+      REQUIRE(a(row, col) == dense(row, col));
+    }
+  }
+
+  auto const empty = algae::csr_matrix<int>(5, 2);
+  REQUIRE(empty.nonzeros() == 0);
+  REQUIRE(empty(4, 1) == 0);
+}
+
+TEST_CASE("sparse products", "[sparse]") {
+  auto const a_dense = algae::matrix<int, 3, 4>(
+      std::array<std::array<int, 4>, 3>{
+          {{1, 0, 0, 2}, {0, 0, 0, 0}, {0, 3, 4, 0}}});
+  auto const b_dense = algae::matrix<int, 4, 2>(
+      std::array<std::array<int, 2>, 4>{{{0, 1}, {4, 0}, {-3, 0}, {5, 0}}});
+  auto const expected = multiply(a_dense, b_dense);
+  auto const a = algae::csr_matrix<int>(a_dense);
+  auto const b = algae::csr_matrix<int>(b_dense);
+
+  SECTION("sparse * sparse") {
+    auto const c = multiply(a, b);
+    REQUIRE(c.height() == 3);
+    REQUIRE(c.width() == 2);
+    // row 2 is 3 * (4, 0) + 4 * (-3, 0); it's in the pattern, even though
+    // it adds up to zero
+    REQUIRE(c.row_offsets() == std::vector<std::size_t>{0, 2, 2, 3});
+    for (std::size_t row = 0; row < 3; ++row) {
+      for (std::size_t col = 0; col < 2; ++col) {
+        REQUIRE(c(row, col) == expected(row, col));
+      }
+    }
+  }
+  SECTION("symbolic, then numeric") {
+    auto c = algae::multiply_symbolic(a, b);
+    REQUIRE(c.nonzeros() == 3);
+    REQUIRE(c.values() == std::vector<int>{0, 0, 0});
+
+    algae::multiply_numeric(a, b, c);
+    REQUIRE(c.values() == std::vector<int>{10, 1, 0});
+
+    // same pattern, new values
+    auto a2 = a;
+    for (auto& x : a2.values()) {
+      x *= 2;
+    }
+    algae::multiply_numeric(a2, b, c);
+    REQUIRE(c.values() == std::vector<int>{20, 2, 0});
+  }
+  SECTION("sparse * dense") {
+    auto out = algae::matrix<int, 3, 2>();
+    multiply(a, algae::view(b_dense), algae::view(out));
+    REQUIRE(out == expected);
+
+    auto out_col = algae::matrix<int, 3, 2, algae::column_major>();
+    multiply(a, algae::view(b_dense), algae::view(out_col));
+    for (std::size_t row = 0; row < 3; ++row) {
+      for (std::size_t col = 0; col < 2; ++col) {
+        REQUIRE(out_col(row, col) == expected(row, col));
+      }
+    }
+
+    // b one row short leaves out as it was
+    auto untouched = algae::matrix<int, 3, 2>();
+    multiply(
+        a,
+        algae::matrix_view<int const>(b_dense.data(), 3, 2, 2),
+        algae::view(untouched));
+    REQUIRE(untouched == algae::matrix<int, 3, 2>());
+  }
+  SECTION("wide products hash their rows") {
+    // a row with a couple of products, in a product thousands wide
+    auto const n = std::size_t(5000);
+    auto const wide = algae::csr_matrix<int>(
+        2, n, {0, 2, 3}, {7, n - 1, n - 1}, {3, 1, -1});
+    auto const left = algae::csr_matrix<int>(1, 2, {0, 2}, {0, 1}, {1, 2});
+    auto const c = multiply(left, wide);
+    REQUIRE(c.columns() == std::vector<std::size_t>{7, n - 1});
+    REQUIRE(c.values() == std::vector<int>{3, -1});
+  }
+}
+
+TEST_CASE("block sparse matrices", "[sparse]") {
+  // 3 x 3 blocks; the diagonal ones are diagonally dominant, and only some
+  // of the others are there
+  auto dense = algae::matrix<double, 9, 9>();
+  for (std::size_t row = 0; row < 9; ++row) {
+    for (std::size_t col = 0; col < 9; ++col) {
+      auto const block_row = row / 3;
+      auto const block_col = col / 3;
+      if (block_row == block_col) {
+        dense(row, col) = row == col ? 10.0 : double(int(row + col) % 3 - 1);
+      } else if ((block_row + 2 * block_col) % 3 == 1) {
+        dense(row, col) = double(int(row * 2 + col) % 5 - 2);
+      }
+    }
+  }
+  auto const a = algae::bsr_matrix<double, 3>(dense);
+  REQUIRE(a.block_height() == 3);
+  REQUIRE(a.height() == 9);
+  REQUIRE(a.nonzero_blocks() == 6);
+  REQUIRE(a.row_offsets() == std::vector<std::size_t>{0, 2, 4, 6});
+  REQUIRE(a.find_block(1, 2) == nullptr);
+  REQUIRE(a.find_block(1, 0) != nullptr);
+  for (std::size_t row = 0; row < 9; ++row) {
+    for (std::size_t col = 0; col < 9; ++col) {
+      REQUIRE(a(row, col) == dense(row, col));
+    }
+  }
+
+  SECTION("products") {
+    auto x = algae::vector<double, 9>(algae::list_init);
+    for (std::size_t idx = 0; idx < 9; ++idx) {
+      x[idx] = double(int(idx) - 4);
+    }
+    auto y = algae::vector<double, 9>(algae::list_init);
+    multiply(a, algae::view(x), algae::view(y));
+    REQUIRE(y == multiply(dense, x));
+    // sizes that don't fit a leave out as it was
+    multiply(a, algae::vector_view<double const>(x.data(), 8), algae::view(y));
+    REQUIRE(y == multiply(dense, x));
+
+    auto b = algae::matrix<double, 9, 2>();
+    for (std::size_t row = 0; row < 9; ++row) {
+      b(row, 0) = x[row];
+      b(row, 1) = double(row % 4);
+    }
+    auto out = algae::matrix<double, 9, 2, algae::column_major>();
+    multiply(a, algae::view(b), algae::view(out));
+    REQUIRE(out == multiply(dense, b));
+    multiply(
+        a,
+        algae::matrix_view<double const>(b.data(), 8, 2, 2),
+        algae::view(out));
+    REQUIRE(out == multiply(dense, b));
+  }
+  SECTION("block jacobi") {
+    auto const m = algae::block_jacobi(a);
+    REQUIRE(m.has_value());
+    REQUIRE(m->inverses().size() == 3);
+
+    // exact for a block diagonal matrix
+    auto block_diagonal = dense;
+    for (std::size_t row = 0; row < 9; ++row) {
+      for (std::size_t col = 0; col < 9; ++col) {
+        if (row / 3 != col / 3) {
+          block_diagonal(row, col) = 0.0;
+        }
+      }
+    }
+    auto const x = algae::make_vector(
+        1.0, -2.0, 3.0, 0.5, 0.0, -1.0, 4.0, 2.0, -3.0);
+    auto r = multiply(block_diagonal, x);
+    auto z = algae::vector<double, 9>(algae::list_init);
+    multiply(*m, algae::view(r), algae::view(z));
+    for (std::size_t idx = 0; idx < 9; ++idx) {
+      REQUIRE(z[idx] == Approx(x[idx]).margin(1e-12));
+    }
+    auto const before = z;
+    multiply(*m, algae::view(r), algae::vector_view<double>(z.data(), 6));
+    REQUIRE(z == before);
+
+    // a missing diagonal block, and a singular one
+    auto const missing = algae::bsr_matrix<double, 3>(3, 3);
+    REQUIRE(!algae::block_jacobi(missing).has_value());
+    auto singular = a;
+    singular.blocks()[0] = algae::matrix<double, 3, 3>();
+    REQUIRE(!algae::block_jacobi(singular).has_value());
+  }
+}
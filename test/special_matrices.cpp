@@ -0,0 +1,126 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include <algae/literals.h>
+#include <algae/matrix.h>
+#include <algae/semiring.h>
+#include <algae/special_matrices.h>
+#include <algae/vector.h>
+
+#include "fixtures.h"
+
+namespace lit = algae::literals;
+
+namespace {
+
+template <std::size_t H, std::size_t W>
+constexpr algae::matrix<int, H, W> pattern(int seed) {
+  return fixtures::generate<int, H, W>([=](std::size_t row, std::size_t col) {
+    return int(row * W + col) * 5 % 13 - 6 + seed;
+  });
+}
+
+// a cycle of length three, and a swap; odd
+constexpr algae::permutation<5> mixed() {
+  return algae::permutation<5>(std::array<std::size_t, 5>{{2, 0, 1, 4, 3}});
+}
+
+} // namespace
+
+TEST_CASE("diagonal matrices", "[special_matrices]") {
+  auto const d =
+      algae::diagonal_matrix<int, 3>(lit::vec | 2 | -1 | 3 | lit::end);
+  REQUIRE(d(1, 1) == -1);
+  REQUIRE(d(0, 1) == 0);
+  REQUIRE(transpose(d) == d);
+
+  auto const m = pattern<3, 4>(0);
+  REQUIRE(multiply(d, m) == multiply(d.dense(), m));
+  auto const n = pattern<4, 3>(1);
+  REQUIRE(multiply(n, d) == multiply(n, d.dense()));
+  using col = algae::matrix<int, 3, 4, algae::column_major>;
+  REQUIRE(multiply(d, col(m)) == multiply(d.dense(), m));
+
+  auto const x = lit::vec | 4 | 5 | 6 | lit::end;
+  REQUIRE(multiply(d, x) == multiply(d.dense(), x));
+  REQUIRE(multiply(x, d) == multiply(x, d.dense()));
+  REQUIRE(multiply(d, d).dense() == multiply(d.dense(), d.dense()));
+
+  // over min-plus, a diagonal adds to each row
+  auto const shifted = multiply(d, m, algae::min_plus<int>());
+  REQUIRE(shifted(2, 3) == m(2, 3) + 3);
+
+  static_assert(
+      multiply(
+          algae::diagonal_matrix<int, 2>(lit::vec | 2 | 3 | lit::end),
+          lit::vec | 5 | 7 | lit::end)[1] == 21);
+}
+
+TEST_CASE("identity matrices", "[special_matrices]") {
+  constexpr auto i = algae::identity_matrix<int, 3>();
+  static_assert(i(1, 1) == 1 && i(1, 2) == 0);
+
+  auto const m = pattern<3, 4>(0);
+  REQUIRE(multiply(i, m) == m);
+  REQUIRE(multiply(transpose(m), i) == transpose(m));
+  REQUIRE(multiply(i, m) == multiply(i.dense(), m));
+  auto const x = lit::vec | 4 | 5 | 6 | lit::end;
+  REQUIRE(multiply(i, x) == x);
+  REQUIRE(multiply(x, i) == x);
+}
+
+TEST_CASE("permutations", "[special_matrices]") {
+  auto const p = mixed();
+  auto const dense = p.dense<int>();
+  REQUIRE(p(0, 2));
+  REQUIRE(!p(0, 0));
+  REQUIRE(p.sign() == -1);
+  REQUIRE(algae::permutation<5>().sign() == 1);
+
+  SECTION("products") {
+    auto const m = pattern<5, 3>(2);
+    REQUIRE(multiply(p, m) == multiply(dense, m));
+    auto const n = pattern<2, 5>(3);
+    REQUIRE(multiply(n, p) == multiply(n, dense));
+    using col = algae::matrix<int, 2, 5, algae::column_major>;
+    REQUIRE(multiply(col(n), p) == multiply(n, dense));
+
+    auto const x = lit::vec | 1 | 2 | 3 | 4 | 5 | lit::end;
+    REQUIRE(multiply(p, x) == multiply(dense, x));
+    REQUIRE(multiply(x, p) == multiply(x, dense));
+  }
+  SECTION("composition") {
+    auto q = algae::permutation<5>();
+    q.swap(0, 4);
+    q.swap(1, 4);
+    REQUIRE(multiply(p, q).dense<int>() == multiply(dense, q.dense<int>()));
+    REQUIRE(multiply(q, p).dense<int>() == multiply(q.dense<int>(), dense));
+    REQUIRE(q.sign() == 1);
+    REQUIRE(multiply(p, q).sign() == p.sign() * q.sign());
+
+    REQUIRE(multiply(p, p.inverse()) == algae::permutation<5>());
+    REQUIRE(transpose(p).dense<int>() == transpose(dense));
+  }
+  SECTION("pivoting") {
+    // the swaps of partial pivoting, recorded as they happen
+    auto pivots = algae::permutation<3>();
+    auto m = algae::matrix<int, 3, 2>(
+        std::array<std::array<int, 2>, 3>{{{1, 2}, {3, 4}, {5, 6}}});
+    auto const original = m;
+    pivots.swap(0, 2);
+    for (std::size_t j = 0; j < 2; ++j) {
+      std::swap(m(0, j), m(2, j));
+    }
+    pivots.swap(1, 2);
+    for (std::size_t j = 0; j < 2; ++j) {
+      std::swap(m(1, j), m(2, j));
+    }
+    REQUIRE(multiply(pivots, original) == m);
+  }
+
+  static_assert(
+      multiply(mixed(), mixed().inverse()) == algae::permutation<5>());
+}
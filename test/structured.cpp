@@ -0,0 +1,176 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <type_traits>
+
+#include <algae/literals.h>
+#include <algae/matrix.h>
+#include <algae/structured.h>
+#include <algae/vector.h>
+#include <algae/view.h>
+
+#include "fixtures.h"
+
+namespace lit = algae::literals;
+
+namespace {
+
+// every element different, and nothing zero, so that reading the wrong
+// half shows up
+template <std::size_t H, std::size_t W>
+algae::matrix<int, H, W> pattern(int seed) {
+  return fixtures::generate<int, H, W>([=](std::size_t row, std::size_t col) {
+    return int(row * W + col) * 3 % 17 + seed;
+  });
+}
+
+// the same matrix, materialized, from its operator()
+template <std::size_t N, typename Structured>
+auto dense(Structured const& a) {
+  return fixtures::generate<typename Structured::value_type, N, N>(
+      [&](std::size_t row, std::size_t col) { return a(row, col); });
+}
+
+} // namespace
+
+TEST_CASE("transpose views", "[structured]") {
+  auto m = pattern<2, 3>(1);
+  auto const t = algae::transpose_view(m);
+  static_assert(std::is_same_v<
+                std::remove_const_t<decltype(t)>,
+                algae::matrix_view<int, 3, 2>>);
+  REQUIRE(t.height() == 3);
+  REQUIRE(t.has_contiguous_columns());
+  for (std::size_t row = 0; row < 3; ++row) {
+    for (std::size_t col = 0; col < 2; ++col) {
+      REQUIRE(t(row, col) == m(col, row));
+    }
+  }
+  // it's not a copy
+  t(2, 1) = 100;
+  REQUIRE(m(1, 2) == 100);
+  REQUIRE(algae::transpose_view(t).data() == m.data());
+
+  // m^T * m, without ever building m^T
+  auto product = algae::matrix<int, 3, 3>();
+  multiply(t, algae::view(m), algae::view(product));
+  REQUIRE(product == multiply(transpose(m), m));
+
+  // real adjoints are transposes
+  auto const a = algae::adjoint_view(m);
+  static_assert(std::is_same_v<
+                std::remove_const_t<decltype(a)>,
+                algae::matrix_view<int const, 3, 2>>);
+  REQUIRE(a(2, 1) == 100);
+}
+
+TEST_CASE("adjoint views", "[structured]") {
+  using c = std::complex<double>;
+  auto const m = algae::matrix<c, 2, 2>(
+      std::array<std::array<c, 2>, 2>{{{c(1, 2), c(3, -1)}, {c(0, 1), c(2)}}});
+  auto const a = algae::adjoint_view(m);
+  REQUIRE(a(0, 1) == c(0, -1));
+  REQUIRE(a(1, 0) == c(3, 1));
+
+  // a unit vector, times the adjoint, is a conjugated row of m
+  auto x = lit::vec | c(0) | c(1) | lit::end;
+  auto out = algae::vector<c, 2>(algae::list_init);
+  multiply(a, algae::view(x), algae::view(out));
+  REQUIRE(out[0] == c(0, -1));
+  REQUIRE(out[1] == c(2));
+
+  auto product = algae::matrix<c, 2, 2>();
+  multiply(a, algae::view(m), algae::view(product));
+  // m^H m is hermitian, with a real diagonal
+  REQUIRE(product(0, 1) == std::conj(product(1, 0)));
+  REQUIRE(product(0, 0) == c(1 * 1 + 2 * 2 + 1 * 1));
+}
+
+TEST_CASE("triangular views", "[structured]") {
+  auto const m = pattern<5, 5>(1);
+  auto const l = algae::lower(m);
+  auto const u = algae::upper(m, algae::diagonal::unit);
+  REQUIRE(l(3, 1) == m(3, 1));
+  REQUIRE(l(1, 3) == 0);
+  REQUIRE(l(2, 2) == m(2, 2));
+  REQUIRE(u(1, 3) == m(1, 3));
+  REQUIRE(u(3, 1) == 0);
+  REQUIRE(u(2, 2) == 1);
+
+  auto const b = pattern<5, 3>(2);
+  SECTION("products") {
+    for (auto const& tri : {l, u}) {
+      auto out = algae::matrix<int, 5, 3>();
+      multiply(tri, algae::view(b), algae::view(out));
+      REQUIRE(out == multiply(dense<5>(tri), b));
+
+      auto x = lit::vec | 1 | -2 | 3 | 0 | 5 | lit::end;
+      auto y = algae::vector<int, 5>(algae::list_init);
+      multiply(tri, algae::view(x), algae::view(y));
+      REQUIRE(y == multiply(dense<5>(tri), x));
+    }
+  }
+  SECTION("solves") {
+    auto const a = algae::matrix<double, 3, 3>(
+        std::array<std::array<double, 3>, 3>{
+            {{2, 7, 7}, {1, 4, 7}, {-1, 2, 8}}});
+    auto const x = lit::vec | 1.0 | -2.0 | 0.5 | lit::end;
+    for (auto const& tri : {algae::lower(a), algae::upper(a)}) {
+      auto const solved = solve(tri, multiply(dense<3>(tri), x));
+      for (std::size_t i = 0; i < 3; ++i) {
+        REQUIRE(solved[i] == Approx(x[i]));
+      }
+    }
+
+    // only the strict lower half of `a` is read
+    auto const unit = algae::lower(a, algae::diagonal::unit);
+    auto xs = algae::matrix<double, 3, 2, algae::column_major>();
+    xs(0, 0) = 1;
+    xs(2, 1) = 4;
+    auto const solved = solve(unit, multiply(dense<3>(unit), xs));
+    REQUIRE(solved == xs);
+  }
+}
+
+TEST_CASE("symmetric views", "[structured]") {
+  auto const m = pattern<4, 4>(1);
+  auto const s = algae::symmetric(m);
+  auto const s_lower = algae::symmetric(m, algae::triangle::lower);
+  REQUIRE(s(0, 3) == m(0, 3));
+  REQUIRE(s(3, 0) == m(0, 3));
+  REQUIRE(s_lower(3, 0) == m(3, 0));
+  REQUIRE(s_lower(0, 3) == m(3, 0));
+  REQUIRE(dense<4>(s) == transpose(dense<4>(s)));
+
+  auto const b = pattern<4, 2>(3);
+  for (auto const& sym : {s, s_lower}) {
+    auto out = algae::matrix<int, 4, 2>();
+    multiply(sym, algae::view(b), algae::view(out));
+    REQUIRE(out == multiply(dense<4>(sym), b));
+
+    auto x = lit::vec | 1 | -2 | 3 | 4 | lit::end;
+    auto y = algae::vector<int, 4>(algae::list_init);
+    multiply(sym, algae::view(x), algae::view(y));
+    REQUIRE(y == multiply(dense<4>(sym), x));
+  }
+
+  // dynamic extents, on a block of a bigger matrix
+  auto const big = pattern<6, 6>(0);
+  auto const corner = algae::symmetric(algae::block(big, 2, 2, 4, 4));
+  REQUIRE(corner.height() == 4);
+  REQUIRE(corner(3, 0) == big(2, 5));
+
+  // where they can only disagree at run time, and do, nothing is written
+  auto x = lit::vec | 1 | -2 | 3 | 4 | lit::end;
+  auto y = algae::vector<int, 4>(algae::list_init);
+  multiply(corner, algae::vector_view<int const>(x.data(), 3), algae::view(y));
+  REQUIRE(y == algae::vector<int, 4>(algae::list_init));
+  auto out = algae::matrix<int, 4, 2>();
+  multiply(
+      algae::lower(algae::block(big, 0, 0, 3, 3)),
+      algae::view(b),
+      algae::view(out));
+  REQUIRE(out == algae::matrix<int, 4, 2>());
+}
@@ -0,0 +1,214 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include <algae/literals.h>
+#include <algae/matrix.h>
+#include <algae/vector.h>
+#include <algae/view.h>
+
+namespace lit = algae::literals;
+
+namespace {
+
+// just enough of std::mdspan, with a layout_stride mapping
+struct fake_mdspan {
+  int* data;
+  std::size_t extents[2];
+  std::size_t strides[2];
+
+  int* data_handle() const { return data; }
+  std::size_t extent(std::size_t r) const { return extents[r]; }
+  std::size_t stride(std::size_t r) const { return strides[r]; }
+};
+
+// squares the top left 2 x 2 of a, into the bottom right of the result
+constexpr algae::matrix<int, 3, 3> square_into_corner() {
+  auto a = algae::matrix<int, 3, 3>(
+      std::array<std::array<int, 3>, 3>{{{1, 2, 0}, {3, 4, 0}, {0, 0, 0}}});
+  auto ret = algae::matrix<int, 3, 3>();
+  auto const top = algae::block<0, 0, 2, 2>(a);
+  multiply(top, top, algae::block<1, 1, 2, 2>(ret));
+  return ret;
+}
+
+} // namespace
+
+TEST_CASE("vector views", "[view]") {
+  auto v = lit::vec | 1 | 2 | 3 | 4 | 5 | 6 | lit::end;
+
+  SECTION("over a vector") {
+    auto whole = algae::view(v);
+    static_assert(decltype(whole)::extent == 6);
+    REQUIRE(whole.size() == 6);
+    REQUIRE(whole.is_contiguous());
+    whole[2] = 30;
+    REQUIRE(v[2] == 30);
+
+    algae::vector_view<int const> dynamic = whole;
+    REQUIRE(dynamic.size() == 6);
+    REQUIRE(dynamic[2] == 30);
+  }
+  SECTION("strided") {
+    // every other element, starting at the second
+    auto odd = algae::vector_view<int>(v.data() + 1, 3, 2);
+    REQUIRE(odd[0] == 2);
+    REQUIRE(odd[2] == 6);
+
+    int expected = 2;
+    for (auto x : odd) {
+      REQUIRE(x == expected);
+      expected += 2;
+    }
+    REQUIRE(odd.end() - odd.begin() == 3);
+    REQUIRE(*odd.rbegin() == 6);
+
+    auto even = algae::vector_view<int const>(v.data(), 3, 2);
+    REQUIRE(algae::dot(odd, even) == 2 * 1 + 4 * 3 + 6 * 5);
+
+    auto shorter = algae::vector_view<int const>(v.data(), 2, 2);
+    REQUIRE(algae::dot(odd, shorter) == 2 * 1 + 4 * 3);
+  }
+  SECTION("a stride of 0") {
+    auto repeated = algae::vector_view<int>(v.data() + 2, 4, 0);
+    REQUIRE(repeated.end() - repeated.begin() == 4);
+    int count = 0;
+    for (auto x : repeated) {
+      REQUIRE(x == 3);
+      ++count;
+    }
+    REQUIRE(count == 4);
+    REQUIRE(algae::dot(repeated, algae::view(v)) == 3 * (1 + 2 + 3 + 4));
+  }
+}
+
+TEST_CASE("matrix views", "[view]") {
+  auto m = algae::matrix<int, 3, 4>(std::array<std::array<int, 4>, 3>{
+      {{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9, 10, 11}}});
+
+  SECTION("over a matrix") {
+    auto row = algae::view(m);
+    REQUIRE(row.row_stride() == 4);
+    REQUIRE(row.col_stride() == 1);
+    REQUIRE(row(2, 3) == 11);
+
+    auto const col = algae::matrix<int, 3, 4, algae::column_major>(m);
+    auto col_view = algae::view(col);
+    REQUIRE(col_view.row_stride() == 1);
+    REQUIRE(col_view.col_stride() == 3);
+    for (std::size_t i = 0; i < 3; ++i) {
+      for (std::size_t j = 0; j < 4; ++j) {
+        REQUIRE(col_view(i, j) == m(i, j));
+      }
+    }
+  }
+  SECTION("rows and columns are vector views") {
+    auto v = algae::view(m);
+    auto col = v.column(2);
+    REQUIRE(col.size() == 3);
+    REQUIRE(col.stride() == 4);
+    REQUIRE(col[2] == 10);
+
+    v.row(1)[0] = 40;
+    REQUIRE(m(1, 0) == 40);
+  }
+  SECTION("swapping the strides transposes") {
+    auto t = algae::matrix_view<int>(m.data(), 4, 3, 1, 4);
+    for (std::size_t i = 0; i < 3; ++i) {
+      for (std::size_t j = 0; j < 4; ++j) {
+        REQUIRE(t(j, i) == m(i, j));
+      }
+    }
+  }
+  SECTION("mdspan") {
+    auto md = fake_mdspan{m.data(), {3, 4}, {4, 1}};
+    auto v = algae::matrix_view<int>(md);
+    REQUIRE(v.height() == 3);
+    REQUIRE(v.width() == 4);
+    REQUIRE(v(1, 2) == 6);
+
+    // and back again
+    REQUIRE(v.rank() == 2);
+    REQUIRE(v.data_handle() == m.data());
+    REQUIRE(v.extent(1) == 4);
+    REQUIRE(v.stride(0) == 4);
+    REQUIRE(algae::matrix_view<int, 3, 4>::static_extent(0) == 3);
+  }
+  SECTION("algorithms") {
+    auto const b = algae::matrix<int, 4, 2>(
+        std::array<std::array<int, 2>, 4>{{{1, 0}, {0, 1}, {2, -1}, {-1, 2}}});
+    auto const expected = multiply(m, b);
+
+    auto out = algae::matrix<int, 3, 2>();
+    multiply(algae::view(m), algae::view(b), algae::view(out));
+    REQUIRE(out == expected);
+
+    auto out_col = algae::matrix<int, 3, 2, algae::column_major>();
+    multiply(algae::view(m), algae::view(b), algae::view(out_col));
+    REQUIRE(out_col == expected);
+
+    auto t = algae::matrix<int, 4, 3>();
+    transpose(algae::view(m), algae::view(t));
+    REQUIRE(t == transpose(m));
+
+    // shapes that only disagree at run time leave out as it was
+    auto const short_b = algae::matrix_view<int const>(b.data(), 3, 2, 2);
+    auto untouched = algae::matrix<int, 3, 2>();
+    multiply(algae::view(m), short_b, algae::view(untouched));
+    REQUIRE(untouched == algae::matrix<int, 3, 2>());
+    auto const narrow = algae::matrix_view<int>(t.data(), 3, 3, 3);
+    transpose(algae::view(m), narrow);
+    REQUIRE(t == transpose(m));
+  }
+}
+
+TEST_CASE("matrix blocks", "[view]") {
+  auto m = algae::matrix<int, 4, 5>();
+  for (std::size_t i = 0; i < 4; ++i) {
+    for (std::size_t j = 0; j < 5; ++j) {
+      m(i, j) = int(i * 10 + j);
+    }
+  }
+
+  SECTION("compile-time bounds") {
+    auto b = algae::block<1, 2, 2, 3>(m);
+    static_assert(std::is_same_v<decltype(b), algae::matrix_view<int, 2, 3>>);
+    REQUIRE(b(0, 0) == 12);
+    REQUIRE(b(1, 2) == 24);
+    REQUIRE(b.row_stride() == 5);
+
+    b(1, 1) = -1;
+    REQUIRE(m(2, 3) == -1);
+
+    // blocks of blocks
+    auto inner = algae::block<1, 1, 1, 2>(b);
+    REQUIRE(inner(0, 0) == -1);
+    REQUIRE(inner(0, 1) == 24);
+  }
+  SECTION("run-time bounds") {
+    auto const& cm = m;
+    auto b = algae::block(cm, 2, 1, 2, 4);
+    REQUIRE(b.height() == 2);
+    REQUIRE(b.width() == 4);
+    REQUIRE(b(0, 0) == 21);
+    REQUIRE(b(1, 3) == 34);
+    REQUIRE(b.column(2)[1] == 33);
+  }
+  SECTION("column-major") {
+    auto const col = algae::matrix<int, 4, 5, algae::column_major>(m);
+    auto b = algae::block<1, 2, 3, 2>(col);
+    for (std::size_t i = 0; i < 3; ++i) {
+      for (std::size_t j = 0; j < 2; ++j) {
+        REQUIRE(b(i, j) == m(i + 1, j + 2));
+      }
+    }
+  }
+  SECTION("constexpr") {
+    constexpr auto product = square_into_corner();
+    static_assert(product(1, 1) == 7);
+    static_assert(product(2, 2) == 22);
+    static_assert(product(0, 0) == 0);
+  }
+}